@@ -0,0 +1,302 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "hvpch.h"
+#include "Compression.h"
+
+namespace Havtorn
+{
+	namespace
+	{
+		constexpr U32 MinMatchLength = 4;
+		constexpr U32 MaxMatchOffset = 0xFFFF;
+		constexpr U32 HashBits = 12;
+		// Matches never start in the last bytes of a block, the tail is always stored as literals
+		constexpr U32 MatchSearchEndMargin = 12;
+
+		U32 Read32(const char* data)
+		{
+			U32 value = 0;
+			memcpy(&value, data, sizeof(U32));
+			return value;
+		}
+
+		U32 Hash(const U32 sequence)
+		{
+			return (sequence * 2654435761u) >> (32 - HashBits);
+		}
+
+		bool WriteLength(U32 length, char*& output, const char* outputEnd)
+		{
+			while (length >= 255)
+			{
+				if (output >= outputEnd)
+					return false;
+
+				*output++ = STATIC_I8(255);
+				length -= 255;
+			}
+
+			if (output >= outputEnd)
+				return false;
+
+			*output++ = STATIC_I8(length);
+			return true;
+		}
+
+		bool ReadLength(U32& length, const U8*& input, const U8* inputEnd)
+		{
+			U8 value = 255;
+			while (value == 255)
+			{
+				if (input >= inputEnd)
+					return false;
+
+				value = *input++;
+				length += value;
+			}
+			return true;
+		}
+
+		bool WriteSequence(const char* literals, const U32 numberOfLiterals, const U32 matchOffset, const U32 matchLength, char*& output, const char* outputEnd)
+		{
+			if (output >= outputEnd)
+				return false;
+
+			char* token = output++;
+			const U32 literalCode = UMath::Min(numberOfLiterals, 15u);
+			const U32 matchCode = matchLength > 0 ? UMath::Min(matchLength - MinMatchLength, 15u) : 0;
+			*token = STATIC_I8((literalCode << 4) | matchCode);
+
+			if (literalCode == 15 && !WriteLength(numberOfLiterals - 15, output, outputEnd))
+				return false;
+
+			if (outputEnd - output < STATIC_I64(numberOfLiterals))
+				return false;
+
+			memcpy(output, literals, numberOfLiterals);
+			output += numberOfLiterals;
+
+			// The last sequence of a block has no match
+			if (matchLength == 0)
+				return true;
+
+			if (outputEnd - output < 2)
+				return false;
+
+			*output++ = STATIC_I8(matchOffset & 0xFF);
+			*output++ = STATIC_I8(matchOffset >> 8);
+
+			if (matchCode == 15 && !WriteLength(matchLength - MinMatchLength - 15, output, outputEnd))
+				return false;
+
+			return true;
+		}
+	}
+
+	U32 UCompression::GetCompressBound(const U32 sourceSize)
+	{
+		// One length byte per 255 literals in the worst case, plus the token
+		return sourceSize + sourceSize / 255 + 16;
+	}
+
+	U32 UCompression::CompressBlock(const char* source, const U32 sourceSize, char* destination, const U32 destinationCapacity)
+	{
+		std::vector<U32> hashTable(1ull << HashBits, 0);
+
+		char* output = destination;
+		const char* outputEnd = destination + destinationCapacity;
+
+		U32 position = 0;
+		U32 anchor = 0;
+		while (sourceSize > MatchSearchEndMargin && position < sourceSize - MatchSearchEndMargin)
+		{
+			const U32 sequence = Read32(source + position);
+			const U32 hash = Hash(sequence);
+			const U32 candidate = hashTable[hash];
+			hashTable[hash] = position;
+
+			if (candidate >= position || position - candidate > MaxMatchOffset || Read32(source + candidate) != sequence)
+			{
+				position++;
+				continue;
+			}
+
+			U32 matchLength = MinMatchLength;
+			while (position + matchLength < sourceSize - MatchSearchEndMargin && source[candidate + matchLength] == source[position + matchLength])
+				matchLength++;
+
+			if (!WriteSequence(source + anchor, position - anchor, position - candidate, matchLength, output, outputEnd))
+				return 0;
+
+			position += matchLength;
+			anchor = position;
+		}
+
+		if (!WriteSequence(source + anchor, sourceSize - anchor, 0, 0, output, outputEnd))
+			return 0;
+
+		return STATIC_U32(output - destination);
+	}
+
+	bool UCompression::DecompressBlock(const char* source, const U32 sourceSize, char* destination, const U32 destinationSize)
+	{
+		const U8* input = reinterpret_cast<const U8*>(source);
+		const U8* inputEnd = input + sourceSize;
+		char* output = destination;
+		const char* outputEnd = destination + destinationSize;
+
+		while (input < inputEnd)
+		{
+			const U8 token = *input++;
+
+			U32 numberOfLiterals = token >> 4;
+			if (numberOfLiterals == 15 && !ReadLength(numberOfLiterals, input, inputEnd))
+				return false;
+
+			if (inputEnd - input < STATIC_I64(numberOfLiterals) || outputEnd - output < STATIC_I64(numberOfLiterals))
+				return false;
+
+			memcpy(output, input, numberOfLiterals);
+			input += numberOfLiterals;
+			output += numberOfLiterals;
+
+			if (input == inputEnd)
+				break;
+
+			if (inputEnd - input < 2)
+				return false;
+
+			const U32 matchOffset = input[0] | (input[1] << 8);
+			input += 2;
+
+			U32 matchLength = (token & 0xF);
+			if (matchLength == 15 && !ReadLength(matchLength, input, inputEnd))
+				return false;
+			matchLength += MinMatchLength;
+
+			if (matchOffset == 0 || matchOffset > STATIC_U64(output - destination) || outputEnd - output < STATIC_I64(matchLength))
+				return false;
+
+			// Byte by byte on purpose, the match may overlap the bytes it is writing
+			const char* match = output - matchOffset;
+			for (U32 i = 0; i < matchLength; i++)
+				output[i] = match[i];
+			output += matchLength;
+		}
+
+		return output == outputEnd;
+	}
+
+	void UCompression::CompressPayload(const char* source, const U64 sourceSize, std::vector<char>& outPayload)
+	{
+		const U32 numberOfChunks = STATIC_U32((sourceSize + PayloadChunkSize - 1) / PayloadChunkSize);
+		const U64 chunkTableSize = PayloadHeaderSize + sizeof(U32) * STATIC_U64(numberOfChunks);
+		outPayload.resize(chunkTableSize + STATIC_U64(numberOfChunks) * GetCompressBound(PayloadChunkSize));
+
+		memcpy(&outPayload[0], &sourceSize, sizeof(U64));
+		memcpy(&outPayload[sizeof(U64)], &numberOfChunks, sizeof(U32));
+
+		U64 payloadSize = chunkTableSize;
+		for (U32 chunkIndex = 0; chunkIndex < numberOfChunks; chunkIndex++)
+		{
+			const U64 chunkStart = STATIC_U64(chunkIndex) * PayloadChunkSize;
+			const U32 chunkSize = STATIC_U32(UMath::Min(STATIC_U64(PayloadChunkSize), sourceSize - chunkStart));
+
+			U32 storedChunkSize = CompressBlock(source + chunkStart, chunkSize, &outPayload[payloadSize], chunkSize);
+			U32 chunkInfo = storedChunkSize;
+			if (storedChunkSize == 0 || storedChunkSize >= chunkSize)
+			{
+				memcpy(&outPayload[payloadSize], source + chunkStart, chunkSize);
+				storedChunkSize = chunkSize;
+				chunkInfo = chunkSize | StoredChunkFlag;
+			}
+
+			memcpy(&outPayload[sizeof(U64) + sizeof(U32) * (STATIC_U64(chunkIndex) + 1)], &chunkInfo, sizeof(U32));
+			payloadSize += storedChunkSize;
+		}
+
+		outPayload.resize(payloadSize);
+	}
+
+	bool UCompression::IsPayloadValid(const char* payload, const U64 availableSize, U64& outPayloadSize)
+	{
+		if (availableSize < PayloadHeaderSize)
+			return false;
+
+		const U64 size = GetPayloadSize(payload);
+		U32 numberOfChunks = 0;
+		memcpy(&numberOfChunks, payload + sizeof(U64), sizeof(U32));
+		if (numberOfChunks != (size + PayloadChunkSize - 1) / PayloadChunkSize)
+			return false;
+
+		const char* chunkTable = payload + PayloadHeaderSize;
+		U64 payloadPosition = PayloadHeaderSize + sizeof(U32) * STATIC_U64(numberOfChunks);
+		if (payloadPosition > availableSize)
+			return false;
+
+		for (U32 chunkIndex = 0; chunkIndex < numberOfChunks; chunkIndex++)
+		{
+			U32 chunkInfo = 0;
+			memcpy(&chunkInfo, chunkTable + sizeof(U32) * STATIC_U64(chunkIndex), sizeof(U32));
+
+			const U32 sourceSize = chunkInfo & ~StoredChunkFlag;
+			if (sourceSize > availableSize - payloadPosition)
+				return false;
+
+			payloadPosition += sourceSize;
+		}
+
+		outPayloadSize = payloadPosition;
+		return true;
+	}
+
+	bool UCompression::GetPayloadChunks(const char* payload, const U64 availableSize, char* destination, std::vector<SCompressedChunk>& outChunks, U64& outPayloadSize)
+	{
+		if (!IsPayloadValid(payload, availableSize, outPayloadSize))
+			return false;
+
+		const U64 size = GetPayloadSize(payload);
+		const U32 numberOfChunks = STATIC_U32((size + PayloadChunkSize - 1) / PayloadChunkSize);
+		const char* chunkTable = payload + PayloadHeaderSize;
+		U64 payloadPosition = PayloadHeaderSize + sizeof(U32) * STATIC_U64(numberOfChunks);
+		for (U32 chunkIndex = 0; chunkIndex < numberOfChunks; chunkIndex++)
+		{
+			U32 chunkInfo = 0;
+			memcpy(&chunkInfo, chunkTable + sizeof(U32) * STATIC_U64(chunkIndex), sizeof(U32));
+
+			const U64 chunkStart = STATIC_U64(chunkIndex) * PayloadChunkSize;
+			SCompressedChunk& chunk = outChunks.emplace_back();
+			chunk.Source = payload + payloadPosition;
+			chunk.Destination = destination + chunkStart;
+			chunk.SourceSize = chunkInfo & ~StoredChunkFlag;
+			chunk.DestinationSize = STATIC_U32(UMath::Min(STATIC_U64(PayloadChunkSize), size - chunkStart));
+			chunk.IsStored = (chunkInfo & StoredChunkFlag) != 0;
+
+			payloadPosition += chunk.SourceSize;
+		}
+
+		return true;
+	}
+
+	bool UCompression::DecompressChunk(const SCompressedChunk& chunk)
+	{
+		if (!chunk.IsStored)
+			return DecompressBlock(chunk.Source, chunk.SourceSize, chunk.Destination, chunk.DestinationSize);
+
+		if (chunk.SourceSize != chunk.DestinationSize)
+			return false;
+
+		memcpy(chunk.Destination, chunk.Source, chunk.SourceSize);
+		return true;
+	}
+
+	bool UCompression::DecompressChunks(const std::vector<SCompressedChunk>& chunks)
+	{
+		for (const SCompressedChunk& chunk : chunks)
+		{
+			if (!DecompressChunk(chunk))
+				return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,58 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#pragma once
+
+#include "Core.h"
+
+namespace Havtorn
+{
+	// One independently decompressible chunk of a payload, see UCompression::CompressPayload
+	struct SCompressedChunk
+	{
+		const char* Source = nullptr;
+		char* Destination = nullptr;
+		U32 SourceSize = 0;
+		U32 DestinationSize = 0;
+		bool IsStored = false;
+	};
+
+	// LZ77 block codec in the style of LZ4. Every block is self contained, so blocks can be decompressed in any order
+	// and on any thread. A sequence is a token byte (literal length << 4 | match length - 4), the literals, and a
+	// two byte offset back into the already decompressed data. Lengths of 15 or more continue in extra bytes.
+	class UCompression
+	{
+	public:
+		static constexpr U32 PayloadChunkSize = 64 * 1024;
+		static constexpr U32 StoredChunkFlag = 0x80000000;
+
+		// Largest size CompressBlock can produce for sourceSize bytes of input
+		CORE_API static U32 GetCompressBound(const U32 sourceSize);
+
+		// Returns the compressed size, or 0 if the result would not fit in destinationCapacity
+		CORE_API static U32 CompressBlock(const char* source, const U32 sourceSize, char* destination, const U32 destinationCapacity);
+
+		// Fails on corrupt input, or if the block doesn't decompress to exactly destinationSize bytes
+		CORE_API static bool DecompressBlock(const char* source, const U32 sourceSize, char* destination, const U32 destinationSize);
+
+		// Splits source into PayloadChunkSize chunks and compresses them one by one, chunks that don't get smaller are stored.
+		// Layout: U64 uncompressed size, U32 number of chunks, a U32 size per chunk (with StoredChunkFlag if stored), the chunks.
+		CORE_API static void CompressPayload(const char* source, const U64 sourceSize, std::vector<char>& outPayload);
+
+		static constexpr U64 PayloadHeaderSize = sizeof(U64) + sizeof(U32);
+
+		// Reads the uncompressed size, payload has to hold at least PayloadHeaderSize bytes
+		[[nodiscard]] static U64 GetPayloadSize(const char* payload) { U64 size = 0; memcpy(&size, payload, sizeof(U64)); return size; }
+
+		// Whether the chunk table is consistent and every chunk lies within the availableSize bytes that can be read from
+		// payload. outPayloadSize is how many of them the payload takes up. Check before sizing anything by GetPayloadSize.
+		CORE_API static bool IsPayloadValid(const char* payload, const U64 availableSize, U64& outPayloadSize);
+
+		// Adds the chunks of payload to outChunks, decompressing into destination, which has to hold GetPayloadSize bytes.
+		// Nothing is decompressed yet. Returns false, adding no chunks, if IsPayloadValid does.
+		CORE_API static bool GetPayloadChunks(const char* payload, const U64 availableSize, char* destination, std::vector<SCompressedChunk>& outChunks, U64& outPayloadSize);
+
+		CORE_API static bool DecompressChunk(const SCompressedChunk& chunk);
+		// On the calling thread, stops at the first corrupt chunk
+		CORE_API static bool DecompressChunks(const std::vector<SCompressedChunk>& chunks);
+	};
+}
@@ -19,6 +19,86 @@ namespace Havtorn
 
 	const std::string UFileSystem::EngineConfig = "Config/EngineConfig.json";
 
+	CMappedFile::~CMappedFile()
+	{
+		Close();
+	}
+
+	CMappedFile::CMappedFile(CMappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	CMappedFile& CMappedFile::operator=(CMappedFile&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+
+		Close();
+		FileHandle = std::exchange(other.FileHandle, nullptr);
+		MappingHandle = std::exchange(other.MappingHandle, nullptr);
+		Data = std::exchange(other.Data, nullptr);
+		Size = std::exchange(other.Size, 0);
+		return *this;
+	}
+
+	bool CMappedFile::Open(const std::string& filePath)
+	{
+		Close();
+
+		HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			HV_LOG_ERROR("CMappedFile could not open file: %s", filePath.c_str());
+			return false;
+		}
+		FileHandle = file;
+
+		LARGE_INTEGER fileSize = {};
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			// Empty files can't be mapped, treat them as a failed open so callers only need one check
+			Close();
+			return false;
+		}
+		Size = STATIC_U64(fileSize.QuadPart);
+
+		MappingHandle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (MappingHandle == NULL)
+		{
+			HV_LOG_ERROR("CMappedFile could not create a file mapping for: %s", filePath.c_str());
+			Close();
+			return false;
+		}
+
+		Data = static_cast<const char*>(MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (Data == nullptr)
+		{
+			HV_LOG_ERROR("CMappedFile could not map a view of: %s", filePath.c_str());
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void CMappedFile::Close()
+	{
+		if (Data != nullptr)
+			UnmapViewOfFile(Data);
+
+		if (MappingHandle != nullptr)
+			CloseHandle(MappingHandle);
+
+		if (FileHandle != nullptr)
+			CloseHandle(FileHandle);
+
+		FileHandle = nullptr;
+		MappingHandle = nullptr;
+		Data = nullptr;
+		Size = 0;
+	}
+
 	bool UFileSystem::Exists(const std::string& path)
 	{
 		return std::filesystem::exists(path);
@@ -66,6 +146,41 @@ namespace Havtorn
 			HV_LOG_ERROR("FileSystem encountered an operation error after closing the output stream");
 	}
 
+	bool UFileSystem::SerializeAtomic(const std::string& filePath, const char* data, U64 size)
+	{
+		// Next to the destination so the rename stays on one volume
+		const std::string temporaryPath = filePath + ".tmp";
+		{
+			std::ofstream outputStream(temporaryPath, fstream::out | fstream::binary | fstream::trunc);
+			if (!outputStream)
+			{
+				HV_LOG_ERROR("FileSystem could not open file: %s", temporaryPath.c_str());
+				return false;
+			}
+
+			outputStream.write(data, size);
+			outputStream.close();
+
+			if (outputStream.fail())
+			{
+				HV_LOG_ERROR("FileSystem could not write file: %s", temporaryPath.c_str());
+				Remove(temporaryPath);
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryPath, filePath, error);
+		if (error)
+		{
+			HV_LOG_ERROR("FileSystem could not replace %s: %s", filePath.c_str(), error.message().c_str());
+			Remove(temporaryPath);
+			return false;
+		}
+
+		return true;
+	}
+
 	void UFileSystem::Deserialize(const std::string& filePath, char* data, U32 size)
 	{
 		std::ifstream inputStream;
@@ -217,6 +332,27 @@ namespace Havtorn
 		return defaultValue;
 	}
 
+	std::map<std::string, std::string> CJsonDocument::GetValuesFromArray(const std::string& arrayName) const
+	{
+		std::map<std::string, std::string> values;
+		if (!HasMember(arrayName) || !Document[arrayName.c_str()].IsArray())
+			return values;
+
+		for (const auto& v : Document[arrayName.c_str()].GetArray())
+		{
+			if (!v.IsObject())
+				continue;
+
+			for (const auto& member : v.GetObject())
+			{
+				if (member.value.IsString())
+					values.emplace(member.name.GetString(), member.value.GetString());
+			}
+		}
+
+		return values;
+	}
+
 	void CJsonDocument::RemoveValueFromArray(const std::string& arrayName, const std::string& valueName)
 	{
 		if (!HasMember(arrayName) || !Document[arrayName.c_str()].IsArray())
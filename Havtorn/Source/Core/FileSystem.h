@@ -74,6 +74,8 @@ namespace Havtorn
 	
 		CORE_API void WriteValueToArray(const std::string& arrayName, const std::string& valueName, const std::string& value);
 		CORE_API std::string GetValueFromArray(const std::string& arrayName, const std::string& valueName, const std::string& defaultValue = std::string());
+		// Every name and value in an array written by WriteValueToArray
+		CORE_API std::map<std::string, std::string> GetValuesFromArray(const std::string& arrayName) const;
 		CORE_API void RemoveValueFromArray(const std::string& arrayName, const std::string& valueName);
 
 		CORE_API void ClearArray(const std::string& arrayName);
@@ -98,6 +100,31 @@ namespace Havtorn
 		return Document[memberName.c_str()].Get<T>();
 	}
 
+	// Read-only view of a whole file. Pages are read in by the OS when first touched instead of being copied up front.
+	class CMappedFile
+	{
+	public:
+		CMappedFile() = default;
+		CORE_API ~CMappedFile();
+		CMappedFile(const CMappedFile&) = delete;
+		CMappedFile& operator=(const CMappedFile&) = delete;
+		CORE_API CMappedFile(CMappedFile&& other) noexcept;
+		CORE_API CMappedFile& operator=(CMappedFile&& other) noexcept;
+
+		CORE_API bool Open(const std::string& filePath);
+		CORE_API void Close();
+
+		[[nodiscard]] const char* GetData() const { return Data; }
+		[[nodiscard]] U64 GetSize() const { return Size; }
+		[[nodiscard]] bool IsOpen() const { return Data != nullptr; }
+
+	private:
+		void* FileHandle = nullptr;
+		void* MappingHandle = nullptr;
+		const char* Data = nullptr;
+		U64 Size = 0;
+	};
+
 	class UFileSystem
 	{
 		friend class GEngine;
@@ -113,6 +140,8 @@ namespace Havtorn
 		static CORE_API CJsonDocument OpenJson(const std::string& filePath);
 
 		static void CORE_API Serialize(const std::string& filePath, const char* data, U32 size);
+		// Writes to a temporary file next to filePath and renames it over filePath, so filePath is never left half written
+		static bool CORE_API SerializeAtomic(const std::string& filePath, const char* data, U64 size);
 		static void CORE_API Deserialize(const std::string& filePath, char* data, U32 size);
 		static void CORE_API Deserialize(const std::string& filePath, std::string& outData);
 
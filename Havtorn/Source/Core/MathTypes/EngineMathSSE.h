@@ -84,4 +84,105 @@ namespace Havtorn
 	{
 		_mm_add_ps(_mm_mul_ps(vec1, vec2), vec3);
 	}
+
+	/**
+	 * Replicates a scalar into all four elements.
+	 */
+	inline VectorRegister VectorRegisterSet1(F32 value)
+	{
+		return _mm_set1_ps(value);
+	}
+
+	/**
+	 * Loads 4 floats from unaligned memory.
+	 */
+	inline VectorRegister VectorRegisterLoad(const F32* registerPointer)
+	{
+		return _mm_loadu_ps(registerPointer);
+	}
+
+	/**
+	 * Stores 4 floats to unaligned memory.
+	 */
+	inline void VectorRegisterStore(const VectorRegister& vectorRegister, F32* registerPointer)
+	{
+		_mm_storeu_ps(registerPointer, vectorRegister);
+	}
+
+	inline VectorRegister VectorRegisterDivide(const VectorRegister& vec1, const VectorRegister& vec2)
+	{
+		return _mm_div_ps(vec1, vec2);
+	}
+
+	/**
+	 * Transposes the 4x4 matrix the registers form as rows, e.g. four quaternions into their X, Y, Z and W lanes and back.
+	 */
+	inline void VectorRegisterTranspose(VectorRegister& row0, VectorRegister& row1, VectorRegister& row2, VectorRegister& row3)
+	{
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+	}
+
+	inline VectorRegister VectorRegisterMin(const VectorRegister& vec1, const VectorRegister& vec2)
+	{
+		return _mm_min_ps(vec1, vec2);
+	}
+
+	inline VectorRegister VectorRegisterMax(const VectorRegister& vec1, const VectorRegister& vec2)
+	{
+		return _mm_max_ps(vec1, vec2);
+	}
+
+	inline VectorRegister VectorRegisterSqrt(const VectorRegister& vectorRegister)
+	{
+		return _mm_sqrt_ps(vectorRegister);
+	}
+
+	/**
+	 * Per element comparisons. Each element of the result is all ones if the comparison holds, otherwise zero.
+	 */
+	inline VectorRegister VectorRegisterCompareLessEqual(const VectorRegister& vec1, const VectorRegister& vec2)
+	{
+		return _mm_cmple_ps(vec1, vec2);
+	}
+
+	inline VectorRegister VectorRegisterCompareGreater(const VectorRegister& vec1, const VectorRegister& vec2)
+	{
+		return _mm_cmpgt_ps(vec1, vec2);
+	}
+
+	inline VectorRegister VectorRegisterCompareGreaterEqual(const VectorRegister& vec1, const VectorRegister& vec2)
+	{
+		return _mm_cmpge_ps(vec1, vec2);
+	}
+
+	inline VectorRegister VectorRegisterAnd(const VectorRegister& vec1, const VectorRegister& vec2)
+	{
+		return _mm_and_ps(vec1, vec2);
+	}
+
+	inline VectorRegister VectorRegisterOr(const VectorRegister& vec1, const VectorRegister& vec2)
+	{
+		return _mm_or_ps(vec1, vec2);
+	}
+
+	/**
+	 * Picks elements from vec1 where mask is set and from vec2 elsewhere.
+	 * 
+	 * @param mask Result of a comparison, each element all ones or zero.
+	 */
+	inline VectorRegister VectorRegisterSelect(const VectorRegister& mask, const VectorRegister& vec1, const VectorRegister& vec2)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, vec1), _mm_andnot_ps(mask, vec2));
+	}
+
+	/**
+	 * Gathers the sign bit of each element into the lowest four bits of an integer.
+	 * 
+	 * @param vectorRegister Usually the result of a comparison.
+	 * @return Bit i is set if element i has its sign bit set.
+	 */
+	inline I32 VectorRegisterMoveMask(const VectorRegister& vectorRegister)
+	{
+		return _mm_movemask_ps(vectorRegister);
+	}
 }
@@ -2,6 +2,10 @@
 
 #pragma once
 
+#include "Compression.h"
+
+#include <span>
+
 //#define LOG_SERIALIZATION
 
 #ifdef LOG_SERIALIZATION
@@ -97,10 +101,8 @@ namespace Havtorn
 		U32 size = 0;
 		DeserializeData(size, source, pointerPosition);
 		const U32 numberOfElements = size / sizeof(T);
-		const auto intermediateVector = new T[numberOfElements];
-		memcpy(&intermediateVector[0], &source[pointerPosition], size);
-		destination.assign(&intermediateVector[0], &intermediateVector[0] + numberOfElements);
-		delete[] intermediateVector;
+		destination.resize(numberOfElements);
+		memcpy(destination.data(), &source[pointerPosition], size);
 		LOG_SERIALIZE("Deserialized vector data of type %s and size %i at position %i -> %i", typeid(T).name(), size, pointerPosition, pointerPosition + size);
 		pointerPosition += size;
 	}
@@ -113,4 +115,93 @@ namespace Havtorn
 		LOG_SERIALIZE("Deserialized data of type std::string and size %i at position %i -> %i", size, pointerPosition, pointerPosition + size);
 		pointerPosition += size;
 	}
+
+	// Aligned blobs are padded relative to the start of the buffer. Files are always read from the start into heap memory
+	// or a mapped view, both of which are aligned at least this much, so the blobs can be used in place.
+	constexpr U64 SerializedBlobAlignment = 16;
+
+	inline U64 GetAlignedBlobPosition(const U64 pointerPosition)
+	{
+		return (pointerPosition + SerializedBlobAlignment - 1) & ~(SerializedBlobAlignment - 1);
+	}
+
+	// Depends on where the blob is written, pointerPosition is the running size of everything before it
+	template<typename T>
+	U32 GetAlignedDataSize(const std::vector<T>& objects, const U32 pointerPosition)
+	{
+		const U64 dataPosition = GetAlignedBlobPosition(pointerPosition + sizeof(U32));
+		const U32 size = STATIC_U32(dataPosition - pointerPosition) + sizeof(T) * STATIC_U32(objects.size());
+		LOG_SERIALIZE("Aligned data vector of type %s was registered for serialization with size %i", typeid(T).name(), size);
+		return size;
+	}
+
+	template<typename T>
+	void SerializeAlignedData(const std::vector<T>& source, char* destination, U64& pointerPosition)
+	{
+		const U32 size = sizeof(T) * STATIC_U32(source.size());
+		SerializeData(size, destination, pointerPosition);
+		const U64 dataPosition = GetAlignedBlobPosition(pointerPosition);
+		memset(&destination[pointerPosition], 0, dataPosition - pointerPosition);
+		pointerPosition = dataPosition;
+		memcpy(&destination[pointerPosition], source.data(), size);
+		LOG_SERIALIZE("Serialized aligned vector data of type %s and size %i at position %i -> %i", typeid(T).name(), size, pointerPosition, pointerPosition + size);
+		pointerPosition += size;
+	}
+
+	// Points straight into source, only valid for as long as source is
+	template<typename T>
+	void DeserializeAlignedData(std::span<const T>& destination, const char* source, U64& pointerPosition)
+	{
+		U32 size = 0;
+		DeserializeData(size, source, pointerPosition);
+		pointerPosition = GetAlignedBlobPosition(pointerPosition);
+		destination = std::span<const T>(reinterpret_cast<const T*>(&source[pointerPosition]), size / sizeof(T));
+		LOG_SERIALIZE("Deserialized aligned vector view of type %s and size %i at position %i -> %i", typeid(T).name(), size, pointerPosition, pointerPosition + size);
+		pointerPosition += size;
+	}
+
+	template<typename T>
+	void DeserializeAlignedData(std::vector<T>& destination, const char* source, U64& pointerPosition)
+	{
+		std::span<const T> view;
+		DeserializeAlignedData(view, source, pointerPosition);
+		destination.assign(view.begin(), view.end());
+	}
+
+	// Compressed blobs are compressed ahead of serialization, GetSize has to know how large they end up.
+	// Works on vectors and strings alike. The payload holds its own sizes, so it is written as is.
+	template<typename T>
+	void CompressData(const T& source, std::vector<char>& outPayload)
+	{
+		UCompression::CompressPayload(reinterpret_cast<const char*>(source.data()), sizeof(typename T::value_type) * source.size(), outPayload);
+	}
+
+	inline void SerializeCompressedData(const std::vector<char>& payload, char* destination, U64& pointerPosition)
+	{
+		memcpy(&destination[pointerPosition], payload.data(), payload.size());
+		LOG_SERIALIZE("Serialized compressed data of size %i at position %i -> %i", payload.size(), pointerPosition, pointerPosition + payload.size());
+		pointerPosition += payload.size();
+	}
+
+	// Sizes destination and adds the chunks that decompress straight into it to outChunks, nothing is decompressed yet.
+	// destination must not be resized until the chunks are decompressed. Returns false, leaving destination empty, if the
+	// payload is corrupt or runs past the sourceSize bytes of source. Nothing after it can be read then.
+	template<typename T>
+	bool DeserializeCompressedData(T& destination, const char* source, const U64 sourceSize, U64& pointerPosition, std::vector<SCompressedChunk>& outChunks)
+	{
+		const U64 availableSize = pointerPosition < sourceSize ? sourceSize - pointerPosition : 0;
+		U64 payloadSize = 0;
+		if (!UCompression::IsPayloadValid(&source[pointerPosition], availableSize, payloadSize))
+		{
+			destination.clear();
+			return false;
+		}
+
+		const U64 size = UCompression::GetPayloadSize(&source[pointerPosition]);
+		destination.resize(size / sizeof(typename T::value_type));
+		UCompression::GetPayloadChunks(&source[pointerPosition], availableSize, reinterpret_cast<char*>(destination.data()), outChunks, payloadSize);
+		LOG_SERIALIZE("Deserialized compressed data of size %i at position %i -> %i", size, pointerPosition, pointerPosition + payloadSize);
+		pointerPosition += payloadSize;
+		return true;
+	}
 }
@@ -359,7 +359,7 @@ namespace Havtorn
 
 			SRenderCommand command;
 			command.Type = ERenderCommandType::GBufferDataInstanced;
-			command.U32s.push_back(MaterialToolPreviewAssetID);
+			command.U64s.push_back(MaterialToolPreviewAssetID);
 			command.DrawCallData.emplace_back(data);
 			command.Materials.push_back(MaterialData);
 			command.MaterialRenderTextures.push_back(MaterialData.GetRenderTextures(MaterialToolRenderID));
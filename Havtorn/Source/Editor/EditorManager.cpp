@@ -12,6 +12,7 @@
 #include <Input/InputTypes.h>
 
 #include <Graphics/RenderManager.h>
+#include <Graphics/Debug/DebugDrawUtility.h>
 #include <ECS/ECSInclude.h>
 #include <ECS/ComponentAlgo.h>
 
@@ -208,6 +209,33 @@ namespace Havtorn
 				GUI::Text(GetSystemMemory().c_str());
 				GUI::Text(GetRenderInfo().c_str());
 
+				if (CRenderSystem* renderSystem = World->GetSystem<CRenderSystem>())
+				{
+					bool occlusionCulling = renderSystem->IsOcclusionCullingEnabled();
+					if (GUI::Checkbox("Occlusion Culling", occlusionCulling))
+						renderSystem->SetOcclusionCullingEnabled(occlusionCulling);
+
+					bool lightClustering = renderSystem->IsLightClusteringEnabled();
+					if (GUI::Checkbox("Light Clustering", lightClustering))
+						renderSystem->SetLightClusteringEnabled(lightClustering);
+				}
+
+				static bool shouldCompressArchive = true;
+				GUI::Checkbox("Compress Asset Archive", shouldCompressArchive);
+				if (GUI::Button("Pack Assets"))
+					UAssetArchivePacker::Pack({ "Resources/", "Assets/" }, CAssetRegistry::ArchiveDirectory + "Assets.hvpak", shouldCompressArchive);
+
+				GUI::Checkbox("Compress Saved Asset Payloads", GEngine::GetAssetRegistry()->ShouldCompressPayloads);
+				GUI::Checkbox("Quantize Saved Mesh Vertices", GEngine::GetAssetRegistry()->ShouldQuantizeVertices);
+				GUI::Checkbox("Resample Animation Clips", GEngine::GetWorld()->GetSystem<CAnimatorGraphSystem>()->ShouldResampleClips);
+				GUI::Checkbox("Animation LOD", GEngine::GetWorld()->GetSystem<CAnimatorGraphSystem>()->IsAnimationLODEnabled);
+
+				static std::string warmDerivedDataCacheResult = "";
+				if (GUI::Button("Warm Derived Data Cache"))
+					warmDerivedDataCacheResult = GEngine::GetAssetRegistry()->WarmDerivedDataCache("Assets/");
+				if (!warmDerivedDataCacheResult.empty())
+					GUI::Text(warmDerivedDataCacheResult.c_str());
+
 				static bool debugRegistry = false;
 				GUI::Checkbox("Show Registry Details", debugRegistry);
 				GUI::Text(GEngine::GetAssetRegistry()->GetDebugString(debugRegistry).c_str());
@@ -407,15 +435,77 @@ namespace Havtorn
 		HV_ASSERT(!entry.is_directory(), "You are trying to create SEditorAssetRepresentation but you're creating a new folder.");
 
 		std::string filePath = path.string();
-		const U64 fileSize = UMath::Max(UFileSystem::GetFileSize(filePath), sizeof(EAssetType));
+		const U64 fileSize = UMath::Max(UFileSystem::GetFileSize(filePath), sizeof(U32) + sizeof(EAssetType));
 		char* data = new char[fileSize];
 
 		UFileSystem::Deserialize(filePath, data, STATIC_U32(fileSize));
 
 		SEditorAssetRepresentation rep;
 
-		const U32 size = sizeof(EAssetType);
-		memcpy(&rep.AssetType, &data[0], size);
+		// Newer mesh, animation and texture files start with a magic, the asset type follows it
+		U64 pointerPosition = 0;
+		bool isQuantized = false;
+		rep.AssetType = DeserializeAssetType(data, pointerPosition, nullptr, &isQuantized);
+
+		// Vertex memory of every mesh, as loaded against what the compact layout takes up
+		auto getMeshStats = [&](const auto& header, const auto& compactVertex)
+			{
+				const U64 fullVertexSize = sizeof(header.Meshes[0].Vertices[0]);
+				const U64 compactVertexSize = sizeof(compactVertex);
+				auto toKB = [](const U64 bytes) { return STATIC_F32(bytes) / 1024.0f; };
+
+				std::string stats = std::format("Stored {} vertices", isQuantized ? "compact" : "full");
+				U64 totalSaved = 0;
+				for (U32 i = 0; i < header.NumberOfMeshes; i++)
+				{
+					U64 numberOfVertices = header.Meshes[i].Vertices.size();
+					if constexpr (std::is_same_v<std::remove_cvref_t<decltype(header)>, SStaticModelFileHeader>)
+					{
+						for (const auto& lod : header.LODs)
+							numberOfVertices += lod.Meshes[i].Vertices.size();
+					}
+
+					const U64 saved = numberOfVertices * (fullVertexSize - compactVertexSize);
+					totalSaved += saved;
+					stats.append(std::format("\n{}: {} vertices, {:.1f} KB -> {:.1f} KB compact, {:.1f} KB saved",
+						header.Meshes[i].Name, numberOfVertices, toKB(numberOfVertices * fullVertexSize), toKB(numberOfVertices * compactVertexSize), toKB(saved)));
+				}
+
+				stats.append(std::format("\nTotal saved: {:.1f} KB", toKB(totalSaved)));
+				return stats;
+			};
+
+		if (rep.AssetType == EAssetType::StaticMesh)
+		{
+			SStaticModelFileHeader header;
+			header.Deserialize(data, fileSize);
+			rep.Stats = getMeshStats(header, SCompactStaticMeshVertex());
+		}
+		else if (rep.AssetType == EAssetType::SkeletalMesh)
+		{
+			SSkeletalModelFileHeader header;
+			header.Deserialize(data, fileSize);
+			rep.Stats = getMeshStats(header, SCompactSkeletalMeshVertex());
+		}
+		else if (rep.AssetType == EAssetType::Animation)
+		{
+			// Keys left after reduction, as loaded against what the compact layout takes up
+			SSkeletalAnimationFileHeader header;
+			header.Deserialize(data, fileSize);
+
+			U64 numberOfVecKeys = 0;
+			U64 numberOfQuatKeys = 0;
+			for (const SBoneAnimationTrack& track : header.BoneAnimationTracks)
+			{
+				numberOfVecKeys += track.TranslationKeys.size() + track.ScaleKeys.size();
+				numberOfQuatKeys += track.RotationKeys.size();
+			}
+
+			auto toKB = [](const U64 bytes) { return STATIC_F32(bytes) / 1024.0f; };
+			const U64 fullSize = numberOfVecKeys * sizeof(SVecBoneAnimationKey) + numberOfQuatKeys * sizeof(SQuatBoneAnimationKey);
+			const U64 compactSize = numberOfVecKeys * sizeof(SCompactVecAnimationKey) + numberOfQuatKeys * sizeof(SCompactQuatAnimationKey);
+			rep.Stats = std::format("Stored {} keys\n{} keys, {:.1f} KB -> {:.1f} KB compact", isQuantized ? "compact" : "full", numberOfVecKeys + numberOfQuatKeys, toKB(fullSize), toKB(compactSize));
+		}
 
 		rep.DirectoryEntry = entry;
 		rep.Name = entry.path().filename().string();
@@ -1068,8 +1158,83 @@ namespace Havtorn
 	{
 		std::string info = "Draw Calls: ";
 		info.append(std::to_string(CRenderManager::NumberOfDrawCallsThisFrame));
+		info.append("\nState Binds: ");
+		info.append(std::to_string(CRenderStateManager::NumberOfStateBindsThisFrame));
+		info.append(" (");
+		info.append(std::to_string(CRenderStateManager::NumberOfStateBindsAvoidedThisFrame));
+		info.append(" avoided)");
 		info.append("\nRender Views: ");
 		info.append(std::to_string(RenderManager->GetNumberOfRenderViews()));
+
+		const SLightClusterStats lightClusterStats = RenderManager->GetMainCameraLightClusterStats();
+		info.append("\nClustered Lights: ");
+		info.append(std::to_string(lightClusterStats.NumberOfPointLights + lightClusterStats.NumberOfSpotLights));
+		info.append("\nLight Assignments: ");
+		info.append(std::to_string(lightClusterStats.NumberOfLightAssignments));
+		info.append(" (");
+		info.append(std::to_string(lightClusterStats.NumberOfOccupiedClusters));
+		info.append(" clusters, max ");
+		info.append(std::to_string(lightClusterStats.MaxLightsInCluster));
+		info.append(")");
+		if (lightClusterStats.NumberOfDroppedAssignments > 0)
+		{
+			info.append("\nDropped Light Assignments: ");
+			info.append(std::to_string(lightClusterStats.NumberOfDroppedAssignments));
+		}
+
+		const SOcclusionCullingStats occlusionStats = RenderManager->GetMainCameraOcclusionCullingStats();
+		info.append("\nStatic Meshes Drawn: ");
+		info.append(std::to_string(occlusionStats.NumberOfVisibleInstances));
+		info.append("\nStatic Meshes Culled: ");
+		info.append(std::to_string(occlusionStats.NumberOfFrustumCulledInstances + occlusionStats.NumberOfOccludedInstances));
+		info.append(" (");
+		info.append(std::to_string(occlusionStats.NumberOfOccludedInstances));
+		info.append(" occluded by ");
+		info.append(std::to_string(occlusionStats.NumberOfOccluders));
+		info.append(" occluders)");
+
+		if (const CAnimatorGraphSystem* animatorGraphSystem = GEngine::GetWorld()->GetSystem<CAnimatorGraphSystem>())
+		{
+			const SAnimationUpdateStats& animationStats = animatorGraphSystem->GetStats();
+			info.append("\nSkeletons Updated: ");
+			info.append(std::to_string(animationStats.NumberOfEvaluatedSkeletons));
+			info.append(" (");
+			info.append(std::to_string(animationStats.NumberOfInterpolatedSkeletons));
+			info.append(" interpolated, ");
+			info.append(std::to_string(animationStats.NumberOfCulledSkeletons));
+			info.append(" culled)");
+			if (animationStats.NumberOfDeferredSkeletons > 0)
+			{
+				info.append("\nSkeletons Over Budget: ");
+				info.append(std::to_string(animationStats.NumberOfDeferredSkeletons));
+			}
+			if (animationStats.NumberOfPoseCacheLookups > 0)
+			{
+				info.append("\nShared Poses: ");
+				info.append(std::to_string(animationStats.NumberOfSharedPoses));
+				info.append(" of ");
+				info.append(std::to_string(animationStats.NumberOfPoseCacheLookups));
+			}
+			if (animationStats.NumberOfAtlasSkeletons > 0)
+			{
+				info.append("\nFrom Animation Atlas: ");
+				info.append(std::to_string(animationStats.NumberOfAtlasSkeletons));
+			}
+		}
+
+		const SDebugDrawStats debugDrawStats = GDebugDraw::GetStats();
+		info.append("\nDebug Shapes: ");
+		info.append(std::to_string(debugDrawStats.NumberOfFrameShapes + debugDrawStats.NumberOfTimedShapes));
+		info.append(" (");
+		info.append(std::to_string(debugDrawStats.NumberOfTimedShapes));
+		info.append(" timed, ");
+		info.append(std::to_string(debugDrawStats.NumberOfBatches));
+		info.append(" batches)");
+		if (debugDrawStats.NumberOfOverwrittenShapes > 0)
+		{
+			info.append("\nDebug Shapes Overwritten: ");
+			info.append(std::to_string(debugDrawStats.NumberOfOverwrittenShapes));
+		}
 		return info;
 	}
 }
@@ -80,6 +80,8 @@ namespace Havtorn
 		CRenderTexture TextureRef;
 		// TODO.NW: Make static string, figure out relationship to engine asset
 		std::string Name = "";
+		// Shown when hovering the asset in the browser, only filled for meshes
+		std::string Stats = "";
 		bool UsingEditorTexture = false;
 		bool IsSourceWatched = false;
 		bool IsBeingNamed = false;
@@ -115,7 +115,7 @@ namespace Havtorn
 
 				SRenderCommand command;
 				command.Type = ERenderCommandType::GBufferDataInstanced;
-				command.U32s.push_back(assetID);
+				command.U64s.push_back(assetID);
 				command.DrawCallData.emplace_back(drawCallData);
 				command.Materials.push_back(asset->Material);
 				command.MaterialRenderTextures.push_back(asset->Material.GetRenderTextures(assetID));
@@ -333,7 +333,25 @@ namespace Havtorn
 		sourceData.AssetDependencyPath = importOptions.AssetRep != nullptr ? importOptions.AssetRep->DirectoryEntry.path().string() : "N/A";
 		sourceData.ImportScale = importOptions.Scale;
 
-		return GEngine::GetAssetRegistry()->ImportAsset(filePath, destinationPath, sourceData);
+		return GEngine::GetAssetRegistry()->ImportAsset(filePath, destinationPath, sourceData, importOptions.LODSettings);
+	}
+
+	SAssetBatchImportHandle CEditorResourceManager::ConvertToHVA(const std::vector<std::string>& filePaths, const std::string& destinationPath, const SAssetImportOptions& importOptions) const
+	{
+		std::vector<SAssetImportRequest> requests;
+		for (const std::string& filePath : filePaths)
+		{
+			SAssetImportRequest& request = requests.emplace_back();
+			request.FilePath = filePath;
+			request.DestinationPath = destinationPath;
+			request.SourceData.AssetType = importOptions.AssetType;
+			request.SourceData.SourcePath = filePath;
+			request.SourceData.AssetDependencyPath = importOptions.AssetRep != nullptr ? importOptions.AssetRep->DirectoryEntry.path().string() : "N/A";
+			request.SourceData.ImportScale = importOptions.Scale;
+			request.LODSettings = importOptions.LODSettings;
+		}
+
+		return GEngine::GetAssetRegistry()->ImportAssetsAsync(requests);
 	}
 
 	void CEditorResourceManager::CreateMaterial(const std::string& destinationPath, const SMaterialAssetFileHeader& fileHeader) const
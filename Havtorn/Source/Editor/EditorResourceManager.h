@@ -6,6 +6,7 @@
 #include <string>	
 
 #include <Havtorn.h>
+#include <Assets/AssetRegistry.h>
 #include <Graphics/RenderingPrimitives/RenderTexture.h>
 
 namespace Havtorn
@@ -52,6 +53,7 @@ namespace Havtorn
 		EAssetType AssetType = EAssetType::None;
 		SEditorAssetRepresentation* AssetRep = nullptr;
 		F32 Scale = 1.0f;
+		SStaticMeshLODImportSettings LODSettings;
 	};
 
 	class CEditorResourceManager
@@ -68,6 +70,8 @@ namespace Havtorn
 
 		EDITOR_API std::string CreateAsset(const std::string& destinationPath, const SAssetFileHeader& fileHeader) const;
 		EDITOR_API std::string ConvertToHVA(const std::string& filePath, const std::string& destinationPath, const SAssetImportOptions& importOptions) const;
+		// Imports every file with the same options on the job threads, poll the handle for when the assets are ready
+		EDITOR_API SAssetBatchImportHandle ConvertToHVA(const std::vector<std::string>& filePaths, const std::string& destinationPath, const SAssetImportOptions& importOptions) const;
 
 		EDITOR_API void CreateMaterial(const std::string& destinationPath, const SMaterialAssetFileHeader& fileHeader) const;
 		
@@ -177,6 +177,28 @@ namespace Havtorn
 			GUI::EndChild();
 		}
 
+		if (BatchImport.has_value())
+		{
+			if (BatchImport->IsDone())
+			{
+				for (const std::string& hvaFilePath : BatchImport->GetImportedPaths())
+				{
+					std::filesystem::directory_entry newDir;
+					newDir.assign(std::filesystem::path(hvaFilePath));
+					Manager->RemoveAssetRep(newDir);
+					Manager->CreateAssetRep(hvaFilePath);
+				}
+				BatchImport.reset();
+			}
+			else
+			{
+				GUI::Text("Importing %u/%u assets", BatchImport->GetNumberOfFinished(), BatchImport->GetNumberOfRequests());
+				GUI::SameLine();
+				if (GUI::Button("Cancel Import"))
+					BatchImport->Cancel();
+			}
+		}
+
 		if (FilePathsToImport.has_value() && !FilePathsToImport->empty())
 		{
 			GUI::OpenPopup("Asset Import");
@@ -376,10 +398,25 @@ namespace Havtorn
 			return;
 		}
 
+		// The rest of the dropped files with the same extension can be imported with these options in one batch
+		std::vector<std::string> batchFilePaths;
+		for (const std::string& path : *FilePathsToImport)
+		{
+			if (UGeneralUtils::ExtractFileExtensionFromPath(path) == fileExtension)
+				batchFilePaths.push_back(path);
+		}
+		const bool canImportBatch = batchFilePaths.size() > 1 && !BatchImport.has_value();
+		const std::string importAllLabel = "Import All (" + std::to_string(batchFilePaths.size()) + ")";
+
 		// Center buttons
 		F32 width = 0.0f;
 		width += GUI::CalculateTextSize("Import").X + GUI::ThumbnailPadding;
 		width += GUI::GetStyleVar(EStyleVar::ItemSpacing).X;
+		if (canImportBatch)
+		{
+			width += GUI::CalculateTextSize(importAllLabel.c_str()).X + GUI::ThumbnailPadding;
+			width += GUI::GetStyleVar(EStyleVar::ItemSpacing).X;
+		}
 		width += GUI::CalculateTextSize("Cancel").X + GUI::ThumbnailPadding;
 		AlignForWidth(width);
 
@@ -397,6 +434,16 @@ namespace Havtorn
 
 		GUI::SameLine();
 
+		if (canImportBatch && GUI::Button(importAllLabel.c_str()))
+		{
+			BatchImport = Manager->GetResourceManager()->ConvertToHVA(batchFilePaths, CurrentDirectory.string() + "\\", ImportOptions);
+			std::erase_if(*FilePathsToImport, [&](const std::string& path) { return path != filePath && std::ranges::find(batchFilePaths, path) != batchFilePaths.end(); });
+			closePopup();
+		}
+
+		if (canImportBatch)
+			GUI::SameLine();
+
 		if (GUI::Button("Cancel"))
 		{
 			closePopup();
@@ -501,6 +548,18 @@ namespace Havtorn
 	void CAssetBrowserWindow::ImportOptionsStaticMesh()
 	{
 		GUI::DragFloat("Import Scale", ImportOptions.Scale, 0.01f);
+
+		SStaticMeshLODImportSettings& lodSettings = ImportOptions.LODSettings;
+		I32 numberOfLODs = STATIC_I32(lodSettings.NumberOfLODs);
+		if (GUI::SliderInt("Generated LODs", numberOfLODs, 0, 4))
+			lodSettings.NumberOfLODs = STATIC_U8(numberOfLODs);
+
+		if (lodSettings.NumberOfLODs == 0)
+			return;
+
+		GUI::SliderFloat("LOD Triangle Ratio", lodSettings.TriangleRatio, 0.1f, 0.9f);
+		GUI::SliderFloat("LOD1 Screen Size", lodSettings.FirstScreenSize, 0.05f, 1.0f);
+		GUI::SliderFloat("LOD Max Error", lodSettings.MaxError, 0.001f, 0.1f);
 	}
 
 	void CAssetBrowserWindow::ImportOptionsSkeletalMesh()
@@ -646,8 +705,7 @@ namespace Havtorn
 						std::string oldPath = payloadAssetRep->DirectoryEntry.path().string().c_str();
 						std::string newPath = (entry.path() / payloadAssetRep->DirectoryEntry.path().filename()).string().c_str();
 
-						CJsonDocument config = UFileSystem::OpenJson(UFileSystem::EngineConfig);
-						config.WriteValueToArray("Asset Redirectors", oldPath, newPath);
+						GEngine::GetAssetRegistry()->AddAssetRedirector(oldPath, newPath);
 
 						Manager->RemoveAssetRep(payloadAssetRep->DirectoryEntry);
 						std::filesystem::rename(oldPath, newPath);
@@ -758,6 +816,9 @@ namespace Havtorn
 			
 			if (result.IsHovered)
 			{
+				if (!rep->Stats.empty())
+					GUI::SetTooltip("%s", rep->Stats.c_str());
+
 				if (rep->AssetType == EAssetType::Animation)
 				{
 					AnimatingThumbnailAsset = rep.get();
@@ -780,8 +841,7 @@ namespace Havtorn
 					std::string oldPath = UGeneralUtils::ConvertToPlatformAgnosticPath(rep->DirectoryEntry.path().string().c_str());
 					std::string newPath = UGeneralUtils::ConvertToPlatformAgnosticPath(CurrentDirectory.string()) + "/" + result.NewAssetName.value() + ".hva";
 
-					CJsonDocument config = UFileSystem::OpenJson(UFileSystem::EngineConfig);
-					config.WriteValueToArray("Asset Redirectors", oldPath, newPath);
+					GEngine::GetAssetRegistry()->AddAssetRedirector(oldPath, newPath);
 
 					Manager->RemoveAssetRep(rep->DirectoryEntry);
 					std::filesystem::rename(oldPath, newPath);
@@ -52,6 +52,7 @@ namespace Havtorn
 		std::filesystem::path CurrentDirectory = "";
 		SGuiTextFilter Filter = SGuiTextFilter();
 		std::optional<std::vector<std::string>> FilePathsToImport;
+		std::optional<SAssetBatchImportHandle> BatchImport;
 
 		std::optional<SEditorAssetRepresentation*> AnimatingThumbnailAsset;
 		SEditorAssetRepresentation* PreviouslyAnimatingThumbnailAsset;
@@ -376,8 +376,7 @@ namespace Havtorn
 			{
 				std::string oldPath = ContextMenuAssetRef->FilePath;
 
-				CJsonDocument config = UFileSystem::OpenJson(UFileSystem::EngineConfig);
-				std::string redirection = config.GetValueFromArray("Asset Redirectors", ContextMenuAssetRef->FilePath, "");
+				std::string redirection = GEngine::GetAssetRegistry()->GetAssetRedirector(ContextMenuAssetRef->FilePath);
 
 				GEngine::GetAssetRegistry()->UnrequestAsset(*ContextMenuAssetRef, ContextMenuAssetRequester);
 				*ContextMenuAssetRef = SAssetReference(redirection);
@@ -0,0 +1,354 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "AnimationCompression.h"
+
+namespace Havtorn
+{
+	namespace
+	{
+		constexpr F32 UnormMax = 65535.0f;
+		// No component but the largest of a unit quaternion can be more than 1 / sqrt(2), the three kept get 15 bits each
+		constexpr F32 SmallestThreeRange = 0.70710678f;
+		constexpr F32 SmallestThreeMax = 32767.0f;
+		constexpr F32 MaxTickOffset = 0.001f;
+
+		U16 EncodeUnorm(const F32 value, const F32 min, const F32 extent)
+		{
+			if (extent <= 0.0f)
+				return 0;
+
+			return STATIC_U16(UMath::Clamp((value - min) / extent, 0.0f, 1.0f) * UnormMax + 0.5f);
+		}
+
+		F32 DecodeUnorm(const U16 value, const F32 min, const F32 extent)
+		{
+			return min + STATIC_F32(value) * (extent / UnormMax);
+		}
+
+		U16 EncodeTick(const F32 time, bool& outIsUnsupported)
+		{
+			const F32 tick = std::round(time);
+			outIsUnsupported = outIsUnsupported || tick < 0.0f || tick > UnormMax || UMath::Abs(time - tick) > MaxTickOffset;
+			return STATIC_U16(UMath::Clamp(tick, 0.0f, UnormMax));
+		}
+
+		// The largest component is left out and the quaternion negated if it is negative, so it can be restored from the
+		// others as positive. The sign bit puts the negation back, playback slerps without taking the shorter way around,
+		// so which of the two equal quaternions a key holds decides how it blends with its neighbours.
+		void EncodeSmallestThree(const SQuaternion& rotation, U16 (&outPacked)[3])
+		{
+			F32 components[4] = { rotation.X, rotation.Y, rotation.Z, rotation.W };
+			F32 length = UMath::Sqrt(components[0] * components[0] + components[1] * components[1] + components[2] * components[2] + components[3] * components[3]);
+			if (length <= 0.0f)
+			{
+				components[0] = components[1] = components[2] = 0.0f;
+				components[3] = length = 1.0f;
+			}
+
+			U8 largest = 0;
+			for (U8 i = 1; i < 4; i++)
+			{
+				if (UMath::Abs(components[i]) > UMath::Abs(components[largest]))
+					largest = i;
+			}
+
+			const bool isNegated = components[largest] < 0.0f;
+			const F32 scale = (isNegated ? -1.0f : 1.0f) / length;
+
+			U64 packed = 0;
+			U8 shift = 0;
+			for (U8 i = 0; i < 4; i++)
+			{
+				if (i == largest)
+					continue;
+
+				const F32 value = UMath::Clamp((components[i] * scale / SmallestThreeRange) * 0.5f + 0.5f, 0.0f, 1.0f);
+				packed |= STATIC_U64(value * SmallestThreeMax + 0.5f) << shift;
+				shift += 15;
+			}
+
+			packed |= STATIC_U64(largest) << 45;
+			packed |= STATIC_U64(isNegated ? 1 : 0) << 47;
+
+			outPacked[0] = STATIC_U16(packed);
+			outPacked[1] = STATIC_U16(packed >> 16);
+			outPacked[2] = STATIC_U16(packed >> 32);
+		}
+
+		SQuaternion DecodeSmallestThree(const U16 (&packed)[3])
+		{
+			const U64 bits = STATIC_U64(packed[0]) | (STATIC_U64(packed[1]) << 16) | (STATIC_U64(packed[2]) << 32);
+			const U8 largest = STATIC_U8((bits >> 45) & 3);
+			const bool isNegated = ((bits >> 47) & 1) != 0;
+
+			F32 components[4] = {};
+			F32 sumOfSquares = 0.0f;
+			U8 shift = 0;
+			for (U8 i = 0; i < 4; i++)
+			{
+				if (i == largest)
+					continue;
+
+				components[i] = (STATIC_F32((bits >> shift) & 0x7FFF) / SmallestThreeMax * 2.0f - 1.0f) * SmallestThreeRange;
+				sumOfSquares += components[i] * components[i];
+				shift += 15;
+			}
+			components[largest] = UMath::Sqrt(UMath::Max(1.0f - sumOfSquares, 0.0f));
+
+			const F32 sign = isNegated ? -1.0f : 1.0f;
+			return SQuaternion(components[0] * sign, components[1] * sign, components[2] * sign, components[3] * sign).GetNormalized();
+		}
+
+		F32 GetDistance(const SVector& a, const SVector& b)
+		{
+			return (a - b).Length();
+		}
+
+		F32 GetLargestDifference(const SVector& a, const SVector& b)
+		{
+			return UMath::Max(UMath::Abs(a.X - b.X), UMath::Max(UMath::Abs(a.Y - b.Y), UMath::Abs(a.Z - b.Z)));
+		}
+
+		// Angle of the rotation between the two, the same for a quaternion and its negation. From the chord rather than the
+		// dot product, acos of a dot product close to 1 is too coarse in F32 for the errors measured here.
+		F32 GetAngle(const SQuaternion& a, const SQuaternion& b)
+		{
+			const SQuaternion normalizedA = a.GetNormalized();
+			SQuaternion normalizedB = b.GetNormalized();
+			if (normalizedA.X * normalizedB.X + normalizedA.Y * normalizedB.Y + normalizedA.Z * normalizedB.Z + normalizedA.W * normalizedB.W < 0.0f)
+				normalizedB = normalizedB * -1.0f;
+
+			auto getLength = [](const F32 x, const F32 y, const F32 z, const F32 w) { return UMath::Sqrt(x * x + y * y + z * z + w * w); };
+			const F32 difference = getLength(normalizedA.X - normalizedB.X, normalizedA.Y - normalizedB.Y, normalizedA.Z - normalizedB.Z, normalizedA.W - normalizedB.W);
+			const F32 sum = getLength(normalizedA.X + normalizedB.X, normalizedA.Y + normalizedB.Y, normalizedA.Z + normalizedB.Z, normalizedA.W + normalizedB.W);
+			return 4.0f * UMath::ATan2(difference, sum);
+		}
+
+		// Interpolation and sampling as CAnimatorGraphSystem plays tracks, so dropped keys are measured against what plays
+		SVector InterpolateKeys(const SVector& a, const SVector& b, const F32 factor)
+		{
+			return a * (1 - factor) + b * factor;
+		}
+
+		SQuaternion InterpolateKeys(const SQuaternion& a, const SQuaternion& b, const F32 factor)
+		{
+			return SQuaternion::Slerp(a, b, factor).GetNormalized();
+		}
+
+		template<typename TKey>
+		F32 GetFactor(const TKey& from, const TKey& to, const F32 time)
+		{
+			const F32 deltaTime = to.Time - from.Time;
+			return deltaTime > 0.0f ? UMath::Clamp((time - from.Time) / deltaTime) : 0.0f;
+		}
+
+		template<typename TKey>
+		decltype(TKey::Value) SampleKeys(const std::vector<TKey>& keys, const F32 time, const decltype(TKey::Value)& defaultValue)
+		{
+			if (keys.empty())
+				return defaultValue;
+
+			if (keys.size() == 1)
+				return keys[0].Value;
+
+			U64 index = keys.size() - 2;
+			for (U64 i = 0; i < keys.size() - 1; i++)
+			{
+				if (time < keys[i + 1].Time)
+				{
+					index = i;
+					break;
+				}
+			}
+
+			return InterpolateKeys(keys[index].Value, keys[index + 1].Value, GetFactor(keys[index], keys[index + 1], time));
+		}
+
+		template<typename TKey, typename TGetError>
+		void ReduceChannel(std::vector<TKey>& keys, const F32 tolerance, TGetError getError)
+		{
+			if (keys.size() <= 1)
+				return;
+
+			if (std::ranges::all_of(keys, [&](const TKey& key) { return getError(keys[0].Value, key.Value) <= tolerance; }))
+			{
+				keys.resize(1);
+				return;
+			}
+
+			// Greedy, the segment from the last kept key grows until a key between, or what played halfway between two keys,
+			// no longer lies on it, then the key before the one that broke it is kept. Halfway points matter for rotations, a
+			// key in the other hemisphere sends the slerps on either side of it the long way around. Quadratic in the length
+			// of a segment, fine at import.
+			std::vector<TKey> keptKeys = { keys[0] };
+			U64 anchor = 0;
+			for (U64 end = 2; end < keys.size(); end++)
+			{
+				auto isOnSegment = [&](const F32 time, const auto& value)
+					{
+						return getError(InterpolateKeys(keys[anchor].Value, keys[end].Value, GetFactor(keys[anchor], keys[end], time)), value) <= tolerance;
+					};
+
+				bool isSegmentKept = true;
+				for (U64 i = anchor; i < end && isSegmentKept; i++)
+				{
+					const F32 halfwayTime = 0.5f * (keys[i].Time + keys[i + 1].Time);
+					isSegmentKept = (i == anchor || isOnSegment(keys[i].Time, keys[i].Value))
+						&& isOnSegment(halfwayTime, InterpolateKeys(keys[i].Value, keys[i + 1].Value, 0.5f));
+				}
+
+				if (!isSegmentKept)
+				{
+					anchor = end - 1;
+					keptKeys.push_back(keys[anchor]);
+				}
+			}
+
+			keptKeys.push_back(keys.back());
+			keys = std::move(keptKeys);
+		}
+
+		template<typename TKey, typename TGetError>
+		F32 MeasureChannel(const std::vector<TKey>& original, const std::vector<TKey>& compressed, const decltype(TKey::Value)& defaultValue, TGetError getError)
+		{
+			F32 error = 0.0f;
+			for (U64 i = 0; i < original.size(); i++)
+			{
+				const F32 time = original[i].Time;
+				error = UMath::Max(error, getError(SampleKeys(original, time, defaultValue), SampleKeys(compressed, time, defaultValue)));
+				if (i + 1 == original.size())
+					continue;
+
+				const F32 halfwayTime = 0.5f * (time + original[i + 1].Time);
+				error = UMath::Max(error, getError(SampleKeys(original, halfwayTime, defaultValue), SampleKeys(compressed, halfwayTime, defaultValue)));
+			}
+			return error;
+		}
+
+		template<typename TGetError>
+		F32 EncodeVecKeys(const std::vector<SVecBoneAnimationKey>& keys, const SVector& min, const SVector& extent, std::vector<SCompactVecAnimationKey>& outKeys, bool& outHasUnsupportedKeyTimes, TGetError getError)
+		{
+			F32 error = 0.0f;
+			outKeys.resize(keys.size());
+			for (U64 i = 0; i < keys.size(); i++)
+			{
+				SCompactVecAnimationKey& compactKey = outKeys[i];
+				compactKey.x = EncodeUnorm(keys[i].Value.X, min.X, extent.X);
+				compactKey.y = EncodeUnorm(keys[i].Value.Y, min.Y, extent.Y);
+				compactKey.z = EncodeUnorm(keys[i].Value.Z, min.Z, extent.Z);
+				compactKey.Tick = EncodeTick(keys[i].Time, outHasUnsupportedKeyTimes);
+
+				const SVector decoded(DecodeUnorm(compactKey.x, min.X, extent.X), DecodeUnorm(compactKey.y, min.Y, extent.Y), DecodeUnorm(compactKey.z, min.Z, extent.Z));
+				error = UMath::Max(error, getError(keys[i].Value, decoded));
+			}
+			return error;
+		}
+	}
+
+	void UAnimationCompression::ReduceKeys(std::vector<SBoneAnimationTrack>& tracks)
+	{
+		for (SBoneAnimationTrack& track : tracks)
+		{
+			ReduceChannel(track.TranslationKeys, MaxTranslationError, GetDistance);
+			ReduceChannel(track.RotationKeys, MaxRotationError, GetAngle);
+			ReduceChannel(track.ScaleKeys, MaxScaleError, GetLargestDifference);
+		}
+	}
+
+	SAnimationQuantization UAnimationCompression::GetQuantization(const std::vector<SBoneAnimationTrack>& tracks)
+	{
+		auto getRange = [&tracks](std::vector<SVecBoneAnimationKey> SBoneAnimationTrack::* keys, SVector& outMin, SVector& outExtent)
+			{
+				SVector min = SVector(FLT_MAX);
+				SVector max = SVector(-FLT_MAX);
+				for (const SBoneAnimationTrack& track : tracks)
+				{
+					for (const SVecBoneAnimationKey& key : track.*keys)
+					{
+						min = SVector(UMath::Min(key.Value.X, min.X), UMath::Min(key.Value.Y, min.Y), UMath::Min(key.Value.Z, min.Z));
+						max = SVector(UMath::Max(key.Value.X, max.X), UMath::Max(key.Value.Y, max.Y), UMath::Max(key.Value.Z, max.Z));
+					}
+				}
+
+				if (min.X > max.X)
+					return;
+
+				outMin = min;
+				outExtent = max - min;
+			};
+
+		SAnimationQuantization quantization;
+		getRange(&SBoneAnimationTrack::TranslationKeys, quantization.TranslationMin, quantization.TranslationExtent);
+		getRange(&SBoneAnimationTrack::ScaleKeys, quantization.ScaleMin, quantization.ScaleExtent);
+		return quantization;
+	}
+
+	SAnimationCompressionError UAnimationCompression::Encode(const std::vector<SBoneAnimationTrack>& tracks, const SAnimationQuantization& quantization, std::vector<SCompactBoneAnimationTrack>& outTracks)
+	{
+		SAnimationCompressionError error;
+		outTracks.resize(tracks.size());
+		for (U64 trackIndex = 0; trackIndex < tracks.size(); trackIndex++)
+		{
+			const SBoneAnimationTrack& track = tracks[trackIndex];
+			SCompactBoneAnimationTrack& compactTrack = outTracks[trackIndex];
+
+			error.Translation = UMath::Max(error.Translation, EncodeVecKeys(track.TranslationKeys, quantization.TranslationMin, quantization.TranslationExtent, compactTrack.TranslationKeys, error.HasUnsupportedKeyTimes, GetDistance));
+			error.Scale = UMath::Max(error.Scale, EncodeVecKeys(track.ScaleKeys, quantization.ScaleMin, quantization.ScaleExtent, compactTrack.ScaleKeys, error.HasUnsupportedKeyTimes, GetLargestDifference));
+
+			compactTrack.RotationKeys.resize(track.RotationKeys.size());
+			for (U64 i = 0; i < track.RotationKeys.size(); i++)
+			{
+				SCompactQuatAnimationKey& compactKey = compactTrack.RotationKeys[i];
+				EncodeSmallestThree(track.RotationKeys[i].Value, compactKey.SmallestThree);
+				compactKey.Tick = EncodeTick(track.RotationKeys[i].Time, error.HasUnsupportedKeyTimes);
+				error.Rotation = UMath::Max(error.Rotation, GetAngle(track.RotationKeys[i].Value, DecodeSmallestThree(compactKey.SmallestThree)));
+			}
+		}
+		return error;
+	}
+
+	void UAnimationCompression::Decode(std::span<const SCompactVecAnimationKey> keys, const SVector& min, const SVector& extent, std::vector<SVecBoneAnimationKey>& outKeys)
+	{
+		outKeys.resize(keys.size());
+		for (U64 i = 0; i < keys.size(); i++)
+		{
+			outKeys[i].Value = SVector(DecodeUnorm(keys[i].x, min.X, extent.X), DecodeUnorm(keys[i].y, min.Y, extent.Y), DecodeUnorm(keys[i].z, min.Z, extent.Z));
+			outKeys[i].Time = STATIC_F32(keys[i].Tick);
+		}
+	}
+
+	void UAnimationCompression::Decode(std::span<const SCompactQuatAnimationKey> keys, std::vector<SQuatBoneAnimationKey>& outKeys)
+	{
+		outKeys.resize(keys.size());
+		for (U64 i = 0; i < keys.size(); i++)
+		{
+			outKeys[i].Value = DecodeSmallestThree(keys[i].SmallestThree);
+			outKeys[i].Time = STATIC_F32(keys[i].Tick);
+		}
+	}
+
+	SAnimationCompressionError UAnimationCompression::Measure(const SBoneAnimationTrack& original, const SBoneAnimationTrack& compressed)
+	{
+		SAnimationCompressionError error;
+		error.Translation = MeasureChannel(original.TranslationKeys, compressed.TranslationKeys, SVector::Zero, GetDistance);
+		error.Rotation = MeasureChannel(original.RotationKeys, compressed.RotationKeys, SQuaternion::Identity, GetAngle);
+		error.Scale = MeasureChannel(original.ScaleKeys, compressed.ScaleKeys, SVector(1.0f), GetLargestDifference);
+		return error;
+	}
+
+	bool UAnimationCompression::IsWithinErrorBounds(const SAnimationCompressionError& error, const SAnimationQuantization& quantization)
+	{
+		// Half a step on every axis, plus what F32 loses on the decode itself
+		auto getMaxError = [](const SVector& min, const SVector& extent, const F32 axes)
+			{
+				const F32 halfStep = 0.5f * UMath::Max(extent.X, UMath::Max(extent.Y, extent.Z)) / UnormMax;
+				const F32 magnitude = UMath::Max(UMath::Abs(min.X) + extent.X, UMath::Max(UMath::Abs(min.Y) + extent.Y, UMath::Abs(min.Z) + extent.Z));
+				return halfStep * UMath::Sqrt(axes) + magnitude * 4.0f * FLT_EPSILON;
+			};
+
+		return !error.HasUnsupportedKeyTimes
+			&& error.Translation <= getMaxError(quantization.TranslationMin, quantization.TranslationExtent, 3.0f)
+			&& error.Rotation <= MaxRotationError
+			&& error.Scale <= getMaxError(quantization.ScaleMin, quantization.ScaleExtent, 1.0f);
+	}
+}
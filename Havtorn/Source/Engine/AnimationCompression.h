@@ -0,0 +1,57 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#pragma once
+
+#include "Graphics/GraphicsStructs.h"
+
+#include <span>
+
+namespace Havtorn
+{
+	// Largest difference between tracks and their compressed version, in the space of each bone's parent
+	struct SAnimationCompressionError
+	{
+		F32 Translation = 0.0f;
+		// Radians
+		F32 Rotation = 0.0f;
+		F32 Scale = 0.0f;
+		// Compact keys only hold whole ticks below 65536, other key times are never approximated
+		bool HasUnsupportedKeyTimes = false;
+
+		void Add(const SAnimationCompressionError& other)
+		{
+			Translation = UMath::Max(Translation, other.Translation);
+			Rotation = UMath::Max(Rotation, other.Rotation);
+			Scale = UMath::Max(Scale, other.Scale);
+			HasUnsupportedKeyTimes = HasUnsupportedKeyTimes || other.HasUnsupportedKeyTimes;
+		}
+	};
+
+	class UAnimationCompression
+	{
+	public:
+		// How far dropped keys may be from what interpolating the ones around them gives, in the units of the track.
+		// Quantization adds up to half a step of the clip's ranges to translations and scales on top.
+		static constexpr F32 MaxTranslationError = 0.001f;
+		static constexpr F32 MaxRotationError = 0.0005f;
+		static constexpr F32 MaxScaleError = 0.0005f;
+
+		// Drops every key that interpolating its neighbours gives within the errors above and collapses tracks that stay
+		// within them of their first key to that key. First and last keys are always kept, so nothing changes outside them.
+		static ENGINE_API void ReduceKeys(std::vector<SBoneAnimationTrack>& tracks);
+
+		// Translation and scale ranges covering every key
+		[[nodiscard]] static ENGINE_API SAnimationQuantization GetQuantization(const std::vector<SBoneAnimationTrack>& tracks);
+
+		// Encodes, decodes the result again and measures the difference per key, which IsWithinErrorBounds then checks
+		static ENGINE_API SAnimationCompressionError Encode(const std::vector<SBoneAnimationTrack>& tracks, const SAnimationQuantization& quantization, std::vector<SCompactBoneAnimationTrack>& outTracks);
+
+		static ENGINE_API void Decode(std::span<const SCompactVecAnimationKey> keys, const SVector& min, const SVector& extent, std::vector<SVecBoneAnimationKey>& outKeys);
+		static ENGINE_API void Decode(std::span<const SCompactQuatAnimationKey> keys, std::vector<SQuatBoneAnimationKey>& outKeys);
+
+		// Samples both tracks the way animations are played, at every key of original and halfway between them
+		[[nodiscard]] static ENGINE_API SAnimationCompressionError Measure(const SBoneAnimationTrack& original, const SBoneAnimationTrack& compressed);
+
+		[[nodiscard]] static ENGINE_API bool IsWithinErrorBounds(const SAnimationCompressionError& error, const SAnimationQuantization& quantization);
+	};
+}
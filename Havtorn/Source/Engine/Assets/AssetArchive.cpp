@@ -0,0 +1,255 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "AssetArchive.h"
+#include "Assets/FileHeaderDeclarations.h"
+
+#include <GeneralUtilities.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace Havtorn
+{
+	bool CAssetArchive::Mount(const std::string& archivePath)
+	{
+		Unmount();
+
+		if (!File.Open(archivePath))
+		{
+			HV_LOG_WARN("CAssetArchive::Mount: Could not open archive %s.", archivePath.c_str());
+			return false;
+		}
+
+		const char* data = File.GetData();
+		const U64 fileSize = File.GetSize();
+
+		SAssetArchiveHeader header;
+		if (fileSize < sizeof(SAssetArchiveHeader))
+		{
+			HV_LOG_WARN("CAssetArchive::Mount: %s is too small to be an archive.", archivePath.c_str());
+			Unmount();
+			return false;
+		}
+		memcpy(&header, data, sizeof(SAssetArchiveHeader));
+
+		if (header.Magic != Magic || header.Version != Version)
+		{
+			HV_LOG_WARN("CAssetArchive::Mount: %s is not an archive of version %u, please repack it.", archivePath.c_str(), Version);
+			Unmount();
+			return false;
+		}
+
+		const U64 tableOfContentsSize = STATIC_U64(header.NumberOfEntries) * sizeof(SAssetArchiveEntry);
+		if (header.ChunkSize != UCompression::PayloadChunkSize
+			|| header.TableOfContentsOffset % alignof(SAssetArchiveEntry) != 0
+			|| header.TableOfContentsOffset + tableOfContentsSize > fileSize
+			|| header.PathTableOffset + header.PathTableSize > fileSize)
+		{
+			HV_LOG_WARN("CAssetArchive::Mount: %s has a corrupt header.", archivePath.c_str());
+			Unmount();
+			return false;
+		}
+
+		FilePath = archivePath;
+		Entries = std::span<const SAssetArchiveEntry>(reinterpret_cast<const SAssetArchiveEntry*>(data + header.TableOfContentsOffset), header.NumberOfEntries);
+		PathTable = data + header.PathTableOffset;
+		PathTableSize = header.PathTableSize;
+		return true;
+	}
+
+	void CAssetArchive::Unmount()
+	{
+		File.Close();
+		FilePath = "";
+		Entries = {};
+		PathTable = nullptr;
+		PathTableSize = 0;
+	}
+
+	const SAssetArchiveEntry* CAssetArchive::FindEntry(const U32 assetUID) const
+	{
+		auto it = std::ranges::lower_bound(Entries, assetUID, {}, &SAssetArchiveEntry::AssetUID);
+		if (it == Entries.end() || it->AssetUID != assetUID)
+			return nullptr;
+
+		return &(*it);
+	}
+
+	bool CAssetArchive::ReadEntry(const SAssetArchiveEntry& entry, std::vector<char>& outBuffer, const char*& outData, std::vector<SCompressedChunk>* outChunks) const
+	{
+		if (entry.Offset + entry.StoredSize > File.GetSize())
+		{
+			HV_LOG_WARN("CAssetArchive::ReadEntry: Entry %u in %s points past the end of the archive.", entry.AssetUID, FilePath.c_str());
+			return false;
+		}
+
+		const char* storedData = File.GetData() + entry.Offset;
+		if (!entry.IsCompressed())
+		{
+			outData = storedData;
+			return true;
+		}
+
+		U64 payloadSize = 0;
+		if (!UCompression::IsPayloadValid(storedData, entry.StoredSize, payloadSize) || UCompression::GetPayloadSize(storedData) != entry.Size)
+		{
+			HV_LOG_WARN("CAssetArchive::ReadEntry: Entry %u in %s has a corrupt payload.", entry.AssetUID, FilePath.c_str());
+			return false;
+		}
+
+		outBuffer.resize(entry.Size);
+		outData = outBuffer.data();
+
+		std::vector<SCompressedChunk> chunks;
+		std::vector<SCompressedChunk>& entryChunks = outChunks != nullptr ? *outChunks : chunks;
+		if (!UCompression::GetPayloadChunks(storedData, entry.StoredSize, outBuffer.data(), entryChunks, payloadSize) || (outChunks == nullptr && !UCompression::DecompressChunks(chunks)))
+		{
+			HV_LOG_WARN("CAssetArchive::ReadEntry: Entry %u in %s has a corrupt payload.", entry.AssetUID, FilePath.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	std::string CAssetArchive::GetEntryPath(const SAssetArchiveEntry& entry) const
+	{
+		if (STATIC_U64(entry.PathOffset) + entry.PathLength > PathTableSize)
+			return std::string();
+
+		return std::string(PathTable + entry.PathOffset, entry.PathLength);
+	}
+
+	bool UAssetArchivePacker::Pack(const std::vector<std::string>& directories, const std::string& archivePath, const bool shouldCompress)
+	{
+		struct SPackedFile
+		{
+			std::string Path;
+			U32 AssetUID = 0;
+		};
+
+		std::vector<SPackedFile> files;
+		for (const std::string& directory : directories)
+		{
+			if (!UFileSystem::Exists(directory))
+				continue;
+
+			for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+			{
+				std::string path = UGeneralUtils::ConvertToPlatformAgnosticPath(entry.path().string());
+				if (!entry.is_directory() && UGeneralUtils::ExtractFileExtensionFromPath(path) == "hva")
+					files.push_back({ path, SAssetReference(path).UID });
+			}
+		}
+
+		std::ranges::sort(files, {}, &SPackedFile::AssetUID);
+		for (U64 i = 1; i < files.size(); i++)
+		{
+			if (files[i].AssetUID == files[i - 1].AssetUID)
+				HV_LOG_WARN("UAssetArchivePacker::Pack: %s has the same UID as %s and was left out.", files[i].Path.c_str(), files[i - 1].Path.c_str());
+		}
+		auto duplicates = std::ranges::unique(files, {}, &SPackedFile::AssetUID);
+		files.erase(duplicates.begin(), duplicates.end());
+
+		const std::string archiveDirectory = UGeneralUtils::ExtractParentDirectoryFromPath(archivePath);
+		if (!archiveDirectory.empty() && !UFileSystem::Exists(archiveDirectory))
+			UFileSystem::AddDirectory(archiveDirectory);
+
+		std::ofstream outputStream(archivePath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!outputStream)
+		{
+			HV_LOG_ERROR("UAssetArchivePacker::Pack: Could not open %s for writing.", archivePath.c_str());
+			return false;
+		}
+
+		// The header is written last, once the offsets are known
+		SAssetArchiveHeader header;
+		outputStream.write(reinterpret_cast<const char*>(&header), sizeof(SAssetArchiveHeader));
+		U64 position = sizeof(SAssetArchiveHeader);
+
+		const char padding[SerializedBlobAlignment] = {};
+		auto padToAlignment = [&]()
+			{
+				const U64 alignedPosition = GetAlignedBlobPosition(position);
+				outputStream.write(padding, alignedPosition - position);
+				position = alignedPosition;
+			};
+
+		std::vector<SAssetArchiveEntry> entries;
+		entries.reserve(files.size());
+		std::string pathTable;
+		std::vector<char> payload;
+		U64 numberOfSourceBytes = 0;
+		U32 numberOfCompressedEntries = 0;
+
+		for (const SPackedFile& file : files)
+		{
+			CMappedFile sourceFile;
+			if (!sourceFile.Open(file.Path))
+			{
+				HV_LOG_WARN("UAssetArchivePacker::Pack: Could not read %s, it was left out.", file.Path.c_str());
+				continue;
+			}
+
+			padToAlignment();
+
+			SAssetArchiveEntry& entry = entries.emplace_back();
+			entry.AssetUID = file.AssetUID;
+			entry.Offset = position;
+			entry.Size = sourceFile.GetSize();
+			entry.PathOffset = STATIC_U32(pathTable.size());
+			entry.PathLength = STATIC_U32(file.Path.size());
+			pathTable.append(file.Path);
+			numberOfSourceBytes += entry.Size;
+
+			bool shouldStoreCompressed = false;
+			if (shouldCompress)
+			{
+				UCompression::CompressPayload(sourceFile.GetData(), entry.Size, payload);
+				shouldStoreCompressed = STATIC_F32(payload.size()) < STATIC_F32(entry.Size) * (1.0f - MinCompressionSavings);
+				if (shouldStoreCompressed)
+				{
+					entry.Flags = EAssetArchiveEntryFlags::Compressed;
+					entry.StoredSize = payload.size();
+					outputStream.write(payload.data(), payload.size());
+					numberOfCompressedEntries++;
+				}
+			}
+
+			if (!shouldStoreCompressed)
+			{
+				entry.StoredSize = entry.Size;
+				outputStream.write(sourceFile.GetData(), entry.Size);
+			}
+
+			position += entry.StoredSize;
+		}
+
+		padToAlignment();
+		header.Magic = CAssetArchive::Magic;
+		header.Version = CAssetArchive::Version;
+		header.NumberOfEntries = STATIC_U32(entries.size());
+		header.ChunkSize = UCompression::PayloadChunkSize;
+		header.TableOfContentsOffset = position;
+		outputStream.write(reinterpret_cast<const char*>(entries.data()), sizeof(SAssetArchiveEntry) * entries.size());
+		position += sizeof(SAssetArchiveEntry) * entries.size();
+
+		header.PathTableOffset = position;
+		header.PathTableSize = pathTable.size();
+		outputStream.write(pathTable.data(), pathTable.size());
+		position += pathTable.size();
+
+		outputStream.seekp(0);
+		outputStream.write(reinterpret_cast<const char*>(&header), sizeof(SAssetArchiveHeader));
+		outputStream.close();
+
+		if (outputStream.bad())
+		{
+			HV_LOG_ERROR("UAssetArchivePacker::Pack: Writing %s failed.", archivePath.c_str());
+			return false;
+		}
+
+		HV_LOG_INFO("UAssetArchivePacker::Pack: Packed %u assets (%u compressed) into %s, %.2f MB -> %.2f MB.", header.NumberOfEntries, numberOfCompressedEntries, archivePath.c_str(),
+			STATIC_F32(numberOfSourceBytes) / (1024.0f * 1024.0f), STATIC_F32(position) / (1024.0f * 1024.0f));
+		return true;
+	}
+}
@@ -0,0 +1,89 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#pragma once
+
+#include <Compression.h>
+#include <FileSystem.h>
+
+#include <span>
+
+namespace Havtorn
+{
+	enum class EAssetArchiveEntryFlags : U32
+	{
+		None = 0,
+		Compressed = 1 << 0
+	};
+
+	// Archives are written and read as raw structs, so the table of contents can be used straight from the mapping.
+	// Layout: header, entries (each starting on SerializedBlobAlignment), table of contents sorted by UID, path table.
+	struct SAssetArchiveHeader
+	{
+		U32 Magic = 0;
+		U32 Version = 0;
+		U32 NumberOfEntries = 0;
+		U32 ChunkSize = 0;
+		U64 TableOfContentsOffset = 0;
+		U64 PathTableOffset = 0;
+		U64 PathTableSize = 0;
+		U64 Padding = 0;
+	};
+	static_assert(sizeof(SAssetArchiveHeader) == 48);
+
+	struct SAssetArchiveEntry
+	{
+		U32 AssetUID = 0;
+		EAssetArchiveEntryFlags Flags = EAssetArchiveEntryFlags::None;
+		// From the start of the archive. Aligned, so the aligned blobs in .hva files stay aligned in the mapping.
+		U64 Offset = 0;
+		// Bytes taken up in the archive, the whole compressed payload for compressed entries
+		U64 StoredSize = 0;
+		// Bytes of the .hva file the entry was packed from
+		U64 Size = 0;
+		U32 PathOffset = 0;
+		U32 PathLength = 0;
+
+		[[nodiscard]] bool IsCompressed() const { return (STATIC_U32(Flags) & STATIC_U32(EAssetArchiveEntryFlags::Compressed)) != 0; }
+	};
+	static_assert(sizeof(SAssetArchiveEntry) == 40);
+
+	// A mounted .hvpak file. Looking up an asset is a binary search in memory instead of file system calls, and
+	// uncompressed entries are used in place from the mapping. Compressed entries are stored as one UCompression payload.
+	class CAssetArchive
+	{
+	public:
+		static constexpr U32 Magic = 0x4B505648; // "HVPK"
+		static constexpr U32 Version = 2;
+
+		ENGINE_API bool Mount(const std::string& archivePath);
+		ENGINE_API void Unmount();
+
+		// Thread safe, the table of contents never changes while mounted
+		[[nodiscard]] ENGINE_API const SAssetArchiveEntry* FindEntry(const U32 assetUID) const;
+		// Thread safe. Uncompressed entries point into the mapping, compressed ones are decompressed into outBuffer.
+		// With outChunks the chunks are only added there, the caller decompresses them before touching outData.
+		ENGINE_API bool ReadEntry(const SAssetArchiveEntry& entry, std::vector<char>& outBuffer, const char*& outData, std::vector<SCompressedChunk>* outChunks = nullptr) const;
+		[[nodiscard]] ENGINE_API std::string GetEntryPath(const SAssetArchiveEntry& entry) const;
+
+		[[nodiscard]] std::span<const SAssetArchiveEntry> GetEntries() const { return Entries; }
+		[[nodiscard]] const std::string& GetFilePath() const { return FilePath; }
+		[[nodiscard]] bool IsMounted() const { return File.IsOpen(); }
+
+	private:
+		CMappedFile File;
+		std::string FilePath = "";
+		std::span<const SAssetArchiveEntry> Entries = {};
+		const char* PathTable = nullptr;
+		U64 PathTableSize = 0;
+	};
+
+	class UAssetArchivePacker
+	{
+	public:
+		// Entries are only stored compressed if that saves at least this much, otherwise they are kept usable in place
+		static constexpr F32 MinCompressionSavings = 0.1f;
+
+		// Packs every .hva file under directories into one archive, paths are stored the way the asset database expects them
+		static ENGINE_API bool Pack(const std::vector<std::string>& directories, const std::string& archivePath, const bool shouldCompress);
+	};
+}
@@ -0,0 +1,286 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "AssetIndex.h"
+#include "Assets/FileHeaderDeclarations.h"
+
+#include <FileSystem.h>
+#include <GeneralUtilities.h>
+
+namespace Havtorn
+{
+	namespace
+	{
+		struct SAssetIndexHeader
+		{
+			U32 Magic = 0;
+			U32 Version = 0;
+			// Of the whole index, a truncated file is rejected before anything is read from it
+			U64 Size = 0;
+			U32 NumberOfDirectories = 0;
+			U32 NumberOfEntries = 0;
+		};
+	}
+
+	bool CAssetIndex::Load(const std::string& indexPath)
+	{
+		Entries.clear();
+		Directories.clear();
+		HasUnsavedChanges = true;
+
+		if (!UFileSystem::Exists(indexPath))
+			return false;
+
+		CMappedFile file;
+		if (!file.Open(indexPath))
+			return false;
+
+		const char* data = file.GetData();
+		SAssetIndexHeader header;
+		if (file.GetSize() < sizeof(SAssetIndexHeader))
+			return false;
+		memcpy(&header, data, sizeof(SAssetIndexHeader));
+
+		if (header.Magic != Magic || header.Version != Version || header.Size != file.GetSize())
+		{
+			HV_LOG_INFO("CAssetIndex::Load: %s is outdated, the asset index will be rebuilt.", indexPath.c_str());
+			return false;
+		}
+
+		U64 pointerPosition = sizeof(SAssetIndexHeader);
+		for (U32 i = 0; i < header.NumberOfDirectories; i++)
+		{
+			std::string path;
+			DeserializeData(path, data, pointerPosition);
+
+			SAssetIndexDirectory& directory = Directories[path];
+			DeserializeData(directory.LastWriteTime, data, pointerPosition);
+			DeserializeData(directory.AssetUIDs, data, pointerPosition);
+
+			U32 numberOfSubdirectories = 0;
+			DeserializeData(numberOfSubdirectories, data, pointerPosition);
+			directory.Subdirectories.resize(numberOfSubdirectories);
+			for (std::string& subdirectory : directory.Subdirectories)
+				DeserializeData(subdirectory, data, pointerPosition);
+		}
+
+		for (U32 i = 0; i < header.NumberOfEntries; i++)
+		{
+			U32 assetUID = 0;
+			DeserializeData(assetUID, data, pointerPosition);
+
+			SAssetIndexEntry& entry = Entries[assetUID];
+			DeserializeData(entry.FilePath, data, pointerPosition);
+			DeserializeData(entry.Type, data, pointerPosition);
+			DeserializeData(entry.Size, data, pointerPosition);
+			DeserializeData(entry.LastWriteTime, data, pointerPosition);
+			DeserializeData(entry.Dependencies, data, pointerPosition);
+		}
+
+		if (pointerPosition != header.Size)
+		{
+			HV_LOG_WARN("CAssetIndex::Load: %s is corrupt, the asset index will be rebuilt.", indexPath.c_str());
+			Entries.clear();
+			Directories.clear();
+			return false;
+		}
+
+		HasUnsavedChanges = false;
+		return true;
+	}
+
+	bool CAssetIndex::Save(const std::string& indexPath)
+	{
+		SAssetIndexHeader header;
+		header.Magic = Magic;
+		header.Version = Version;
+		header.NumberOfDirectories = STATIC_U32(Directories.size());
+		header.NumberOfEntries = STATIC_U32(Entries.size());
+
+		U32 size = sizeof(SAssetIndexHeader);
+		for (const auto& [path, directory] : Directories)
+		{
+			size += GetDataSize(path);
+			size += GetDataSize(directory.LastWriteTime);
+			size += GetDataSize(directory.AssetUIDs);
+			size += GetDataSize(STATIC_U32(directory.Subdirectories.size()));
+			for (const std::string& subdirectory : directory.Subdirectories)
+				size += GetDataSize(subdirectory);
+		}
+
+		for (const auto& [assetUID, entry] : Entries)
+		{
+			size += GetDataSize(assetUID);
+			size += GetDataSize(entry.FilePath);
+			size += GetDataSize(entry.Type);
+			size += GetDataSize(entry.Size);
+			size += GetDataSize(entry.LastWriteTime);
+			size += GetDataSize(entry.Dependencies);
+		}
+		header.Size = size;
+
+		std::vector<char> data(size);
+		memcpy(data.data(), &header, sizeof(SAssetIndexHeader));
+		U64 pointerPosition = sizeof(SAssetIndexHeader);
+		for (const auto& [path, directory] : Directories)
+		{
+			SerializeData(path, data.data(), pointerPosition);
+			SerializeData(directory.LastWriteTime, data.data(), pointerPosition);
+			SerializeData(directory.AssetUIDs, data.data(), pointerPosition);
+			SerializeData(STATIC_U32(directory.Subdirectories.size()), data.data(), pointerPosition);
+			for (const std::string& subdirectory : directory.Subdirectories)
+				SerializeData(subdirectory, data.data(), pointerPosition);
+		}
+
+		for (const auto& [assetUID, entry] : Entries)
+		{
+			SerializeData(assetUID, data.data(), pointerPosition);
+			SerializeData(entry.FilePath, data.data(), pointerPosition);
+			SerializeData(entry.Type, data.data(), pointerPosition);
+			SerializeData(entry.Size, data.data(), pointerPosition);
+			SerializeData(entry.LastWriteTime, data.data(), pointerPosition);
+			SerializeData(entry.Dependencies, data.data(), pointerPosition);
+		}
+
+		const std::string indexDirectory = UGeneralUtils::ExtractParentDirectoryFromPath(indexPath);
+		if (!indexDirectory.empty() && !UFileSystem::Exists(indexDirectory))
+			UFileSystem::AddDirectory(indexDirectory);
+
+		UFileSystem::Serialize(indexPath, data.data(), size);
+		HasUnsavedChanges = false;
+		return true;
+	}
+
+	U32 CAssetIndex::Refresh(const std::vector<std::string>& rootDirectories)
+	{
+		std::map<U32, SAssetIndexEntry> entries;
+		std::map<std::string, SAssetIndexDirectory> directories;
+		U32 numberOfListedDirectories = 0;
+
+		std::vector<std::string> directoriesToVisit;
+		for (const std::string& rootDirectory : rootDirectories)
+		{
+			// Shipping builds may only have archives
+			if (UFileSystem::Exists(rootDirectory))
+				directoriesToVisit.emplace_back(rootDirectory);
+		}
+
+		while (!directoriesToVisit.empty())
+		{
+			const std::string path = std::move(directoriesToVisit.back());
+			directoriesToVisit.pop_back();
+
+			std::error_code error;
+			const I64 writeTime = GetWriteTime(std::filesystem::last_write_time(path, error));
+			if (error)
+				continue;
+
+			SAssetIndexDirectory directory;
+			if (auto it = Directories.find(path); it != Directories.end() && it->second.LastWriteTime == writeTime)
+			{
+				directory = std::move(it->second);
+				for (const U32 assetUID : directory.AssetUIDs)
+				{
+					if (auto entryIt = Entries.find(assetUID); entryIt != Entries.end())
+						entries.emplace(assetUID, std::move(entryIt->second));
+				}
+			}
+			else
+			{
+				numberOfListedDirectories++;
+				directory.LastWriteTime = writeTime;
+
+				for (const auto& entry : std::filesystem::directory_iterator(path, error))
+				{
+					std::string entryPath = UGeneralUtils::ConvertToPlatformAgnosticPath(entry.path().string());
+					if (entry.is_directory())
+					{
+						directory.Subdirectories.emplace_back(std::move(entryPath));
+						continue;
+					}
+
+					if (UGeneralUtils::ExtractFileExtensionFromPath(entryPath) != "hva")
+						continue;
+
+					// Size and write time come with the directory listing, only files that changed are opened
+					const U32 assetUID = SAssetReference(entryPath).UID;
+					auto entryIt = Entries.find(assetUID);
+					if (entryIt != Entries.end() && entryIt->second.FilePath == entryPath && entryIt->second.Size == entry.file_size(error)
+						&& entryIt->second.LastWriteTime == GetWriteTime(entry.last_write_time(error)))
+					{
+						entries.emplace(assetUID, std::move(entryIt->second));
+					}
+					else
+					{
+						SAssetIndexEntry indexEntry;
+						if (!ReadEntry(entryPath, indexEntry))
+							continue;
+
+						entries.emplace(assetUID, std::move(indexEntry));
+					}
+
+					directory.AssetUIDs.emplace_back(assetUID);
+				}
+			}
+
+			directoriesToVisit.insert(directoriesToVisit.end(), directory.Subdirectories.begin(), directory.Subdirectories.end());
+			directories.emplace(path, std::move(directory));
+		}
+
+		if (numberOfListedDirectories > 0 || directories.size() != Directories.size() || entries.size() != Entries.size())
+			HasUnsavedChanges = true;
+
+		Entries = std::move(entries);
+		Directories = std::move(directories);
+		return numberOfListedDirectories;
+	}
+
+	void CAssetIndex::UpdateEntry(const std::string& filePath)
+	{
+		SAssetIndexEntry indexEntry;
+		if (!ReadEntry(UGeneralUtils::ConvertToPlatformAgnosticPath(filePath), indexEntry))
+			return;
+
+		// New files change the write time of their directory, the next refresh adds them to its list
+		Entries[SAssetReference(indexEntry.FilePath).UID] = std::move(indexEntry);
+		HasUnsavedChanges = true;
+	}
+
+	const SAssetIndexEntry* CAssetIndex::FindEntry(const U32 assetUID) const
+	{
+		auto it = Entries.find(assetUID);
+		return it != Entries.end() ? &it->second : nullptr;
+	}
+
+	bool CAssetIndex::ReadEntry(const std::string& filePath, SAssetIndexEntry& outEntry)
+	{
+		std::error_code error;
+		const auto writeTime = std::filesystem::last_write_time(filePath, error);
+		if (error)
+			return false;
+
+		CMappedFile file;
+		if (!file.Open(filePath) || file.GetSize() < sizeof(U32))
+			return false;
+
+		outEntry.FilePath = filePath;
+		outEntry.Size = file.GetSize();
+		outEntry.LastWriteTime = GetWriteTime(writeTime);
+
+		U64 pointerPosition = 0;
+		outEntry.Type = DeserializeAssetType(file.GetData(), pointerPosition);
+
+		outEntry.Dependencies.clear();
+		if (outEntry.Type == EAssetType::Material)
+		{
+			SMaterialAssetFileHeader header;
+			header.Deserialize(file.GetData());
+			for (const SOfflineGraphicsMaterialProperty& property : header.Material.Properties)
+			{
+				if (property.TextureChannelIndex > -1 && !property.TexturePath.empty())
+					outEntry.Dependencies.emplace_back(SAssetReference(property.TexturePath).UID);
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,62 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#pragma once
+
+#include <filesystem>
+#include <map>
+
+namespace Havtorn
+{
+	struct SAssetIndexEntry
+	{
+		std::string FilePath = "";
+		EAssetType Type = EAssetType::None;
+		U64 Size = 0;
+		I64 LastWriteTime = 0;
+		// Assets requested along with this one, the textures of a material
+		std::vector<U32> Dependencies;
+	};
+
+	// A directory's write time changes when files or subdirectories are added to, removed from or renamed in it,
+	// so as long as it is unchanged the lists below are still correct and the directory doesn't have to be listed.
+	struct SAssetIndexDirectory
+	{
+		I64 LastWriteTime = 0;
+		std::vector<U32> AssetUIDs;
+		std::vector<std::string> Subdirectories;
+	};
+
+	// Persistent UID -> asset file lookup, so startup doesn't have to walk every asset directory.
+	// Written as one binary blob: header, directories, entries.
+	class CAssetIndex
+	{
+	public:
+		static constexpr U32 Magic = 0x58495648; // "HVIX"
+		static constexpr U32 Version = 1;
+
+		// Fails on a missing, outdated or corrupt index, which leaves the index empty so the next refresh rebuilds it
+		ENGINE_API bool Load(const std::string& indexPath);
+		ENGINE_API bool Save(const std::string& indexPath);
+
+		// Walks rootDirectories, only listing the directories whose write time changed since they were indexed, and only
+		// reading files that are new or whose size or write time changed. Returns the number of directories listed.
+		// Contents of files that are overwritten in place aren't picked up, use UpdateEntry for those.
+		ENGINE_API U32 Refresh(const std::vector<std::string>& rootDirectories);
+
+		// Rereads one asset file, e.g. after it was saved
+		ENGINE_API void UpdateEntry(const std::string& filePath);
+
+		[[nodiscard]] ENGINE_API const SAssetIndexEntry* FindEntry(const U32 assetUID) const;
+		[[nodiscard]] const std::map<U32, SAssetIndexEntry>& GetEntries() const { return Entries; }
+		[[nodiscard]] U64 GetNumberOfDirectories() const { return Directories.size(); }
+		[[nodiscard]] bool IsDirty() const { return HasUnsavedChanges; }
+
+	private:
+		static I64 GetWriteTime(const std::filesystem::file_time_type& time) { return STATIC_I64(time.time_since_epoch().count()); }
+		static bool ReadEntry(const std::string& filePath, SAssetIndexEntry& outEntry);
+
+		std::map<U32, SAssetIndexEntry> Entries;
+		std::map<std::string, SAssetIndexDirectory> Directories;
+		bool HasUnsavedChanges = false;
+	};
+}
@@ -8,19 +8,29 @@
 
 #include "Graphics/RenderManager.h"
 #include "Graphics/TextureBank.h"
+#include "Threading/ThreadManager.h"
 
 #include "ModelImporter.h"
+#include "MeshOptimizer.h"
 
 #include <magic_enum.h>
+#include <chrono>
+#include <format>
 
 namespace Havtorn
 {
+    const std::string CAssetRegistry::ArchiveDirectory = "Archives/";
+    const std::string CAssetRegistry::AssetIndexPath = "Cache/AssetIndex.hvidx";
+
     CAssetRegistry::CAssetRegistry()
     {
     }
 
     CAssetRegistry::~CAssetRegistry()
     {
+        // Saved assets update their index entries, keep those for the next startup
+        if (AssetIndex.IsDirty())
+            AssetIndex.Save(AssetIndexPath);
     }
 
     bool CAssetRegistry::Init(CRenderManager* renderManager)
@@ -31,17 +41,68 @@ namespace Havtorn
         SAsset nullAsset = SAsset();
         AddAsset(0, nullAsset);
 
+        CJsonDocument config = UFileSystem::OpenJson(UFileSystem::EngineConfig);
+        ShouldCompressPayloads = config.Get<bool>("Compress Asset Payloads", false);
+        ShouldQuantizeVertices = config.Get<bool>("Quantize Mesh Vertices", false);
+        ShouldCompressAnimationKeys = config.Get<bool>("Compress Animation Keys", false);
+        AssetRedirectors = config.GetValuesFromArray("Asset Redirectors");
+
+        constexpr U64 bytesPerMB = 1024 * 1024;
+        SoftCacheBudget = STATIC_U64(config.Get<U32>("Asset Soft Cache Budget MB", DefaultSoftCacheBudgetMB)) * bytesPerMB;
+        for (const auto& [type, typeName] : magic_enum::enum_entries<EAssetType>())
+        {
+            const U32 budgetMB = config.Get<U32>(std::format("{} Memory Budget MB", typeName), 0);
+            if (budgetMB > 0)
+                SetMemoryBudget(type, STATIC_U64(budgetMB) * bytesPerMB);
+        }
+
+#ifndef HV_EDITOR_BUILD
+        // The editor works on loose files only, a mounted archive would hide every change made to the assets in it
+        if (UFileSystem::Exists(ArchiveDirectory))
+        {
+            std::vector<std::string> archivePaths;
+            for (const auto& entry : std::filesystem::directory_iterator(ArchiveDirectory))
+            {
+                std::string path = UGeneralUtils::ConvertToPlatformAgnosticPath(entry.path().string());
+                if (!entry.is_directory() && UGeneralUtils::ExtractFileExtensionFromPath(path) == "hvpak")
+                    archivePaths.emplace_back(path);
+            }
+
+            std::ranges::sort(archivePaths);
+            for (const std::string& archivePath : archivePaths)
+                MountArchive(archivePath);
+        }
+#endif
+
+        DerivedDataCache.Init(STATIC_U64(config.Get<U32>("Derived Data Cache Size MB", CDerivedDataCache::DefaultSizeBudgetMB)) * bytesPerMB);
+
+        AssetIndex.Load(AssetIndexPath);
         RefreshDatabase();
 
         return true;
     }
 
+    bool CAssetRegistry::MountArchive(const std::string& archivePath)
+    {
+        CAssetArchive archive;
+        if (!archive.Mount(archivePath))
+            return false;
+
+        for (const SAssetArchiveEntry& entry : archive.GetEntries())
+            AssetDatabase.emplace(entry.AssetUID, archive.GetEntryPath(entry));
+
+        HV_LOG_INFO("CAssetRegistry::MountArchive: Mounted %s with %u assets.", archivePath.c_str(), STATIC_U32(archive.GetEntries().size()));
+        MountedArchives.emplace_back(std::move(archive));
+        return true;
+    }
+
     SAsset* CAssetRegistry::RequestAsset(const SAssetReference& assetRef, const U64 requesterID)
     {
-        // TODO.NW: Load on different thread and return null asset while loading?
+        // Blocks until loaded, use RequestAssetAsync where a hitch on first use is a problem
         if (!LoadedAssets.contains(assetRef.UID) && !LoadAsset(assetRef))
             return GetAsset(0);
         
+        UncacheAsset(assetRef.UID);
         SAsset* loadedAsset = GetAsset(assetRef.UID);
         loadedAsset->Requesters.insert(requesterID);
         RequestDependencies(assetRef.UID, requesterID);
@@ -49,9 +110,43 @@ namespace Havtorn
         return loadedAsset;
     }
 
+    const SStaticMeshAsset* CAssetRegistry::RequestOccluderAssetDataAsync(const SAssetReference& assetRef, const EAssetLoadPriority priority, const U64 requesterID)
+    {
+        {
+            std::scoped_lock lock(OccluderAssetsMutex);
+            OccluderAssets.insert(assetRef.UID);
+        }
+
+        SStaticMeshAsset* meshAsset = RequestAssetDataAsync<SStaticMeshAsset>(assetRef, priority, requesterID);
+        if (meshAsset == nullptr || meshAsset->HasOccluderGeometry)
+            return meshAsset;
+
+        // Loaded before it was marked, or read before the mark reached the load job
+        SAsset asset;
+        SAssetFileHeader fileHeader;
+        SAssetFileData fileData;
+        if (ReadAsset(assetRef, asset, fileHeader, fileData))
+        {
+            SStaticMeshAsset& readAsset = std::get<SStaticMeshAsset>(asset.Data);
+            meshAsset->OccluderPositions = std::move(readAsset.OccluderPositions);
+            meshAsset->OccluderIndices = std::move(readAsset.OccluderIndices);
+        }
+        else
+        {
+            HV_LOG_WARN("CAssetRegistry::RequestOccluderAssetDataAsync: Could not read occluder geometry of %s!", assetRef.FilePath.c_str());
+        }
+
+        // Don't try again every frame if the file couldn't be read
+        meshAsset->HasOccluderGeometry = true;
+        return meshAsset;
+    }
+
     void CAssetRegistry::UnrequestAsset(const SAssetReference& assetRef, const U64 requesterID)
     {
-        // TODO.NW: Check if asset is loading on separate thread, or check if requests are still there when finished loading?
+        // Loads in flight check their requesters again when they are finalized
+        if (auto it = PendingLoads.find(assetRef.UID); it != PendingLoads.end())
+            it->second->Requesters.erase(requesterID);
+
         if (!LoadedAssets.contains(assetRef.UID))
             return;
 
@@ -59,7 +154,7 @@ namespace Havtorn
         loadedAsset->Requesters.erase(requesterID);
         UnrequestDependencies(assetRef.UID, requesterID);
 
-        if (loadedAsset->Requesters.empty())
+        if (loadedAsset->Requesters.empty() && !CacheAsset(assetRef.UID))
             UnloadAsset(assetRef);
     }
 
@@ -67,6 +162,7 @@ namespace Havtorn
     {
         if (LoadedAssets.contains(assetUID))
         {
+            UncacheAsset(assetUID);
             SAsset* loadedAsset = GetAsset(assetUID);
             loadedAsset->Requesters.insert(requesterID);
             RequestDependencies(assetUID, requesterID);
@@ -83,7 +179,9 @@ namespace Havtorn
 
     void CAssetRegistry::UnrequestAsset(const U32 assetUID, const U64 requesterID)
     {
-        // TODO.NW: Check if asset is loading on separate thread, or check if requests are still there when finished loading?
+        if (auto it = PendingLoads.find(assetUID); it != PendingLoads.end())
+            it->second->Requesters.erase(requesterID);
+
         if (!LoadedAssets.contains(assetUID))
             return;
 
@@ -91,7 +189,7 @@ namespace Havtorn
         loadedAsset->Requesters.erase(requesterID);
         UnrequestDependencies(assetUID, requesterID);
 
-        if (loadedAsset->Requesters.empty())
+        if (loadedAsset->Requesters.empty() && !CacheAsset(assetUID))
         {
             if (AssetDatabase.contains(assetUID))
                 UnloadAsset(SAssetReference(AssetDatabase[assetUID]));
@@ -114,6 +212,201 @@ namespace Havtorn
             UnrequestAsset(ref, requesterID);
     }
 
+    SAssetLoadHandle CAssetRegistry::RequestAssetAsync(const SAssetReference& assetRef, const EAssetLoadPriority priority, const U64 requesterID)
+    {
+        // Resident assets all share one state, this path is hit every frame by systems polling their assets
+        static const std::shared_ptr<std::atomic<EAssetLoadState>> loadedState = std::make_shared<std::atomic<EAssetLoadState>>(EAssetLoadState::Loaded);
+
+        if (LoadedAssets.contains(assetRef.UID))
+        {
+            SAsset* loadedAsset = GetAsset(assetRef.UID);
+
+            // A registered requester means the asset is neither cached nor missing its dependencies
+            if (loadedAsset->Requesters.contains(requesterID))
+                return { assetRef.UID, loadedState };
+
+            UncacheAsset(assetRef.UID);
+            loadedAsset->Requesters.insert(requesterID);
+            RequestDependencies(assetRef.UID, requesterID, true);
+
+            return { assetRef.UID, loadedState };
+        }
+
+        if (auto it = PendingLoads.find(assetRef.UID); it != PendingLoads.end())
+        {
+            SPendingAssetLoad& load = *it->second;
+            load.Requesters.insert(requesterID);
+            
+            // Only has an effect until the load job is started
+            if (priority > load.Priority)
+                load.Priority = priority;
+
+            return { assetRef.UID, load.State };
+        }
+
+        auto load = std::make_shared<SPendingAssetLoad>();
+        load->Reference = assetRef;
+        load->Priority = priority;
+        load->RequestOrder = NextLoadRequestOrder++;
+        load->Requesters.insert(requesterID);
+        load->State = std::make_shared<std::atomic<EAssetLoadState>>(EAssetLoadState::Queued);
+
+        PendingLoads.emplace(assetRef.UID, load);
+        QueuedLoads.push_back(load);
+
+        return { assetRef.UID, load->State };
+    }
+
+    SAssetLoadHandle CAssetRegistry::RequestAssetAsync(const U32 assetUID, const EAssetLoadPriority priority, const U64 requesterID)
+    {
+        if (LoadedAssets.contains(assetUID))
+            return RequestAssetAsync(GetAsset(assetUID)->Reference, priority, requesterID);
+
+        if (auto it = PendingLoads.find(assetUID); it != PendingLoads.end())
+            return RequestAssetAsync(it->second->Reference, priority, requesterID);
+
+        if (AssetDatabase.contains(assetUID))
+            return RequestAssetAsync(SAssetReference(AssetDatabase[assetUID]), priority, requesterID);
+
+        HV_LOG_ERROR("CAssetRegistry::RequestAssetAsync: Could not request asset with ID: %i, it is not loaded yet and has not been found in the database before. Please use the asset file path instead", assetUID);
+        static const std::shared_ptr<std::atomic<EAssetLoadState>> failedState = std::make_shared<std::atomic<EAssetLoadState>>(EAssetLoadState::Failed);
+        return { assetUID, failedState };
+    }
+
+    void CAssetRegistry::UpdateAsyncLoads()
+    {
+        // Loads can push a type over its budget too. They can happen with the registry lock held, so evict here instead.
+        EvictCachedAssets();
+
+        std::vector<std::shared_ptr<SAssetBatchImportState>> finishedImports;
+        {
+            std::unique_lock lock(FinishedImportsMutex);
+            finishedImports.swap(FinishedImports);
+        }
+
+        for (const std::shared_ptr<SAssetBatchImportState>& batch : finishedImports)
+        {
+            for (const std::string& hvaPath : batch->ImportedPaths)
+            {
+                OnAssetWritten(hvaPath);
+                AssetDatabase.emplace(SAssetReference(hvaPath).UID, hvaPath);
+            }
+            batch->IsDone.store(true);
+        }
+
+        // Start queued loads, highest priority first
+        if (!QueuedLoads.empty() && NumberOfLoadsInFlight < MaxAsyncLoadsInFlight)
+        {
+            std::ranges::sort(QueuedLoads, &CAssetRegistry::SortPendingLoads);
+
+            CThreadManager* threadManager = GEngine::GetThreadManager();
+            const U64 numberOfLoadsToStart = UMath::Min(STATIC_U64(QueuedLoads.size()), STATIC_U64(MaxAsyncLoadsInFlight - NumberOfLoadsInFlight));
+            for (U64 i = 0; i < numberOfLoadsToStart; i++)
+            {
+                std::shared_ptr<SPendingAssetLoad> load = QueuedLoads[i];
+                load->State->store(EAssetLoadState::Reading);
+                NumberOfLoadsInFlight++;
+
+                auto job = [this, load]()
+                    {
+                        load->WasRead = ReadAsset(load->Reference, load->Asset, load->FileHeader, load->FileData);
+                        load->State->store(EAssetLoadState::AwaitingFinalize);
+
+                        std::unique_lock lock(FinishedLoadsMutex);
+                        FinishedLoads.push_back(load);
+                    };
+
+                if (threadManager != nullptr)
+                    threadManager->PushJob(job);
+                else
+                    job();
+            }
+
+            QueuedLoads.erase(QueuedLoads.begin(), QueuedLoads.begin() + numberOfLoadsToStart);
+        }
+
+        std::vector<std::shared_ptr<SPendingAssetLoad>> finishedLoads;
+        {
+            std::unique_lock lock(FinishedLoadsMutex);
+            finishedLoads.swap(FinishedLoads);
+        }
+
+        if (finishedLoads.empty())
+            return;
+
+        std::ranges::sort(finishedLoads, &CAssetRegistry::SortPendingLoads);
+
+        // GPU resources are created here rather than on the job threads, the render state manager isn't thread safe.
+        // Always finalize at least one load so a single large asset can't stall the queue forever.
+        const auto startTime = std::chrono::high_resolution_clock::now();
+        U64 numberOfFinalizedLoads = 0;
+        for (; numberOfFinalizedLoads < finishedLoads.size(); numberOfFinalizedLoads++)
+        {
+            if (numberOfFinalizedLoads > 0)
+            {
+                const F32 elapsedMilliseconds = std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+                if (elapsedMilliseconds > AsyncFinalizeBudgetMilliseconds)
+                    break;
+            }
+
+            FinalizeAsyncLoad(*finishedLoads[numberOfFinalizedLoads]);
+            NumberOfLoadsInFlight--;
+        }
+
+        // Whatever didn't fit in the budget is picked up again next frame
+        if (numberOfFinalizedLoads < finishedLoads.size())
+        {
+            std::unique_lock lock(FinishedLoadsMutex);
+            FinishedLoads.insert(FinishedLoads.end(), finishedLoads.begin() + numberOfFinalizedLoads, finishedLoads.end());
+        }
+    }
+
+    bool CAssetRegistry::SortPendingLoads(const std::shared_ptr<SPendingAssetLoad>& a, const std::shared_ptr<SPendingAssetLoad>& b)
+    {
+        if (a->Priority != b->Priority)
+            return a->Priority > b->Priority;
+
+        return a->RequestOrder < b->RequestOrder;
+    }
+
+    void CAssetRegistry::FinalizeAsyncLoad(SPendingAssetLoad& load)
+    {
+        const U32 assetUID = load.Reference.UID;
+        PendingLoads.erase(assetUID);
+
+        if (!load.WasRead)
+        {
+            load.State->store(EAssetLoadState::Failed);
+            return;
+        }
+
+        // Everyone unrequested the asset while it was loading
+        if (load.Requesters.empty())
+        {
+            load.State->store(EAssetLoadState::None);
+            return;
+        }
+
+        // A synchronous request got there first, the data we read is already in use
+        if (!LoadedAssets.contains(assetUID))
+        {
+            FinalizeAsset(load.Asset, load.FileHeader);
+            AddAsset(assetUID, load.Asset);
+        }
+        load.FileHeader = std::monostate();
+        load.FileData.Release();
+
+        UncacheAsset(assetUID);
+        SAsset* loadedAsset = GetAsset(assetUID);
+        for (const U64 requesterID : load.Requesters)
+        {
+            loadedAsset->Requesters.insert(requesterID);
+            RequestDependencies(assetUID, requesterID, true);
+        }
+
+        load.State->store(EAssetLoadState::Loaded);
+    }
+
     std::string CAssetRegistry::GetAssetDatabaseEntry(const U32 uid)
     {
         if (!AssetDatabase.contains(uid))
@@ -125,7 +418,7 @@ namespace Havtorn
         return AssetDatabase[uid];
     }
 
-    void CAssetRegistry::RequestDependencies(const U32 assetUID, const U64 requesterID)
+    void CAssetRegistry::RequestDependencies(const U32 assetUID, const U64 requesterID, const bool isAsync)
     {
         SAsset* asset = GetAsset(assetUID);
         if (std::holds_alternative<SGraphicsMaterialAsset>(asset->Data))
@@ -137,7 +430,10 @@ namespace Havtorn
                     if (property.TextureChannelIndex <= -1.0f)
                         return;
 
-                    RequestAsset(property.TextureUID, requesterID);
+                    if (isAsync)
+                        RequestAssetAsync(property.TextureUID, EAssetLoadPriority::Normal, requesterID);
+                    else
+                        RequestAsset(property.TextureUID, requesterID);
                 };
 
             requestAssetDependency(assetData.Material.AlbedoA);
@@ -187,149 +483,252 @@ namespace Havtorn
 
     bool CAssetRegistry::LoadAsset(const SAssetReference& assetRef)
     {
-        std::string filePath = assetRef.FilePath;
-        if (!UFileSystem::Exists(filePath))
+        SAsset asset;
+        SAssetFileHeader fileHeader;
+        SAssetFileData fileData;
+        if (!ReadAsset(assetRef, asset, fileHeader, fileData))
+            return false;
+
+        FinalizeAsset(asset, fileHeader);
+
+        // TODO.NW: Bind filewatchers?
+
+        AddAsset(assetRef.UID, asset);
+        return true;
+    }
+
+    bool CAssetRegistry::ResolveAssetFilePath(const SAssetReference& assetRef, std::string& outFilePath) const
+    {
+        outFilePath = assetRef.FilePath;
+        if (UFileSystem::Exists(outFilePath))
+            return true;
+
+        std::string redirection = GetAssetRedirector(outFilePath);
+        while (!UFileSystem::Exists(redirection) && redirection != "")
         {
-            CJsonDocument config = UFileSystem::OpenJson(UFileSystem::EngineConfig);
-            std::string redirection = config.GetValueFromArray("Asset Redirectors", filePath, "");
-            
-            while (!UFileSystem::Exists(redirection) && redirection != "")
-            {
-                redirection = config.GetValueFromArray("Asset Redirectors", redirection, "");
-            } 
+            redirection = GetAssetRedirector(redirection);
+        } 
+
+        if (redirection == "")
+            return false;
+
+        outFilePath = redirection;
+        return true;
+    }
+
+    bool CAssetRegistry::OpenAssetFile(const SAssetReference& assetRef, SAssetFileData& outFileData) const
+    {
+        // Archives first, finding an asset in one doesn't need any file system calls
+        for (const CAssetArchive& archive : MountedArchives)
+        {
+            const SAssetArchiveEntry* entry = archive.FindEntry(assetRef.UID);
+            if (entry == nullptr)
+                continue;
 
-            if (redirection == "")
+            std::vector<SCompressedChunk> chunks;
+            if (!archive.ReadEntry(*entry, outFileData.Buffer, outFileData.Data, &chunks) || !DecompressChunks(chunks))
             {
-                HV_LOG_WARN("CAssetRegistry::LoadAsset: Asset file pointed to by %s failed to load, does not exist!", assetRef.FilePath.c_str());
+                HV_LOG_WARN("CAssetRegistry::LoadAsset: Asset %s failed to load from archive %s!", assetRef.FilePath.c_str(), archive.GetFilePath().c_str());
                 return false;
             }
 
-            filePath = redirection;
+            outFileData.Size = entry->Size;
+            return true;
         }
 
-        const U64 fileSize = UFileSystem::GetFileSize(filePath);
-        if (fileSize == 0)
+        std::string filePath;
+        if (!ResolveAssetFilePath(assetRef, filePath))
+        {
+            HV_LOG_WARN("CAssetRegistry::LoadAsset: Asset file pointed to by %s failed to load, does not exist!", assetRef.FilePath.c_str());
+            return false;
+        }
+
+        // Mapped rather than read into a buffer, mesh data in aligned files is uploaded straight from the mapping
+        if (!outFileData.MappedFile.Open(filePath))
         {
             HV_LOG_WARN("CAssetRegistry::LoadAsset: Asset file pointed to by %s failed to load, was empty!", assetRef.FilePath.c_str());
             return false;
         }
 
-        char* data = new char[fileSize];
+        outFileData.Data = outFileData.MappedFile.GetData();
+        outFileData.Size = outFileData.MappedFile.GetSize();
+        return true;
+    }
+
+    bool CAssetRegistry::DecompressChunks(const std::vector<SCompressedChunk>& chunks)
+    {
+        CThreadManager* threadManager = GEngine::GetThreadManager();
+        if (threadManager == nullptr || chunks.size() < MinChunksToDecompressInParallel)
+            return UCompression::DecompressChunks(chunks);
+
+        // Chunks are spread evenly rather than one job each, most of them decompress in well under the cost of a job
+        const U32 numberOfChunks = STATIC_U32(chunks.size());
+        const U32 numberOfJobs = UMath::Min(numberOfChunks, STATIC_U32(threadManager->GetNumberOfThreads()) + 1);
+        std::atomic<bool> didSucceed = true;
+        threadManager->ParallelFor(numberOfJobs, [&](const U32 jobIndex)
+            {
+                const U32 firstChunk = numberOfChunks * jobIndex / numberOfJobs;
+                const U32 lastChunk = numberOfChunks * (jobIndex + 1) / numberOfJobs;
+                for (U32 i = firstChunk; i < lastChunk; i++)
+                {
+                    if (!UCompression::DecompressChunk(chunks[i]))
+                        didSucceed = false;
+                }
+            });
 
-        UFileSystem::Deserialize(filePath, data, STATIC_U32(fileSize));
-        EAssetType type = EAssetType::None;
+        return didSucceed;
+    }
+
+    void CAssetRegistry::SAssetFileData::Release()
+    {
+        MappedFile.Close();
+        Buffer = {};
+        Data = nullptr;
+        Size = 0;
+    }
+
+    bool CAssetRegistry::ReadAsset(const SAssetReference& assetRef, SAsset& outAsset, SAssetFileHeader& outFileHeader, SAssetFileData& outFileData) const
+    {
+        if (!OpenAssetFile(assetRef, outFileData))
+            return false;
+
+        const char* data = outFileData.Data;
+        const U64 fileSize = outFileData.Size;
         U64 pointerPosition = 0;
-        DeserializeData(type, data, pointerPosition);
+        const EAssetType type = DeserializeAssetType(data, pointerPosition);
 
-        SAsset asset;
-        asset.Type = type;
-        asset.Reference = assetRef;
+        outAsset.Type = type;
+        outAsset.Reference = assetRef;
+
+        // Blobs in compressed files decompress straight into the header being read. That has to be done before anything
+        // reads them and before the header is moved, short strings live inside the header itself.
+        std::vector<SCompressedChunk> chunks;
+        auto decompressPayloads = [&](const bool wasDeserialized)
+            {
+                if (wasDeserialized && DecompressChunks(chunks))
+                    return true;
+
+                HV_LOG_WARN("CAssetRegistry::LoadAsset: Asset %s has corrupt compressed data!", assetRef.FilePath.c_str());
+                return false;
+            };
 
         switch (type)
         {
         case EAssetType::StaticMesh:
         {
             SStaticModelFileHeader assetFile;
-            assetFile.Deserialize(data);
+            if (!decompressPayloads(assetFile.Deserialize(data, fileSize, true, &chunks)))
+                return false;
+
             SStaticMeshAsset meshAsset(assetFile);
+            if (IsOccluderAsset(assetRef.UID))
+                meshAsset.AddOccluderGeometry(assetFile);
 
-            for (U16 i = 0; i < assetFile.NumberOfMeshes; i++)
+            // Files imported before bounds were stored have to be scanned, and store them when saved again.
+            // LOD meshes are subsets of the LOD0 vertices, so they share its bounds.
+            SMeshBounds bounds = assetFile.Bounds;
+            if (!bounds.IsValid())
             {
-                const SStaticMesh& mesh = assetFile.Meshes[i];
-                SDrawCallData& drawCallData = meshAsset.DrawCallData[i];
+                std::vector<std::span<const SStaticMeshVertex>> meshVertices;
+                for (U16 i = 0; i < assetFile.NumberOfMeshes; i++)
+                    meshVertices.emplace_back(assetFile.GetVertices(0, i));
 
-                // TODO.NW: Check for existing buffers
-                drawCallData.VertexBufferIndex = RenderManager->RenderStateManager.AddVertexBuffer(mesh.Vertices);
-                drawCallData.IndexBufferIndex = RenderManager->RenderStateManager.AddIndexBuffer(mesh.Indices);
-                drawCallData.VertexStrideIndex = 0;
-                drawCallData.VertexOffsetIndex = 0;
-
-                for (const SStaticMeshVertex& vertex : mesh.Vertices)
-                {
-                    meshAsset.BoundsMin.X = UMath::Min(vertex.x, meshAsset.BoundsMin.X);
-                    meshAsset.BoundsMin.Y = UMath::Min(vertex.y, meshAsset.BoundsMin.Y);
-                    meshAsset.BoundsMin.Z = UMath::Min(vertex.z, meshAsset.BoundsMin.Z);
+                bounds = UMeshOptimizer::GetBounds(meshVertices);
+                assetFile.Bounds = bounds;
+            }
 
-                    meshAsset.BoundsMax.X = UMath::Max(vertex.x, meshAsset.BoundsMax.X);
-                    meshAsset.BoundsMax.Y = UMath::Max(vertex.y, meshAsset.BoundsMax.Y);
-                    meshAsset.BoundsMax.Z = UMath::Max(vertex.z, meshAsset.BoundsMax.Z);
-                }
+            meshAsset.BoundsMin = bounds.Min;
+            meshAsset.BoundsMax = bounds.Max;
+            meshAsset.BoundsCenter = bounds.Center;
+            meshAsset.BoundsRadius = bounds.Radius;
 
-                meshAsset.BoundsCenter = meshAsset.BoundsMin + (meshAsset.BoundsMax - meshAsset.BoundsMin) * 0.5f;
+            // The CPU copies are dropped in FinalizeAsset, this is what the vertex and index buffers hold
+            for (U8 lodIndex = 0; lodIndex <= STATIC_U8(assetFile.LODs.size()); lodIndex++)
+            {
+                for (U16 i = 0; i < assetFile.NumberOfMeshes; i++)
+                    outAsset.MemorySize += assetFile.GetVertices(lodIndex, i).size_bytes() + assetFile.GetIndices(lodIndex, i).size_bytes();
             }
 
-            asset.Data = meshAsset;
-            asset.SourceData = assetFile.SourceData;
+            outAsset.Data = meshAsset;
+            outAsset.SourceData = assetFile.SourceData;
+            outFileHeader = std::move(assetFile);
         }
         break;
         case EAssetType::SkeletalMesh:
         {
             SSkeletalModelFileHeader assetFile;
-            assetFile.Deserialize(data);
+            if (!decompressPayloads(assetFile.Deserialize(data, fileSize, true, &chunks)))
+                return false;
+
             SSkeletalMeshAsset meshAsset(assetFile);
 
-            for (U16 i = 0; i < assetFile.NumberOfMeshes; i++)
+            SMeshBounds bounds = assetFile.Bounds;
+            if (!bounds.IsValid())
             {
-                const SSkeletalMesh& mesh = assetFile.Meshes[i];
-                SDrawCallData& drawCallData = meshAsset.DrawCallData[i];
+                std::vector<std::span<const SSkeletalMeshVertex>> meshVertices;
+                for (U16 i = 0; i < assetFile.NumberOfMeshes; i++)
+                    meshVertices.emplace_back(assetFile.GetVertices(i));
 
-                // TODO.NW: Check for existing buffers
-                drawCallData.VertexBufferIndex = RenderManager->RenderStateManager.AddVertexBuffer(mesh.Vertices);
-                drawCallData.IndexBufferIndex = RenderManager->RenderStateManager.AddIndexBuffer(mesh.Indices);
-                drawCallData.VertexStrideIndex = 2;
-                drawCallData.VertexOffsetIndex = 0;
-
-                for (const SSkeletalMeshVertex& vertex : mesh.Vertices)
-                {
-                    meshAsset.BoundsMin.X = UMath::Min(vertex.x, meshAsset.BoundsMin.X);
-                    meshAsset.BoundsMin.Y = UMath::Min(vertex.y, meshAsset.BoundsMin.Y);
-                    meshAsset.BoundsMin.Z = UMath::Min(vertex.z, meshAsset.BoundsMin.Z);
+                bounds = UMeshOptimizer::GetBounds(meshVertices);
+                assetFile.Bounds = bounds;
+            }
 
-                    meshAsset.BoundsMax.X = UMath::Max(vertex.x, meshAsset.BoundsMax.X);
-                    meshAsset.BoundsMax.Y = UMath::Max(vertex.y, meshAsset.BoundsMax.Y);
-                    meshAsset.BoundsMax.Z = UMath::Max(vertex.z, meshAsset.BoundsMax.Z);
-                }
+            meshAsset.BoundsMin = bounds.Min;
+            meshAsset.BoundsMax = bounds.Max;
+            meshAsset.BoundsCenter = bounds.Center;
+            meshAsset.BoundsRadius = bounds.Radius;
 
-                meshAsset.BoundsCenter = meshAsset.BoundsMin + (meshAsset.BoundsMax - meshAsset.BoundsMin) * 0.5f;
-            }
+            for (U16 i = 0; i < assetFile.NumberOfMeshes; i++)
+                outAsset.MemorySize += assetFile.GetVertices(i).size_bytes() + assetFile.GetIndices(i).size_bytes();
 
-            asset.Data = meshAsset;
-            asset.SourceData = assetFile.SourceData;
+            outAsset.Data = meshAsset;
+            outAsset.SourceData = assetFile.SourceData;
+            outFileHeader = std::move(assetFile);
         }
         break;
         case EAssetType::Texture:
         {
             STextureFileHeader assetFile;
-            assetFile.Deserialize(data);
-            STextureAsset textureAsset(assetFile);
-            textureAsset.RenderTexture = RenderManager->RenderTextureFactory.CreateStaticTexture(filePath, assetFile.AssetType);
-            asset.Data = textureAsset;
-            asset.SourceData = assetFile.SourceData;
+            if (!decompressPayloads(assetFile.Deserialize(data, fileSize, &chunks)))
+                return false;
+
+            outAsset.Data = STextureAsset(assetFile);
+            outAsset.MemorySize = assetFile.Data.size();
+            outAsset.SourceData = assetFile.SourceData;
+            outFileHeader = std::move(assetFile);
         }
         break;
         case EAssetType::TextureCube:
         {
             STextureCubeFileHeader assetFile;
-            assetFile.Deserialize(data);
-            STextureCubeAsset textureAsset(assetFile);
-            textureAsset.RenderTexture = RenderManager->RenderTextureFactory.CreateStaticTexture(filePath, assetFile.AssetType);
-            asset.Data = textureAsset;
-            asset.SourceData = assetFile.SourceData;
+            if (!decompressPayloads(assetFile.Deserialize(data, fileSize, &chunks)))
+                return false;
+
+            outAsset.Data = STextureCubeAsset(assetFile);
+            outAsset.MemorySize = assetFile.Data.size();
+            outAsset.SourceData = assetFile.SourceData;
+            outFileHeader = std::move(assetFile);
         }
         break;
         case EAssetType::Material:
         {
             SMaterialAssetFileHeader assetFile;
             assetFile.Deserialize(data);
-            asset.Data = SGraphicsMaterialAsset(assetFile);
+            outAsset.Data = SGraphicsMaterialAsset(assetFile);
+            outAsset.MemorySize = sizeof(SGraphicsMaterialAsset);
         }
         break;
         case EAssetType::Animation:
         {
             SSkeletalAnimationFileHeader assetFile;
-            assetFile.Deserialize(data);
-            asset.Data = SSkeletalAnimationAsset(assetFile);
-            asset.SourceData = assetFile.SourceData;
+            if (!decompressPayloads(assetFile.Deserialize(data, fileSize, &chunks)))
+                return false;
+
+            for (const SBoneAnimationTrack& track : assetFile.BoneAnimationTracks)
+                outAsset.MemorySize += GetDataSize(track.TranslationKeys) + GetDataSize(track.RotationKeys) + GetDataSize(track.ScaleKeys);
+
+            outAsset.SourceData = assetFile.SourceData;
+            outAsset.Data = SSkeletalAnimationAsset(std::move(assetFile));
         }
         break;
         case EAssetType::Script:
@@ -345,17 +744,74 @@ namespace Havtorn
         break;
         case EAssetType::Sequencer:
             HV_LOG_WARN("CAssetRegistry: Asset Resolving for asset type %s is not yet implemented.", magic_enum::enum_name<EAssetType>(type).data());
-            delete[] data;
             return false;
         }
-        delete[] data;
 
-        // TODO.NW: Bind filewatchers?
+        // Everything but mesh data in uncompressed files has been copied out by now, no need to keep the file around until finalization
+        if ((type != EAssetType::StaticMesh && type != EAssetType::SkeletalMesh) || !chunks.empty())
+            outFileData.Release();
 
-        AddAsset(assetRef.UID, asset);
         return true;
     }
 
+    void CAssetRegistry::FinalizeAsset(SAsset& asset, SAssetFileHeader& fileHeader)
+    {
+        if (SStaticModelFileHeader* assetFile = std::get_if<SStaticModelFileHeader>(&fileHeader))
+        {
+            SStaticMeshAsset& meshAsset = std::get<SStaticMeshAsset>(asset.Data);
+
+            for (U16 i = 0; i < assetFile->NumberOfMeshes; i++)
+            {
+                SDrawCallData& drawCallData = meshAsset.DrawCallData[i];
+
+                // TODO.NW: Check for existing buffers
+                drawCallData.VertexBufferIndex = RenderManager->RenderStateManager.AddVertexBuffer(assetFile->GetVertices(0, i));
+                drawCallData.IndexBufferIndex = RenderManager->RenderStateManager.AddIndexBuffer(assetFile->GetIndices(0, i));
+                drawCallData.VertexStrideIndex = 0;
+                drawCallData.VertexOffsetIndex = 0;
+            }
+
+            for (U16 lodIndex = 0; lodIndex < STATIC_U16(meshAsset.LODs.size()); lodIndex++)
+            {
+                for (U16 i = 0; i < assetFile->NumberOfMeshes; i++)
+                {
+                    SDrawCallData& drawCallData = meshAsset.LODs[lodIndex].DrawCallData[i];
+
+                    drawCallData.VertexBufferIndex = RenderManager->RenderStateManager.AddVertexBuffer(assetFile->GetVertices(STATIC_U8(lodIndex + 1), i));
+                    drawCallData.IndexBufferIndex = RenderManager->RenderStateManager.AddIndexBuffer(assetFile->GetIndices(STATIC_U8(lodIndex + 1), i));
+                    drawCallData.VertexStrideIndex = 0;
+                    drawCallData.VertexOffsetIndex = 0;
+                }
+            }
+        }
+        else if (SSkeletalModelFileHeader* assetFile = std::get_if<SSkeletalModelFileHeader>(&fileHeader))
+        {
+            SSkeletalMeshAsset& meshAsset = std::get<SSkeletalMeshAsset>(asset.Data);
+
+            for (U16 i = 0; i < assetFile->NumberOfMeshes; i++)
+            {
+                SDrawCallData& drawCallData = meshAsset.DrawCallData[i];
+
+                // TODO.NW: Check for existing buffers
+                drawCallData.VertexBufferIndex = RenderManager->RenderStateManager.AddVertexBuffer(assetFile->GetVertices(i));
+                drawCallData.IndexBufferIndex = RenderManager->RenderStateManager.AddIndexBuffer(assetFile->GetIndices(i));
+                drawCallData.VertexStrideIndex = 2;
+                drawCallData.VertexOffsetIndex = 0;
+            }
+        }
+        else if (STextureFileHeader* assetFile = std::get_if<STextureFileHeader>(&fileHeader))
+        {
+            std::get<STextureAsset>(asset.Data).RenderTexture = RenderManager->RenderTextureFactory.CreateStaticTexture(assetFile->OriginalFormat, assetFile->Data);
+        }
+        else if (STextureCubeFileHeader* assetFile = std::get_if<STextureCubeFileHeader>(&fileHeader))
+        {
+            std::get<STextureCubeAsset>(asset.Data).RenderTexture = RenderManager->RenderTextureFactory.CreateStaticTexture(assetFile->OriginalFormat, assetFile->Data);
+        }
+
+        // The file header can hold all vertices or texels of the asset, don't keep it around once the GPU has them
+        fileHeader = std::monostate();
+    }
+
     bool CAssetRegistry::UnloadAsset(const SAssetReference& assetRef)
     {
         if (!LoadedAssets.contains(assetRef.UID))
@@ -380,33 +836,199 @@ namespace Havtorn
 
         // NW: It's important that we move the asset here, otherwise pointers in the assets (e.g. to data bindings in data binding nodes in scripts)
         // may be left dangling.
+        ResidentMemory[asset.Type] += asset.MemorySize;
         if (LoadedAssets.contains(assetUID))
         {
-            LoadedAssets[assetUID] = std::move(asset);
+            SAsset& replacedAsset = LoadedAssets[assetUID];
+            ResidentMemory[replacedAsset.Type] -= replacedAsset.MemorySize;
+            if (auto it = SoftCacheEntries.find(assetUID); it != SoftCacheEntries.end())
+            {
+                SoftCacheMemory = SoftCacheMemory - GetSoftCacheSize(replacedAsset) + GetSoftCacheSize(asset);
+                // Reloaded, e.g. after a reimport, counts as just released
+                SoftCache.splice(SoftCache.end(), SoftCache, it->second);
+            }
+
+            replacedAsset = std::move(asset);
             return;
         }
 
+        NumberOfLoads++;
         LoadedAssets.emplace(assetUID, std::move(asset));
     }
 
     void CAssetRegistry::RemoveAsset(const U32 assetUID)
     {
         std::unique_lock lock(RegistryMutex);
-        LoadedAssets.erase(assetUID);
+        auto it = LoadedAssets.find(assetUID);
+        if (it == LoadedAssets.end())
+            return;
+
+        if (auto cacheIt = SoftCacheEntries.find(assetUID); cacheIt != SoftCacheEntries.end())
+        {
+            SoftCacheMemory -= GetSoftCacheSize(it->second);
+            SoftCache.erase(cacheIt->second);
+            SoftCacheEntries.erase(cacheIt);
+        }
+
+        ResidentMemory[it->second.Type] -= it->second.MemorySize;
+        LoadedAssets.erase(it);
+    }
+
+    bool CAssetRegistry::CacheAsset(const U32 assetUID)
+    {
+        auto it = LoadedAssets.find(assetUID);
+        if (it == LoadedAssets.end())
+            return false;
+
+        const SAsset& asset = it->second;
+        switch (asset.Type)
+        {
+        case EAssetType::StaticMesh:
+        case EAssetType::SkeletalMesh:
+        case EAssetType::Texture:
+        case EAssetType::TextureCube:
+        case EAssetType::Material:
+        case EAssetType::Animation:
+            break;
+        default:
+            return false;
+        }
+
+        if (!SoftCacheEntries.contains(assetUID))
+        {
+            SoftCacheEntries.emplace(assetUID, SoftCache.insert(SoftCache.end(), assetUID));
+            SoftCacheMemory += GetSoftCacheSize(asset);
+        }
+
+        EvictCachedAssets();
+        return true;
+    }
+
+    void CAssetRegistry::UncacheAsset(const U32 assetUID)
+    {
+        auto it = SoftCacheEntries.find(assetUID);
+        if (it == SoftCacheEntries.end())
+            return;
+
+        SoftCacheMemory -= GetSoftCacheSize(LoadedAssets[assetUID]);
+        SoftCache.erase(it->second);
+        SoftCacheEntries.erase(it);
+        NumberOfCacheHits++;
+    }
+
+    void CAssetRegistry::EvictCachedAssets()
+    {
+        auto isOverTypeBudget = [this](const EAssetType type)
+            {
+                auto it = MemoryBudgets.find(type);
+                return it != MemoryBudgets.end() && ResidentMemory[type] > it->second;
+            };
+
+        for (auto it = SoftCache.begin(); it != SoftCache.end();)
+        {
+            const U32 assetUID = *it++;
+            const EAssetType type = LoadedAssets[assetUID].Type;
+            if (!IsEvictable(type) || (SoftCacheMemory <= SoftCacheBudget && !isOverTypeBudget(type)))
+                continue;
+
+            RemoveAsset(assetUID);
+            NumberOfEvictions++;
+        }
+    }
+
+    void CAssetRegistry::SetMemoryBudget(const EAssetType type, const U64 budgetBytes)
+    {
+        if (!IsEvictable(type))
+        {
+            HV_LOG_WARN("CAssetRegistry::SetMemoryBudget: %s assets can't be evicted, ignoring the budget. Their residency is reported on its own in the debug string.", magic_enum::enum_name<EAssetType>(type).data());
+            return;
+        }
+
+        if (budgetBytes == 0)
+            MemoryBudgets.erase(type);
+        else
+            MemoryBudgets[type] = budgetBytes;
+
+        EvictCachedAssets();
+    }
+
+    void CAssetRegistry::SetSoftCacheBudget(const U64 budgetBytes)
+    {
+        SoftCacheBudget = budgetBytes;
+        EvictCachedAssets();
+    }
+
+    void CAssetRegistry::EvictSoftCache()
+    {
+        for (auto it = SoftCache.begin(); it != SoftCache.end();)
+        {
+            const U32 assetUID = *it++;
+            if (!IsEvictable(LoadedAssets[assetUID].Type))
+                continue;
+
+            RemoveAsset(assetUID);
+            NumberOfEvictions++;
+        }
+    }
+
+    bool CAssetRegistry::IsEvictable(const EAssetType assetType)
+    {
+        // Mesh vertex and index buffers live in the render state manager for as long as it does, evicting a mesh
+        // would only create new buffers for it the next time it's requested
+        return assetType != EAssetType::StaticMesh && assetType != EAssetType::SkeletalMesh;
+    }
+
+    U64 CAssetRegistry::GetSoftCacheSize(const SAsset& asset)
+    {
+        return IsEvictable(asset.Type) ? asset.MemorySize : 0;
+    }
+
+    bool CAssetRegistry::IsOccluderAsset(const U32 assetUID) const
+    {
+        std::scoped_lock lock(OccluderAssetsMutex);
+        return OccluderAssets.contains(assetUID);
+    }
+
+    bool CAssetRegistry::IsQuantizedOnImport(const EAssetType assetType) const
+    {
+        return assetType == EAssetType::Animation ? ShouldCompressAnimationKeys : ShouldQuantizeVertices;
+    }
+
+    SStaticMeshLODImportSettings CAssetRegistry::GetLODImportSettings(const SAsset* asset)
+    {
+        if (asset == nullptr || !std::holds_alternative<SStaticMeshAsset>(asset->Data))
+            return {};
+
+        return std::get<SStaticMeshAsset>(asset->Data).LODImportSettings;
     }
 
-    std::string CAssetRegistry::ImportAsset(const std::string& filePath, const std::string& destinationPath, const SSourceAssetData& sourceData)
+    std::string CAssetRegistry::ImportAsset(const std::string& filePath, const std::string& destinationPath, const SSourceAssetData& sourceData, const SStaticMeshLODImportSettings& lodSettings)
     {
         std::string hvaPath = "INVALID_PATH";
+        AddDestinationDirectories(destinationPath);
+        if (ImportSourceAsset({ filePath, destinationPath, sourceData, lodSettings }, hvaPath))
+            OnAssetWritten(hvaPath);
+
+        if (hvaPath == "INVALID_PATH")
+            HV_LOG_WARN("CAssetRegistry::ImportAsset: The chosen source data refers to an asset type doesn't have import logic implemented. Could not create asset at %s for %s!", destinationPath.c_str(), filePath.c_str());
+
+        SAssetReference ref(hvaPath);
+        if (!AssetDatabase.contains(ref.UID))
+            AssetDatabase.emplace(ref.UID, hvaPath);
+        
+        return hvaPath;
+    }
+
+    SAssetFileHeader CAssetRegistry::ReadSourceAsset(const std::string& filePath, const SSourceAssetData& sourceData, const SStaticMeshLODImportSettings& lodSettings)
+    {
         switch (sourceData.AssetType)
         {
         case EAssetType::StaticMesh: // fallthrough
         case EAssetType::SkeletalMesh: // fallthrough
         case EAssetType::Animation:
         {
-            hvaPath = SaveAsset(destinationPath, UModelImporter::ImportFBX(filePath, sourceData));
+            return UModelImporter::ImportFBX(filePath, sourceData, lodSettings);
         }
-        break;
         case EAssetType::Texture:
         {
             std::string textureFileData;
@@ -429,9 +1051,8 @@ namespace Havtorn
 
             // TODO.NW: Make sure file header gets source data set, in ModelImport as well
 
-            hvaPath = SaveAsset(destinationPath, fileHeader);
+            return fileHeader;
         }
-        break;
         case EAssetType::TextureCube:
         {
             std::string textureFileData;
@@ -453,142 +1074,396 @@ namespace Havtorn
 
             // TODO.NW: Make sure file header gets source data set, in ModelImport as well
 
-            hvaPath = SaveAsset(destinationPath, fileHeader);
+            return fileHeader;
         }
-        break;
         case EAssetType::AudioOneShot:
             break;
         case EAssetType::AudioCollection:
             break;
         }
 
-        if (hvaPath == "INVALID_PATH")
-            HV_LOG_WARN("CAssetRegistry::ImportAsset: The chosen source data refers to an asset type doesn't have import logic implemented. Could not create asset at %s for %s!", destinationPath.c_str(), filePath.c_str());
+        return std::monostate();
+    }
 
-        SAssetReference ref(hvaPath);
-        if (!AssetDatabase.contains(ref.UID))
-            AssetDatabase.emplace(ref.UID, hvaPath);
-        
+    std::string CAssetRegistry::SaveAsset(const std::string& destinationPath, const SAssetFileHeader& fileHeader)
+    {
+        std::string hvaPath = "INVALID_PATH";
+        if (!WriteAssetFile(destinationPath, fileHeader, hvaPath))
+            return hvaPath;
+
+        OnAssetWritten(hvaPath);
         return hvaPath;
     }
 
-    std::string CAssetRegistry::SaveAsset(const std::string& destinationPath, const SAssetFileHeader& fileHeader)
+    bool CAssetRegistry::ImportSourceAsset(const SAssetImportRequest& request, std::string& outHvaPath)
     {
-        // TODO.NW: See if we can make char stream we can then convert to data buffer,
-        // so as to not repeat the logic for every case
+        // Only models and animations go through the cache, textures are stored as they are so importing one is a copy either way
+        const bool isCached = request.SourceData.AssetType == EAssetType::StaticMesh || request.SourceData.AssetType == EAssetType::SkeletalMesh || request.SourceData.AssetType == EAssetType::Animation;
+        const U64 key = isCached ? CDerivedDataCache::GetKey(request.FilePath, request.SourceData, request.LODSettings, ShouldCompressPayloads, IsQuantizedOnImport(request.SourceData.AssetType)) : 0;
+        if (key != 0)
+        {
+            // The importer names models and animations after their source file
+            const std::string hvaPath = request.DestinationPath + UGeneralUtils::ExtractFileBaseNameFromPath(request.SourceData.SourcePath.AsString()) + ".hva";
+            if (DerivedDataCache.Fetch(key, hvaPath))
+            {
+                outHvaPath = hvaPath;
+                return true;
+            }
+        }
+
+        std::vector<char> data;
+        if (!SerializeAssetFile(request.DestinationPath, ReadSourceAsset(request.FilePath, request.SourceData, request.LODSettings), data, outHvaPath))
+            return false;
 
+        if (!UFileSystem::SerializeAtomic(outHvaPath, data.data(), data.size()))
+            return false;
+
+        if (key != 0)
+            DerivedDataCache.Store(key, data.data(), data.size());
+
+        return true;
+    }
+
+    void CAssetRegistry::AddDestinationDirectories(const std::string& destinationPath)
+    {
         std::vector<std::string> paths = UFileSystem::SplitPath(destinationPath);
         for (std::string& path : paths)
         {
             if (!UFileSystem::Exists(path))
                 UFileSystem::AddDirectory(path);
         }
+    }
+
+    bool CAssetRegistry::WriteAssetFile(const std::string& destinationPath, const SAssetFileHeader& fileHeader, std::string& outHvaPath) const
+    {
+        AddDestinationDirectories(destinationPath);
+
+        std::vector<char> data;
+        if (!SerializeAssetFile(destinationPath, fileHeader, data, outHvaPath))
+            return false;
+
+        return UFileSystem::SerializeAtomic(outHvaPath, data.data(), data.size());
+    }
+
+    bool CAssetRegistry::SerializeAssetFile(const std::string& destinationPath, const SAssetFileHeader& fileHeader, std::vector<char>& outData, std::string& outHvaPath) const
+    {
+        // TODO.NW: See if we can make char stream we can then convert to data buffer,
+        // so as to not repeat the logic for every case
 
         std::string hvaPath = "INVALID_PATH";
         if (std::holds_alternative<SStaticModelFileHeader>(fileHeader))
         {
             SStaticModelFileHeader header = std::get<SStaticModelFileHeader>(fileHeader);
-            U32 size = header.GetSize();
-            const auto data = new char[size];
-            header.Serialize(data);
+            if (ShouldQuantizeVertices)
+                header.QuantizeVertices();
+            if (ShouldCompressPayloads)
+                header.CompressPayloads();
+            outData.resize(header.GetSize());
+            header.Serialize(outData.data());
             hvaPath = destinationPath + header.Name + ".hva";
-            UFileSystem::Serialize(hvaPath, &data[0], size);
-            delete[] data;
         }
         else if (std::holds_alternative<SSkeletalModelFileHeader>(fileHeader))
         {
             SSkeletalModelFileHeader header = std::get<SSkeletalModelFileHeader>(fileHeader);
-            U32 size = header.GetSize();
-            const auto data = new char[size];
-            header.Serialize(data);
+            if (ShouldQuantizeVertices)
+                header.QuantizeVertices();
+            if (ShouldCompressPayloads)
+                header.CompressPayloads();
+            outData.resize(header.GetSize());
+            header.Serialize(outData.data());
             hvaPath = destinationPath + header.Name + ".hva";
-            UFileSystem::Serialize(hvaPath, &data[0], size);
-            delete[] data;
         }
         else if (std::holds_alternative<SSkeletalAnimationFileHeader>(fileHeader))
         {
             SSkeletalAnimationFileHeader header = std::get<SSkeletalAnimationFileHeader>(fileHeader);
-            U32 size = header.GetSize();
-            const auto data = new char[size];
-            header.Serialize(data);
+            if (ShouldCompressAnimationKeys)
+                header.CompressTracks();
+            if (ShouldCompressPayloads)
+                header.CompressPayloads();
+            outData.resize(header.GetSize());
+            header.Serialize(outData.data());
             hvaPath = destinationPath + header.Name + ".hva";
-            UFileSystem::Serialize(hvaPath, &data[0], size);
-            delete[] data;
         }
         else if (std::holds_alternative<STextureFileHeader>(fileHeader))
         {
             STextureFileHeader header = std::get<STextureFileHeader>(fileHeader);
-            U32 size = header.GetSize();
-            const auto data = new char[size];
-            header.Serialize(data);
+            if (ShouldCompressPayloads)
+                header.CompressPayloads();
+            outData.resize(header.GetSize());
+            header.Serialize(outData.data());
             hvaPath = destinationPath + header.Name + ".hva";
-            UFileSystem::Serialize(hvaPath, &data[0], size);
-            delete[] data;
         }
         else if (std::holds_alternative<STextureCubeFileHeader>(fileHeader))
         {
             STextureCubeFileHeader header = std::get<STextureCubeFileHeader>(fileHeader);
-            U32 size = header.GetSize();
-            const auto data = new char[size];
-            header.Serialize(data);
+            if (ShouldCompressPayloads)
+                header.CompressPayloads();
+            outData.resize(header.GetSize());
+            header.Serialize(outData.data());
             hvaPath = destinationPath + header.Name + ".hva";
-            UFileSystem::Serialize(hvaPath, &data[0], size);
-            delete[] data;
         }
         else if (std::holds_alternative<SMaterialAssetFileHeader>(fileHeader))
         {
             SMaterialAssetFileHeader header = std::get<SMaterialAssetFileHeader>(fileHeader);
-            U32 size = header.GetSize();
-            const auto data = new char[size];
-            header.Serialize(data);
+            outData.resize(header.GetSize());
+            header.Serialize(outData.data());
             hvaPath = destinationPath + header.Name + ".hva";
-            UFileSystem::Serialize(hvaPath, &data[0], size);
-            delete[] data;
         }
         else if (std::holds_alternative<SScriptFileHeader>(fileHeader))
         {
             SScriptFileHeader header = std::get<SScriptFileHeader>(fileHeader);
-            U32 size = header.GetSize();
-            const auto data = new char[size];
-            header.Serialize(data);
+            outData.resize(header.GetSize());
+            header.Serialize(outData.data());
             hvaPath = destinationPath + header.Name + ".hva";
-            UFileSystem::Serialize(hvaPath, &data[0], size);
-            delete[] data;
         }
         else if (std::holds_alternative<SSceneFileHeader>(fileHeader))
         {
             SSceneFileHeader header = std::get<SSceneFileHeader>(fileHeader);
-            U32 size = header.GetSize();
-            const auto data = new char[size];
+            outData.resize(header.GetSize());
             U64 pointerPosition = 0;
-            header.Serialize(data, pointerPosition);
+            header.Serialize(outData.data(), pointerPosition);
             hvaPath = destinationPath + header.Scene->GetSceneName() + ".hva";
-            UFileSystem::Serialize(hvaPath, &data[0], size);
-            delete[] data;
         }
 
         if (hvaPath == "INVALID_PATH")
             HV_LOG_WARN("CAssetRegistry::SaveAsset: The chosen file header had no serialization implemented. Could not create asset at %s!", destinationPath.c_str());
 
-        return hvaPath;
+        outHvaPath = hvaPath;
+        return hvaPath != "INVALID_PATH";
     }
 
-    void CAssetRegistry::RefreshDatabase()
+    void CAssetRegistry::OnAssetWritten(const std::string& hvaPath)
     {
-        AssetDatabase.clear();
+        AssetIndex.UpdateEntry(hvaPath);
+
+        // The soft cache would hand out what was just overwritten the next time the asset is requested
+        if (const U32 savedUID = SAssetReference(hvaPath).UID; SoftCacheEntries.contains(savedUID))
+        {
+            RemoveAsset(savedUID);
+            NumberOfEvictions++;
+        }
+    }
+
+    SAssetBatchImportHandle CAssetRegistry::ImportAssetsAsync(const std::vector<SAssetImportRequest>& requests)
+    {
+        auto batch = std::make_shared<SAssetBatchImportState>();
 
-        std::vector<std::string> topLevelDirectories = { "Resources/", "Assets/"};
-        for (const std::string& directory : topLevelDirectories)
+        // Keyed on the .hva file a request writes, the name the importers give an asset is the base name of its source.
+        // Two jobs writing the same file would race on it, and the second import would only repeat the first.
+        std::map<std::string, const SAssetImportRequest*> requestsByOutput;
+        for (const SAssetImportRequest& request : requests)
         {
-            for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+            const std::string outputPath = UGeneralUtils::ConvertToPlatformAgnosticPath(request.DestinationPath + UGeneralUtils::ExtractFileBaseNameFromPath(request.FilePath) + ".hva");
+            auto [it, wasInserted] = requestsByOutput.emplace(outputPath, &request);
+            if (wasInserted)
             {
-                std::string path = UGeneralUtils::ConvertToPlatformAgnosticPath(entry.path().string());
-                if (!entry.is_directory() && UGeneralUtils::ExtractFileExtensionFromPath(path) == "hva")
+                batch->Requests.push_back(request);
+                continue;
+            }
+
+            if (UGeneralUtils::ConvertToPlatformAgnosticPath(it->second->FilePath) != UGeneralUtils::ConvertToPlatformAgnosticPath(request.FilePath))
+                HV_LOG_WARN("CAssetRegistry::ImportAssetsAsync: %s and %s would both be imported to %s, only the first is imported.", it->second->FilePath.c_str(), request.FilePath.c_str(), outputPath.c_str());
+        }
+
+        if (batch->Requests.size() < requests.size())
+            HV_LOG_INFO("CAssetRegistry::ImportAssetsAsync: Importing %u assets, %u duplicate requests were skipped.", STATIC_U32(batch->Requests.size()), STATIC_U32(requests.size() - batch->Requests.size()));
+
+        // Created here on the calling thread, the import jobs would race each other creating the same directories
+        std::set<std::string> destinationPaths;
+        for (const SAssetImportRequest& request : batch->Requests)
+            destinationPaths.insert(request.DestinationPath);
+        for (const std::string& destinationPath : destinationPaths)
+            AddDestinationDirectories(destinationPath);
+
+        CThreadManager* threadManager = GEngine::GetThreadManager();
+        if (threadManager == nullptr)
+        {
+            RunImportBatch(*batch, nullptr);
+            for (const std::string& hvaPath : batch->ImportedPaths)
+            {
+                OnAssetWritten(hvaPath);
+                AssetDatabase.emplace(SAssetReference(hvaPath).UID, hvaPath);
+            }
+            batch->IsDone.store(true);
+            return { batch };
+        }
+
+        // One job fans the batch out, so the calling thread doesn't wait for it
+        threadManager->PushJob([this, batch, threadManager]()
+            {
+                RunImportBatch(*batch, threadManager);
+
+                std::unique_lock lock(FinishedImportsMutex);
+                FinishedImports.push_back(batch);
+            });
+
+        return { batch };
+    }
+
+    void CAssetRegistry::RunImportBatch(SAssetBatchImportState& batch, CThreadManager* threadManager)
+    {
+        const U32 numberOfRequests = STATIC_U32(batch.Requests.size());
+        std::vector<std::string> hvaPaths(numberOfRequests);
+
+        auto importRequest = [&](const U32 requestIndex)
+            {
+                if (!batch.IsCancelled.load())
                 {
-                    AssetDatabase.emplace(SAssetReference(path).UID, path);
+                    const SAssetImportRequest& request = batch.Requests[requestIndex];
+                    if (!ImportSourceAsset(request, hvaPaths[requestIndex]))
+                    {
+                        HV_LOG_WARN("CAssetRegistry::RunImportBatch: Could not import %s to %s.", request.FilePath.c_str(), request.DestinationPath.c_str());
+                        hvaPaths[requestIndex].clear();
+                        batch.NumberOfFailed++;
+                    }
                 }
-            }
+
+                batch.NumberOfFinished++;
+            };
+
+        if (threadManager != nullptr)
+        {
+            threadManager->ParallelFor(numberOfRequests, importRequest);
+        }
+        else
+        {
+            for (U32 requestIndex = 0; requestIndex < numberOfRequests; requestIndex++)
+                importRequest(requestIndex);
+        }
+
+        // Failed and skipped requests leave their path empty
+        for (std::string& hvaPath : hvaPaths)
+        {
+            if (!hvaPath.empty())
+                batch.ImportedPaths.push_back(std::move(hvaPath));
+        }
+    }
+
+    std::string CAssetRegistry::WarmDerivedDataCache(const std::string& directory)
+    {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+
+        const std::string root = UGeneralUtils::ConvertToPlatformAgnosticPath(directory);
+        std::vector<std::string> assetPaths;
+        for (const auto& [assetUID, entry] : AssetIndex.GetEntries())
+        {
+            const bool isCached = entry.Type == EAssetType::StaticMesh || entry.Type == EAssetType::SkeletalMesh || entry.Type == EAssetType::Animation;
+            if (isCached && entry.FilePath.starts_with(root))
+                assetPaths.push_back(entry.FilePath);
+        }
+
+        std::atomic<U32> numberOfImported = 0;
+        std::atomic<U32> numberOfCached = 0;
+        std::atomic<U32> numberOfFailed = 0;
+        auto warmAsset = [&](const U32 assetIndex)
+            {
+                // The source data and LOD settings the asset was imported with are only stored in the asset itself
+                const SAssetReference assetRef(assetPaths[assetIndex]);
+                SAsset asset;
+                SAssetFileHeader fileHeader;
+                SAssetFileData fileData;
+                if (!ReadAsset(assetRef, asset, fileHeader, fileData) || !asset.SourceData.IsValid())
+                {
+                    numberOfFailed++;
+                    return;
+                }
+
+                const std::string sourcePath = asset.SourceData.SourcePath.AsString();
+                const SStaticMeshLODImportSettings lodSettings = GetLODImportSettings(&asset);
+                const U64 key = CDerivedDataCache::GetKey(sourcePath, asset.SourceData, lodSettings, ShouldCompressPayloads, IsQuantizedOnImport(asset.SourceData.AssetType));
+                if (key == 0)
+                {
+                    HV_LOG_WARN("CAssetRegistry::WarmDerivedDataCache: The source of %s, %s, could not be read.", assetRef.FilePath.c_str(), sourcePath.c_str());
+                    numberOfFailed++;
+                    return;
+                }
+
+                if (DerivedDataCache.Contains(key))
+                {
+                    numberOfCached++;
+                    return;
+                }
+
+                std::vector<char> data;
+                std::string hvaPath;
+                if (!SerializeAssetFile(UGeneralUtils::ExtractParentDirectoryFromPath(assetRef.FilePath), ReadSourceAsset(sourcePath, asset.SourceData, lodSettings), data, hvaPath))
+                {
+                    numberOfFailed++;
+                    return;
+                }
+
+                DerivedDataCache.Store(key, data.data(), data.size());
+                numberOfImported++;
+            };
+
+        CThreadManager* threadManager = GEngine::GetThreadManager();
+        if (threadManager != nullptr)
+        {
+            threadManager->ParallelFor(STATIC_U32(assetPaths.size()), warmAsset);
+        }
+        else
+        {
+            for (U32 assetIndex = 0; assetIndex < STATIC_U32(assetPaths.size()); assetIndex++)
+                warmAsset(assetIndex);
+        }
+
+        const F32 milliseconds = std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+        const std::string result = std::format("Derived Data Cache Warm | {} assets under {} | {} imported, {} already cached, {} failed | {:.2f} ms",
+            assetPaths.size(), root, numberOfImported.load(), numberOfCached.load(), numberOfFailed.load(), milliseconds);
+        HV_LOG_INFO("%s", result.c_str());
+        return result;
+    }
+
+    void CAssetRegistry::RefreshDatabase()
+    {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+
+        AssetDatabase.clear();
+
+        for (const CAssetArchive& archive : MountedArchives)
+        {
+            for (const SAssetArchiveEntry& entry : archive.GetEntries())
+                AssetDatabase.emplace(entry.AssetUID, archive.GetEntryPath(entry));
+        }
+
+        const U32 numberOfListedDirectories = AssetIndex.Refresh({ "Resources/", "Assets/" });
+        for (const auto& [assetUID, entry] : AssetIndex.GetEntries())
+            AssetDatabase.emplace(assetUID, entry.FilePath);
+
+        if (AssetIndex.IsDirty())
+            AssetIndex.Save(AssetIndexPath);
+
+        HV_LOG_INFO("CAssetRegistry::RefreshDatabase: %u database entries in %.2f ms, %u of %u directories had changed.", STATIC_U32(AssetDatabase.size()),
+            std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count(), numberOfListedDirectories, STATIC_U32(AssetIndex.GetNumberOfDirectories()));
+    }
+
+    void CAssetRegistry::AddAssetRedirector(const std::string& fromPath, const std::string& toPath)
+    {
+        {
+            std::unique_lock lock(AssetRedirectorMutex);
+            AssetRedirectors[UGeneralUtils::ConvertToPlatformAgnosticPath(fromPath)] = UGeneralUtils::ConvertToPlatformAgnosticPath(toPath);
         }
+
+        CJsonDocument config = UFileSystem::OpenJson(UFileSystem::EngineConfig);
+        config.WriteValueToArray("Asset Redirectors", fromPath, toPath);
+    }
+
+    std::string CAssetRegistry::GetAssetRedirector(const std::string& fromPath) const
+    {
+        std::shared_lock lock(AssetRedirectorMutex);
+        auto it = AssetRedirectors.find(fromPath);
+        return it != AssetRedirectors.end() ? it->second : "";
+    }
+
+    void CAssetRegistry::ClearAssetRedirectors()
+    {
+        {
+            std::unique_lock lock(AssetRedirectorMutex);
+            AssetRedirectors.clear();
+        }
+
+        CJsonDocument config = UFileSystem::OpenJson(UFileSystem::EngineConfig);
+        config.ClearArray("Asset Redirectors");
     }
 
     void CAssetRegistry::FixUpAssetRedirectors()
@@ -603,12 +1478,10 @@ namespace Havtorn
             SAssetReference assetRef = SAssetReference(entry.path().string());
             if (!UFileSystem::Exists(assetRef.FilePath))
             {
-                CJsonDocument config = UFileSystem::OpenJson(UFileSystem::EngineConfig);
-                std::string redirection = config.GetValueFromArray("Asset Redirectors", assetRef.FilePath, "");
-
+                std::string redirection = GetAssetRedirector(assetRef.FilePath);
                 while (!UFileSystem::Exists(redirection) && redirection != "")
                 {
-                    redirection = config.GetValueFromArray("Asset Redirectors", redirection, "");
+                    redirection = GetAssetRedirector(redirection);
                 }
 
                 if (redirection == "")
@@ -633,12 +1506,10 @@ namespace Havtorn
 
             if (!UFileSystem::Exists(dependencyPath))
             {
-                CJsonDocument config = UFileSystem::OpenJson(UFileSystem::EngineConfig);
-                std::string redirection = config.GetValueFromArray("Asset Redirectors", dependencyPath, "");
-
+                std::string redirection = GetAssetRedirector(dependencyPath);
                 while (!UFileSystem::Exists(redirection) && redirection != "")
                 {
-                    redirection = config.GetValueFromArray("Asset Redirectors", redirection, "");
+                    redirection = GetAssetRedirector(redirection);
                 }
 
                 if (redirection == "")
@@ -649,13 +1520,12 @@ namespace Havtorn
 
             HV_LOG_INFO("CAssetRegistry::FixUpAssetRedirectors: Asset file %s changed Asset Dependency Path from %s to %s.", assetRef.FilePath.c_str(), asset->SourceData.AssetDependencyPath.AsString().c_str(), dependencyPath.c_str());
             asset->SourceData.AssetDependencyPath = dependencyPath;
-            ImportAsset(asset->SourceData.SourcePath.AsString(), UGeneralUtils::ExtractParentDirectoryFromPath(asset->Reference.FilePath), asset->SourceData);
+            ImportAsset(asset->SourceData.SourcePath.AsString(), UGeneralUtils::ExtractParentDirectoryFromPath(asset->Reference.FilePath), asset->SourceData, GetLODImportSettings(asset));
 
             UnrequestAsset(assetRef, AssetRegistryRequestID);
         }
 
-        CJsonDocument config = UFileSystem::OpenJson(UFileSystem::EngineConfig);
-        config.ClearArray("Asset Redirectors");
+        ClearAssetRedirectors();
     }
 
     std::set<U64> CAssetRegistry::GetReferencers(const SAssetReference& assetRef)
@@ -732,7 +1602,7 @@ namespace Havtorn
         }
 
         SAsset* asset = WatchedAssets[sourceFilePath];
-        ImportAsset(asset->SourceData.SourcePath.AsString(), UGeneralUtils::ExtractParentDirectoryFromPath(asset->Reference.FilePath), asset->SourceData);
+        ImportAsset(asset->SourceData.SourcePath.AsString(), UGeneralUtils::ExtractParentDirectoryFromPath(asset->Reference.FilePath), asset->SourceData, GetLODImportSettings(asset));
 
         if (LoadAsset(asset->Reference))
             HV_LOG_INFO("CAssetRegistry::OnSourceFileChanged: Asset file %s was reimported after source change in %s.", asset->Reference.FilePath.c_str(), sourceFilePath.c_str());
@@ -746,10 +1616,38 @@ namespace Havtorn
     {
         std::shared_lock lock(RegistryMutex);
 
-        std::string debugString = "Asset Registry | Loaded Assets: " + std::to_string(LoadedAssets.size()) + " | Database Entries: " + std::to_string(AssetDatabase.size()) + " |";
+        std::string debugString = "Asset Registry | Loaded Assets: " + std::to_string(LoadedAssets.size()) + " | Pending Loads: " + std::to_string(PendingLoads.size()) + " | Database Entries: " + std::to_string(AssetDatabase.size()) + " | Mounted Archives: " + std::to_string(MountedArchives.size()) + " |";
+
+        auto toMB = [](const U64 bytes) { return STATIC_F32(bytes) / (1024.0f * 1024.0f); };
+        U64 residentMemory = 0;
+        U64 residentMeshMemory = 0;
+        for (const auto& [type, memory] : ResidentMemory)
+        {
+            if (IsEvictable(type))
+                residentMemory += memory;
+            else
+                residentMeshMemory += memory;
+        }
+
+        const U64 numberOfRequests = NumberOfCacheHits + NumberOfLoads;
+        debugString.append(std::format("\nResident: {:.2f} MB | Mesh Buffers: {:.2f} MB, not evictable | Soft Cache: {} assets, {:.2f} / {:.2f} MB | Cache Hit Rate: {:.1f}% | Evictions: {} |",
+            toMB(residentMemory), toMB(residentMeshMemory), SoftCache.size(), toMB(SoftCacheMemory), toMB(SoftCacheBudget), numberOfRequests > 0 ? 100.0f * STATIC_F32(NumberOfCacheHits) / STATIC_F32(numberOfRequests) : 0.0f, NumberOfEvictions));
+        debugString.append("\n" + DerivedDataCache.GetDebugString() + " |");
         
         if (shouldExpand)
         {
+            for (const auto& [type, memory] : ResidentMemory)
+            {
+                if (memory == 0 && !MemoryBudgets.contains(type))
+                    continue;
+
+                debugString.append(std::format("\n{}: {:.2f} MB", magic_enum::enum_name<EAssetType>(type), toMB(memory)));
+                if (auto it = MemoryBudgets.find(type); it != MemoryBudgets.end())
+                    debugString.append(std::format(" / {:.2f} MB", toMB(it->second)));
+                else if (!IsEvictable(type))
+                    debugString.append(" in vertex and index buffers, not evictable");
+            }
+
             for (auto const& [uid, asset] : LoadedAssets)
             {
                 debugString.append("\n");
@@ -760,6 +1658,7 @@ namespace Havtorn
                     debugString.append(std::to_string(*asset.Requesters.begin()));
                     debugString.append("\t");
                 }
+                debugString.append(std::format("{:.2f} MB\t", toMB(asset.MemorySize)));
                 debugString.append(asset.Reference.FilePath);
             }
         }
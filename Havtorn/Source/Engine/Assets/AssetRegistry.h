@@ -2,9 +2,14 @@
 
 #pragma once
 
+#include "Assets/AssetArchive.h"
+#include "Assets/AssetIndex.h"
+#include "Assets/DerivedDataCache.h"
 #include "Assets/FileHeaderDeclarations.h"
 #include "Assets/RuntimeAssetDeclarations.h"
 
+#include <atomic>
+#include <list>
 #include <map>
 #include <shared_mutex>
 
@@ -13,6 +18,72 @@ namespace Havtorn
 {
 	class CGraphicsFramework;
 	class CRenderManager;
+	class CThreadManager;
+
+	enum class EAssetLoadPriority : U8
+	{
+		Low,
+		Normal,
+		High
+	};
+
+	enum class EAssetLoadState : U8
+	{
+		None,
+		Queued,
+		Reading,
+		AwaitingFinalize,
+		Loaded,
+		Failed
+	};
+
+	// Returned by async requests, can be polled every frame until the asset is ready
+	struct SAssetLoadHandle
+	{
+		U32 AssetUID = 0;
+		std::shared_ptr<const std::atomic<EAssetLoadState>> State = nullptr;
+
+		[[nodiscard]] EAssetLoadState GetState() const { return State != nullptr ? State->load() : EAssetLoadState::None; }
+		[[nodiscard]] bool IsReady() const { return GetState() == EAssetLoadState::Loaded; }
+		[[nodiscard]] bool HasFailed() const { return GetState() == EAssetLoadState::Failed; }
+	};
+
+	struct SAssetImportRequest
+	{
+		std::string FilePath = "";
+		std::string DestinationPath = "";
+		SSourceAssetData SourceData;
+		SStaticMeshLODImportSettings LODSettings = {};
+	};
+
+	// Shared between the import jobs and the handle, see CAssetRegistry::ImportAssetsAsync
+	struct SAssetBatchImportState
+	{
+		std::vector<SAssetImportRequest> Requests;
+		std::atomic<U32> NumberOfFinished = 0;
+		std::atomic<U32> NumberOfFailed = 0;
+		std::atomic<bool> IsCancelled = false;
+		std::atomic<bool> IsDone = false;
+		// Written once the jobs are done, only read it after IsDone
+		std::vector<std::string> ImportedPaths;
+	};
+
+	// Returned by batch imports, can be polled every frame for progress until the batch is done
+	struct SAssetBatchImportHandle
+	{
+		std::shared_ptr<SAssetBatchImportState> State = nullptr;
+
+		[[nodiscard]] U32 GetNumberOfRequests() const { return State != nullptr ? STATIC_U32(State->Requests.size()) : 0; }
+		[[nodiscard]] U32 GetNumberOfFinished() const { return State != nullptr ? State->NumberOfFinished.load() : 0; }
+		[[nodiscard]] U32 GetNumberOfFailed() const { return State != nullptr ? State->NumberOfFailed.load() : 0; }
+		[[nodiscard]] F32 GetProgress() const { return GetNumberOfRequests() > 0 ? STATIC_F32(GetNumberOfFinished()) / STATIC_F32(GetNumberOfRequests()) : 1.0f; }
+		[[nodiscard]] bool IsDone() const { return State == nullptr || State->IsDone.load(); }
+		// The .hva files written by the batch, empty until it is done
+		[[nodiscard]] std::vector<std::string> GetImportedPaths() const { return IsDone() && State != nullptr ? State->ImportedPaths : std::vector<std::string>(); }
+
+		// Requests that haven't started yet are skipped, the ones already importing still finish
+		void Cancel() const { if (State != nullptr) State->IsCancelled.store(true); }
+	};
 
 	class CAssetRegistry
 	{
@@ -21,13 +92,38 @@ namespace Havtorn
 		static constexpr U64 RenderManagerRequestID = 200;
 		static constexpr U64 EditorManagerRequestID = 300;
 
+		static constexpr U32 MaxAsyncLoadsInFlight = 4;
+		static constexpr F32 AsyncFinalizeBudgetMilliseconds = 2.0f;
+		// Fewer chunks than this are decompressed on the loading thread, splitting them up costs more than it saves
+		static constexpr U32 MinChunksToDecompressInParallel = 4;
+		// Used when the engine config has no "Asset Soft Cache Budget MB"
+		static constexpr U32 DefaultSoftCacheBudgetMB = 256;
+
+		// Game builds mount every .hvpak in here on init
+		ENGINE_API static const std::string ArchiveDirectory;
+		ENGINE_API static const std::string AssetIndexPath;
+
 		CMulticastDelegate<const std::string&> OnAssetReloaded;
 
-		CAssetRegistry();
-		~CAssetRegistry();
+		// Saves mesh, animation and texture blobs compressed. Read from the engine config, off by default
+		// since compressed meshes can't be used in place from the file.
+		bool ShouldCompressPayloads = false;
+		// Saves mesh vertices in the compact layout, see UVertexQuantization. Read from the engine config, off by default
+		// since the meshes are decoded when loaded and can't be used in place from the file either.
+		bool ShouldQuantizeVertices = false;
+		// Reduces animation keys and saves them in the compact layout, see UAnimationCompression. Read from the engine config,
+		// off by default since dropped keys are gone from the asset for good.
+		bool ShouldCompressAnimationKeys = false;
+
+		ENGINE_API CAssetRegistry();
+		ENGINE_API ~CAssetRegistry();
 
 		bool Init(CRenderManager* renderManager);
 
+		// Assets in mounted archives are found before loose files, earlier mounts before later ones.
+		// Mount before requesting assets, the archive list isn't guarded against the load jobs.
+		ENGINE_API bool MountArchive(const std::string& archivePath);
+
 		template<typename T>
 		T* RequestAssetData(const SAssetReference& assetRef, const U64 requesterID);
 
@@ -43,6 +139,14 @@ namespace Havtorn
 		template<typename T>
 		std::vector<T*> RequestAssetData(const std::vector<U32>& assetUIDs, const U64 requesterID);
 
+		// Returns nullptr until the asset has finished loading in the background
+		template<typename T>
+		T* RequestAssetDataAsync(const SAssetReference& assetRef, const EAssetLoadPriority priority, const U64 requesterID);
+
+		// Like RequestAssetDataAsync, and marks the mesh as an occluder so its coarsest LOD is kept on the CPU once loaded.
+		// A mesh that was already loaded before it was marked reads it from its file, blocking, the first time it is requested.
+		ENGINE_API const SStaticMeshAsset* RequestOccluderAssetDataAsync(const SAssetReference& assetRef, const EAssetLoadPriority priority, const U64 requesterID);
+
 		ENGINE_API SAsset* RequestAsset(const SAssetReference& assetRef, const U64 requesterID);
 		ENGINE_API void UnrequestAsset(const SAssetReference& assetRef, const U64 requesterID);
 
@@ -52,15 +156,55 @@ namespace Havtorn
 		ENGINE_API std::vector<SAsset*> RequestAssets(const std::vector<SAssetReference>& assetRefs, const U64 requesterID);
 		ENGINE_API void UnrequestAssets(const std::vector<SAssetReference>& assetRefs, const U64 requesterID);
 
+		// Assets nobody requests anymore stay loaded in a soft cache, so requesting them again is free. The least recently
+		// released ones are evicted once the cache is over its budget, or once their type is over its budget. Requested assets
+		// count towards the type budgets but are never evicted. Neither are meshes, whose GPU buffers can't be released yet, so
+		// mesh budgets are rejected and mesh residency is reported on its own. Budgets are read from the engine config on init,
+		// "Asset Soft Cache Budget MB" and "<Asset Type> Memory Budget MB", e.g. "Texture Memory Budget MB". 0 means no budget.
+		ENGINE_API void SetMemoryBudget(const EAssetType type, const U64 budgetBytes);
+		ENGINE_API void SetSoftCacheBudget(const U64 budgetBytes);
+		// Drops every asset in the soft cache but meshes
+		ENGINE_API void EvictSoftCache();
+
+		// File reads and deserialization run on the job threads, GPU resources are created in UpdateAsyncLoads.
+		// Requesting an asset that is already loaded registers the requester right away and returns a ready handle.
+		ENGINE_API SAssetLoadHandle RequestAssetAsync(const SAssetReference& assetRef, const EAssetLoadPriority priority, const U64 requesterID);
+		ENGINE_API SAssetLoadHandle RequestAssetAsync(const U32 assetUID, const EAssetLoadPriority priority, const U64 requesterID);
+
+		// Called once per frame on the main thread. Starts queued loads and finalizes finished ones, highest priority first,
+		// until AsyncFinalizeBudgetMilliseconds is used up. At least one load is finalized per frame.
+		// Also enforces the memory budgets and adds finished batch imports to the database.
+		ENGINE_API void UpdateAsyncLoads();
+
 		ENGINE_API std::string GetAssetDatabaseEntry(const U32 uid);
 
 		// TODO.NW: If we extend our own filePath struct, could be nice to separate full paths from folders
-		ENGINE_API std::string ImportAsset(const std::string& filePath, const std::string& destinationPath, const SSourceAssetData& sourceData);
+		ENGINE_API std::string ImportAsset(const std::string& filePath, const std::string& destinationPath, const SSourceAssetData& sourceData, const SStaticMeshLODImportSettings& lodSettings = {});
 		ENGINE_API std::string SaveAsset(const std::string& destinationPath, const SAssetFileHeader& fileHeader);
 
+		// Source files are read, converted and written on the job threads, one request per job. Requests that would write
+		// the same .hva file are only imported once. Files are written next to their destination and renamed into place, so an
+		// asset is never left half written, even when the batch is cancelled. The database is updated in UpdateAsyncLoads,
+		// the handle is done once that has happened.
+		ENGINE_API SAssetBatchImportHandle ImportAssetsAsync(const std::vector<SAssetImportRequest>& requests);
+		// Imports every request of the batch on the calling thread, fanned out over the job threads of threadManager if there is
+		// one. Skips what's left once cancelled. The destination directories have to exist, and neither the database nor the index
+		// is touched, ImportAssetsAsync takes care of both.
+		ENGINE_API void RunImportBatch(SAssetBatchImportState& batch, CThreadManager* threadManager);
+
+		// Imports the source of every mesh and animation under directory into the derived data cache, without touching the
+		// assets themselves. Run by the launcher with -WarmDerivedDataCache=<directory>, e.g. after syncing a new art drop.
+		ENGINE_API std::string WarmDerivedDataCache(const std::string& directory);
+
+		// Brings the persistent asset index up to date, which only lists directories that changed since it was saved
 		ENGINE_API void RefreshDatabase();
 		ENGINE_API void FixUpAssetRedirectors();
 
+		// Redirectors are read from the engine config once on init and kept in memory, these keep both in sync
+		ENGINE_API void AddAssetRedirector(const std::string& fromPath, const std::string& toPath);
+		ENGINE_API std::string GetAssetRedirector(const std::string& fromPath) const;
+		ENGINE_API void ClearAssetRedirectors();
+
 		ENGINE_API std::set<U64> GetReferencers(const SAssetReference& assetRef);
 
 		ENGINE_API void StartSourceFileWatch(const SAssetReference& assetRef);
@@ -72,26 +216,129 @@ namespace Havtorn
 		// TODO.NW: Catch asset location changes! Both source and asset itself, as part of file watching? 
 		// At the very least we shouldn't crash if we try to load an asset with an invalid path
 
-		ENGINE_API void RequestDependencies(const U32 assetUID, const U64 requesterID);
+		ENGINE_API void RequestDependencies(const U32 assetUID, const U64 requesterID, const bool isAsync = false);
 		void UnrequestDependencies(const U32 assetUID, const U64 requesterID);
 
 		// Load asset synchronously
 		bool LoadAsset(const SAssetReference& assetRef);
 		bool UnloadAsset(const SAssetReference& assetRef);
 
+		// Returns false for asset types that are unloaded right away, like scripts and scenes which own their instances
+		bool CacheAsset(const U32 assetUID);
+		// Called when a loaded asset gets a requester again
+		void UncacheAsset(const U32 assetUID);
+		void EvictCachedAssets();
+
+		// The bytes of one .hva file, mapped from a loose file, pointing into a mounted archive or decompressed from one
+		struct SAssetFileData
+		{
+			CMappedFile MappedFile;
+			std::vector<char> Buffer;
+			const char* Data = nullptr;
+			U64 Size = 0;
+
+			void Release();
+		};
+
+		struct SPendingAssetLoad
+		{
+			SAssetReference Reference;
+			EAssetLoadPriority Priority = EAssetLoadPriority::Normal;
+			U64 RequestOrder = 0;
+			std::set<U64> Requesters = {};
+			std::shared_ptr<std::atomic<EAssetLoadState>> State = nullptr;
+
+			// Written by the load job, read on the main thread once the job is done
+			SAsset Asset;
+			SAssetFileHeader FileHeader;
+			SAssetFileData FileData;
+			bool WasRead = false;
+		};
+
+		static bool SortPendingLoads(const std::shared_ptr<SPendingAssetLoad>& a, const std::shared_ptr<SPendingAssetLoad>& b);
+
+		// Thread safe, touches neither the registry maps nor the GPU
+		bool ResolveAssetFilePath(const SAssetReference& assetRef, std::string& outFilePath) const;
+		bool OpenAssetFile(const SAssetReference& assetRef, SAssetFileData& outFileData) const;
+		// Spread over the job threads when there are enough of them, safe to call from a job
+		static bool DecompressChunks(const std::vector<SCompressedChunk>& chunks);
+		// Mesh file headers point into outFileData, it has to be kept alive until the asset is finalized
+		bool ReadAsset(const SAssetReference& assetRef, SAsset& outAsset, SAssetFileHeader& outFileHeader, SAssetFileData& outFileData) const;
+		// Main thread only, creates the GPU resources for what ReadAsset left in the file header
+		void FinalizeAsset(SAsset& asset, SAssetFileHeader& fileHeader);
+		void FinalizeAsyncLoad(SPendingAssetLoad& load);
+
+		// Thread safe. Reads a source file through the model importer or as texture data, monostate if it can't be imported.
+		static SAssetFileHeader ReadSourceAsset(const std::string& filePath, const SSourceAssetData& sourceData, const SStaticMeshLODImportSettings& lodSettings);
+		// Thread safe. Copies the .hva from the derived data cache if the same source was imported the same way before,
+		// imports it and adds it to the cache otherwise. Touches neither the database nor the index. The destination
+		// directory has to exist.
+		bool ImportSourceAsset(const SAssetImportRequest& request, std::string& outHvaPath);
+		// Not thread safe, creating the same directory from two threads can fail in either
+		static void AddDestinationDirectories(const std::string& destinationPath);
+		// Main thread only since it creates the destination directories, touches neither the database nor the index
+		bool WriteAssetFile(const std::string& destinationPath, const SAssetFileHeader& fileHeader, std::string& outHvaPath) const;
+		// Thread safe, what WriteAssetFile would write to outHvaPath
+		bool SerializeAssetFile(const std::string& destinationPath, const SAssetFileHeader& fileHeader, std::vector<char>& outData, std::string& outHvaPath) const;
+		// Main thread only, brings the index, database and soft cache up to date with a written .hva file
+		void OnAssetWritten(const std::string& hvaPath);
+
 		void OnSourceFileChanged(const std::string& sourceFilePath);
 		const U64 OnSourceFileChangedFunctionHandle = 100;
 
+		// Thread safe, whether ReadAsset keeps the occluder geometry of the mesh
+		bool IsOccluderAsset(const U32 assetUID) const;
+
+		// Whether imports of assetType save compact data, part of the derived data cache key
+		bool IsQuantizedOnImport(const EAssetType assetType) const;
+		// Meshes stay loaded once released, and aren't counted towards any budget
+		static bool IsEvictable(const EAssetType assetType);
+		// What the asset counts towards the soft cache budget, nothing for assets that can't be evicted
+		static U64 GetSoftCacheSize(const SAsset& asset);
+		// Reimports should generate the same LODs as the original import
+		static SStaticMeshLODImportSettings GetLODImportSettings(const SAsset* asset);
+
 		ENGINE_API inline SAsset* GetAsset(const U32 assetUID);
 		ENGINE_API inline void AddAsset(const U32 assetUID, SAsset& asset);
 		inline void RemoveAsset(const U32 assetUID);
 
 		CRenderManager* RenderManager = nullptr;
 		std::map<U32, std::string> AssetDatabase;
+		CAssetIndex AssetIndex;
+		CDerivedDataCache DerivedDataCache;
+		std::map<std::string, std::string> AssetRedirectors;
+		// Redirectors are followed on the load jobs
+		mutable std::shared_mutex AssetRedirectorMutex;
+		std::vector<CAssetArchive> MountedArchives;
 		std::map<U32, SAsset> LoadedAssets;
 
+		// Least recently released first
+		std::list<U32> SoftCache;
+		std::map<U32, std::list<U32>::iterator> SoftCacheEntries;
+		std::map<EAssetType, U64> MemoryBudgets;
+		std::map<EAssetType, U64> ResidentMemory;
+		U64 SoftCacheMemory = 0;
+		U64 SoftCacheBudget = STATIC_U64(DefaultSoftCacheBudgetMB) * 1024 * 1024;
+		U64 NumberOfCacheHits = 0;
+		U64 NumberOfLoads = 0;
+		U64 NumberOfEvictions = 0;
+
+		// Meshes requested as occluders, read on the load jobs
+		std::set<U32> OccluderAssets;
+		mutable std::mutex OccluderAssetsMutex;
+
 		std::map<std::string, SAsset*> WatchedAssets;
 		std::shared_mutex RegistryMutex;
+
+		std::map<U32, std::shared_ptr<SPendingAssetLoad>> PendingLoads;
+		std::vector<std::shared_ptr<SPendingAssetLoad>> QueuedLoads;
+		std::vector<std::shared_ptr<SPendingAssetLoad>> FinishedLoads;
+		std::mutex FinishedLoadsMutex;
+		U64 NextLoadRequestOrder = 0;
+		U32 NumberOfLoadsInFlight = 0;
+
+		std::vector<std::shared_ptr<SAssetBatchImportState>> FinishedImports;
+		std::mutex FinishedImportsMutex;
 	};
 
 	template<typename T>
@@ -204,6 +451,20 @@ namespace Havtorn
 
 		return assets;
 	}
-	
 
+	template<typename T>
+	inline T* CAssetRegistry::RequestAssetDataAsync(const SAssetReference& assetRef, const EAssetLoadPriority priority, const U64 requesterID)
+	{
+		if (!RequestAssetAsync(assetRef, priority, requesterID).IsReady())
+			return nullptr;
+
+		SAsset* asset = GetAsset(assetRef.UID);
+		if (!std::holds_alternative<T>(asset->Data))
+		{
+			HV_LOG_WARN("CAssetRegistry::RequestAssetDataAsync could not provide the requested asset data in %s", assetRef.FilePath.c_str());
+			return nullptr;
+		}
+
+		return &std::get<T>(asset->Data);
+	}
 }
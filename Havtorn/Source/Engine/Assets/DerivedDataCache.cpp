@@ -0,0 +1,240 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "DerivedDataCache.h"
+#include "Assets/FileHeaderDeclarations.h"
+#include "ModelImporter.h"
+
+#include <FileSystem.h>
+#include <GeneralUtilities.h>
+
+#include <charconv>
+#include <filesystem>
+#include <format>
+
+namespace Havtorn
+{
+	namespace
+	{
+		// 64 bit FNV-1a, same as asset UIDs but wide enough that whole source files don't collide
+		constexpr U64 HashOffsetBasis = 0xcbf29ce484222325;
+		constexpr U64 HashPrime = 0x100000001b3;
+
+		U64 HashBytes(const void* data, const U64 size, U64 hash)
+		{
+			const U8* bytes = static_cast<const U8*>(data);
+			for (U64 i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= HashPrime;
+			}
+			return hash;
+		}
+
+		template<typename T>
+		U64 HashValue(const T& value, const U64 hash)
+		{
+			return HashBytes(&value, sizeof(T), hash);
+		}
+
+		U64 HashString(const std::string& value, const U64 hash)
+		{
+			// Length first, so "ab" + "c" and "a" + "bc" don't end up the same
+			return HashBytes(value.data(), value.size(), HashValue(value.size(), hash));
+		}
+	}
+
+	const std::string CDerivedDataCache::CacheDirectory = "Cache/DerivedData/";
+
+	void CDerivedDataCache::Init(const U64 sizeBudgetBytes)
+	{
+		std::unique_lock lock(Mutex);
+		SizeBudget = sizeBudgetBytes;
+		Entries.clear();
+		UseOrder.clear();
+		Size = 0;
+
+		if (!UFileSystem::Exists(CacheDirectory))
+		{
+			UFileSystem::AddDirectory(CacheDirectory);
+			return;
+		}
+
+		struct SFoundEntry
+		{
+			U64 Key = 0;
+			U64 Size = 0;
+			std::filesystem::file_time_type LastUseTime;
+		};
+
+		std::vector<SFoundEntry> foundEntries;
+		for (const auto& entry : std::filesystem::directory_iterator(CacheDirectory))
+		{
+			if (entry.is_directory())
+				continue;
+
+			const std::string path = UGeneralUtils::ConvertToPlatformAgnosticPath(entry.path().string());
+			const std::string stem = entry.path().stem().string();
+			U64 key = 0;
+			const auto [end, error] = std::from_chars(stem.data(), stem.data() + stem.size(), key, 16);
+			if (UGeneralUtils::ExtractFileExtensionFromPath(path) != "hva" || error != std::errc() || end != stem.data() + stem.size() || key == 0)
+			{
+				// Left over from writes that never finished
+				UFileSystem::Remove(path);
+				continue;
+			}
+
+			foundEntries.push_back({ key, STATIC_U64(entry.file_size()), entry.last_write_time() });
+		}
+
+		std::ranges::sort(foundEntries, {}, &SFoundEntry::LastUseTime);
+		for (const SFoundEntry& foundEntry : foundEntries)
+		{
+			UseOrder.push_back(foundEntry.Key);
+			Entries[foundEntry.Key] = { foundEntry.Size, std::prev(UseOrder.end()) };
+			Size += foundEntry.Size;
+		}
+
+		EvictEntries();
+	}
+
+	U64 CDerivedDataCache::GetKey(const std::string& sourceFilePath, const SSourceAssetData& sourceData, const SStaticMeshLODImportSettings& lodSettings, const bool isCompressed, const bool isQuantized)
+	{
+		CMappedFile sourceFile;
+		if (!sourceFile.Open(sourceFilePath))
+			return 0;
+
+		U64 key = HashBytes(sourceFile.GetData(), sourceFile.GetSize(), HashOffsetBasis);
+
+		// The source and dependency paths end up in the imported file, the asset name is taken from the source path
+		key = HashString(UGeneralUtils::ConvertToPlatformAgnosticPath(sourceData.SourcePath.AsString()), key);
+		key = HashString(sourceData.AssetDependencyPath.AsString(), key);
+		key = HashValue(sourceData.AssetType, key);
+		key = HashValue(sourceData.ImportScale, key);
+		key = HashValue(lodSettings.NumberOfLODs, key);
+		key = HashValue(lodSettings.TriangleRatio, key);
+		key = HashValue(lodSettings.FirstScreenSize, key);
+		key = HashValue(lodSettings.MaxError, key);
+		key = HashValue(isCompressed, key);
+		key = HashValue(isQuantized, key);
+		key = HashValue(UModelImporter::Version, key);
+		key = HashValue(Version, key);
+
+		// 0 means no key
+		return key != 0 ? key : 1;
+	}
+
+	bool CDerivedDataCache::Fetch(const U64 key, const std::string& filePath)
+	{
+		{
+			std::unique_lock lock(Mutex);
+			if (!Entries.contains(key))
+			{
+				NumberOfMisses++;
+				return false;
+			}
+			Touch(key);
+		}
+
+		// Copied outside the lock so imports on other threads aren't held up, an entry evicted in the meantime is a miss
+		const std::string entryPath = GetEntryPath(key);
+		const std::string temporaryPath = filePath + ".tmp";
+		std::error_code error;
+		std::filesystem::copy_file(entryPath, temporaryPath, std::filesystem::copy_options::overwrite_existing, error);
+		if (!error)
+			std::filesystem::rename(temporaryPath, filePath, error);
+
+		std::unique_lock lock(Mutex);
+		if (error)
+		{
+			HV_LOG_WARN("CDerivedDataCache::Fetch: Could not copy %s to %s: %s", entryPath.c_str(), filePath.c_str(), error.message().c_str());
+			std::filesystem::remove(temporaryPath, error);
+			NumberOfMisses++;
+			return false;
+		}
+
+		// Keeps the use order across runs
+		std::filesystem::last_write_time(entryPath, std::filesystem::file_time_type::clock::now(), error);
+		NumberOfHits++;
+		return true;
+	}
+
+	void CDerivedDataCache::Store(const U64 key, const char* data, const U64 size)
+	{
+		if (key == 0 || !UFileSystem::SerializeAtomic(GetEntryPath(key), data, size))
+			return;
+
+		std::unique_lock lock(Mutex);
+		if (auto it = Entries.find(key); it != Entries.end())
+		{
+			Size -= it->second.Size;
+			it->second.Size = size;
+		}
+		else
+		{
+			UseOrder.push_back(key);
+			Entries[key] = { size, std::prev(UseOrder.end()) };
+		}
+
+		Size += size;
+		Touch(key);
+		EvictEntries();
+	}
+
+	bool CDerivedDataCache::Contains(const U64 key) const
+	{
+		std::unique_lock lock(Mutex);
+		return Entries.contains(key);
+	}
+
+	void CDerivedDataCache::SetSizeBudget(const U64 budgetBytes)
+	{
+		std::unique_lock lock(Mutex);
+		SizeBudget = budgetBytes;
+		EvictEntries();
+	}
+
+	void CDerivedDataCache::Clear()
+	{
+		std::unique_lock lock(Mutex);
+		for (const auto& [key, entry] : Entries)
+			UFileSystem::Remove(GetEntryPath(key));
+
+		NumberOfEvictions += Entries.size();
+		Entries.clear();
+		UseOrder.clear();
+		Size = 0;
+	}
+
+	std::string CDerivedDataCache::GetDebugString() const
+	{
+		std::unique_lock lock(Mutex);
+		const U64 numberOfLookups = NumberOfHits + NumberOfMisses;
+		return std::format("Derived Data Cache: {} entries, {:.2f} / {:.2f} MB | Hits: {}, Misses: {} ({:.1f}% hit rate) | Evictions: {}",
+			Entries.size(), STATIC_F32(Size) / (1024.0f * 1024.0f), STATIC_F32(SizeBudget) / (1024.0f * 1024.0f),
+			NumberOfHits, NumberOfMisses, numberOfLookups > 0 ? 100.0f * STATIC_F32(NumberOfHits) / STATIC_F32(numberOfLookups) : 0.0f, NumberOfEvictions);
+	}
+
+	std::string CDerivedDataCache::GetEntryPath(const U64 key)
+	{
+		return std::format("{}{:016x}.hva", CacheDirectory, key);
+	}
+
+	void CDerivedDataCache::Touch(const U64 key)
+	{
+		SEntry& entry = Entries[key];
+		UseOrder.splice(UseOrder.end(), UseOrder, entry.LeastRecentlyUsed);
+	}
+
+	void CDerivedDataCache::EvictEntries()
+	{
+		while (SizeBudget > 0 && Size > SizeBudget && !UseOrder.empty())
+		{
+			const U64 key = UseOrder.front();
+			UFileSystem::Remove(GetEntryPath(key));
+			Size -= Entries[key].Size;
+			Entries.erase(key);
+			UseOrder.pop_front();
+			NumberOfEvictions++;
+		}
+	}
+}
@@ -0,0 +1,68 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace Havtorn
+{
+	struct SSourceAssetData;
+	struct SStaticMeshLODImportSettings;
+
+	// Local cache of imported .hva files, keyed on everything that goes into an import: the contents of the source file,
+	// the import options and the importer version. Entries are plain files named after their key in CacheDirectory.
+	class CDerivedDataCache
+	{
+	public:
+		static constexpr U32 Version = 1;
+		// Used when the engine config has no "Derived Data Cache Size MB"
+		static constexpr U32 DefaultSizeBudgetMB = 2048;
+
+		ENGINE_API static const std::string CacheDirectory;
+
+		// Picks up the entries left by earlier runs, least recently used first
+		ENGINE_API void Init(const U64 sizeBudgetBytes);
+
+		// Thread safe. 0 if the source file can't be read. isCompressed and isQuantized are how the .hva is saved.
+		[[nodiscard]] ENGINE_API static U64 GetKey(const std::string& sourceFilePath, const SSourceAssetData& sourceData, const SStaticMeshLODImportSettings& lodSettings, const bool isCompressed, const bool isQuantized);
+
+		// Thread safe. Copies the cached file to filePath, replacing it in one go. Counts a hit or a miss.
+		ENGINE_API bool Fetch(const U64 key, const std::string& filePath);
+		// Thread safe. Evicts the least recently used entries once the cache is over its budget.
+		ENGINE_API void Store(const U64 key, const char* data, const U64 size);
+		[[nodiscard]] ENGINE_API bool Contains(const U64 key) const;
+
+		// 0 means no budget
+		ENGINE_API void SetSizeBudget(const U64 budgetBytes);
+		// Deletes every entry
+		ENGINE_API void Clear();
+
+		[[nodiscard]] ENGINE_API std::string GetDebugString() const;
+
+		// Where the entry for key is stored, whether or not there is one
+		[[nodiscard]] ENGINE_API static std::string GetEntryPath(const U64 key);
+
+	private:
+		// Lock held
+		void Touch(const U64 key);
+		void EvictEntries();
+
+		struct SEntry
+		{
+			U64 Size = 0;
+			std::list<U64>::iterator LeastRecentlyUsed;
+		};
+
+		mutable std::mutex Mutex;
+		std::map<U64, SEntry> Entries;
+		// Least recently used first
+		std::list<U64> UseOrder;
+		U64 Size = 0;
+		U64 SizeBudget = STATIC_U64(DefaultSizeBudgetMB) * 1024 * 1024;
+		U64 NumberOfHits = 0;
+		U64 NumberOfMisses = 0;
+		U64 NumberOfEvictions = 0;
+	};
+}
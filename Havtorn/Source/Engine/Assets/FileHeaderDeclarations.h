@@ -7,6 +7,8 @@
 #include "Scene/Scene.h"
 #include "Assets/SequencerAsset.h"
 #include "HexRune/HexRune.h"
+#include "VertexQuantization.h"
+#include "AnimationCompression.h"
 
 #include <variant>
 
@@ -125,6 +127,61 @@ namespace Havtorn
 		return references;
 	}
 
+	// Mesh and animation files saved with this in place of their asset type store vertex, index and keyframe blobs aligned
+	// to SerializedBlobAlignment, so they can be used straight from a mapped file. Asset types are small numbers, files saved
+	// before this existed can never start with it.
+	constexpr U32 AlignedAssetFileMagic = 0x31415648; // "HVA1"
+	// Same as above, but the blobs are UCompression payloads instead. Textures only get a magic when compressed.
+	constexpr U32 CompressedAssetFileMagic = 0x31435648; // "HVC1"
+	// Mesh files with compact vertices and animation files with compact keys, aligned and compressed respectively. The
+	// vertex or animation quantization follows the asset type.
+	constexpr U32 AlignedQuantizedAssetFileMagic = 0x31515648; // "HVQ1"
+	constexpr U32 CompressedQuantizedAssetFileMagic = 0x32515648; // "HVQ2"
+
+	enum class EAssetFileLayout : U8
+	{
+		// Files without a magic, blobs follow right after their size
+		Legacy,
+		// Blobs are aligned and can be used in place
+		Aligned,
+		// Blobs are UCompression payloads, decompressed straight into the file header
+		Compressed
+	};
+
+	inline U32 GetAssetFileMagic(const bool isCompressed, const bool isQuantized)
+	{
+		if (isQuantized)
+			return isCompressed ? CompressedQuantizedAssetFileMagic : AlignedQuantizedAssetFileMagic;
+
+		return isCompressed ? CompressedAssetFileMagic : AlignedAssetFileMagic;
+	}
+
+	// Reads the asset type, skipping the magic in front of it in newer files
+	inline EAssetType DeserializeAssetType(const char* fromData, U64& pointerPosition, EAssetFileLayout* outLayout = nullptr, bool* outIsQuantized = nullptr)
+	{
+		U32 firstWord = 0;
+		DeserializeData(firstWord, fromData, pointerPosition);
+
+		EAssetFileLayout layout = EAssetFileLayout::Legacy;
+		if (firstWord == AlignedAssetFileMagic || firstWord == AlignedQuantizedAssetFileMagic)
+			layout = EAssetFileLayout::Aligned;
+		else if (firstWord == CompressedAssetFileMagic || firstWord == CompressedQuantizedAssetFileMagic)
+			layout = EAssetFileLayout::Compressed;
+
+		if (outLayout != nullptr)
+			*outLayout = layout;
+
+		if (outIsQuantized != nullptr)
+			*outIsQuantized = firstWord == AlignedQuantizedAssetFileMagic || firstWord == CompressedQuantizedAssetFileMagic;
+
+		if (layout == EAssetFileLayout::Legacy)
+			return static_cast<EAssetType>(firstWord);
+
+		EAssetType type = EAssetType::None;
+		DeserializeData(type, fromData, pointerPosition);
+		return type;
+	}
+
 	struct SSourceAssetData
 	{
 		EAssetType AssetType = EAssetType::None;
@@ -135,6 +192,18 @@ namespace Havtorn
 		const bool IsValid() const { return SourcePath.Length() != 0; }
 	};
 
+	struct SStaticMeshLODImportSettings
+	{
+		// Number of simplified LODs to generate in addition to the source mesh (LOD0)
+		U8 NumberOfLODs = 0;
+		// Triangle count of each LOD relative to the previous one
+		F32 TriangleRatio = 0.5f;
+		// Screen size at which LOD1 kicks in, halved for every following LOD
+		F32 FirstScreenSize = 0.5f;
+		// Simplification stops early when collapses would deviate more than this, relative to the mesh extent
+		F32 MaxError = 0.02f;
+	};
+
 	struct SStaticModelFileHeader
 	{
 		EAssetType AssetType = EAssetType::StaticMesh;
@@ -146,15 +215,135 @@ namespace Havtorn
 		U32 NumberOfMeshes = 0;
 		std::vector<SStaticMesh> Meshes;
 
+		// LOD1 and onwards, Meshes is LOD0. Stored after the meshes, files saved before LODs existed simply end there.
+		SStaticMeshLODImportSettings LODImportSettings;
+		U8 NumberOfLODs = 0;
+		std::vector<SStaticMeshLOD> LODs;
+
+		// Computed at import and stored after the LODs. Files imported before that end before it and leave it invalid.
+		SMeshBounds Bounds;
+
+		// Filled instead of the mesh vertices and indices when deserializing an aligned file with viewBlobs,
+		// LOD0 meshes first and then every LOD in order. They point into the file data, which has to outlive the header.
+		std::vector<std::span<const SStaticMeshVertex>> VertexViews;
+		std::vector<std::span<const U32>> IndexViews;
+
+		// Filled by CompressPayloads before saving, every vertex and index blob in the order they are written.
+		// The file is written in the compressed layout if there are any.
+		std::vector<std::vector<char>> CompressedPayloads;
+
+		// Filled by QuantizeVertices before saving, the compact version of every vertex blob in the order they are written.
+		// The file is written with them in place of the vertices if there are any. Reading decodes them into the meshes again,
+		// so views are never used for these files.
+		std::vector<std::vector<SCompactStaticMeshVertex>> CompactVertices;
+		SVertexQuantization Quantization;
+
+		// Mesh data regardless of how the file was deserialized, lodIndex 0 is Meshes
+		[[nodiscard]] std::span<const SStaticMeshVertex> GetVertices(const U8 lodIndex, const U32 meshIndex) const;
+		[[nodiscard]] std::span<const U32> GetIndices(const U8 lodIndex, const U32 meshIndex) const;
+
+		// Returns false and leaves CompactVertices empty if any vertex would end up outside the error bounds of UVertexQuantization
+		bool QuantizeVertices();
+		// Call after QuantizeVertices, if at all
+		void CompressPayloads();
 		[[nodiscard]] U32 GetSize() const;
 		void Serialize(char* toData) const;
-		void Deserialize(const char* fromData);
+		// Blobs in compressed files are decompressed before returning, unless outChunks is given to collect the chunks instead.
+		// Compact vertices are always decompressed and decoded before returning, only index chunks end up in outChunks.
+		// Returns false if a compressed blob is corrupt or runs past fromDataSize.
+		bool Deserialize(const char* fromData, const U64 fromDataSize, const bool viewBlobs = false, std::vector<SCompressedChunk>* outChunks = nullptr);
 	};
 
+	inline std::span<const SStaticMeshVertex> SStaticModelFileHeader::GetVertices(const U8 lodIndex, const U32 meshIndex) const
+	{
+		if (!VertexViews.empty())
+			return VertexViews[lodIndex * NumberOfMeshes + meshIndex];
+
+		return lodIndex == 0 ? Meshes[meshIndex].Vertices : LODs[lodIndex - 1].Meshes[meshIndex].Vertices;
+	}
+
+	inline std::span<const U32> SStaticModelFileHeader::GetIndices(const U8 lodIndex, const U32 meshIndex) const
+	{
+		if (!IndexViews.empty())
+			return IndexViews[lodIndex * NumberOfMeshes + meshIndex];
+
+		return lodIndex == 0 ? Meshes[meshIndex].Indices : LODs[lodIndex - 1].Meshes[meshIndex].Indices;
+	}
+
+	inline bool SStaticModelFileHeader::QuantizeVertices()
+	{
+		std::vector<std::span<const SStaticMeshVertex>> meshVertices;
+		for (auto& mesh : Meshes)
+			meshVertices.emplace_back(mesh.Vertices);
+
+		for (auto& lod : LODs)
+		{
+			for (auto& mesh : lod.Meshes)
+				meshVertices.emplace_back(mesh.Vertices);
+		}
+
+		Quantization = UVertexQuantization::GetQuantization(meshVertices);
+		CompactVertices.clear();
+
+		SVertexQuantizationError error;
+		for (const std::span<const SStaticMeshVertex>& vertices : meshVertices)
+			error.Add(UVertexQuantization::Encode(vertices, Quantization, CompactVertices.emplace_back()));
+
+		if (UVertexQuantization::IsWithinErrorBounds(error, Quantization))
+			return true;
+
+		HV_LOG_WARN("SStaticModelFileHeader::QuantizeVertices: %s keeps full vertices, the compact ones would be off by up to %f units, %f radians and %f in UV.", Name.c_str(), error.Position, error.Direction, error.UV);
+		CompactVertices.clear();
+		return false;
+	}
+
+	inline void SStaticModelFileHeader::CompressPayloads()
+	{
+		CompressedPayloads.clear();
+		U32 vertexBlobIndex = 0;
+		auto compressVertices = [&](const std::vector<SStaticMeshVertex>& vertices)
+			{
+				if (CompactVertices.empty())
+					CompressData(vertices, CompressedPayloads.emplace_back());
+				else
+					CompressData(CompactVertices[vertexBlobIndex++], CompressedPayloads.emplace_back());
+			};
+
+		for (auto& mesh : Meshes)
+		{
+			compressVertices(mesh.Vertices);
+			CompressData(mesh.Indices, CompressedPayloads.emplace_back());
+		}
+
+		for (auto& lod : LODs)
+		{
+			for (auto& mesh : lod.Meshes)
+			{
+				compressVertices(mesh.Vertices);
+				CompressData(mesh.Indices, CompressedPayloads.emplace_back());
+			}
+		}
+	}
+
 	inline U32 SStaticModelFileHeader::GetSize() const
 	{
 		U32 size = 0;
+		U32 payloadIndex = 0;
+		U32 vertexBlobIndex = 0;
+		auto getBlobSize = [&](const auto& blob)
+			{
+				return CompressedPayloads.empty() ? GetAlignedDataSize(blob, size) : STATIC_U32(CompressedPayloads[payloadIndex++].size());
+			};
+		auto getVertexBlobSize = [&](const auto& vertices)
+			{
+				return CompactVertices.empty() ? getBlobSize(vertices) : getBlobSize(CompactVertices[vertexBlobIndex++]);
+			};
+
+		size += GetDataSize(AlignedAssetFileMagic);
 		size += GetDataSize(AssetType);
+		if (!CompactVertices.empty())
+			size += GetDataSize(Quantization);
+
 		size += GetDataSize(Name);
 		size += GetDataSize(UID);
 		size += GetDataSize(SourceData);
@@ -164,17 +353,52 @@ namespace Havtorn
 		for (auto& mesh : Meshes)
 		{
 			size += GetDataSize(mesh.Name);
-			size += GetDataSize(mesh.Vertices);
-			size += GetDataSize(mesh.Indices);
+			size += getVertexBlobSize(mesh.Vertices);
+			size += getBlobSize(mesh.Indices);
 			size += GetDataSize(mesh.MaterialIndex);
 		}
+
+		size += GetDataSize(LODImportSettings);
+		size += GetDataSize(NumberOfLODs);
+		for (auto& lod : LODs)
+		{
+			size += GetDataSize(lod.ScreenSize);
+			for (auto& mesh : lod.Meshes)
+			{
+				size += getVertexBlobSize(mesh.Vertices);
+				size += getBlobSize(mesh.Indices);
+			}
+		}
+
+		size += GetDataSize(Bounds);
 		return size;
 	}
 
 	inline void SStaticModelFileHeader::Serialize(char* toData) const
 	{
 		U64 pointerPosition = 0;
+		U32 payloadIndex = 0;
+		auto serializeBlob = [&](const auto& blob)
+			{
+				if (CompressedPayloads.empty())
+					SerializeAlignedData(blob, toData, pointerPosition);
+				else
+					SerializeCompressedData(CompressedPayloads[payloadIndex++], toData, pointerPosition);
+			};
+		U32 vertexBlobIndex = 0;
+		auto serializeVertexBlob = [&](const auto& vertices)
+			{
+				if (CompactVertices.empty())
+					serializeBlob(vertices);
+				else
+					serializeBlob(CompactVertices[vertexBlobIndex++]);
+			};
+
+		SerializeData(GetAssetFileMagic(!CompressedPayloads.empty(), !CompactVertices.empty()), toData, pointerPosition);
 		SerializeData(AssetType, toData, pointerPosition);
+		if (!CompactVertices.empty())
+			SerializeData(Quantization, toData, pointerPosition);
+
 		SerializeData(Name, toData, pointerPosition);
 		SerializeData(UID, toData, pointerPosition);
 		SerializeData(SourceData, toData, pointerPosition);
@@ -184,31 +408,127 @@ namespace Havtorn
 		for (auto& mesh : Meshes)
 		{
 			SerializeData(mesh.Name, toData, pointerPosition);
-			SerializeData(mesh.Vertices, toData, pointerPosition);
-			SerializeData(mesh.Indices, toData, pointerPosition);
+			serializeVertexBlob(mesh.Vertices);
+			serializeBlob(mesh.Indices);
 			SerializeData(mesh.MaterialIndex, toData, pointerPosition);
 		}
+
+		// LOD meshes share name and material index with their LOD0 counterpart
+		SerializeData(LODImportSettings, toData, pointerPosition);
+		SerializeData(NumberOfLODs, toData, pointerPosition);
+		for (auto& lod : LODs)
+		{
+			SerializeData(lod.ScreenSize, toData, pointerPosition);
+			for (auto& mesh : lod.Meshes)
+			{
+				serializeVertexBlob(mesh.Vertices);
+				serializeBlob(mesh.Indices);
+			}
+		}
+
+		SerializeData(Bounds, toData, pointerPosition);
 	}
 
-	inline void SStaticModelFileHeader::Deserialize(const char* fromData)
+	inline bool SStaticModelFileHeader::Deserialize(const char* fromData, const U64 fromDataSize, const bool viewBlobs, std::vector<SCompressedChunk>* outChunks)
 	{
 		U64 pointerPosition = 0;
-		DeserializeData(AssetType, fromData, pointerPosition);
+		EAssetFileLayout layout = EAssetFileLayout::Legacy;
+		bool hasCompactVertices = false;
+		AssetType = DeserializeAssetType(fromData, pointerPosition, &layout, &hasCompactVertices);
+		if (hasCompactVertices)
+			DeserializeData(Quantization, fromData, pointerPosition);
+
 		DeserializeData(Name, fromData, pointerPosition);
 		DeserializeData(UID, fromData, pointerPosition);
 		DeserializeData(SourceData, fromData, pointerPosition);
 		DeserializeData(NumberOfMaterials, fromData, pointerPosition);
 		DeserializeData(NumberOfMeshes, fromData, pointerPosition);
 
+		std::vector<SCompressedChunk> chunks;
+		std::vector<SCompressedChunk>& payloadChunks = outChunks != nullptr ? *outChunks : chunks;
+
+		// Compressed compact vertices have to be decompressed before they can be decoded, so they never go to outChunks
+		std::vector<SCompressedChunk> compactChunks;
+		std::vector<std::vector<SCompactStaticMeshVertex>> compressedCompactVertices;
+		std::vector<std::vector<SStaticMeshVertex>*> compressedCompactVertexTargets;
+
+		auto deserializeMeshData = [&](SStaticMesh& mesh)
+			{
+				if (hasCompactVertices && layout == EAssetFileLayout::Compressed)
+				{
+					compressedCompactVertexTargets.emplace_back(&mesh.Vertices);
+					return DeserializeCompressedData(compressedCompactVertices.emplace_back(), fromData, fromDataSize, pointerPosition, compactChunks)
+						&& DeserializeCompressedData(mesh.Indices, fromData, fromDataSize, pointerPosition, payloadChunks);
+				}
+				else if (hasCompactVertices)
+				{
+					std::span<const SCompactStaticMeshVertex> compactVertices;
+					DeserializeAlignedData(compactVertices, fromData, pointerPosition);
+					UVertexQuantization::Decode(compactVertices, Quantization, mesh.Vertices);
+					DeserializeAlignedData(mesh.Indices, fromData, pointerPosition);
+				}
+				else if (layout == EAssetFileLayout::Compressed)
+				{
+					return DeserializeCompressedData(mesh.Vertices, fromData, fromDataSize, pointerPosition, payloadChunks)
+						&& DeserializeCompressedData(mesh.Indices, fromData, fromDataSize, pointerPosition, payloadChunks);
+				}
+				else if (layout == EAssetFileLayout::Aligned && viewBlobs)
+				{
+					DeserializeAlignedData(VertexViews.emplace_back(), fromData, pointerPosition);
+					DeserializeAlignedData(IndexViews.emplace_back(), fromData, pointerPosition);
+				}
+				else if (layout == EAssetFileLayout::Aligned)
+				{
+					DeserializeAlignedData(mesh.Vertices, fromData, pointerPosition);
+					DeserializeAlignedData(mesh.Indices, fromData, pointerPosition);
+				}
+				else
+				{
+					DeserializeData(mesh.Vertices, fromData, pointerPosition);
+					DeserializeData(mesh.Indices, fromData, pointerPosition);
+				}
+				return true;
+			};
+
 		Meshes.reserve(NumberOfMeshes);
 		for (U16 i = 0; i < NumberOfMeshes; i++)
 		{
 			Meshes.emplace_back();
 			DeserializeData(Meshes.back().Name, fromData, pointerPosition);
-			DeserializeData(Meshes.back().Vertices, fromData, pointerPosition);
-			DeserializeData(Meshes.back().Indices, fromData, pointerPosition);
+			if (!deserializeMeshData(Meshes.back()))
+				return false;
 			DeserializeData(Meshes.back().MaterialIndex, fromData, pointerPosition);
 		}
+
+		if (pointerPosition < fromDataSize)
+		{
+			DeserializeData(LODImportSettings, fromData, pointerPosition);
+			DeserializeData(NumberOfLODs, fromData, pointerPosition);
+			LODs.resize(NumberOfLODs);
+			for (auto& lod : LODs)
+			{
+				DeserializeData(lod.ScreenSize, fromData, pointerPosition);
+				lod.Meshes.resize(NumberOfMeshes);
+				for (U16 i = 0; i < NumberOfMeshes; i++)
+				{
+					lod.Meshes[i].Name = Meshes[i].Name;
+					lod.Meshes[i].MaterialIndex = Meshes[i].MaterialIndex;
+					if (!deserializeMeshData(lod.Meshes[i]))
+						return false;
+				}
+			}
+		}
+
+		if (pointerPosition < fromDataSize)
+			DeserializeData(Bounds, fromData, pointerPosition);
+
+		if (!UCompression::DecompressChunks(compactChunks))
+			return false;
+
+		for (U64 i = 0; i < compressedCompactVertices.size(); i++)
+			UVertexQuantization::Decode(compressedCompactVertices[i], Quantization, *compressedCompactVertexTargets[i]);
+
+		return outChunks != nullptr || UCompression::DecompressChunks(chunks);
 	}
 
 	struct SSkeletalModelFileHeader
@@ -224,15 +544,94 @@ namespace Havtorn
 		U32 NumberOfNodes = 0;
 		std::vector<SSkeletalMeshNode> Nodes;
 
+		// Bind pose bounds, computed at import and stored after the nodes. Files imported before that end before it and leave it invalid.
+		SMeshBounds Bounds;
+
+		// Filled instead of the mesh vertices and indices when deserializing an aligned file with viewBlobs.
+		// They point into the file data, which has to outlive the header.
+		std::vector<std::span<const SSkeletalMeshVertex>> VertexViews;
+		std::vector<std::span<const U32>> IndexViews;
+
+		// Mesh data regardless of how the file was deserialized
+		[[nodiscard]] std::span<const SSkeletalMeshVertex> GetVertices(const U32 meshIndex) const { return VertexViews.empty() ? std::span<const SSkeletalMeshVertex>(Meshes[meshIndex].Vertices) : VertexViews[meshIndex]; }
+		[[nodiscard]] std::span<const U32> GetIndices(const U32 meshIndex) const { return IndexViews.empty() ? std::span<const U32>(Meshes[meshIndex].Indices) : IndexViews[meshIndex]; }
+
+		// Filled by CompressPayloads before saving, the vertex and index blob of every mesh in order
+		std::vector<std::vector<char>> CompressedPayloads;
+
+		// Filled by QuantizeVertices before saving, see SStaticModelFileHeader
+		std::vector<std::vector<SCompactSkeletalMeshVertex>> CompactVertices;
+		SVertexQuantization Quantization;
+
+		// Also returns false if any bone index doesn't fit in a byte
+		bool QuantizeVertices();
+		void CompressPayloads();
 		[[nodiscard]] U32 GetSize() const;
 		void Serialize(char* toData) const;
-		void Deserialize(const char* fromData);
+		// Blobs in compressed files are decompressed before returning, unless outChunks is given to collect the chunks instead.
+		// Compact vertices are always decompressed and decoded before returning, only index chunks end up in outChunks.
+		// Returns false if a compressed blob is corrupt or runs past fromDataSize.
+		bool Deserialize(const char* fromData, const U64 fromDataSize, const bool viewBlobs = false, std::vector<SCompressedChunk>* outChunks = nullptr);
 	};
 
+	inline bool SSkeletalModelFileHeader::QuantizeVertices()
+	{
+		std::vector<std::span<const SSkeletalMeshVertex>> meshVertices;
+		for (auto& mesh : Meshes)
+			meshVertices.emplace_back(mesh.Vertices);
+
+		Quantization = UVertexQuantization::GetQuantization(meshVertices);
+		CompactVertices.clear();
+
+		SVertexQuantizationError error;
+		for (const std::span<const SSkeletalMeshVertex>& vertices : meshVertices)
+			error.Add(UVertexQuantization::Encode(vertices, Quantization, CompactVertices.emplace_back()));
+
+		if (UVertexQuantization::IsWithinErrorBounds(error, Quantization))
+			return true;
+
+		if (error.HasUnsupportedBoneIndices)
+			HV_LOG_WARN("SSkeletalModelFileHeader::QuantizeVertices: %s keeps full vertices, it has bone indices that don't fit in a byte.", Name.c_str());
+		else
+			HV_LOG_WARN("SSkeletalModelFileHeader::QuantizeVertices: %s keeps full vertices, the compact ones would be off by up to %f units, %f radians, %f in UV and %f in bone weight.", Name.c_str(), error.Position, error.Direction, error.UV, error.BoneWeight);
+
+		CompactVertices.clear();
+		return false;
+	}
+
+	inline void SSkeletalModelFileHeader::CompressPayloads()
+	{
+		CompressedPayloads.clear();
+		for (U64 i = 0; i < Meshes.size(); i++)
+		{
+			if (CompactVertices.empty())
+				CompressData(Meshes[i].Vertices, CompressedPayloads.emplace_back());
+			else
+				CompressData(CompactVertices[i], CompressedPayloads.emplace_back());
+
+			CompressData(Meshes[i].Indices, CompressedPayloads.emplace_back());
+		}
+	}
+
 	inline U32 SSkeletalModelFileHeader::GetSize() const
 	{
 		U32 size = 0;
+		U32 payloadIndex = 0;
+		U32 vertexBlobIndex = 0;
+		auto getBlobSize = [&](const auto& blob)
+			{
+				return CompressedPayloads.empty() ? GetAlignedDataSize(blob, size) : STATIC_U32(CompressedPayloads[payloadIndex++].size());
+			};
+		auto getVertexBlobSize = [&](const auto& vertices)
+			{
+				return CompactVertices.empty() ? getBlobSize(vertices) : getBlobSize(CompactVertices[vertexBlobIndex++]);
+			};
+
+		size += GetDataSize(AlignedAssetFileMagic);
 		size += GetDataSize(AssetType);
+		if (!CompactVertices.empty())
+			size += GetDataSize(Quantization);
+
 		size += GetDataSize(Name);
 		size += GetDataSize(UID);
 		size += GetDataSize(SourceData);
@@ -242,8 +641,8 @@ namespace Havtorn
 		for (auto& mesh : Meshes)
 		{
 			size += GetDataSize(mesh.Name);
-			size += GetDataSize(mesh.Vertices);
-			size += GetDataSize(mesh.Indices);
+			size += getVertexBlobSize(mesh.Vertices);
+			size += getBlobSize(mesh.Indices);
 			size += GetDataSize(mesh.MaterialIndex);
 		}
 
@@ -257,13 +656,35 @@ namespace Havtorn
 			size += GetDataSize(node.ChildIndices);
 		}
 
+		size += GetDataSize(Bounds);
 		return size;
 	}
 
 	inline void SSkeletalModelFileHeader::Serialize(char* toData) const
 	{
 		U64 pointerPosition = 0;
+		U32 payloadIndex = 0;
+		auto serializeBlob = [&](const auto& blob)
+			{
+				if (CompressedPayloads.empty())
+					SerializeAlignedData(blob, toData, pointerPosition);
+				else
+					SerializeCompressedData(CompressedPayloads[payloadIndex++], toData, pointerPosition);
+			};
+		U32 vertexBlobIndex = 0;
+		auto serializeVertexBlob = [&](const auto& vertices)
+			{
+				if (CompactVertices.empty())
+					serializeBlob(vertices);
+				else
+					serializeBlob(CompactVertices[vertexBlobIndex++]);
+			};
+
+		SerializeData(GetAssetFileMagic(!CompressedPayloads.empty(), !CompactVertices.empty()), toData, pointerPosition);
 		SerializeData(AssetType, toData, pointerPosition);
+		if (!CompactVertices.empty())
+			SerializeData(Quantization, toData, pointerPosition);
+
 		SerializeData(Name, toData, pointerPosition);
 		SerializeData(UID, toData, pointerPosition);
 		SerializeData(SourceData, toData, pointerPosition);
@@ -273,8 +694,8 @@ namespace Havtorn
 		for (auto& mesh : Meshes)
 		{
 			SerializeData(mesh.Name, toData, pointerPosition);
-			SerializeData(mesh.Vertices, toData, pointerPosition);
-			SerializeData(mesh.Indices, toData, pointerPosition);
+			serializeVertexBlob(mesh.Vertices);
+			serializeBlob(mesh.Indices);
 			SerializeData(mesh.MaterialIndex, toData, pointerPosition);
 		}
 
@@ -287,25 +708,72 @@ namespace Havtorn
 			SerializeData(node.NodeTransform, toData, pointerPosition);
 			SerializeData(node.ChildIndices, toData, pointerPosition);
 		}
+
+		SerializeData(Bounds, toData, pointerPosition);
 	}
 
-	inline void SSkeletalModelFileHeader::Deserialize(const char* fromData)
+	inline bool SSkeletalModelFileHeader::Deserialize(const char* fromData, const U64 fromDataSize, const bool viewBlobs, std::vector<SCompressedChunk>* outChunks)
 	{
 		U64 pointerPosition = 0;
-		DeserializeData(AssetType, fromData, pointerPosition);
+		EAssetFileLayout layout = EAssetFileLayout::Legacy;
+		bool hasCompactVertices = false;
+		AssetType = DeserializeAssetType(fromData, pointerPosition, &layout, &hasCompactVertices);
+		if (hasCompactVertices)
+			DeserializeData(Quantization, fromData, pointerPosition);
+
 		DeserializeData(Name, fromData, pointerPosition);
 		DeserializeData(UID, fromData, pointerPosition);
 		DeserializeData(SourceData, fromData, pointerPosition);
 		DeserializeData(NumberOfMaterials, fromData, pointerPosition);
 		DeserializeData(NumberOfMeshes, fromData, pointerPosition);
 
+		std::vector<SCompressedChunk> chunks;
+		std::vector<SCompressedChunk>& payloadChunks = outChunks != nullptr ? *outChunks : chunks;
+
+		std::vector<SCompressedChunk> compactChunks;
+		std::vector<std::vector<SCompactSkeletalMeshVertex>> compressedCompactVertices;
+
 		Meshes.reserve(NumberOfMeshes);
 		for (U16 i = 0; i < NumberOfMeshes; i++)
 		{
 			Meshes.emplace_back();
 			DeserializeData(Meshes.back().Name, fromData, pointerPosition);
-			DeserializeData(Meshes.back().Vertices, fromData, pointerPosition);
-			DeserializeData(Meshes.back().Indices, fromData, pointerPosition);
+
+			if (hasCompactVertices && layout == EAssetFileLayout::Compressed)
+			{
+				if (!DeserializeCompressedData(compressedCompactVertices.emplace_back(), fromData, fromDataSize, pointerPosition, compactChunks)
+					|| !DeserializeCompressedData(Meshes.back().Indices, fromData, fromDataSize, pointerPosition, payloadChunks))
+					return false;
+			}
+			else if (hasCompactVertices)
+			{
+				std::span<const SCompactSkeletalMeshVertex> compactVertices;
+				DeserializeAlignedData(compactVertices, fromData, pointerPosition);
+				UVertexQuantization::Decode(compactVertices, Quantization, Meshes.back().Vertices);
+				DeserializeAlignedData(Meshes.back().Indices, fromData, pointerPosition);
+			}
+			else if (layout == EAssetFileLayout::Compressed)
+			{
+				if (!DeserializeCompressedData(Meshes.back().Vertices, fromData, fromDataSize, pointerPosition, payloadChunks)
+					|| !DeserializeCompressedData(Meshes.back().Indices, fromData, fromDataSize, pointerPosition, payloadChunks))
+					return false;
+			}
+			else if (layout == EAssetFileLayout::Aligned && viewBlobs)
+			{
+				DeserializeAlignedData(VertexViews.emplace_back(), fromData, pointerPosition);
+				DeserializeAlignedData(IndexViews.emplace_back(), fromData, pointerPosition);
+			}
+			else if (layout == EAssetFileLayout::Aligned)
+			{
+				DeserializeAlignedData(Meshes.back().Vertices, fromData, pointerPosition);
+				DeserializeAlignedData(Meshes.back().Indices, fromData, pointerPosition);
+			}
+			else
+			{
+				DeserializeData(Meshes.back().Vertices, fromData, pointerPosition);
+				DeserializeData(Meshes.back().Indices, fromData, pointerPosition);
+			}
+
 			DeserializeData(Meshes.back().MaterialIndex, fromData, pointerPosition);
 		}
 
@@ -320,6 +788,18 @@ namespace Havtorn
 			DeserializeData(Nodes.back().NodeTransform, fromData, pointerPosition);
 			DeserializeData(Nodes.back().ChildIndices, fromData, pointerPosition);
 		}
+
+		if (pointerPosition < fromDataSize)
+			DeserializeData(Bounds, fromData, pointerPosition);
+
+		// Every mesh has one when there are any
+		if (!UCompression::DecompressChunks(compactChunks))
+			return false;
+
+		for (U64 i = 0; i < compressedCompactVertices.size(); i++)
+			UVertexQuantization::Decode(compressedCompactVertices[i], Quantization, Meshes[i].Vertices);
+
+		return outChunks != nullptr || UCompression::DecompressChunks(chunks);
 	}
 
 	struct SSkeletalAnimationFileHeader
@@ -333,15 +813,80 @@ namespace Havtorn
 		U32 NumberOfBones = 0;
 		std::vector<SBoneAnimationTrack> BoneAnimationTracks;
 
+		// Filled by CompressTracks before saving, the compact version of every track in the same order. Compact keys are
+		// decoded back to BoneAnimationTracks when read, only the reduction of keys is kept at runtime.
+		std::vector<SCompactBoneAnimationTrack> CompactTracks;
+		SAnimationQuantization Quantization;
+
+		// Filled by CompressPayloads before saving, the translation, rotation and scale keys of every track in order
+		std::vector<std::vector<char>> CompressedPayloads;
+
+		// Reduces the keys of BoneAnimationTracks in place, then returns false and leaves CompactTracks empty if any key
+		// would end up outside the error bounds of UAnimationCompression
+		bool CompressTracks();
+		// Call after CompressTracks, if at all
+		void CompressPayloads();
 		[[nodiscard]] U32 GetSize() const;
 		void Serialize(char* toData) const;
-		void Deserialize(const char* fromData);
+		// Keys in compressed files are decompressed before returning, unless outChunks is given to collect the chunks instead.
+		// Compact keys are always decompressed and decoded before returning. Returns false if a compressed blob is corrupt or
+		// runs past fromDataSize.
+		bool Deserialize(const char* fromData, const U64 fromDataSize, std::vector<SCompressedChunk>* outChunks = nullptr);
 	};
 
+	inline bool SSkeletalAnimationFileHeader::CompressTracks()
+	{
+		UAnimationCompression::ReduceKeys(BoneAnimationTracks);
+		Quantization = UAnimationCompression::GetQuantization(BoneAnimationTracks);
+		CompactTracks.clear();
+
+		const SAnimationCompressionError error = UAnimationCompression::Encode(BoneAnimationTracks, Quantization, CompactTracks);
+		if (UAnimationCompression::IsWithinErrorBounds(error, Quantization))
+			return true;
+
+		if (error.HasUnsupportedKeyTimes)
+			HV_LOG_WARN("SSkeletalAnimationFileHeader::CompressTracks: %s keeps full keys, it has key times that aren't whole ticks.", Name.c_str());
+		else
+			HV_LOG_WARN("SSkeletalAnimationFileHeader::CompressTracks: %s keeps full keys, the compact ones would be off by up to %f units, %f radians and %f in scale.", Name.c_str(), error.Translation, error.Rotation, error.Scale);
+
+		CompactTracks.clear();
+		return false;
+	}
+
+	inline void SSkeletalAnimationFileHeader::CompressPayloads()
+	{
+		CompressedPayloads.clear();
+		for (U64 i = 0; i < BoneAnimationTracks.size(); i++)
+		{
+			if (CompactTracks.empty())
+			{
+				CompressData(BoneAnimationTracks[i].TranslationKeys, CompressedPayloads.emplace_back());
+				CompressData(BoneAnimationTracks[i].RotationKeys, CompressedPayloads.emplace_back());
+				CompressData(BoneAnimationTracks[i].ScaleKeys, CompressedPayloads.emplace_back());
+			}
+			else
+			{
+				CompressData(CompactTracks[i].TranslationKeys, CompressedPayloads.emplace_back());
+				CompressData(CompactTracks[i].RotationKeys, CompressedPayloads.emplace_back());
+				CompressData(CompactTracks[i].ScaleKeys, CompressedPayloads.emplace_back());
+			}
+		}
+	}
+
 	inline U32 SSkeletalAnimationFileHeader::GetSize() const
 	{
 		U32 size = 0;
+		U32 payloadIndex = 0;
+		auto getBlobSize = [&](const auto& blob)
+			{
+				return CompressedPayloads.empty() ? GetAlignedDataSize(blob, size) : STATIC_U32(CompressedPayloads[payloadIndex++].size());
+			};
+
+		size += GetDataSize(AlignedAssetFileMagic);
 		size += GetDataSize(AssetType);
+		if (!CompactTracks.empty())
+			size += GetDataSize(Quantization);
+
 		size += GetDataSize(Name);
 		size += GetDataSize(UID);
 		size += GetDataSize(SourceData);
@@ -349,8 +894,22 @@ namespace Havtorn
 		size += GetDataSize(TickRate);
 		size += GetDataSize(NumberOfBones);
 
-		for (auto& track : BoneAnimationTracks)
-			size += track.GetSize();
+		for (U64 i = 0; i < BoneAnimationTracks.size(); i++)
+		{
+			if (CompactTracks.empty())
+			{
+				size += getBlobSize(BoneAnimationTracks[i].TranslationKeys);
+				size += getBlobSize(BoneAnimationTracks[i].RotationKeys);
+				size += getBlobSize(BoneAnimationTracks[i].ScaleKeys);
+			}
+			else
+			{
+				size += getBlobSize(CompactTracks[i].TranslationKeys);
+				size += getBlobSize(CompactTracks[i].RotationKeys);
+				size += getBlobSize(CompactTracks[i].ScaleKeys);
+			}
+			size += GetDataSize(BoneAnimationTracks[i].TrackName);
+		}
 
 		return size;
 	}
@@ -358,7 +917,20 @@ namespace Havtorn
 	inline void SSkeletalAnimationFileHeader::Serialize(char* toData) const
 	{
 		U64 pointerPosition = 0;
+		U32 payloadIndex = 0;
+		auto serializeBlob = [&](const auto& blob)
+			{
+				if (CompressedPayloads.empty())
+					SerializeAlignedData(blob, toData, pointerPosition);
+				else
+					SerializeCompressedData(CompressedPayloads[payloadIndex++], toData, pointerPosition);
+			};
+
+		SerializeData(GetAssetFileMagic(!CompressedPayloads.empty(), !CompactTracks.empty()), toData, pointerPosition);
 		SerializeData(AssetType, toData, pointerPosition);
+		if (!CompactTracks.empty())
+			SerializeData(Quantization, toData, pointerPosition);
+
 		SerializeData(Name, toData, pointerPosition);
 		SerializeData(UID, toData, pointerPosition);
 		SerializeData(SourceData, toData, pointerPosition);
@@ -366,19 +938,33 @@ namespace Havtorn
 		SerializeData(TickRate, toData, pointerPosition);
 		SerializeData(NumberOfBones, toData, pointerPosition);
 
-		for (auto& track : BoneAnimationTracks)
+		for (U64 i = 0; i < BoneAnimationTracks.size(); i++)
 		{
-			SerializeData(track.TranslationKeys, toData, pointerPosition);
-			SerializeData(track.RotationKeys, toData, pointerPosition);
-			SerializeData(track.ScaleKeys, toData, pointerPosition);
-			SerializeData(track.TrackName, toData, pointerPosition);
+			if (CompactTracks.empty())
+			{
+				serializeBlob(BoneAnimationTracks[i].TranslationKeys);
+				serializeBlob(BoneAnimationTracks[i].RotationKeys);
+				serializeBlob(BoneAnimationTracks[i].ScaleKeys);
+			}
+			else
+			{
+				serializeBlob(CompactTracks[i].TranslationKeys);
+				serializeBlob(CompactTracks[i].RotationKeys);
+				serializeBlob(CompactTracks[i].ScaleKeys);
+			}
+			SerializeData(BoneAnimationTracks[i].TrackName, toData, pointerPosition);
 		}
 	}
 
-	inline void SSkeletalAnimationFileHeader::Deserialize(const char* fromData)
+	inline bool SSkeletalAnimationFileHeader::Deserialize(const char* fromData, const U64 fromDataSize, std::vector<SCompressedChunk>* outChunks)
 	{
 		U64 pointerPosition = 0;
-		DeserializeData(AssetType, fromData, pointerPosition);
+		EAssetFileLayout layout = EAssetFileLayout::Legacy;
+		bool hasCompactTracks = false;
+		AssetType = DeserializeAssetType(fromData, pointerPosition, &layout, &hasCompactTracks);
+		if (hasCompactTracks)
+			DeserializeData(Quantization, fromData, pointerPosition);
+
 		DeserializeData(Name, fromData, pointerPosition);
 		DeserializeData(UID, fromData, pointerPosition);
 		DeserializeData(SourceData, fromData, pointerPosition);
@@ -386,14 +972,73 @@ namespace Havtorn
 		DeserializeData(TickRate, fromData, pointerPosition);
 		DeserializeData(NumberOfBones, fromData, pointerPosition);
 
+		// Keys are copied once, straight from the file data. The runtime asset outlives the file so it can't view them.
+		std::vector<SCompressedChunk> chunks;
+		std::vector<SCompressedChunk>& payloadChunks = outChunks != nullptr ? *outChunks : chunks;
+
+		std::vector<SCompressedChunk> compactChunks;
+		std::vector<SCompactBoneAnimationTrack> compressedCompactTracks;
+
+		BoneAnimationTracks.reserve(NumberOfBones);
 		for (U16 i = 0; i < NumberOfBones; i++)
 		{
-			BoneAnimationTracks.emplace_back();
-			DeserializeData(BoneAnimationTracks.back().TranslationKeys, fromData, pointerPosition);
-			DeserializeData(BoneAnimationTracks.back().RotationKeys, fromData, pointerPosition);
-			DeserializeData(BoneAnimationTracks.back().ScaleKeys, fromData, pointerPosition);
-			DeserializeData(BoneAnimationTracks.back().TrackName, fromData, pointerPosition);
+			SBoneAnimationTrack& track = BoneAnimationTracks.emplace_back();
+			if (hasCompactTracks && layout == EAssetFileLayout::Compressed)
+			{
+				SCompactBoneAnimationTrack& compactTrack = compressedCompactTracks.emplace_back();
+				if (!DeserializeCompressedData(compactTrack.TranslationKeys, fromData, fromDataSize, pointerPosition, compactChunks)
+					|| !DeserializeCompressedData(compactTrack.RotationKeys, fromData, fromDataSize, pointerPosition, compactChunks)
+					|| !DeserializeCompressedData(compactTrack.ScaleKeys, fromData, fromDataSize, pointerPosition, compactChunks))
+					return false;
+			}
+			else if (hasCompactTracks)
+			{
+				std::span<const SCompactVecAnimationKey> translationKeys;
+				std::span<const SCompactQuatAnimationKey> rotationKeys;
+				std::span<const SCompactVecAnimationKey> scaleKeys;
+				DeserializeAlignedData(translationKeys, fromData, pointerPosition);
+				DeserializeAlignedData(rotationKeys, fromData, pointerPosition);
+				DeserializeAlignedData(scaleKeys, fromData, pointerPosition);
+				UAnimationCompression::Decode(translationKeys, Quantization.TranslationMin, Quantization.TranslationExtent, track.TranslationKeys);
+				UAnimationCompression::Decode(rotationKeys, track.RotationKeys);
+				UAnimationCompression::Decode(scaleKeys, Quantization.ScaleMin, Quantization.ScaleExtent, track.ScaleKeys);
+			}
+			else if (layout == EAssetFileLayout::Compressed)
+			{
+				if (!DeserializeCompressedData(track.TranslationKeys, fromData, fromDataSize, pointerPosition, payloadChunks)
+					|| !DeserializeCompressedData(track.RotationKeys, fromData, fromDataSize, pointerPosition, payloadChunks)
+					|| !DeserializeCompressedData(track.ScaleKeys, fromData, fromDataSize, pointerPosition, payloadChunks))
+					return false;
+			}
+			else if (layout == EAssetFileLayout::Aligned)
+			{
+				DeserializeAlignedData(track.TranslationKeys, fromData, pointerPosition);
+				DeserializeAlignedData(track.RotationKeys, fromData, pointerPosition);
+				DeserializeAlignedData(track.ScaleKeys, fromData, pointerPosition);
+			}
+			else
+			{
+				DeserializeData(track.TranslationKeys, fromData, pointerPosition);
+				DeserializeData(track.RotationKeys, fromData, pointerPosition);
+				DeserializeData(track.ScaleKeys, fromData, pointerPosition);
+			}
+			DeserializeData(track.TrackName, fromData, pointerPosition);
 		}
+
+		// Every track has one when there are any
+		if (!UCompression::DecompressChunks(compactChunks))
+			return false;
+
+		for (U64 i = 0; i < compressedCompactTracks.size(); i++)
+		{
+			const SCompactBoneAnimationTrack& compactTrack = compressedCompactTracks[i];
+			SBoneAnimationTrack& track = BoneAnimationTracks[i];
+			UAnimationCompression::Decode(compactTrack.TranslationKeys, Quantization.TranslationMin, Quantization.TranslationExtent, track.TranslationKeys);
+			UAnimationCompression::Decode(compactTrack.RotationKeys, track.RotationKeys);
+			UAnimationCompression::Decode(compactTrack.ScaleKeys, Quantization.ScaleMin, Quantization.ScaleExtent, track.ScaleKeys);
+		}
+
+		return outChunks != nullptr || UCompression::DecompressChunks(chunks);
 	}
 
 	struct STextureFileHeader
@@ -408,21 +1053,30 @@ namespace Havtorn
 		char Suffix = 0;
 		std::string Data = "";
 
+		// Filled by CompressPayloads before saving. Only compressed textures are written with a magic,
+		// uncompressed ones keep the legacy layout.
+		std::vector<char> CompressedData;
+
+		void CompressPayloads() { CompressData(Data, CompressedData); }
 		[[nodiscard]] U32 GetSize() const;
 		void Serialize(char* toData) const;
-		void Deserialize(const char* fromData);
+		// Data in compressed files is decompressed before returning, unless outChunks is given to collect the chunks instead.
+		// Returns false if the compressed data is corrupt or runs past fromDataSize.
+		bool Deserialize(const char* fromData, const U64 fromDataSize, std::vector<SCompressedChunk>* outChunks = nullptr);
 	};
 
 	inline U32 STextureFileHeader::GetSize() const
 	{
 		U32 size = 0;
+		if (!CompressedData.empty())
+			size += GetDataSize(CompressedAssetFileMagic);
 		size += GetDataSize(AssetType);
 		size += GetDataSize(Name);
 		size += GetDataSize(UID);
 		size += GetDataSize(SourceData);
 		size += GetDataSize(OriginalFormat);
 		size += GetDataSize(Suffix);
-		size += GetDataSize(Data);
+		size += CompressedData.empty() ? GetDataSize(Data) : STATIC_U32(CompressedData.size());
 
 		return size;
 	}
@@ -430,25 +1084,41 @@ namespace Havtorn
 	inline void STextureFileHeader::Serialize(char* toData) const
 	{
 		U64 pointerPosition = 0;
+		if (!CompressedData.empty())
+			SerializeData(CompressedAssetFileMagic, toData, pointerPosition);
 		SerializeData(AssetType, toData, pointerPosition);
 		SerializeData(Name, toData, pointerPosition);
 		SerializeData(UID, toData, pointerPosition);
 		SerializeData(SourceData, toData, pointerPosition);
 		SerializeData(OriginalFormat, toData, pointerPosition);
 		SerializeData(Suffix, toData, pointerPosition);
-		SerializeData(Data, toData, pointerPosition);
+		if (CompressedData.empty())
+			SerializeData(Data, toData, pointerPosition);
+		else
+			SerializeCompressedData(CompressedData, toData, pointerPosition);
 	}
 
-	inline void STextureFileHeader::Deserialize(const char* fromData)
+	inline bool STextureFileHeader::Deserialize(const char* fromData, const U64 fromDataSize, std::vector<SCompressedChunk>* outChunks)
 	{
 		U64 pointerPosition = 0;
-		DeserializeData(AssetType, fromData, pointerPosition);
+		EAssetFileLayout layout = EAssetFileLayout::Legacy;
+		AssetType = DeserializeAssetType(fromData, pointerPosition, &layout);
 		DeserializeData(Name, fromData, pointerPosition);
 		DeserializeData(UID, fromData, pointerPosition);
 		DeserializeData(SourceData, fromData, pointerPosition);
 		DeserializeData(OriginalFormat, fromData, pointerPosition);
 		DeserializeData(Suffix, fromData, pointerPosition);
-		DeserializeData(Data, fromData, pointerPosition);
+		if (layout != EAssetFileLayout::Compressed)
+		{
+			DeserializeData(Data, fromData, pointerPosition);
+			return true;
+		}
+
+		std::vector<SCompressedChunk> chunks;
+		if (!DeserializeCompressedData(Data, fromData, fromDataSize, pointerPosition, outChunks != nullptr ? *outChunks : chunks))
+			return false;
+
+		return outChunks != nullptr || UCompression::DecompressChunks(chunks);
 	}
 
 	struct STextureCubeFileHeader
@@ -459,19 +1129,28 @@ namespace Havtorn
 		ETextureFormat OriginalFormat = ETextureFormat::DDS;
 		std::string Data = "";
 
+		// Filled by CompressPayloads before saving. Only compressed textures are written with a magic,
+		// uncompressed ones keep the legacy layout.
+		std::vector<char> CompressedData;
+
+		void CompressPayloads() { CompressData(Data, CompressedData); }
 		[[nodiscard]] U32 GetSize() const;
 		void Serialize(char* toData) const;
-		void Deserialize(const char* fromData);
+		// Data in compressed files is decompressed before returning, unless outChunks is given to collect the chunks instead.
+		// Returns false if the compressed data is corrupt or runs past fromDataSize.
+		bool Deserialize(const char* fromData, const U64 fromDataSize, std::vector<SCompressedChunk>* outChunks = nullptr);
 	};
 
 	inline U32 STextureCubeFileHeader::GetSize() const
 	{
 		U32 size = 0;
+		if (!CompressedData.empty())
+			size += GetDataSize(CompressedAssetFileMagic);
 		size += GetDataSize(AssetType);
 		size += GetDataSize(Name);
 		size += GetDataSize(SourceData);
 		size += GetDataSize(OriginalFormat);
-		size += GetDataSize(Data);
+		size += CompressedData.empty() ? GetDataSize(Data) : STATIC_U32(CompressedData.size());
 
 		return size;
 	}
@@ -479,21 +1158,37 @@ namespace Havtorn
 	inline void STextureCubeFileHeader::Serialize(char* toData) const
 	{
 		U64 pointerPosition = 0;
+		if (!CompressedData.empty())
+			SerializeData(CompressedAssetFileMagic, toData, pointerPosition);
 		SerializeData(AssetType, toData, pointerPosition);
 		SerializeData(Name, toData, pointerPosition);
 		SerializeData(SourceData, toData, pointerPosition);
 		SerializeData(OriginalFormat, toData, pointerPosition);
-		SerializeData(Data, toData, pointerPosition);
+		if (CompressedData.empty())
+			SerializeData(Data, toData, pointerPosition);
+		else
+			SerializeCompressedData(CompressedData, toData, pointerPosition);
 	}
 
-	inline void STextureCubeFileHeader::Deserialize(const char* fromData)
+	inline bool STextureCubeFileHeader::Deserialize(const char* fromData, const U64 fromDataSize, std::vector<SCompressedChunk>* outChunks)
 	{
 		U64 pointerPosition = 0;
-		DeserializeData(AssetType, fromData, pointerPosition);
+		EAssetFileLayout layout = EAssetFileLayout::Legacy;
+		AssetType = DeserializeAssetType(fromData, pointerPosition, &layout);
 		DeserializeData(Name, fromData, pointerPosition);
 		DeserializeData(SourceData, fromData, pointerPosition);
 		DeserializeData(OriginalFormat, fromData, pointerPosition);
-		DeserializeData(Data, fromData, pointerPosition);
+		if (layout != EAssetFileLayout::Compressed)
+		{
+			DeserializeData(Data, fromData, pointerPosition);
+			return true;
+		}
+
+		std::vector<SCompressedChunk> chunks;
+		if (!DeserializeCompressedData(Data, fromData, fromDataSize, pointerPosition, outChunks != nullptr ? *outChunks : chunks))
+			return false;
+
+		return outChunks != nullptr || UCompression::DecompressChunks(chunks);
 	}
 
 	// TODO.NW: Rename to SMaterialFileHeader?
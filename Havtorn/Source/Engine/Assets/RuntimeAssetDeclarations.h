@@ -23,22 +23,69 @@ namespace Havtorn
 			: AssetType(assetFileData.AssetType)
 			, Name(assetFileData.Name)
 			, NumberOfMaterials(assetFileData.NumberOfMaterials)
+			, LODImportSettings(assetFileData.LODImportSettings)
 		{
-			for (auto& mesh : assetFileData.Meshes)
+			for (U32 i = 0; i < STATIC_U32(assetFileData.Meshes.size()); i++)
 			{
 				DrawCallData.emplace_back();
-				DrawCallData.back().IndexCount = STATIC_U32(mesh.Indices.size());
-				DrawCallData.back().MaterialIndex = STATIC_U16(mesh.MaterialIndex);
+				DrawCallData.back().IndexCount = STATIC_U32(assetFileData.GetIndices(0, i).size());
+				DrawCallData.back().MaterialIndex = STATIC_U16(assetFileData.Meshes[i].MaterialIndex);
+			}
+
+			for (U8 lodIndex = 1; lodIndex <= STATIC_U8(assetFileData.LODs.size()); lodIndex++)
+			{
+				const SStaticMeshLOD& lod = assetFileData.LODs[lodIndex - 1];
+				SStaticMeshLODDrawData& lodData = LODs.emplace_back();
+				lodData.ScreenSize = lod.ScreenSize;
+				for (U32 i = 0; i < STATIC_U32(lod.Meshes.size()); i++)
+				{
+					lodData.DrawCallData.emplace_back();
+					lodData.DrawCallData.back().IndexCount = STATIC_U32(assetFileData.GetIndices(lodIndex, i).size());
+					lodData.DrawCallData.back().MaterialIndex = STATIC_U16(lod.Meshes[i].MaterialIndex);
+				}
 			}
 		}
 
+		// Copies the coarsest LOD for the occlusion culler. Only done for meshes marked as occluders.
+		void AddOccluderGeometry(const SStaticModelFileHeader& assetFileData)
+		{
+			OccluderPositions.clear();
+			OccluderIndices.clear();
+
+			const U8 coarsestLODIndex = STATIC_U8(assetFileData.LODs.size());
+			for (U32 i = 0; i < STATIC_U32(assetFileData.Meshes.size()); i++)
+			{
+				const U32 indexOffset = STATIC_U32(OccluderPositions.size());
+				for (auto& vertex : assetFileData.GetVertices(coarsestLODIndex, i))
+					OccluderPositions.emplace_back(vertex.x, vertex.y, vertex.z);
+				for (const U32 index : assetFileData.GetIndices(coarsestLODIndex, i))
+					OccluderIndices.emplace_back(index + indexOffset);
+			}
+			HasOccluderGeometry = true;
+		}
+
+		struct SStaticMeshLODDrawData
+		{
+			F32 ScreenSize = 0.0f;
+			std::vector<SDrawCallData> DrawCallData = {};
+		};
+
 		EAssetType AssetType = EAssetType::StaticMesh;
 		std::string Name = "";
 		U8 NumberOfMaterials = 0;
+		// LOD0
 		std::vector<SDrawCallData> DrawCallData = {};
+		// LOD1 and onwards, sorted by descending screen size
+		std::vector<SStaticMeshLODDrawData> LODs = {};
+		SStaticMeshLODImportSettings LODImportSettings = {};
+		// CPU copy of the coarsest LOD, rasterized when the mesh is used as an occluder. Empty for other meshes.
+		std::vector<SVector> OccluderPositions = {};
+		std::vector<U32> OccluderIndices = {};
+		bool HasOccluderGeometry = false;
 		SVector BoundsMin = SVector(FLT_MAX);
 		SVector BoundsMax = SVector(-FLT_MAX);
 		SVector BoundsCenter = SVector(0.0f);
+		F32 BoundsRadius = 0.0f;
 	};
 
 	struct SSkeletalMeshAsset
@@ -52,11 +99,11 @@ namespace Havtorn
 			, BindPoseBones(assetFileData.BindPoseBones)
 			, Nodes(assetFileData.Nodes)
 		{
-			for (auto& mesh : assetFileData.Meshes)
+			for (U32 i = 0; i < STATIC_U32(assetFileData.Meshes.size()); i++)
 			{
 				DrawCallData.emplace_back();
-				DrawCallData.back().IndexCount = STATIC_U32(mesh.Indices.size());
-				DrawCallData.back().MaterialIndex = STATIC_U16(mesh.MaterialIndex);
+				DrawCallData.back().IndexCount = STATIC_U32(assetFileData.GetIndices(i).size());
+				DrawCallData.back().MaterialIndex = STATIC_U16(assetFileData.Meshes[i].MaterialIndex);
 			}
 		}
 
@@ -69,13 +116,15 @@ namespace Havtorn
 		SVector BoundsMin = SVector(FLT_MAX);
 		SVector BoundsMax = SVector(-FLT_MAX);
 		SVector BoundsCenter = SVector(0.0f);
+		F32 BoundsRadius = 0.0f;
 	};
 
 	struct SSkeletalAnimationAsset
 	{
 		SSkeletalAnimationAsset() = default;
 
-		explicit SSkeletalAnimationAsset(const SSkeletalAnimationFileHeader& assetFileData)
+		// Taken by value so the keyframes can be moved in when the file header isn't needed afterwards
+		explicit SSkeletalAnimationAsset(SSkeletalAnimationFileHeader assetFileData)
 			: AssetType(assetFileData.AssetType)
 			, Name(assetFileData.Name)
 			, RigPath(assetFileData.SourceData.AssetDependencyPath.AsString())
@@ -83,7 +132,7 @@ namespace Havtorn
 			, TickRate(assetFileData.TickRate)
 			, NumberOfTracks(assetFileData.NumberOfBones)
 			, ImportScale(assetFileData.SourceData.ImportScale)
-			, BoneAnimationTracks(assetFileData.BoneAnimationTracks)
+			, BoneAnimationTracks(std::move(assetFileData.BoneAnimationTracks))
 		{
 		}
 
@@ -165,6 +214,8 @@ namespace Havtorn
 
 		std::set<U64> Requesters = {};
 		SAssetData Data = std::monostate();
+		// Estimated bytes the asset keeps resident, mesh and texture data count once even though it lives on the GPU
+		U64 MemorySize = 0;
 
 		const bool IsValid() const { return Reference.IsValid() && Type != EAssetType::None; }
 	};
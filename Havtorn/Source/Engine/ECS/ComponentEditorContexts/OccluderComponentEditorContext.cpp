@@ -0,0 +1,54 @@
+// Copyright 2024 Team Havtorn. All Rights Reserved.
+
+#include "hvpch.h"
+#include "OccluderComponentEditorContext.h"
+
+#include "ECS/Components/OccluderComponent.h"
+#include "Scene/Scene.h"
+
+#include <GUI.h>
+
+namespace Havtorn
+{
+	SOccluderComponentEditorContext SOccluderComponentEditorContext::Context = {};
+
+    SComponentViewResult SOccluderComponentEditorContext::View(const SEntity& entityOwner, CScene* scene) const
+    {
+		if (!GUI::TryOpenComponentView("Occluder"))
+			return SComponentViewResult();
+
+		SOccluderComponent* occluderComp = scene->GetComponent<SOccluderComponent>(entityOwner);
+
+		GUI::PushID("##occluder");
+		GUI::Checkbox("Is Active", occluderComp->IsActive);
+		GUI::PopID();
+
+        return SComponentViewResult();
+    }
+
+	bool SOccluderComponentEditorContext::AddComponent(const SEntity& entity, CScene* scene) const
+	{
+		if (!GUI::Button("Occluder Component"))
+			return false;
+
+		if (scene == nullptr || !entity.IsValid())
+			return false;
+
+		scene->AddComponent<SOccluderComponent>(entity);
+		scene->AddComponentEditorContext(entity, &SOccluderComponentEditorContext::Context);
+		return true;
+	}
+
+	bool SOccluderComponentEditorContext::RemoveComponent(const SEntity& entity, CScene* scene) const
+	{
+		if (!GUI::Button("X##20"))
+			return false;
+
+		if (scene == nullptr || !entity.IsValid())
+			return false;
+
+		scene->RemoveComponent<SOccluderComponent>(entity);
+		scene->RemoveComponentEditorContext(entity, &SOccluderComponentEditorContext::Context);
+		return true;
+	}
+}
@@ -44,19 +44,86 @@ namespace Havtorn
 
 		GUI::Separator();
 		GUI::TextDisabled("Playing Animations:");
-		if (skeletalAnimationComp->PlayData.size() > 0)
+		for (U32 index = 0; index < STATIC_U32(skeletalAnimationComp->PlayData.size()); index++)
 		{
-			GUI::TextDisabled(std::string("A: " + UGeneralUtils::ExtractFileBaseNameFromPath(skeletalAnimationComp->AssetReferences[skeletalAnimationComp->PlayData[0].AssetReferenceIndex].FilePath)).c_str());
-			if (skeletalAnimationComp->PlayData.size() > 1)
+			SSkeletalAnimationPlayData& playData = skeletalAnimationComp->PlayData[index];
+			GUI::PushID(STATIC_I32(index));
+			GUI::TextDisabled(UGeneralUtils::ExtractFileBaseNameFromPath(skeletalAnimationComp->AssetReferences[playData.AssetReferenceIndex].FilePath).c_str());
+			if (!skeletalAnimationComp->Layers.empty())
 			{
-				GUI::TextDisabled(std::string("B: " + UGeneralUtils::ExtractFileBaseNameFromPath(skeletalAnimationComp->AssetReferences[skeletalAnimationComp->PlayData[1].AssetReferenceIndex].FilePath)).c_str());
+				I32 layerIndex = STATIC_I32(playData.LayerIndex);
 				GUI::PushItemWidth(100.0f);
-				GUI::SliderFloat("2D Blend A : B", skeletalAnimationComp->BlendValue, 0.0f, 1.0f);
+				if (GUI::InputInt("Layer", layerIndex, 1))
+					playData.LayerIndex = STATIC_U32(UMath::Clamp(layerIndex, 0, STATIC_I32(skeletalAnimationComp->Layers.size()) - 1));
 				GUI::PopItemWidth();
+				GUI::DragFloat2("Blend Position", playData.BlendPosition, 0.01f);
 			}
+			GUI::PopID();
 		}
-		else
+
+		if (skeletalAnimationComp->PlayData.empty())
 			GUI::TextDisabled("None");
+		else if (skeletalAnimationComp->Layers.empty() && skeletalAnimationComp->PlayData.size() > 1)
+		{
+			GUI::PushItemWidth(100.0f);
+			GUI::SliderFloat("Blend", skeletalAnimationComp->BlendValue, 0.0f, 1.0f);
+			GUI::PopItemWidth();
+		}
+
+		GUI::Separator();
+		GUI::TextDisabled("Layers");
+
+		GUI::SameLine();
+		if (GUI::Button("Add##Layer"))
+			skeletalAnimationComp->Layers.push_back(SSkeletalAnimationLayer());
+
+		GUI::SameLine();
+		if (GUI::Button("Clear##Layers"))
+		{
+			skeletalAnimationComp->Layers.clear();
+			for (SSkeletalAnimationPlayData& playData : skeletalAnimationComp->PlayData)
+				playData.LayerIndex = 0;
+		}
+
+		for (U32 index = 0; index < STATIC_U32(skeletalAnimationComp->Layers.size()); index++)
+		{
+			SSkeletalAnimationLayer& layer = skeletalAnimationComp->Layers[index];
+			GUI::PushID(STATIC_I32(index) + 1000);
+			GUI::TextDisabled("Layer %u", index);
+
+			bool isAdditive = layer.BlendMode == ESkeletalAnimationLayerBlendMode::Additive;
+			if (GUI::Checkbox("Additive", isAdditive))
+				layer.BlendMode = isAdditive ? ESkeletalAnimationLayerBlendMode::Additive : ESkeletalAnimationLayerBlendMode::Override;
+
+			GUI::PushItemWidth(100.0f);
+			GUI::SliderFloat("Weight", layer.Weight, 0.0f, 1.0f);
+			GUI::PopItemWidth();
+			GUI::DragFloat2("Blend Parameter", layer.BlendParameter, 0.01f);
+
+			for (U32 maskIndex = 0; maskIndex < STATIC_U32(layer.MaskRoots.size()); maskIndex++)
+			{
+				GUI::PushID(STATIC_I32(maskIndex));
+				if (GUI::InputText("Mask Root", layer.MaskRoots[maskIndex]))
+					layer.MaskNumberOfNodes = 0;
+
+				GUI::SameLine();
+				if (GUI::Button("X"))
+				{
+					layer.MaskRoots.erase(layer.MaskRoots.begin() + maskIndex);
+					layer.MaskNumberOfNodes = 0;
+					GUI::PopID();
+					break;
+				}
+				GUI::PopID();
+			}
+
+			if (GUI::Button("Add Mask Root"))
+			{
+				layer.MaskRoots.emplace_back();
+				layer.MaskNumberOfNodes = 0;
+			}
+			GUI::PopID();
+		}
 
 		GUI::Separator();
 
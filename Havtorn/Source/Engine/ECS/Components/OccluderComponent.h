@@ -0,0 +1,19 @@
+// Copyright 2022 Team Havtorn. All Rights Reserved.
+
+#pragma once
+#include "ECS/Component.h"
+
+namespace Havtorn
+{
+	// Marks the static mesh on the same entity as an occluder for software occlusion culling.
+	// The coarsest LOD of the mesh is what gets rasterized.
+	struct SOccluderComponent : public SComponent
+	{
+		SOccluderComponent() = default;
+		SOccluderComponent(const SEntity& entityOwner)
+			: SComponent(entityOwner)
+		{}
+
+		bool IsActive = true;
+	};
+}
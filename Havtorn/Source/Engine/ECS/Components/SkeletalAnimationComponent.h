@@ -14,9 +14,37 @@ namespace Havtorn
 			: AssetReferenceIndex(assetReferenceIndex)
 		{}
 
-		std::vector<SSkeletalPosedNode> LocalPosedNodes;
+		SSkeletalPose LocalPose;
+		// Per track of the animation
+		std::vector<SBoneTrackCursor> TrackCursors;
 		U32 AssetReferenceIndex = 0;
 		F32 CurrentAnimationTime = 0.0f;
+		// Index in SSkeletalAnimationComponent::Layers, 0 while it has none
+		U32 LayerIndex = 0;
+		// Where the animation sits in its layer's blend space
+		SVector2<F32> BlendPosition = SVector2<F32>::Zero;
+	};
+
+	enum class ESkeletalAnimationLayerBlendMode : U8
+	{
+		Override,
+		Additive
+	};
+
+	// Play data on a layer are weighted by how close their BlendPosition is to the layer's BlendParameter, along a line when
+	// every position is on one and by the surrounding triangle of positions otherwise. Layers are applied in order on top of each
+	// other, only to the nodes under their mask roots. Additive layers add how their animations move away from their first frame.
+	struct SSkeletalAnimationLayer
+	{
+		ESkeletalAnimationLayerBlendMode BlendMode = ESkeletalAnimationLayerBlendMode::Override;
+		SVector2<F32> BlendParameter = SVector2<F32>::Zero;
+		F32 Weight = 1.0f;
+		// Names of the nodes whose subtrees the layer affects, every node if empty
+		std::vector<std::string> MaskRoots;
+
+		// Resolved from MaskRoots when the mesh node count changes, reset MaskNumberOfNodes after editing them
+		std::vector<U32> MaskNodeIndices;
+		U64 MaskNumberOfNodes = 0;
 	};
 
 	struct SSkeletalAnimationComponent : public SComponent
@@ -39,7 +67,30 @@ namespace Havtorn
 		std::vector<SAssetReference> AssetReferences;
 		std::vector<SSkeletalAnimationPlayData> PlayData;
 
+		// Without any, every play data is on one override layer with BlendValue as its parameter
+		std::vector<SSkeletalAnimationLayer> Layers;
+
 		std::vector<SMatrix> Bones = {};
 		F32 BlendValue = 0.0f;
+
+		// Scratch for the blended pose, the second sample of resampled clips, additive layer changes and the model space transforms
+		// of every node. Not serialized, kept on the component so evaluating it reuses last frame's allocations, also on the job threads.
+		SSkeletalPose BlendedPose;
+		SSkeletalPose SamplePose;
+		SSkeletalPose AdditivePose;
+		std::vector<SMatrix> GlobalTransforms;
+
+		// Animation LOD state, kept by CAnimatorGraphSystem. Skeletons evaluated less than every frame are evaluated into
+		// TargetBones, Bones blends from PreviousBones towards them until the next evaluation.
+		std::vector<SMatrix> PreviousBones;
+		std::vector<SMatrix> TargetBones;
+		U32 FramesSinceUpdate = 0;
+		U32 UpdateInterval = 1;
+		bool IsAnimationCulled = false;
+
+		// Far away skeletons playing a baked clip skip evaluation and are drawn from this frame of the animation atlas,
+		// see UAnimationAtlas. Zero bones when Bones are used.
+		U32 AtlasFrameTexel = 0;
+		U32 AtlasNumberOfBones = 0;
 	};
 }
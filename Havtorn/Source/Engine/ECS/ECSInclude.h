@@ -61,5 +61,7 @@
 #include "ECS/ComponentEditorContexts/Physics3DControllerComponentEditorContext.h"
 #include "ECS/Components/UICanvasComponent.h"
 #include "ECS/ComponentEditorContexts/UICanvasComponentEditorContext.h"
+#include "ECS/Components/OccluderComponent.h"
+#include "ECS/ComponentEditorContexts/OccluderComponentEditorContext.h"
 #include "ECS/Components/DebugShapeComponent.h"
 #include "ECS/Components/MetaDataComponent.h"
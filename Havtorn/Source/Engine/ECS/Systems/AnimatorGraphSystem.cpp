@@ -5,21 +5,60 @@
 #include "Graphics/RenderManager.h"
 #include "ECS/Components/SkeletalAnimationComponent.h"
 #include "ECS/Components/SkeletalMeshComponent.h"
+#include "ECS/Components/TransformComponent.h"
+#include "ECS/Components/CameraComponent.h"
 #include "Scene/Scene.h"
+#include "Scene/World.h"
 #include "Assets/AssetRegistry.h"
 #include "Assets/RuntimeAssetDeclarations.h"
+#include "Graphics/SkeletalPose.h"
+#include "Graphics/AnimationAtlas.h"
+#include "Threading/ThreadManager.h"
+
+#include <FileSystem.h>
 
 namespace Havtorn
 {
+	// A clip baking on the job threads, with its own copies of what it reads
+	struct SPendingAnimationBake
+	{
+		U64 Key = 0;
+		U32 Generation = 0;
+		SSkeletalMeshAsset Mesh;
+		SSkeletalAnimationAsset Animation;
+		SSkeletalAnimationBinding Binding;
+		SBakedAnimationClip Clip;
+	};
+
 	CAnimatorGraphSystem::CAnimatorGraphSystem(CRenderManager* renderManager)
 		: ISystem()
 		, RenderManager(renderManager)
 	{
+		GEngine::GetAssetRegistry()->OnAssetReloaded.AddMember(this, &CAnimatorGraphSystem::OnAssetReloaded);
+
+		CJsonDocument config = UFileSystem::OpenJson(UFileSystem::EngineConfig);
+		ShouldResampleClips = config.Get<bool>("Resample Animation Clips", false);
+		IsAnimationLODEnabled = config.Get<bool>("Animation LOD", IsAnimationLODEnabled);
+		HalfRateScreenSize = config.Get<F32>("Animation LOD Half Rate Screen Size", HalfRateScreenSize);
+		QuarterRateScreenSize = config.Get<F32>("Animation LOD Quarter Rate Screen Size", QuarterRateScreenSize);
+		EighthRateScreenSize = config.Get<F32>("Animation LOD Eighth Rate Screen Size", EighthRateScreenSize);
+		UpdateBudget = config.Get<U32>("Animation Updates Per Frame", UpdateBudget);
+		PoseCacheSamplesPerSecond = config.Get<F32>("Animation Pose Cache Samples Per Second", PoseCacheSamplesPerSecond);
+		AtlasScreenSize = config.Get<F32>("Animation Atlas Screen Size", AtlasScreenSize);
+		AtlasSamplesPerSecond = config.Get<F32>("Animation Atlas Samples Per Second", AtlasSamplesPerSecond);
 	}
 
 	void CAnimatorGraphSystem::Update(std::vector<Ptr<CScene>>& scenes)
 	{
 		const F32 deltaTime = GTime::Dt();
+		Evaluations.clear();
+		ClipEvaluations.clear();
+		Stats = {};
+		PackBakedClips();
+		FrameIndex++;
+
+		SAnimationLODView lodView;
+		const bool isLODActive = IsAnimationLODEnabled && GetAnimationLODView(scenes, lodView);
 
 		for (Ptr<CScene>& scene : scenes)
 		{
@@ -33,229 +72,845 @@ namespace Havtorn
 					continue;
 
 				CAssetRegistry* assetRegistry = GEngine::GetAssetRegistry();
-				const SSkeletalMeshAsset* meshAsset = assetRegistry->RequestAssetData<SSkeletalMeshAsset>(mesh->AssetReference, component->Owner.GUID);
+				const SSkeletalMeshAsset* meshAsset = assetRegistry->RequestAssetDataAsync<SSkeletalMeshAsset>(mesh->AssetReference, EAssetLoadPriority::Normal, component->Owner.GUID);
+				if (meshAsset == nullptr)
+					continue;
 
-				component->Bones.clear();
 				F32 importScale = 1.0f;
+				bool areAnimationsLoaded = true;
+				const U32 numberOfLayers = component->Layers.empty() ? 1 : STATIC_U32(component->Layers.size());
+
+				SSkeletalAnimationEvaluation evaluation;
+				evaluation.Component = component;
+				evaluation.Mesh = meshAsset;
+				evaluation.FirstClip = STATIC_U32(ClipEvaluations.size());
+
+				const STransformComponent* transform = scene->GetComponent<STransformComponent>(component->Owner);
+				if (isLODActive && SComponent::IsValid(transform))
+					evaluation.UpdateInterval = SelectUpdateInterval(lodView, meshAsset, transform->Transform.GetMatrix(), evaluation.ScreenSize);
+
+				// Back in view it is evaluated right away and snaps to the pose, instead of blending from the one it left view with.
+				// The same coming closer than the atlas, its bones are from before it was drawn from there. Otherwise updates are
+				// spread over the interval's frames by entity, and made up for when deferred by the budget.
+				const bool isCulled = evaluation.UpdateInterval == 0;
+				if (!isCulled && (component->IsAnimationCulled || component->AtlasNumberOfBones > 0))
+					evaluation.UpdateInterval = 1;
+
+				// Picking a frame of the atlas needs the clip every frame
+				const bool isAtlasCandidate = !isCulled && AtlasScreenSize > 0.0f && evaluation.ScreenSize < AtlasScreenSize;
 
-				// Read local poses of playing animations
+				const bool isDue = !isCulled && ((FrameIndex + component->Owner.GUID) % evaluation.UpdateInterval == 0 || component->FramesSinceUpdate >= evaluation.UpdateInterval);
+				const F32 lookAheadTime = isDue ? STATIC_F32(evaluation.UpdateInterval - 1) * deltaTime : 0.0f;
+
+				// Advance playing animations, their local poses are read when the component is evaluated
 				for (SSkeletalAnimationPlayData& playData : component->PlayData)
 				{
-					if (!UMath::IsWithin(playData.AssetReferenceIndex, 0u, STATIC_U32(component->AssetReferences.size())))
+					if (!UMath::IsWithin(playData.AssetReferenceIndex, 0u, STATIC_U32(component->AssetReferences.size())) || playData.LayerIndex >= numberOfLayers)
 						continue;
 
-					const SSkeletalAnimationAsset* animationAsset = assetRegistry->RequestAssetData<SSkeletalAnimationAsset>(component->AssetReferences[playData.AssetReferenceIndex], component->Owner.GUID);
+					const SAssetReference& animationReference = component->AssetReferences[playData.AssetReferenceIndex];
+					const SSkeletalAnimationAsset* animationAsset = assetRegistry->RequestAssetDataAsync<SSkeletalAnimationAsset>(animationReference, EAssetLoadPriority::Normal, component->Owner.GUID);
 					if (animationAsset == nullptr)
+					{
+						areAnimationsLoaded = false;
 						continue;
+					}
 
 					importScale = animationAsset->ImportScale;
 
 					playData.CurrentAnimationTime = fmodf(playData.CurrentAnimationTime += deltaTime, animationAsset->DurationInTicks / STATIC_F32(animationAsset->TickRate));
+					if (!isDue && !isAtlasCandidate)
+						continue;
 
 					const F32 tickRate = animationAsset->TickRate != 0 ? STATIC_F32(animationAsset->TickRate): 24.0f;
-					const F32 animationTime = fmodf(playData.CurrentAnimationTime * tickRate, STATIC_F32(animationAsset->DurationInTicks));
 
-					playData.LocalPosedNodes = {};
-					ReadAnimationLocalPose(animationAsset, meshAsset, animationTime, meshAsset->Nodes[0], playData.LocalPosedNodes);
+					SSkeletalAnimationClipEvaluation& clip = ClipEvaluations.emplace_back();
+					clip.PlayData = &playData;
+					clip.Animation = animationAsset;
+					clip.Binding = &GetBinding(mesh->AssetReference.UID, meshAsset, animationReference.UID, animationAsset);
+					clip.ResampledClip = ShouldResampleClips ? &GetResampledClip(animationReference.UID, animationAsset) : nullptr;
+					clip.AnimationTime = fmodf((playData.CurrentAnimationTime + lookAheadTime) * tickRate, STATIC_F32(animationAsset->DurationInTicks));
+					clip.LayerIndex = playData.LayerIndex;
+
+					// The hierarchy and bone parts of a binding only depend on the mesh, so any of them will do for the blended pose
+					evaluation.Binding = clip.Binding;
 				}
-				
-				std::vector<SSkeletalPosedNode> posedNodes = {};
-				posedNodes.resize(meshAsset->Nodes.size());
-				
-				// Blend animations
-				if (component->PlayData.size() > 1)
+
+				// Keep last frame's bones until every playing animation has finished loading, blending needs all the poses
+				if (!areAnimationsLoaded)
 				{
-					// TODO.NW: Barycentric interpolation for more than 2 animations
+					ClipEvaluations.resize(evaluation.FirstClip);
+					continue;
+				}
 
-					for (U32 i = 0; i < posedNodes.size(); i++)
-					{
-						const SSkeletalPosedNode& posedNodeA = component->PlayData[0].LocalPosedNodes[i];
-						const SSkeletalPosedNode& posedNodeB = component->PlayData[1].LocalPosedNodes[i];
+				if (isCulled)
+				{
+					component->IsAnimationCulled = true;
+					Stats.NumberOfCulledSkeletons++;
+					continue;
+				}
+
+				if (isAtlasCandidate && SelectAtlasFrame(component, mesh->AssetReference.UID, meshAsset, evaluation.FirstClip))
+				{
+					ClipEvaluations.resize(evaluation.FirstClip);
+					Stats.NumberOfAtlasSkeletons++;
+					continue;
+				}
 
-						posedNodes[i].Name = meshAsset->Nodes[i].Name;
-						posedNodes[i].LocalTransform = SMatrix::Interpolate(posedNodeA.LocalTransform, posedNodeB.LocalTransform, component->BlendValue);
+				component->AtlasNumberOfBones = 0;
+				if (!isDue)
+				{
+					ClipEvaluations.resize(evaluation.FirstClip);
+					component->FramesSinceUpdate++;
+					if (component->PreviousBones.size() == component->TargetBones.size() && component->UpdateInterval > 1)
+					{
+						const F32 blendFactor = UMath::Min(STATIC_F32(component->FramesSinceUpdate + 1) / STATIC_F32(component->UpdateInterval), 1.0f);
+						USkeletalPose::BlendTransforms(component->PreviousBones, component->TargetBones, blendFactor, component->Bones);
+						Stats.NumberOfInterpolatedSkeletons++;
 					}
+					continue;
 				}
-				else if (component->PlayData.size() > 0)
+
+				// Nothing playing, bind pose
+				if (evaluation.Binding == nullptr)
 				{
-					posedNodes = component->PlayData[0].LocalPosedNodes;
+					component->Bones.assign(meshAsset->BindPoseBones.size(), SMatrix::Identity);
+					continue;
 				}
 
-				// Apply local pose and inverse bind transform
-				SMatrix root = SMatrix::Identity;
-				root.SetScale(importScale);
-				ApplyLocalPoseToHierarchy(meshAsset, posedNodes, meshAsset->Nodes[0], root);
+				WeighClips(evaluation, ClipEvaluations, BlendPositions, BlendWeights);
+				evaluation.RootTransform.SetScale(importScale);
+				Evaluations.emplace_back(evaluation);
+			}
+		}
 
-				component->Bones.resize(meshAsset->BindPoseBones.size(), SMatrix::Identity);
-				for (U32 i = 0; i < posedNodes.size(); i++)
+		if (UpdateBudget > 0 && Evaluations.size() > UpdateBudget)
+		{
+			// The longest waiting first, then the largest on screen. The rest keep their bones and wait a frame longer,
+			// which puts them first in line next frame. Their clip evaluations are left unused.
+			std::ranges::sort(Evaluations, [](const SSkeletalAnimationEvaluation& a, const SSkeletalAnimationEvaluation& b)
 				{
-					SSkeletalPosedNode& posedNode = posedNodes[i];
-					I32 boneIndex = -1;
-				
-					if (auto it = std::ranges::find(meshAsset->BindPoseBones, posedNode.Name, &SSkeletalMeshBone::Name); it != meshAsset->BindPoseBones.end())
-						boneIndex = STATIC_I32(std::distance(meshAsset->BindPoseBones.begin(), it));
+					if (a.Component->FramesSinceUpdate != b.Component->FramesSinceUpdate)
+						return a.Component->FramesSinceUpdate > b.Component->FramesSinceUpdate;
+					return a.ScreenSize > b.ScreenSize;
+				});
 
-					if (boneIndex < 0)
-						continue;
+			for (U64 i = UpdateBudget; i < Evaluations.size(); i++)
+				Evaluations[i].Component->FramesSinceUpdate++;
+
+			Stats.NumberOfDeferredSkeletons = STATIC_U32(Evaluations.size()) - UpdateBudget;
+			Evaluations.resize(UpdateBudget);
+		}
 
-					const SSkeletalMeshBone& bone = meshAsset->BindPoseBones[boneIndex];
-					component->Bones[boneIndex] = bone.InverseBindPoseTransform * posedNode.GlobalTransform;
+		for (const SSkeletalAnimationEvaluation& evaluation : Evaluations)
+		{
+			evaluation.Component->FramesSinceUpdate = 0;
+			evaluation.Component->UpdateInterval = evaluation.UpdateInterval;
+			evaluation.Component->IsAnimationCulled = false;
+		}
+
+		AssignPoseCache(PoseCache, Evaluations, ClipEvaluations, PoseCacheSamplesPerSecond);
+		Stats.NumberOfPoseCacheLookups = PoseCache.NumberOfLookups;
+		Stats.NumberOfSharedPoses = STATIC_U32(PoseCache.SharedPoses.size());
+		Stats.NumberOfEvaluatedSkeletons = STATIC_U32(Evaluations.size());
+
+		EvaluateComponents(Evaluations, ClipEvaluations, GEngine::GetThreadManager());
+		ApplySharedPoses(PoseCache);
+
+		if (IsAnimationAtlasDirty && RenderManager != nullptr)
+		{
+			RenderManager->WriteToAnimationDataTexture(AnimationAtlas);
+			IsAnimationAtlasDirty = false;
+		}
+	}
+
+	void CAnimatorGraphSystem::AssignPoseCache(SAnimationPoseCache& cache, std::vector<SSkeletalAnimationEvaluation>& evaluations, std::vector<SSkeletalAnimationClipEvaluation>& clips, const F32 samplesPerSecond)
+	{
+		cache.Entries.clear();
+		cache.SharedPoses.clear();
+		cache.NumberOfLookups = 0;
+		if (samplesPerSecond <= 0.0f)
+			return;
+
+		U64 numberOfEvaluated = 0;
+		for (U64 i = 0; i < evaluations.size(); i++)
+		{
+			const SSkeletalAnimationEvaluation& evaluation = evaluations[i];
+			const SSkeletalAnimationComponent* component = evaluation.Component;
+
+			// Only a single clip on a layer that replaces the whole pose, anything blended depends on more than the clip's time
+			if (evaluation.NumberOfClips == 1 && IsLayerWholePose(component, clips[evaluation.FirstClip].LayerIndex))
+			{
+				SSkeletalAnimationClipEvaluation& clip = clips[evaluation.FirstClip];
+				const F32 tickRate = clip.Animation->TickRate != 0 ? STATIC_F32(clip.Animation->TickRate) : 24.0f;
+				const F32 samplesPerTick = samplesPerSecond / tickRate;
+				const I64 timeIndex = STATIC_I64(std::lround(clip.AnimationTime * samplesPerTick));
+				clip.AnimationTime = fmodf(STATIC_F32(timeIndex) / samplesPerTick, STATIC_F32(clip.Animation->DurationInTicks));
+
+				const SAnimationPoseCache::SKey key = { clip.Binding, timeIndex, evaluation.UpdateInterval };
+				cache.NumberOfLookups++;
+				if (auto it = cache.Entries.find(key); it != cache.Entries.end())
+				{
+					cache.SharedPoses.push_back({ evaluation.Component, it->second, evaluation.UpdateInterval });
+					continue;
 				}
+
+				cache.Entries.emplace(key, component);
 			}
+
+			evaluations[numberOfEvaluated++] = evaluation;
 		}
+
+		evaluations.resize(numberOfEvaluated);
 	}
 
+	void CAnimatorGraphSystem::ApplySharedPoses(const SAnimationPoseCache& cache)
+	{
+		for (const SAnimationPoseCache::SSharedPose& sharedPose : cache.SharedPoses)
+		{
+			if (sharedPose.UpdateInterval <= 1)
+			{
+				sharedPose.Component->Bones = sharedPose.Source->Bones;
+				continue;
+			}
+
+			sharedPose.Component->TargetBones = sharedPose.Source->TargetBones;
+			BlendBonesTowardsTarget(sharedPose.Component, sharedPose.UpdateInterval);
+		}
+	}
 
-	void CAnimatorGraphSystem::BindEvaluateFunction(std::function<I16(CScene*, const SEntity&)>& function, const std::string& classAndFunctionName)
+	void CAnimatorGraphSystem::BlendBonesTowardsTarget(SSkeletalAnimationComponent* component, const U32 updateInterval)
 	{
-		U64 id = std::hash<std::string>{}(classAndFunctionName);
+		std::swap(component->PreviousBones, component->Bones);
+		if (component->PreviousBones.size() == component->TargetBones.size())
+			USkeletalPose::BlendTransforms(component->PreviousBones, component->TargetBones, 1.0f / STATIC_F32(updateInterval), component->Bones);
+		else
+			component->Bones = component->PreviousBones = component->TargetBones;
+	}
 
-		if (EvaluateFunctionMap.contains(id))
-			EvaluateFunctionMap.erase(id);
+	bool CAnimatorGraphSystem::IsLayerWholePose(const SSkeletalAnimationComponent* component, const U32 layerIndex)
+	{
+		if (component->Layers.empty())
+			return true;
 
-		EvaluateFunctionMap.emplace(id, function);
+		const SSkeletalAnimationLayer& layer = component->Layers[layerIndex];
+		return layer.BlendMode == ESkeletalAnimationLayerBlendMode::Override && layer.MaskRoots.empty() && layer.Weight >= 1.0f;
 	}
 
-	U64 FindRotation(F32 animationTime, const SBoneAnimationTrack& track)
+	bool CAnimatorGraphSystem::SelectAtlasFrame(SSkeletalAnimationComponent* component, const U32 meshUID, const SSkeletalMeshAsset* mesh, const U32 firstClip)
 	{
-		assert(track.RotationKeys.size() > 0);
+		if (ClipEvaluations.size() != firstClip + 1)
+			return false;
+
+		const SSkeletalAnimationClipEvaluation& clip = ClipEvaluations[firstClip];
+		if (!IsLayerWholePose(component, clip.LayerIndex))
+			return false;
+
+		const U32 animationUID = component->AssetReferences[clip.PlayData->AssetReferenceIndex].UID;
+		const SBakedAnimationClip& bakedClip = GetBakedClip(meshUID, mesh, animationUID, clip.Animation, *clip.Binding);
+		if (!bakedClip.IsInAtlas || bakedClip.NumberOfBones == 0)
+			return false;
+
+		// The closest frame, the one past the last is the first again
+		const U32 frame = STATIC_U32(std::lround(clip.PlayData->CurrentAnimationTime * bakedClip.SamplesPerSecond)) % bakedClip.NumberOfFrames;
+		component->AtlasFrameTexel = bakedClip.AtlasTexel + frame * bakedClip.NumberOfBones * UAnimationAtlas::TexelsPerBone;
+		component->AtlasNumberOfBones = bakedClip.NumberOfBones;
+		return true;
+	}
 
-		for (U64 i = 0; i < track.RotationKeys.size() - 1; i++)
+	bool CAnimatorGraphSystem::GetAnimationLODView(const std::vector<Ptr<CScene>>& scenes, SAnimationLODView& outView) const
+	{
+		const SEntity mainCamera = GEngine::GetWorld()->GetMainCamera();
+		if (!mainCamera.IsValid())
+			return false;
+
+		for (const Ptr<CScene>& scene : scenes)
 		{
-			if (animationTime < (F32)track.RotationKeys[i + 1].Time)
+			const SCameraComponent* cameraComp = scene->GetComponent<SCameraComponent>(mainCamera);
+			const STransformComponent* transformComp = scene->GetComponent<STransformComponent>(mainCamera);
+			if (!SComponent::IsValid(cameraComp) || !SComponent::IsValid(transformComp))
+				continue;
+
+			const SMatrix cameraMatrix = transformComp->Transform.GetMatrix();
+			const SMatrix viewProjection = cameraMatrix.FastInverse() * cameraComp->ProjectionMatrix;
+
+			// Positions are row vectors, so clip space X is the dot product with the first column and so on. Depth is 0 to W.
+			auto getColumn = [&viewProjection](const U8 column) { return SVector4(viewProjection.M[0][column], viewProjection.M[1][column], viewProjection.M[2][column], viewProjection.M[3][column]); };
+			const SVector4 x = getColumn(0);
+			const SVector4 y = getColumn(1);
+			const SVector4 z = getColumn(2);
+			const SVector4 w = getColumn(3);
+			const SVector4 planes[6] = { w + x, w - x, w + y, w - y, z, w - z };
+			for (U8 i = 0; i < 6; i++)
 			{
-				return i;
+				const F32 length = UMath::Max(SVector(planes[i].X, planes[i].Y, planes[i].Z).Length(), SMALL_NUMBER);
+				outView.FrustumPlanes[i] = planes[i] * (1.0f / length);
 			}
+
+			outView.Position = cameraMatrix.GetTranslation();
+			outView.TanHalfFOV = UMath::Tan(UMath::DegToRad(cameraComp->FOV) * 0.5f);
+			outView.ViewHeight = UMath::Max(cameraComp->ViewHeight, 0.0001f);
+			outView.IsOrthographic = cameraComp->ProjectionType == ECameraProjectionType::Orthographic;
+			return true;
 		}
 
-		// This is an 'ugly-fix'
-		// In short: bypasses the error by returning the last working key
-		return track.RotationKeys.size() - 2;
+		return false;
 	}
 
-	SQuaternion CalcInterpolatedRotation(F32 animationTime, const SBoneAnimationTrack& track)
+	U32 CAnimatorGraphSystem::SelectUpdateInterval(const SAnimationLODView& view, const SSkeletalMeshAsset* mesh, const SMatrix& meshTransform, F32& outScreenSize) const
 	{
-		if (track.RotationKeys.empty())
-			return SQuaternion::Identity;
+		// Bounds are the bind pose's, padded since animations reach outside them
+		constexpr F32 boundsPadding = 1.5f;
+
+		const SVector scale = meshTransform.GetScale();
+		const F32 radius = mesh->BoundsRadius * UMath::Max(scale.X, UMath::Max(scale.Y, scale.Z)) * boundsPadding;
+		const SVector center = (SVector4(mesh->BoundsCenter, 1.0f) * meshTransform).ToVector3();
 
-		// we need at least two values to interpolate...
-		if (track.RotationKeys.size() == 1)
+		for (const SVector4& plane : view.FrustumPlanes)
 		{
-			return track.RotationKeys[0].Value;
+			if (plane.X * center.X + plane.Y * center.Y + plane.Z * center.Z + plane.W < -radius)
+				return 0;
 		}
 
-		U64 rotationIndex = FindRotation(animationTime, track);
-		U64 nextRotationIndex = (rotationIndex + 1);
-		assert(nextRotationIndex < track.RotationKeys.size());
+		// Projected diameter over screen height, like static mesh LODs
+		const F32 distance = (center - view.Position).Length();
+		if (view.IsOrthographic)
+			outScreenSize = (2.0f * radius) / view.ViewHeight;
+		else
+			outScreenSize = distance <= radius ? 1.0f : radius / (distance * view.TanHalfFOV);
+
+		if (outScreenSize < EighthRateScreenSize)
+			return 8;
+		if (outScreenSize < QuarterRateScreenSize)
+			return 4;
+		if (outScreenSize < HalfRateScreenSize)
+			return 2;
+		return 1;
+	}
 
-		F32 deltaTime = static_cast<F32>(track.RotationKeys[nextRotationIndex].Time - track.RotationKeys[rotationIndex].Time);
+	void CAnimatorGraphSystem::WeighClips(SSkeletalAnimationEvaluation& evaluation, std::vector<SSkeletalAnimationClipEvaluation>& clips, std::vector<SVector2<F32>>& scratchPositions, std::vector<F32>& scratchWeights)
+	{
+		SSkeletalAnimationComponent* component = evaluation.Component;
+		const U32 numberOfLayers = component->Layers.empty() ? 1 : STATIC_U32(component->Layers.size());
+		for (U32 layerIndex = 0; layerIndex < numberOfLayers; layerIndex++)
+		{
+			scratchPositions.clear();
+			for (U64 i = evaluation.FirstClip; i < clips.size(); i++)
+			{
+				if (clips[i].LayerIndex == layerIndex)
+					scratchPositions.emplace_back(clips[i].PlayData->BlendPosition);
+			}
 
-		F32 factor = (animationTime - (F32)track.RotationKeys[rotationIndex].Time) / deltaTime;
-		factor = UMath::Clamp(factor);
+			if (scratchPositions.empty())
+				continue;
+
+			SSkeletalAnimationLayer* layer = component->Layers.empty() ? nullptr : &component->Layers[layerIndex];
+			const SVector2<F32> blendParameter = layer != nullptr ? layer->BlendParameter : SVector2<F32>(component->BlendValue, 0.0f);
+			const bool isLayerWeighted = layer == nullptr || layer->Weight > 0.0f;
+			CalculateBlendSpaceWeights(scratchPositions, blendParameter, scratchWeights);
+
+			U64 positionIndex = 0;
+			for (U64 i = evaluation.FirstClip; i < clips.size(); i++)
+			{
+				if (clips[i].LayerIndex == layerIndex)
+					clips[i].Weight = isLayerWeighted ? scratchWeights[positionIndex++] : 0.0f;
+			}
+
+			if (layer != nullptr && isLayerWeighted)
+				ResolveLayerMask(evaluation.Mesh, *evaluation.Binding, *layer);
+		}
+
+		// Clips without weight still advance their time, so they are in step when they blend back in, but are never sampled
+		clips.erase(std::remove_if(clips.begin() + evaluation.FirstClip, clips.end(), [](const SSkeletalAnimationClipEvaluation& clip) { return clip.Weight <= 0.0f; }), clips.end());
+		evaluation.NumberOfClips = STATIC_U32(clips.size()) - evaluation.FirstClip;
+	}
+
+	void CAnimatorGraphSystem::ResolveLayerMask(const SSkeletalMeshAsset* mesh, const SSkeletalAnimationBinding& binding, SSkeletalAnimationLayer& layer)
+	{
+		if (layer.MaskRoots.empty() || layer.MaskNumberOfNodes == mesh->Nodes.size())
+			return;
+
+		layer.MaskNodeIndices.clear();
+		layer.MaskNumberOfNodes = mesh->Nodes.size();
 
-		const SQuaternion& startRotationQ = track.RotationKeys[rotationIndex].Value;
-		const SQuaternion& endRotationQ = track.RotationKeys[nextRotationIndex].Value;
-		return SQuaternion::Slerp(startRotationQ, endRotationQ, factor).GetNormalized();
+		// Parents come first, so a node is masked if it is a root or its parent is
+		std::vector<bool> isMasked(mesh->Nodes.size(), false);
+		for (const U32 nodeIndex : binding.EvaluationOrder)
+		{
+			const I32 parentIndex = binding.ParentIndices[nodeIndex];
+			isMasked[nodeIndex] = (parentIndex >= 0 && isMasked[parentIndex]) || std::ranges::find(layer.MaskRoots, mesh->Nodes[nodeIndex].Name.AsString()) != layer.MaskRoots.end();
+			if (isMasked[nodeIndex])
+				layer.MaskNodeIndices.push_back(nodeIndex);
+		}
 	}
 
-	U64 FindScaling(F32 animationTime, const SBoneAnimationTrack& track)
+	void CAnimatorGraphSystem::CalculateBlendSpaceWeights(const std::vector<SVector2<F32>>& positions, const SVector2<F32>& parameter, std::vector<F32>& outWeights)
 	{
-		assert(track.ScaleKeys.size() > 0);
+		constexpr F32 minWeight = 0.001f;
+		constexpr F32 lineTolerance = 0.001f;
+		constexpr F32 triangleTolerance = 0.00001f;
+
+		const U64 numberOfPositions = positions.size();
+		outWeights.assign(numberOfPositions, 0.0f);
+		if (numberOfPositions == 0)
+			return;
+
+		bool areCoincident = true;
+		for (const SVector2<F32>& position : positions)
+			areCoincident = areCoincident && position.X == positions[0].X && position.Y == positions[0].Y;
 
-		for (U64 i = 0; i < track.ScaleKeys.size() - 1; i++)
+		auto getPosition = [&](const U64 i)
+			{
+				return areCoincident && numberOfPositions > 1 ? SVector2<F32>(STATIC_F32(i) / STATIC_F32(numberOfPositions - 1), 0.0f) : positions[i];
+			};
+
+		// The position farthest from the first one gives the direction of the line, if they are on one
+		const SVector2<F32> origin = getPosition(0);
+		SVector2<F32> direction = SVector2<F32>::Zero;
+		F32 lengthSquared = 0.0f;
+		for (U64 i = 1; i < numberOfPositions; i++)
 		{
-			if (animationTime < (F32)track.ScaleKeys[i + 1].Time)
+			const SVector2<F32> offset = getPosition(i) - origin;
+			const F32 offsetLengthSquared = offset.X * offset.X + offset.Y * offset.Y;
+			if (offsetLengthSquared > lengthSquared)
 			{
-				return i;
+				direction = offset;
+				lengthSquared = offsetLengthSquared;
 			}
 		}
 
-		// This is an 'ugly-fix'
-		// In short: bypasses the error by returning the last working key
-		return track.ScaleKeys.size() - 2;
+		if (lengthSquared <= SMALL_NUMBER)
+		{
+			outWeights[0] = 1.0f;
+			return;
+		}
+
+		bool isLine = true;
+		for (U64 i = 1; i < numberOfPositions && isLine; i++)
+		{
+			const F32 cross = direction.X * (getPosition(i).Y - origin.Y) - direction.Y * (getPosition(i).X - origin.X);
+			isLine = UMath::Abs(cross) <= lineTolerance * lengthSquared;
+		}
+
+		if (isLine)
+		{
+			// The closest positions on either side of the parameter along the line
+			auto getLinePosition = [&](const SVector2<F32>& position) { return ((position.X - origin.X) * direction.X + (position.Y - origin.Y) * direction.Y) / lengthSquared; };
+			const F32 parameterPosition = getLinePosition(parameter);
+
+			I64 below = -1;
+			I64 above = -1;
+			F32 belowPosition = 0.0f;
+			F32 abovePosition = 0.0f;
+			for (U64 i = 0; i < numberOfPositions; i++)
+			{
+				const F32 linePosition = getLinePosition(getPosition(i));
+				if (linePosition <= parameterPosition && (below < 0 || linePosition > belowPosition))
+				{
+					below = STATIC_I64(i);
+					belowPosition = linePosition;
+				}
+				if (linePosition >= parameterPosition && (above < 0 || linePosition < abovePosition))
+				{
+					above = STATIC_I64(i);
+					abovePosition = linePosition;
+				}
+			}
+
+			if (below < 0 || above < 0 || below == above || abovePosition - belowPosition <= SMALL_NUMBER)
+			{
+				outWeights[below < 0 ? above : below] = 1.0f;
+			}
+			else
+			{
+				const F32 factor = (parameterPosition - belowPosition) / (abovePosition - belowPosition);
+				outWeights[below] = 1.0f - factor;
+				outWeights[above] = factor;
+			}
+		}
+		else
+		{
+			// Barycentric weights in the smallest triangle around the parameter
+			F32 smallestArea = FLT_MAX;
+			for (U64 a = 0; a < numberOfPositions; a++)
+			{
+				for (U64 b = a + 1; b < numberOfPositions; b++)
+				{
+					for (U64 c = b + 1; c < numberOfPositions; c++)
+					{
+						const SVector2<F32> positionA = getPosition(a);
+						const SVector2<F32> edgeB = getPosition(b) - positionA;
+						const SVector2<F32> edgeC = getPosition(c) - positionA;
+						const SVector2<F32> toParameter = parameter - positionA;
+
+						const F32 determinant = edgeB.X * edgeC.Y - edgeC.X * edgeB.Y;
+						const F32 area = UMath::Abs(determinant);
+						if (area <= SMALL_NUMBER || area >= smallestArea)
+							continue;
+
+						const F32 weightB = (toParameter.X * edgeC.Y - edgeC.X * toParameter.Y) / determinant;
+						const F32 weightC = (edgeB.X * toParameter.Y - toParameter.X * edgeB.Y) / determinant;
+						const F32 weightA = 1.0f - weightB - weightC;
+						if (weightA < -triangleTolerance || weightB < -triangleTolerance || weightC < -triangleTolerance)
+							continue;
+
+						smallestArea = area;
+						outWeights.assign(numberOfPositions, 0.0f);
+						outWeights[a] = UMath::Max(weightA, 0.0f);
+						outWeights[b] = UMath::Max(weightB, 0.0f);
+						outWeights[c] = UMath::Max(weightC, 0.0f);
+					}
+				}
+			}
+
+			// Outside every triangle, along the closest edge
+			if (smallestArea == FLT_MAX)
+			{
+				F32 closestDistanceSquared = FLT_MAX;
+				for (U64 a = 0; a < numberOfPositions; a++)
+				{
+					for (U64 b = a + 1; b < numberOfPositions; b++)
+					{
+						const SVector2<F32> positionA = getPosition(a);
+						const SVector2<F32> edge = getPosition(b) - positionA;
+						const F32 edgeLengthSquared = edge.X * edge.X + edge.Y * edge.Y;
+						if (edgeLengthSquared <= SMALL_NUMBER)
+							continue;
+
+						const F32 factor = UMath::Clamp(((parameter.X - positionA.X) * edge.X + (parameter.Y - positionA.Y) * edge.Y) / edgeLengthSquared);
+						const F32 distanceX = positionA.X + edge.X * factor - parameter.X;
+						const F32 distanceY = positionA.Y + edge.Y * factor - parameter.Y;
+						const F32 distanceSquared = distanceX * distanceX + distanceY * distanceY;
+						if (distanceSquared >= closestDistanceSquared)
+							continue;
+
+						closestDistanceSquared = distanceSquared;
+						outWeights.assign(numberOfPositions, 0.0f);
+						outWeights[a] = 1.0f - factor;
+						outWeights[b] = factor;
+					}
+				}
+			}
+		}
+
+		F32 weightSum = 0.0f;
+		for (F32& weight : outWeights)
+		{
+			weight = weight < minWeight ? 0.0f : weight;
+			weightSum += weight;
+		}
+
+		for (F32& weight : outWeights)
+			weight /= weightSum;
 	}
 
-	SVector CalcInterpolatedScaling(F32 animationTime, const SBoneAnimationTrack& track)
+	void CAnimatorGraphSystem::EvaluateComponents(const std::vector<SSkeletalAnimationEvaluation>& evaluations, const std::vector<SSkeletalAnimationClipEvaluation>& clips, CThreadManager* threadManager)
 	{
-		if (track.ScaleKeys.empty())
-			return SVector(1.0f);
+		// Small enough that a few characters stay on the calling thread, large enough that a crowd has work for every job thread
+		constexpr U32 minEvaluationsPerJob = 8;
+
+		const U32 numberOfEvaluations = STATIC_U32(evaluations.size());
+		if (numberOfEvaluations == 0)
+			return;
+
+		const U32 maxNumberOfJobs = threadManager != nullptr ? STATIC_U32(threadManager->GetNumberOfThreads()) + 1 : 1;
+		const U32 numberOfJobs = UMath::Min(maxNumberOfJobs, (numberOfEvaluations + minEvaluationsPerJob - 1) / minEvaluationsPerJob);
 
-		if (track.ScaleKeys.size() == 1)
+		auto evaluateChunk = [&](const U32 jobIndex)
 		{
-			return track.ScaleKeys[0].Value;
+			const U32 first = STATIC_U32(STATIC_U64(numberOfEvaluations) * jobIndex / numberOfJobs);
+			const U32 last = STATIC_U32(STATIC_U64(numberOfEvaluations) * (jobIndex + 1) / numberOfJobs);
+			for (U32 i = first; i < last; i++)
+				EvaluateComponent(evaluations[i], clips);
+		};
+
+		if (threadManager != nullptr && numberOfJobs > 1)
+			threadManager->ParallelFor(numberOfJobs, evaluateChunk);
+		else
+			evaluateChunk(0);
+	}
+
+	void CAnimatorGraphSystem::EvaluateComponent(const SSkeletalAnimationEvaluation& evaluation, const std::vector<SSkeletalAnimationClipEvaluation>& clips)
+	{
+		SSkeletalAnimationComponent* component = evaluation.Component;
+		const SSkeletalAnimationBinding& binding = *evaluation.Binding;
+		const U32 firstClip = evaluation.FirstClip;
+		const U32 lastClip = evaluation.FirstClip + evaluation.NumberOfClips;
+
+		// Every layer accumulates into the one blended pose. A full weight override layer without a mask replaces it, which
+		// is all the base layer usually does, anything else starts from the rest pose so nodes no layer reaches stay in place.
+		SSkeletalPose& pose = component->BlendedPose;
+		bool isPoseInitialized = false;
+
+		const U32 numberOfLayers = component->Layers.empty() ? 1 : STATIC_U32(component->Layers.size());
+		for (U32 layerIndex = 0; layerIndex < numberOfLayers; layerIndex++)
+		{
+			const SSkeletalAnimationLayer* layer = component->Layers.empty() ? nullptr : &component->Layers[layerIndex];
+			const bool isMasked = layer != nullptr && !layer->MaskRoots.empty();
+			const bool isAdditive = layer != nullptr && layer->BlendMode == ESkeletalAnimationLayerBlendMode::Additive;
+			const F32 layerWeight = layer != nullptr ? UMath::Min(layer->Weight, 1.0f) : 1.0f;
+			const std::vector<U32>& nodeIndices = isMasked ? layer->MaskNodeIndices : binding.EvaluationOrder;
+
+			// Read local poses of the layer's animations, only for the nodes it affects
+			U32 numberOfLayerClips = 0;
+			const SSkeletalAnimationClipEvaluation* layerClips[2] = { nullptr, nullptr };
+			for (U32 i = firstClip; i < lastClip; i++)
+			{
+				const SSkeletalAnimationClipEvaluation& clip = clips[i];
+				if (clip.LayerIndex != layerIndex)
+					continue;
+
+				if (clip.ResampledClip != nullptr)
+					ReadResampledLocalPose(*clip.ResampledClip, *clip.Binding, clip.AnimationTime, nodeIndices, component->SamplePose, clip.PlayData->LocalPose);
+				else
+					ReadAnimationLocalPose(clip.Animation, *clip.Binding, clip.AnimationTime, nodeIndices, clip.PlayData->TrackCursors, clip.PlayData->LocalPose);
+
+				if (numberOfLayerClips < 2)
+					layerClips[numberOfLayerClips] = &clip;
+				numberOfLayerClips++;
+			}
+
+			if (numberOfLayerClips == 0 || nodeIndices.empty())
+				continue;
+
+			if (!isAdditive && !isMasked && layerWeight >= 1.0f && numberOfLayerClips <= 2)
+			{
+				if (numberOfLayerClips == 1)
+					pose = layerClips[0]->PlayData->LocalPose;
+				else
+					USkeletalPose::Blend(layerClips[0]->PlayData->LocalPose, layerClips[1]->PlayData->LocalPose, layerClips[1]->Weight / (layerClips[0]->Weight + layerClips[1]->Weight), pose);
+
+				isPoseInitialized = true;
+				continue;
+			}
+
+			if (!isPoseInitialized)
+			{
+				pose = binding.RestPose;
+				isPoseInitialized = true;
+			}
+
+			if (isAdditive)
+			{
+				SSkeletalPose& additivePose = component->AdditivePose;
+				additivePose.Resize(pose.Size());
+				USkeletalPose::Clear(nodeIndices, additivePose);
+				for (U32 i = firstClip; i < lastClip; i++)
+				{
+					if (clips[i].LayerIndex == layerIndex)
+						USkeletalPose::AccumulateAdditive(clips[i].PlayData->LocalPose, clips[i].Binding->ReferencePose, clips[i].Weight, nodeIndices, additivePose);
+				}
+				USkeletalPose::NormalizeRotations(nodeIndices, additivePose);
+				USkeletalPose::ApplyAdditive(additivePose, layerWeight, nodeIndices, pose);
+			}
+			else
+			{
+				USkeletalPose::Scale(1.0f - layerWeight, nodeIndices, pose);
+				for (U32 i = firstClip; i < lastClip; i++)
+				{
+					if (clips[i].LayerIndex == layerIndex)
+						USkeletalPose::Accumulate(clips[i].PlayData->LocalPose, clips[i].Weight * layerWeight, nodeIndices, pose);
+				}
+				USkeletalPose::NormalizeRotations(nodeIndices, pose);
+			}
 		}
 
-		U64 scalingIndex = FindScaling(animationTime, track);
-		U64 nextScalingIndex = (scalingIndex + 1);
-		assert(nextScalingIndex < track.ScaleKeys.size());
+		// Every layer weighted to nothing
+		if (!isPoseInitialized)
+			pose = binding.RestPose;
 
-		F32 deltaTime = static_cast<F32>(track.ScaleKeys[nextScalingIndex].Time - track.ScaleKeys[scalingIndex].Time);
+		if (pose.Size() != evaluation.Mesh->Nodes.size())
+		{
+			component->Bones.assign(evaluation.Mesh->BindPoseBones.size(), SMatrix::Identity);
+			return;
+		}
 
-		F32 factor = (animationTime - (F32)track.ScaleKeys[scalingIndex].Time) / deltaTime;
-		factor = UMath::Clamp(factor);
+		// Apply local pose and inverse bind transform
+		ApplyLocalPoseToHierarchy(binding, pose, evaluation.RootTransform, component->GlobalTransforms);
+		if (evaluation.UpdateInterval <= 1)
+		{
+			ApplyInverseBindPose(evaluation.Mesh, binding, component->GlobalTransforms, component->Bones);
+			return;
+		}
 
-		const SVector& startScaling = track.ScaleKeys[scalingIndex].Value;
-		const SVector& endScaling = track.ScaleKeys[nextScalingIndex].Value;
-		return startScaling * (1 - factor) + endScaling * factor;
+		// Evaluated ahead by the interval, bones start blending towards it from what they are now
+		ApplyInverseBindPose(evaluation.Mesh, binding, component->GlobalTransforms, component->TargetBones);
+		BlendBonesTowardsTarget(component, evaluation.UpdateInterval);
 	}
 
-	U64 FindPosition(F32 animationTime, const SBoneAnimationTrack& track)
+	const SSkeletalAnimationBinding& CAnimatorGraphSystem::GetBinding(const U32 meshUID, const SSkeletalMeshAsset* mesh, const U32 animationUID, const SSkeletalAnimationAsset* animation)
 	{
-		assert(track.TranslationKeys.size() > 0);
+		const U64 key = (STATIC_U64(meshUID) << 32) | STATIC_U64(animationUID);
+		SSkeletalAnimationBinding& binding = Bindings[key];
+		if (binding.ParentIndices.size() != mesh->Nodes.size() || binding.BoneNodeIndices.size() != mesh->BindPoseBones.size() || binding.NumberOfTracks != animation->BoneAnimationTracks.size())
+			BuildBinding(mesh, animation, binding);
 
-		for (U64 i = 0; i < track.TranslationKeys.size() - 1; i++)
+		return binding;
+	}
+
+	void CAnimatorGraphSystem::BuildBinding(const SSkeletalMeshAsset* mesh, const SSkeletalAnimationAsset* animation, SSkeletalAnimationBinding& outBinding)
+	{
+		outBinding = {};
+		outBinding.NumberOfTracks = animation->BoneAnimationTracks.size();
+		outBinding.ParentIndices.assign(mesh->Nodes.size(), -1);
+		outBinding.TrackIndices.assign(mesh->Nodes.size(), -1);
+		outBinding.BoneNodeIndices.assign(mesh->BindPoseBones.size(), -1);
+		outBinding.RestPose.Resize(mesh->Nodes.size());
+		for (U64 i = 0; i < mesh->Nodes.size(); i++)
+			SMatrix::Decompose(mesh->Nodes[i].NodeTransform, outBinding.RestPose.Translations[i], outBinding.RestPose.Rotations[i], outBinding.RestPose.Scales[i]);
+
+		if (mesh->Nodes.empty())
+			return;
+
+		// The first track or bone with a name wins, like the name lookups this replaces
+		std::unordered_map<std::string, I32> trackIndices;
+		for (U64 i = 0; i < animation->BoneAnimationTracks.size(); i++)
+			trackIndices.emplace(animation->BoneAnimationTracks[i].TrackName.AsString(), STATIC_I32(i));
+
+		std::unordered_map<std::string, I32> boneIndices;
+		for (U64 i = 0; i < mesh->BindPoseBones.size(); i++)
+			boneIndices.emplace(mesh->BindPoseBones[i].Name.AsString(), STATIC_I32(i));
+
+		// Depth first from the root, children in order
+		std::vector<U32> nodeStack = { 0 };
+		while (!nodeStack.empty())
 		{
-			if (animationTime < (F32)track.TranslationKeys[i + 1].Time)
+			const U32 nodeIndex = nodeStack.back();
+			nodeStack.pop_back();
+			outBinding.EvaluationOrder.push_back(nodeIndex);
+
+			const std::string nodeName = mesh->Nodes[nodeIndex].Name.AsString();
+			if (auto it = trackIndices.find(nodeName); it != trackIndices.end())
+				outBinding.TrackIndices[nodeIndex] = it->second;
+
+			if (auto it = boneIndices.find(nodeName); it != boneIndices.end())
+				outBinding.BoneNodeIndices[it->second] = STATIC_I32(nodeIndex);
+
+			const std::vector<U32>& childIndices = mesh->Nodes[nodeIndex].ChildIndices;
+			for (auto it = childIndices.rbegin(); it != childIndices.rend(); ++it)
 			{
-				return i;
+				outBinding.ParentIndices[*it] = STATIC_I32(nodeIndex);
+				nodeStack.push_back(*it);
 			}
 		}
 
-		// This is an 'ugly-fix'
-		// In short: bypasses the error by returning the last working key
-		return track.TranslationKeys.size() - 2;
+		std::vector<SBoneTrackCursor> cursors;
+		ReadAnimationLocalPose(animation, outBinding, 0.0f, outBinding.EvaluationOrder, cursors, outBinding.ReferencePose);
 	}
 
-	SVector CalcInterpolatedPosition(F32 animationTime, const SBoneAnimationTrack& track)
+	void CAnimatorGraphSystem::OnAssetReloaded(const std::string& assetPath)
 	{
-		if (track.TranslationKeys.empty())
-			return SVector::Zero;
+		const U32 uid = SAssetReference(assetPath).UID;
+		std::erase_if(Bindings, [uid](const auto& entry) { return STATIC_U32(entry.first >> 32) == uid || STATIC_U32(entry.first) == uid; });
+		ResampledClips.erase(uid);
 
-		// we need at least two values to interpolate...
-		if (track.TranslationKeys.size() == 1)
+		// Packed back to back, so removing one clip would move the others. Rebaking is rare enough to start over.
+		if (!BakedClips.empty())
 		{
-			return track.TranslationKeys[0].Value;
+			BakedClips.clear();
+			AnimationAtlas.clear();
+			IsAnimationAtlasDirty = true;
+			AtlasGeneration++;
 		}
+	}
 
-		U64 positionIndex = FindPosition(animationTime, track);
-		U64 nextPositionIndex = (positionIndex + 1);
-		assert(nextPositionIndex < track.TranslationKeys.size());
 
-		F32 deltaTime = static_cast<F32>(track.TranslationKeys[nextPositionIndex].Time - track.TranslationKeys[positionIndex].Time);
+	void CAnimatorGraphSystem::BindEvaluateFunction(std::function<I16(CScene*, const SEntity&)>& function, const std::string& classAndFunctionName)
+	{
+		U64 id = std::hash<std::string>{}(classAndFunctionName);
 
-		F32 factor = (animationTime - (F32)track.TranslationKeys[positionIndex].Time) / deltaTime;
-		factor = UMath::Clamp(factor);
+		if (EvaluateFunctionMap.contains(id))
+			EvaluateFunctionMap.erase(id);
 
-		const SVector& startPosition = track.TranslationKeys[positionIndex].Value;
-		const SVector& endPosition = track.TranslationKeys[nextPositionIndex].Value;
-		return startPosition * (1 - factor) + endPosition * factor;
+		EvaluateFunctionMap.emplace(id, function);
 	}
 
-	void CAnimatorGraphSystem::ApplyLocalPoseToHierarchy(const SSkeletalMeshAsset* mesh, std::vector<SSkeletalPosedNode>& in, const SSkeletalMeshNode& node, const SMatrix& parentTransform)
+	namespace
 	{
-		SMatrix nodeTransform = node.NodeTransform;
+		// Index of the key starting the segment animationTime is in, clamped to the first and last segment. Steps forward from
+		// the cursor, which is all normal playback needs, and falls back to a binary search after a seek or loop.
+		template<typename TKey>
+		U64 FindKey(const std::vector<TKey>& keys, const F32 animationTime, U32& cursor)
+		{
+			constexpr U64 maxSteps = 4;
+			const U64 lastSegment = keys.size() - 2;
+
+			U64 index = UMath::Min(STATIC_U64(cursor), lastSegment);
+			if (index == 0 || !(animationTime < keys[index].Time))
+			{
+				for (U64 step = 0; step < maxSteps && index < lastSegment && !(animationTime < keys[index + 1].Time); step++)
+					index++;
 
-		auto it = std::ranges::find(in, node.Name, &SSkeletalPosedNode::Name);
-		if (it != in.end())
-			nodeTransform = it->LocalTransform;
+				if (index == lastSegment || animationTime < keys[index + 1].Time)
+				{
+					cursor = STATIC_U32(index);
+					return index;
+				}
+			}
 
-		SMatrix globalTransform = nodeTransform * parentTransform;
+			// The number of keys after the first, up to the last segment, that start at or before animationTime
+			const auto it = std::upper_bound(keys.begin() + 1, keys.begin() + lastSegment + 1, animationTime, [](const F32 time, const TKey& key) { return time < key.Time; });
+			index = STATIC_U64(std::distance(keys.begin() + 1, it));
+			cursor = STATIC_U32(index);
+			return index;
+		}
 
-		if (it != in.end())
-			it->GlobalTransform = globalTransform;
+		SVector InterpolateKeys(const SVector& a, const SVector& b, const F32 factor)
+		{
+			return a * (1 - factor) + b * factor;
+		}
 
-		for (auto childNodeIndex : node.ChildIndices)
-			ApplyLocalPoseToHierarchy(mesh, in, mesh->Nodes[childNodeIndex], globalTransform);
+		SQuaternion InterpolateKeys(const SQuaternion& a, const SQuaternion& b, const F32 factor)
+		{
+			return SQuaternion::Slerp(a, b, factor).GetNormalized();
+		}
+
+		template<typename TKey, typename TFindKey>
+		decltype(TKey::Value) SampleKeys(const std::vector<TKey>& keys, const F32 animationTime, const decltype(TKey::Value)& defaultValue, TFindKey findKey)
+		{
+			if (keys.empty())
+				return defaultValue;
+
+			// we need at least two values to interpolate...
+			if (keys.size() == 1)
+				return keys[0].Value;
+
+			const U64 index = findKey(keys);
+			const F32 deltaTime = keys[index + 1].Time - keys[index].Time;
+			const F32 factor = UMath::Clamp((animationTime - keys[index].Time) / deltaTime);
+			return InterpolateKeys(keys[index].Value, keys[index + 1].Value, factor);
+		}
+
+		void SampleTrack(const SBoneAnimationTrack& track, const F32 animationTime, SBoneTrackCursor& cursor, SVector& outTranslation, SQuaternion& outRotation, SVector& outScale)
+		{
+			outTranslation = SampleKeys(track.TranslationKeys, animationTime, SVector::Zero, [&](const auto& keys) { return FindKey(keys, animationTime, cursor.TranslationKey); });
+			outRotation = SampleKeys(track.RotationKeys, animationTime, SQuaternion::Identity, [&](const auto& keys) { return FindKey(keys, animationTime, cursor.RotationKey); });
+			outScale = SampleKeys(track.ScaleKeys, animationTime, SVector(1.0f), [&](const auto& keys) { return FindKey(keys, animationTime, cursor.ScaleKey); });
+		}
+	}
+
+	void CAnimatorGraphSystem::ApplyLocalPoseToHierarchy(const SSkeletalAnimationBinding& binding, const SSkeletalPose& localPose, const SMatrix& rootTransform, std::vector<SMatrix>& outGlobalTransforms)
+	{
+		// Local transforms of every node first, then turned into global ones in place, parents before their children
+		USkeletalPose::ComposeTransforms(localPose, outGlobalTransforms);
+		for (const U32 nodeIndex : binding.EvaluationOrder)
+		{
+			const I32 parentIndex = binding.ParentIndices[nodeIndex];
+			USkeletalPose::Multiply(outGlobalTransforms[nodeIndex], parentIndex < 0 ? rootTransform : outGlobalTransforms[parentIndex], outGlobalTransforms[nodeIndex]);
+		}
+	}
+
+	void CAnimatorGraphSystem::ApplyInverseBindPose(const SSkeletalMeshAsset* mesh, const SSkeletalAnimationBinding& binding, const std::vector<SMatrix>& globalTransforms, std::vector<SMatrix>& outBones)
+	{
+		outBones.resize(mesh->BindPoseBones.size());
+		for (U64 boneIndex = 0; boneIndex < outBones.size(); boneIndex++)
+		{
+			const I32 nodeIndex = binding.BoneNodeIndices[boneIndex];
+			if (nodeIndex < 0)
+				outBones[boneIndex] = SMatrix::Identity;
+			else
+				USkeletalPose::Multiply(mesh->BindPoseBones[boneIndex].InverseBindPoseTransform, globalTransforms[nodeIndex], outBones[boneIndex]);
+		}
 	}
 
 	std::vector<SMatrix> CAnimatorGraphSystem::ReadAssetAnimationPose(const std::string& animationFile, const F32 animationTime)
@@ -271,67 +926,205 @@ namespace Havtorn
 		F32 duration = STATIC_F32(animationAsset->DurationInTicks);
 		F32 time = fmodf(timeInTicks, duration);
 
-		std::vector<SSkeletalPosedNode> posedNodes = {};
-
-		ReadAnimationLocalPose(animationAsset, meshAsset, time, meshAsset->Nodes[0], posedNodes);
+		const SSkeletalAnimationBinding& binding = GetBinding(SAssetReference(animationAsset->RigPath).UID, meshAsset, SAssetReference(animationFile).UID, animationAsset);
+		SSkeletalPose localPose;
+		std::vector<SBoneTrackCursor> cursors;
+		ReadAnimationLocalPose(animationAsset, binding, time, binding.EvaluationOrder, cursors, localPose);
 		SMatrix root;
 		root.SetScale(animationAsset->ImportScale);
-		ApplyLocalPoseToHierarchy(meshAsset, posedNodes, meshAsset->Nodes[0], root);
+		std::vector<SMatrix> globalTransforms;
+		ApplyLocalPoseToHierarchy(binding, localPose, root, globalTransforms);
 
 		std::vector<SMatrix> transforms;
-		transforms.resize(meshAsset->BindPoseBones.size());
+		ApplyInverseBindPose(meshAsset, binding, globalTransforms, transforms);
 
-		//Apply Inverse Bind Transform
-		for (U32 i = 0; i < posedNodes.size(); i++)
-		{
-			SSkeletalPosedNode& posedNode = posedNodes[i];
-			I32 boneIndex = -1;
+		assetRegistry->UnrequestAsset(SAssetReference(animationAsset->RigPath), CAssetRegistry::EditorManagerRequestID);
+		assetRegistry->UnrequestAsset(SAssetReference(animationFile), CAssetRegistry::EditorManagerRequestID);
 
-			if (auto it = std::ranges::find(meshAsset->BindPoseBones, posedNode.Name, &SSkeletalMeshBone::Name); it != meshAsset->BindPoseBones.end())
-				boneIndex = STATIC_I32(std::distance(meshAsset->BindPoseBones.begin(), it));
+		return transforms;
+	}
 
-			if (boneIndex < 0)
+	void CAnimatorGraphSystem::ReadAnimationLocalPose(const SSkeletalAnimationAsset* animation, const SSkeletalAnimationBinding& binding, const F32 animationTime, const std::vector<U32>& nodeIndices, std::vector<SBoneTrackCursor>& cursors, SSkeletalPose& outPose)
+	{
+		outPose.Resize(binding.RestPose.Size());
+		cursors.resize(animation->BoneAnimationTracks.size());
+		for (const U32 nodeIndex : nodeIndices)
+		{
+			const I32 trackIndex = binding.TrackIndices[nodeIndex];
+			if (trackIndex < 0)
+			{
+				outPose.Translations[nodeIndex] = binding.RestPose.Translations[nodeIndex];
+				outPose.Rotations[nodeIndex] = binding.RestPose.Rotations[nodeIndex];
+				outPose.Scales[nodeIndex] = binding.RestPose.Scales[nodeIndex];
 				continue;
+			}
 
-			SSkeletalMeshBone& bone = meshAsset->BindPoseBones[boneIndex];
-			transforms[boneIndex] = bone.InverseBindPoseTransform * posedNode.GlobalTransform;
+			SampleTrack(animation->BoneAnimationTracks[trackIndex], animationTime, cursors[trackIndex], outPose.Translations[nodeIndex], outPose.Rotations[nodeIndex], outPose.Scales[nodeIndex]);
 		}
+	}
 
-		assetRegistry->UnrequestAsset(SAssetReference(animationAsset->RigPath), CAssetRegistry::EditorManagerRequestID);
-		assetRegistry->UnrequestAsset(SAssetReference(animationFile), CAssetRegistry::EditorManagerRequestID);
+	void CAnimatorGraphSystem::ReadResampledLocalPose(const SResampledAnimationClip& clip, const SSkeletalAnimationBinding& binding, const F32 animationTime, const std::vector<U32>& nodeIndices, SSkeletalPose& scratchPose, SSkeletalPose& outPose)
+	{
+		outPose.Resize(binding.RestPose.Size());
+		scratchPose.Resize(binding.RestPose.Size());
+
+		// Same segment and factor for every track
+		const F32 samplePosition = UMath::Max(animationTime * clip.SamplesPerTick, 0.0f);
+		const U64 lastSample = clip.NumberOfSamples > 0 ? clip.NumberOfSamples - 1 : 0;
+		const U64 sampleIndex = UMath::Min(STATIC_U64(samplePosition), lastSample > 0 ? lastSample - 1 : 0);
+		const U64 nextSampleIndex = UMath::Min(sampleIndex + 1, lastSample);
+		const F32 factor = UMath::Clamp(samplePosition - STATIC_F32(sampleIndex));
+
+		// Gathers the samples on either side, then blends every node between them in one batch. Nodes outside nodeIndices
+		// are blended too, between whatever they held before, which is cheaper than skipping them one by one.
+		for (const U32 nodeIndex : nodeIndices)
+		{
+			const I32 trackIndex = binding.TrackIndices[nodeIndex];
+			if (trackIndex < 0 || STATIC_U64(trackIndex) >= clip.NumberOfTracks || clip.NumberOfSamples == 0)
+			{
+				outPose.Translations[nodeIndex] = scratchPose.Translations[nodeIndex] = binding.RestPose.Translations[nodeIndex];
+				outPose.Rotations[nodeIndex] = scratchPose.Rotations[nodeIndex] = binding.RestPose.Rotations[nodeIndex];
+				outPose.Scales[nodeIndex] = scratchPose.Scales[nodeIndex] = binding.RestPose.Scales[nodeIndex];
+				continue;
+			}
 
-		return transforms;
+			const U64 a = STATIC_U64(trackIndex) * clip.NumberOfSamples + sampleIndex;
+			const U64 b = STATIC_U64(trackIndex) * clip.NumberOfSamples + nextSampleIndex;
+			outPose.Translations[nodeIndex] = clip.Translations[a];
+			outPose.Rotations[nodeIndex] = clip.Rotations[a];
+			outPose.Scales[nodeIndex] = clip.Scales[a];
+			scratchPose.Translations[nodeIndex] = clip.Translations[b];
+			scratchPose.Rotations[nodeIndex] = clip.Rotations[b];
+			scratchPose.Scales[nodeIndex] = clip.Scales[b];
+		}
+
+		USkeletalPose::Blend(outPose, scratchPose, factor, outPose);
 	}
 
-	void CAnimatorGraphSystem::ReadAnimationLocalPose(const SSkeletalAnimationAsset* animation, const SSkeletalMeshAsset* mesh, const F32 animationTime, const SSkeletalMeshNode& fromNode, std::vector<SSkeletalPosedNode>& posedNodes)
+	void CAnimatorGraphSystem::ResampleClip(const SSkeletalAnimationAsset* animation, const F32 samplesPerTick, SResampledAnimationClip& outClip)
 	{
-		SMatrix nodeTransform = fromNode.NodeTransform;
-		// TODO.NW: Streamline this so we can read the local pose of different animations at the same time, then combine them at the end
-		const std::string nodeName = fromNode.Name.AsString();
+		outClip = {};
+		outClip.SamplesPerTick = samplesPerTick;
+		outClip.NumberOfSamples = STATIC_U32(UMath::Ceil(STATIC_F32(animation->DurationInTicks) * samplesPerTick)) + 1;
+		outClip.NumberOfTracks = animation->BoneAnimationTracks.size();
 
-		posedNodes.emplace_back(SSkeletalPosedNode{});
-		posedNodes.back().Name = fromNode.Name;
+		const U64 numberOfSamples = outClip.NumberOfTracks * outClip.NumberOfSamples;
+		outClip.Translations.resize(numberOfSamples);
+		outClip.Rotations.resize(numberOfSamples);
+		outClip.Scales.resize(numberOfSamples);
 
-		const std::vector<SBoneAnimationTrack>& tracks = animation->BoneAnimationTracks;
-		if (auto it = std::ranges::find(tracks, nodeName, &SBoneAnimationTrack::TrackName); it != tracks.end())
+		for (U64 trackIndex = 0; trackIndex < outClip.NumberOfTracks; trackIndex++)
 		{
-			const SBoneAnimationTrack& track = *it;
+			SBoneTrackCursor cursor;
+			for (U32 sampleIndex = 0; sampleIndex < outClip.NumberOfSamples; sampleIndex++)
+			{
+				const U64 i = trackIndex * outClip.NumberOfSamples + sampleIndex;
+				SampleTrack(animation->BoneAnimationTracks[trackIndex], STATIC_F32(sampleIndex) / samplesPerTick, cursor, outClip.Translations[i], outClip.Rotations[i], outClip.Scales[i]);
+			}
+		}
+	}
+
+	const SResampledAnimationClip& CAnimatorGraphSystem::GetResampledClip(const U32 animationUID, const SSkeletalAnimationAsset* animation)
+	{
+		SResampledAnimationClip& clip = ResampledClips[animationUID];
+		if (clip.NumberOfSamples == 0 || clip.NumberOfTracks != animation->BoneAnimationTracks.size())
+			ResampleClip(animation, 1.0f, clip);
 
-			const SVector scaling = CalcInterpolatedScaling(animationTime, track);
-			const SQuaternion rotation = CalcInterpolatedRotation(animationTime, track);
-			const SVector translation = CalcInterpolatedPosition(animationTime, track);
+		return clip;
+	}
 
-			SMatrix::Recompose(translation, rotation, scaling, nodeTransform);
-			posedNodes.back().LocalTransform = nodeTransform;
+	void CAnimatorGraphSystem::BakeClip(const SSkeletalMeshAsset* mesh, const SSkeletalAnimationAsset* animation, const SSkeletalAnimationBinding& binding, const F32 samplesPerSecond, SBakedAnimationClip& outClip)
+	{
+		const F32 tickRate = animation->TickRate != 0 ? STATIC_F32(animation->TickRate) : 24.0f;
+		const F32 duration = STATIC_F32(animation->DurationInTicks);
+
+		outClip = {};
+		outClip.SamplesPerSecond = UMath::Max(samplesPerSecond, 1.0f);
+		outClip.NumberOfFrames = UMath::Max(STATIC_U32(std::ceil(duration / tickRate * outClip.SamplesPerSecond)), 1u);
+		outClip.NumberOfBones = STATIC_U32(mesh->BindPoseBones.size());
+		outClip.Halves.reserve(STATIC_U64(outClip.NumberOfFrames) * outClip.NumberOfBones * UAnimationAtlas::TexelsPerBone * UAnimationAtlas::HalvesPerTexel);
+
+		SMatrix rootTransform = SMatrix::Identity;
+		rootTransform.SetScale(animation->ImportScale);
+
+		SSkeletalPose localPose;
+		std::vector<SBoneTrackCursor> cursors;
+		std::vector<SMatrix> globalTransforms;
+		std::vector<SMatrix> bones;
+		for (U32 frame = 0; frame < outClip.NumberOfFrames; frame++)
+		{
+			// Fresh cursors, so a frame doesn't depend on the ones baked before it
+			cursors.clear();
+			const F32 animationTime = duration > 0.0f ? fmodf(STATIC_F32(frame) / outClip.SamplesPerSecond * tickRate, duration) : 0.0f;
+			ReadAnimationLocalPose(animation, binding, animationTime, binding.EvaluationOrder, cursors, localPose);
+			ApplyLocalPoseToHierarchy(binding, localPose, rootTransform, globalTransforms);
+			ApplyInverseBindPose(mesh, binding, globalTransforms, bones);
+			UAnimationAtlas::EncodeBones(bones, outClip.Halves);
 		}
+	}
+
+	const SBakedAnimationClip& CAnimatorGraphSystem::GetBakedClip(const U32 meshUID, const SSkeletalMeshAsset* mesh, const U32 animationUID, const SSkeletalAnimationAsset* animation, const SSkeletalAnimationBinding& binding)
+	{
+		const U64 key = (STATIC_U64(meshUID) << 32) | STATIC_U64(animationUID);
+		if (auto it = BakedClips.find(key); it != BakedClips.end())
+			return it->second;
+
+		// Claimed right away so the pair is only baked once. The bake works on copies, the assets can reload while it runs.
+		SBakedAnimationClip& clip = BakedClips[key];
+		auto bake = std::make_shared<SPendingAnimationBake>();
+		bake->Key = key;
+		bake->Generation = AtlasGeneration;
+		bake->Mesh = *mesh;
+		bake->Animation = *animation;
+		bake->Binding = binding;
+
+		auto job = [this, bake, samplesPerSecond = AtlasSamplesPerSecond]()
+			{
+				BakeClip(&bake->Mesh, &bake->Animation, bake->Binding, samplesPerSecond, bake->Clip);
+
+				std::unique_lock lock(FinishedBakesMutex);
+				FinishedBakes.push_back(bake);
+			};
+
+		if (CThreadManager* threadManager = GEngine::GetThreadManager(); threadManager != nullptr)
+			threadManager->PushJob(job);
 		else
+			job();
+
+		return clip;
+	}
+
+	void CAnimatorGraphSystem::PackBakedClips()
+	{
+		std::vector<std::shared_ptr<SPendingAnimationBake>> finishedBakes;
 		{
-			posedNodes.back().LocalTransform = nodeTransform;
+			std::unique_lock lock(FinishedBakesMutex);
+			finishedBakes.swap(FinishedBakes);
 		}
 
-		for (const U32 childIndex : fromNode.ChildIndices)
+		constexpr U64 atlasSize = STATIC_U64(UAnimationAtlas::Width) * UAnimationAtlas::Height * UAnimationAtlas::HalvesPerTexel;
+		for (const std::shared_ptr<SPendingAnimationBake>& bake : finishedBakes)
 		{
-			ReadAnimationLocalPose(animation, mesh, animationTime, mesh->Nodes[childIndex], posedNodes);
+			auto it = BakedClips.find(bake->Key);
+			if (bake->Generation != AtlasGeneration || it == BakedClips.end())
+				continue;
+
+			SBakedAnimationClip& clip = it->second;
+			clip = std::move(bake->Clip);
+
+			// A clip that doesn't fit is left out for good, skeletons playing it are evaluated like any other
+			if (AnimationAtlas.size() + clip.Halves.size() > atlasSize)
+			{
+				HV_LOG_WARN("CAnimatorGraphSystem: The animation atlas is full, %u frames of %u bones don't fit.", clip.NumberOfFrames, clip.NumberOfBones);
+				clip.Halves = {};
+				continue;
+			}
+
+			clip.AtlasTexel = STATIC_U32(AnimationAtlas.size() / UAnimationAtlas::HalvesPerTexel);
+			clip.IsInAtlas = true;
+			AnimationAtlas.insert(AnimationAtlas.end(), clip.Halves.begin(), clip.Halves.end());
+			clip.Halves = {};
+			IsAnimationAtlasDirty = true;
 		}
 	}
 }
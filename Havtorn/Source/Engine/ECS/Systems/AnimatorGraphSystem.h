@@ -3,6 +3,10 @@
 #pragma once
 #include "ECS/System.h"
 #include "ECS/Entity.h"
+#include "Graphics/GraphicsStructs.h"
+
+#include <memory>
+#include <mutex>
 
 namespace Havtorn
 {
@@ -11,8 +15,134 @@ namespace Havtorn
 	struct SSkeletalAnimationAsset;
 	struct SSkeletalMeshAsset;
 	struct SSkeletalMeshNode;
-	struct SSkeletalPosedNode;
+	struct SSkeletalAnimationComponent;
+	struct SSkeletalAnimationPlayData;
+	struct SSkeletalAnimationLayer;
+	struct SPendingAnimationBake;
 	class CRenderManager;
+	class CThreadManager;
+
+	// Which track and bone every node of a skeleton maps to for one clip. Built the first time the pair is evaluated,
+	// so evaluating a pose only walks indices and never compares names.
+	struct SSkeletalAnimationBinding
+	{
+		// Every node reachable from the root, parents before their children
+		std::vector<U32> EvaluationOrder;
+		// Per node, -1 for the root
+		std::vector<I32> ParentIndices;
+		// Per node, -1 if the clip doesn't animate it
+		std::vector<I32> TrackIndices;
+		// Per bind pose bone, -1 if no reachable node drives it
+		std::vector<I32> BoneNodeIndices;
+		// Node transforms of the mesh in TRS form, used for every node the clip doesn't animate
+		SSkeletalPose RestPose;
+		// The clip's first frame, additive layers add how the clip moves away from it
+		SSkeletalPose ReferencePose;
+		// Checked against the assets on every use, a reimport that changes them rebuilds the binding
+		U64 NumberOfTracks = 0;
+	};
+
+	// A clip sampled at a fixed rate, so the samples around any time are found by index instead of searching the keys.
+	// Exact when every key sits on a sample, which is the case for clips baked per frame, otherwise close to it.
+	struct SResampledAnimationClip
+	{
+		F32 SamplesPerTick = 1.0f;
+		U32 NumberOfSamples = 0;
+		U64 NumberOfTracks = 0;
+		// NumberOfSamples per track, track after track
+		std::vector<SVector> Translations;
+		std::vector<SQuaternion> Rotations;
+		std::vector<SVector> Scales;
+	};
+
+	// A clip sampled at a fixed rate into bone palettes for one mesh, encoded for the animation atlas. Far away skeletons
+	// playing it are drawn from the frame closest to their time instead of being evaluated.
+	struct SBakedAnimationClip
+	{
+		F32 SamplesPerSecond = 30.0f;
+		U32 NumberOfFrames = 0;
+		U32 NumberOfBones = 0;
+		// UAnimationAtlas::TexelsPerBone texels per bone, frame after frame. Emptied once packed into the atlas.
+		std::vector<U16> Halves;
+		// Texel of the first frame in the atlas, if it fit
+		U32 AtlasTexel = 0;
+		bool IsInAtlas = false;
+	};
+
+	// One playing animation of a component, resolved and weighted on the main thread since requesting assets and building
+	// bindings isn't thread safe. Everything after that only touches the component's own buffers and can run on the job threads.
+	struct SSkeletalAnimationClipEvaluation
+	{
+		SSkeletalAnimationPlayData* PlayData = nullptr;
+		const SSkeletalAnimationAsset* Animation = nullptr;
+		const SSkeletalAnimationBinding* Binding = nullptr;
+		// Set when sampling resampled clips
+		const SResampledAnimationClip* ResampledClip = nullptr;
+		F32 AnimationTime = 0.0f;
+		U32 LayerIndex = 0;
+		// In the blend space of the layer, clips weighted to nothing are left out before evaluation
+		F32 Weight = 1.0f;
+	};
+
+	struct SSkeletalAnimationEvaluation
+	{
+		SSkeletalAnimationComponent* Component = nullptr;
+		const SSkeletalMeshAsset* Mesh = nullptr;
+		// Hierarchy and bones, the binding of any clip will do
+		const SSkeletalAnimationBinding* Binding = nullptr;
+		SMatrix RootTransform = SMatrix::Identity;
+		// Range in the clip evaluations
+		U32 FirstClip = 0;
+		U32 NumberOfClips = 0;
+		// Frames until the next evaluation, bones blend towards this one over them when more than 1
+		U32 UpdateInterval = 1;
+		// Projected size on the main camera, 1 without animation LOD
+		F32 ScreenSize = 1.0f;
+	};
+
+	struct SAnimationUpdateStats
+	{
+		U32 NumberOfEvaluatedSkeletons = 0;
+		// Blending between their last two evaluations
+		U32 NumberOfInterpolatedSkeletons = 0;
+		// Out of view, only advancing their animation time
+		U32 NumberOfCulledSkeletons = 0;
+		// Due but over the update budget, first in line next frame
+		U32 NumberOfDeferredSkeletons = 0;
+		// Skeletons playing a single clip, looked up in the pose cache
+		U32 NumberOfPoseCacheLookups = 0;
+		// Of those, the ones that took the palette of a skeleton in the same playback state instead of being evaluated
+		U32 NumberOfSharedPoses = 0;
+		// Far away, drawn from a baked frame in the animation atlas instead of being evaluated
+		U32 NumberOfAtlasSkeletons = 0;
+	};
+
+	// Skeletons playing nothing but one clip, grouped by playback state so only the first in each is evaluated. Rebuilt every update.
+	struct SAnimationPoseCache
+	{
+		struct SKey
+		{
+			// One per mesh and clip pair
+			const SSkeletalAnimationBinding* Binding = nullptr;
+			// The clip's time rounded to the cache's samples
+			I64 TimeIndex = 0;
+			U32 UpdateInterval = 1;
+			auto operator<=>(const SKey& other) const = default;
+		};
+
+		struct SSharedPose
+		{
+			SSkeletalAnimationComponent* Component = nullptr;
+			const SSkeletalAnimationComponent* Source = nullptr;
+			U32 UpdateInterval = 1;
+		};
+
+		// By the skeleton evaluated for each playback state
+		std::map<SKey, const SSkeletalAnimationComponent*> Entries;
+		std::vector<SSharedPose> SharedPoses;
+		// Every lookup that doesn't end in a shared pose adds an entry
+		U32 NumberOfLookups = 0;
+	};
 
 	class CAnimatorGraphSystem : public ISystem
 	{
@@ -22,14 +152,122 @@ namespace Havtorn
 		ENGINE_API void Update(std::vector<Ptr<CScene>>& scenes) override;
 		ENGINE_API void BindEvaluateFunction(std::function<I16(CScene*, const SEntity&)>& function, const std::string& classAndFunctionName);
 
-		void ReadAnimationLocalPose(const SSkeletalAnimationAsset* animation, const SSkeletalMeshAsset* mesh, const F32 animationTime, const SSkeletalMeshNode& fromNode, std::vector<SSkeletalPosedNode>& posedBoneOrder);
-		void ApplyLocalPoseToHierarchy(const SSkeletalMeshAsset* mesh, std::vector<SSkeletalPosedNode>& in, const SSkeletalMeshNode& node, const SMatrix& parentTransform);
+		// Poses and global transforms are indexed like the mesh nodes. Local poses stay in TRS form until the hierarchy is applied.
+		// Only the nodes in nodeIndices are read, the binding's EvaluationOrder for all of them.
+		static ENGINE_API void ReadAnimationLocalPose(const SSkeletalAnimationAsset* animation, const SSkeletalAnimationBinding& binding, const F32 animationTime, const std::vector<U32>& nodeIndices, std::vector<SBoneTrackCursor>& cursors, SSkeletalPose& outPose);
+		// scratchPose holds the later of the two samples around animationTime
+		static ENGINE_API void ReadResampledLocalPose(const SResampledAnimationClip& clip, const SSkeletalAnimationBinding& binding, const F32 animationTime, const std::vector<U32>& nodeIndices, SSkeletalPose& scratchPose, SSkeletalPose& outPose);
+		static ENGINE_API void ResampleClip(const SSkeletalAnimationAsset* animation, const F32 samplesPerTick, SResampledAnimationClip& outClip);
+		// Every frame is read with fresh key cursors and encoded bit by bit, so the same assets always bake to the same halves
+		static ENGINE_API void BakeClip(const SSkeletalMeshAsset* mesh, const SSkeletalAnimationAsset* animation, const SSkeletalAnimationBinding& binding, const F32 samplesPerSecond, SBakedAnimationClip& outClip);
+		static ENGINE_API void ApplyLocalPoseToHierarchy(const SSkeletalAnimationBinding& binding, const SSkeletalPose& localPose, const SMatrix& rootTransform, std::vector<SMatrix>& outGlobalTransforms);
+		static ENGINE_API void ApplyInverseBindPose(const SSkeletalMeshAsset* mesh, const SSkeletalAnimationBinding& binding, const std::vector<SMatrix>& globalTransforms, std::vector<SMatrix>& outBones);
+		// Maps the nodes of mesh to the tracks of animation and the bind pose bones, see SSkeletalAnimationBinding
+		static ENGINE_API void BuildBinding(const SSkeletalMeshAsset* mesh, const SSkeletalAnimationAsset* animation, SSkeletalAnimationBinding& outBinding);
+		// Blends the layers of one gathered component into its bones. Only touches the component's own buffers.
+		static ENGINE_API void EvaluateComponent(const SSkeletalAnimationEvaluation& evaluation, const std::vector<SSkeletalAnimationClipEvaluation>& clips);
+		// Splits evaluations into contiguous chunks for the job threads of threadManager, evaluates them all on the calling thread without one
+		static ENGINE_API void EvaluateComponents(const std::vector<SSkeletalAnimationEvaluation>& evaluations, const std::vector<SSkeletalAnimationClipEvaluation>& clips, CThreadManager* threadManager);
+
+		// Weight of every position in a blend space at parameter, summing to 1. Positions on a line are blended between the closest
+		// two on either side, others by the smallest triangle of positions around the parameter or the closest edge outside all of
+		// them. Positions that all coincide, like play data nobody placed, are spread evenly from 0 to 1 along X. Weights under
+		// 0.1% are dropped so their clips are never sampled. Tries every triangle, meant for the handful of clips a blend space has.
+		static ENGINE_API void CalculateBlendSpaceWeights(const std::vector<SVector2<F32>>& positions, const SVector2<F32>& parameter, std::vector<F32>& outWeights);
+		// Weighs the clips of evaluation, which have to be the last ones in clips, in the blend spaces of their layers, removes
+		// the ones weighted to nothing and resolves layer masks. The scratch vectors only keep their allocations between calls.
+		static ENGINE_API void WeighClips(SSkeletalAnimationEvaluation& evaluation, std::vector<SSkeletalAnimationClipEvaluation>& clips, std::vector<SVector2<F32>>& scratchPositions, std::vector<F32>& scratchWeights);
+
+		// Empties the cache, then rounds the time of every single clip evaluation to samplesPerSecond and removes the ones matching
+		// an earlier evaluation from evaluations, to take its palette in ApplySharedPoses once it is evaluated. 0 turns the cache off.
+		static ENGINE_API void AssignPoseCache(SAnimationPoseCache& cache, std::vector<SSkeletalAnimationEvaluation>& evaluations, std::vector<SSkeletalAnimationClipEvaluation>& clips, const F32 samplesPerSecond);
+		static ENGINE_API void ApplySharedPoses(const SAnimationPoseCache& cache);
 
 		// TODO.NW: Make static function that additionally takes RenderManager arg?
 		ENGINE_API std::vector<SMatrix> ReadAssetAnimationPose(const std::string& animationFile, const F32 animationTime);
 
+		// Sample resampled clips instead of searching keys, read from "Resample Animation Clips" in the engine config
+		bool ShouldResampleClips = false;
+
+		// Animation LOD against the main camera, read from the engine config. Skeletons smaller on screen than the half, quarter
+		// and eighth rate sizes are evaluated every 2nd, 4th or 8th frame, ahead of time so their bones can blend towards the
+		// result in between. Skeletons out of view only advance their animation time. With a budget, at most that many skeletons
+		// are evaluated per frame, the ones that waited the longest first.
+		bool IsAnimationLODEnabled = true;
+		F32 HalfRateScreenSize = 0.25f;
+		F32 QuarterRateScreenSize = 0.1f;
+		F32 EighthRateScreenSize = 0.04f;
+		U32 UpdateBudget = 0;
+
+		// Skeletons playing nothing but one clip share a palette with the others playing it on the same mesh at the same time,
+		// rounded to this many samples per second. Read from "Animation Pose Cache Samples Per Second" in the engine config,
+		// 0 turns the cache off.
+		F32 PoseCacheSamplesPerSecond = 60.0f;
+
+		// Skeletons smaller on screen than this playing a single clip are drawn from the clip baked into the animation atlas at
+		// AtlasSamplesPerSecond, without being evaluated. Read from "Animation Atlas Screen Size" and "Animation Atlas Samples Per
+		// Second" in the engine config, needs animation LOD. A size of 0 turns the atlas off.
+		F32 AtlasScreenSize = 0.02f;
+		F32 AtlasSamplesPerSecond = 30.0f;
+
+		[[nodiscard]] const SAnimationUpdateStats& GetStats() const { return Stats; }
+
 	private:
+		struct SAnimationLODView
+		{
+			// Inside when the signed distance to every plane is positive
+			SVector4 FrustumPlanes[6];
+			SVector Position = SVector::Zero;
+			F32 TanHalfFOV = 1.0f;
+			F32 ViewHeight = 1.0f;
+			bool IsOrthographic = false;
+		};
+
+		// False without a main camera, every skeleton is evaluated every frame then
+		bool GetAnimationLODView(const std::vector<Ptr<CScene>>& scenes, SAnimationLODView& outView) const;
+		// 0 when out of view, otherwise 1, 2, 4 or 8
+		U32 SelectUpdateInterval(const SAnimationLODView& view, const SSkeletalMeshAsset* mesh, const SMatrix& meshTransform, F32& outScreenSize) const;
+
+		// Bones start blending from what they are now towards TargetBones, over updateInterval frames
+		static void BlendBonesTowardsTarget(SSkeletalAnimationComponent* component, const U32 updateInterval);
+		// A single clip on this layer is the whole pose, true without layers
+		static bool IsLayerWholePose(const SSkeletalAnimationComponent* component, const U32 layerIndex);
+		// Points the component at the frame of its clip in the animation atlas, false unless the clips gathered from firstClip
+		// are a single one that is the whole pose and fits in the atlas
+		bool SelectAtlasFrame(SSkeletalAnimationComponent* component, const U32 meshUID, const SSkeletalMeshAsset* mesh, const U32 firstClip);
+
+		const SSkeletalAnimationBinding& GetBinding(const U32 meshUID, const SSkeletalMeshAsset* mesh, const U32 animationUID, const SSkeletalAnimationAsset* animation);
+		const SResampledAnimationClip& GetResampledClip(const U32 animationUID, const SSkeletalAnimationAsset* animation);
+		// Starts baking the pair on the job threads the first time, the clip stays out of the atlas until the bake is packed
+		const SBakedAnimationClip& GetBakedClip(const U32 meshUID, const SSkeletalMeshAsset* mesh, const U32 animationUID, const SSkeletalAnimationAsset* animation, const SSkeletalAnimationBinding& binding);
+		// Packs the bakes finished since the last update after the others in the atlas, if there is room
+		void PackBakedClips();
+		void OnAssetReloaded(const std::string& assetPath);
+
+		static void ResolveLayerMask(const SSkeletalMeshAsset* mesh, const SSkeletalAnimationBinding& binding, SSkeletalAnimationLayer& layer);
+
 		CRenderManager* RenderManager;
 		std::map<U64, std::function<I16(CScene*, const SEntity&)>> EvaluateFunctionMap;
+		// Keyed by mesh UID in the upper and animation UID in the lower half
+		std::unordered_map<U64, SSkeletalAnimationBinding> Bindings;
+		// Keyed by animation UID, only built while ShouldResampleClips is set
+		std::unordered_map<U32, SResampledAnimationClip> ResampledClips;
+		// Keyed like Bindings. Clips keep their place in the atlas until an asset reloads, which empties it, the render manager
+		// gets a copy whenever a clip is added.
+		std::unordered_map<U64, SBakedAnimationClip> BakedClips;
+		std::vector<U16> AnimationAtlas;
+		bool IsAnimationAtlasDirty = false;
+		// Bumped whenever the atlas is emptied, bakes started before that are dropped when they finish
+		U32 AtlasGeneration = 0;
+		std::vector<std::shared_ptr<SPendingAnimationBake>> FinishedBakes;
+		std::mutex FinishedBakesMutex;
+		// Gathered every update, kept to reuse their allocations
+		std::vector<SSkeletalAnimationEvaluation> Evaluations;
+		std::vector<SSkeletalAnimationClipEvaluation> ClipEvaluations;
+		std::vector<SVector2<F32>> BlendPositions;
+		std::vector<F32> BlendWeights;
+		SAnimationUpdateStats Stats;
+		U64 FrameIndex = 0;
+		SAnimationPoseCache PoseCache;
 	};
-}
\ No newline at end of file
+}
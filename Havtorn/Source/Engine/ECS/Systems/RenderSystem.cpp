@@ -9,9 +9,30 @@
 #include "ECS/ComponentAlgo.h"
 #include "Input/Input.h"
 #include "Assets/AssetRegistry.h"
+#include "Threading/ThreadManager.h"
 
 namespace Havtorn
 {
+	namespace
+	{
+		struct SStaticMeshRenderEntry
+		{
+			const SStaticMeshComponent* StaticMeshComponent = nullptr;
+			const STransformComponent* TransformComponent = nullptr;
+			SMaterialComponent* MaterialComponent = nullptr;
+			SStaticMeshAsset* Asset = nullptr;
+		};
+
+		// FNV-1a over the material UIDs, meshes using the same materials get the same key
+		U32 GetMaterialSortKey(const std::vector<SAssetReference>& materialReferences)
+		{
+			U32 key = 2166136261u;
+			for (const SAssetReference& reference : materialReferences)
+				key = (key ^ reference.UID) * 16777619u;
+			return key;
+		}
+	}
+
 	CRenderSystem::CRenderSystem(CRenderManager* renderManager, CWorld* world)
 		: ISystem()
 		, RenderManager(renderManager)
@@ -50,6 +71,55 @@ namespace Havtorn
 			}
 		}
 
+		std::erase_if(StaticMeshLODs, [&renderViewEntities](const auto& cameraLODs) { return std::ranges::find(renderViewEntities, cameraLODs.first) == renderViewEntities.end(); });
+
+		// Clustered Light Pre-Pass, lights are gathered once and binned per render view
+		std::vector<SClusteredPointLight> clusteredPointLights = {};
+		std::vector<SClusteredSpotLight> clusteredSpotLights = {};
+		if (LightClusteringEnabled)
+		{
+			for (Ptr<CScene>& scene : scenes)
+			{
+				for (const SPointLightComponent* pointLightComp : scene->GetComponents<SPointLightComponent>())
+				{
+					if (!SComponent::IsValid(pointLightComp) || !pointLightComp->IsActive)
+						continue;
+
+					const STransformComponent* transformComp = scene->GetComponent<STransformComponent>(pointLightComp);
+					if (!SComponent::IsValid(transformComp))
+						continue;
+
+					const SVector position = transformComp->Transform.GetMatrix().GetTranslation();
+					SClusteredPointLight& light = clusteredPointLights.emplace_back();
+					light.PositionAndRange = { position.X, position.Y, position.Z, pointLightComp->Range };
+					light.ColorAndIntensity = pointLightComp->ColorAndIntensity;
+				}
+
+				for (const SSpotLightComponent* spotLightComp : scene->GetComponents<SSpotLightComponent>())
+				{
+					if (!SComponent::IsValid(spotLightComp) || !spotLightComp->IsActive)
+						continue;
+
+					const STransformComponent* transformComp = scene->GetComponent<STransformComponent>(spotLightComp);
+					if (!SComponent::IsValid(transformComp))
+						continue;
+
+					// Angles are half angles in degrees, see DeferredLightSpot_PS
+					const F32 outerAngle = UMath::DegToRad(UMath::Clamp(spotLightComp->OuterAngle, 0.0f, 179.0f));
+					const F32 innerAngle = UMath::DegToRad(UMath::Clamp(spotLightComp->InnerAngle, 0.0f, 179.0f));
+
+					const SVector position = transformComp->Transform.GetMatrix().GetTranslation();
+					SClusteredSpotLight& light = clusteredSpotLights.emplace_back();
+					light.PositionAndRange = { position.X, position.Y, position.Z, spotLightComp->Range };
+					light.ColorAndIntensity = spotLightComp->ColorAndIntensity;
+					light.Direction = spotLightComp->Direction;
+					light.CosOuterAngle = UMath::Cos(outerAngle);
+					light.CosInnerAngle = UMath::Cos(innerAngle);
+					light.SinOuterAngle = UMath::Sin(outerAngle);
+				}
+			}
+		}
+
 		// TODO.NW: Would be cool to explore a render graph solution for this, now that it is more clear what need to happen for every rendered frame
 		for (const SCameraData& cameraData : activeCameras)
 		{
@@ -63,14 +133,68 @@ namespace Havtorn
 				RenderManager->PushRenderCommand(command, cameraEntity.GUID);
 			}
 
+			CLightClusterGrid* lightClusterGrid = RenderManager->GetLightClusterGrid(cameraEntity.GUID);
+			if (lightClusterGrid != nullptr && !LightClusteringEnabled)
+			{
+				lightClusterGrid->Clear();
+			}
+			else if (lightClusterGrid != nullptr)
+			{
+				const SCameraComponent* cameraComp = cameraData.CameraComponent;
+
+				SLightClusterFrustum frustum;
+				frustum.IsOrthographic = cameraComp->ProjectionType == ECameraProjectionType::Orthographic;
+				frustum.FOV = cameraComp->FOV;
+				frustum.AspectRatio = cameraComp->AspectRatio;
+				frustum.ViewWidth = cameraComp->ViewWidth;
+				frustum.ViewHeight = cameraComp->ViewHeight;
+				frustum.NearClip = cameraComp->NearClip;
+				frustum.FarClip = cameraComp->FarClip;
+				lightClusterGrid->Build(cameraData.TransformComponent->Transform.GetMatrix(), frustum, clusteredPointLights, clusteredSpotLights);
+			}
+
+			std::unordered_map<U64, U8>& previousStaticMeshLODs = StaticMeshLODs[cameraEntity.GUID];
+			std::unordered_map<U64, U8> selectedStaticMeshLODs = {};
+
+			// Occluder Pre-Pass
+			COcclusionCuller* occlusionCuller = OcclusionCullingEnabled ? RenderManager->GetOcclusionCuller(cameraEntity.GUID) : nullptr;
+			if (occlusionCuller != nullptr)
+			{
+				occlusionCuller->BeginFrame(cameraData.TransformComponent->Transform.GetMatrix().FastInverse() * cameraData.CameraComponent->ProjectionMatrix);
+
+				for (Ptr<CScene>& scene : scenes)
+				{
+					for (const SOccluderComponent* occluderComp : scene->GetComponents<SOccluderComponent>())
+					{
+						if (!SComponent::IsValid(occluderComp) || !occluderComp->IsActive)
+							continue;
+
+						const SStaticMeshComponent* staticMeshComponent = scene->GetComponent<SStaticMeshComponent>(occluderComp);
+						const STransformComponent* transformComp = scene->GetComponent<STransformComponent>(occluderComp);
+						if (!SComponent::IsValid(staticMeshComponent) || !SComponent::IsValid(transformComp))
+							continue;
+
+						// Occluders hide everything behind them, so they go before other meshes in the load queue
+						const SStaticMeshAsset* asset = GEngine::GetAssetRegistry()->RequestOccluderAssetDataAsync(staticMeshComponent->AssetReference, EAssetLoadPriority::High, staticMeshComponent->Owner.GUID);
+						if (asset == nullptr)
+							continue;
+
+						occlusionCuller->AddOccluder(asset->OccluderPositions, asset->OccluderIndices, transformComp->Transform.GetMatrix());
+					}
+				}
+
+				occlusionCuller->RasterizeOccluders(GEngine::GetThreadManager());
+			}
+
 			for (Ptr<CScene>& scene : scenes)
 			{
 				const std::vector<SDirectionalLightComponent*>& directionalLightComponents = scene->GetComponents<SDirectionalLightComponent>();
 				const std::vector<SPointLightComponent*>& pointLightComponents = scene->GetComponents<SPointLightComponent>();
 				const std::vector<SSpotLightComponent*>& spotLightComponents = scene->GetComponents<SSpotLightComponent>();
 	
-				// TODO.NW: Add frustum culling - send all meshes in all scenes to all active cameras, let the cameras decide whether they are visible
+				// TODO: Only static meshes are culled so far - send everything else in all scenes to all active cameras, let the cameras decide whether they are visible
 
+				std::vector<SStaticMeshRenderEntry> staticMeshEntries = {};
 				for (const SStaticMeshComponent* staticMeshComponent : scene->GetComponents<SStaticMeshComponent>())
 				{
 					const STransformComponent* transformComp = scene->GetComponent<STransformComponent>(staticMeshComponent);
@@ -79,12 +203,51 @@ namespace Havtorn
 					if (!SComponent::IsValid(staticMeshComponent) || !SComponent::IsValid(transformComp) || !SComponent::IsValid(materialComp))
 						continue;
 
-					if (!RenderManager->IsStaticMeshInInstancedRenderList(staticMeshComponent->AssetReference.UID, cameraEntity.GUID)) // if static, if instanced
+					// Meshes are skipped until they have finished loading in the background
+					SStaticMeshAsset* asset = GEngine::GetAssetRegistry()->RequestAssetDataAsync<SStaticMeshAsset>(staticMeshComponent->AssetReference, EAssetLoadPriority::Normal, staticMeshComponent->Owner.GUID);
+					if (asset == nullptr)
+						continue;
+
+					staticMeshEntries.push_back({ staticMeshComponent, transformComp, materialComp, asset });
+				}
+
+				// Tested in one batch so the queries can be spread over the job threads
+				std::vector<EOcclusionResult> occlusionResults = {};
+				if (occlusionCuller != nullptr)
+				{
+					std::vector<SOcclusionQuery> occlusionQueries = {};
+					occlusionQueries.reserve(staticMeshEntries.size());
+					for (const SStaticMeshRenderEntry& entry : staticMeshEntries)
+						occlusionQueries.push_back({ entry.TransformComponent->Transform.GetMatrix(), entry.Asset->BoundsMin, entry.Asset->BoundsMax });
+
+					occlusionCuller->TestBounds(occlusionQueries, occlusionResults, GEngine::GetThreadManager());
+				}
+
+				for (U64 entryIndex = 0; entryIndex < staticMeshEntries.size(); entryIndex++)
+				{
+					const SStaticMeshComponent* staticMeshComponent = staticMeshEntries[entryIndex].StaticMeshComponent;
+					const STransformComponent* transformComp = staticMeshEntries[entryIndex].TransformComponent;
+					SMaterialComponent* materialComp = staticMeshEntries[entryIndex].MaterialComponent;
+					const SStaticMeshAsset* asset = staticMeshEntries[entryIndex].Asset;
+					const bool isVisible = occlusionResults.empty() || occlusionResults[entryIndex] == EOcclusionResult::Visible;
+
+					// Each LOD is its own instanced batch, keyed by mesh UID and LOD index
+					U8 lodIndex = 0;
+					if (!asset->LODs.empty())
 					{
-						SStaticMeshAsset* asset = GEngine::GetAssetRegistry()->RequestAssetData<SStaticMeshAsset>(staticMeshComponent->AssetReference, staticMeshComponent->Owner.GUID);
-						if (asset == nullptr)
-							continue;
+						const auto previousLOD = previousStaticMeshLODs.find(staticMeshComponent->Owner.GUID);
+						lodIndex = SelectStaticMeshLOD(asset, GetProjectedScreenSize(cameraData, asset, transformComp), previousLOD != previousStaticMeshLODs.end() ? previousLOD->second : 0);
+						selectedStaticMeshLODs[staticMeshComponent->Owner.GUID] = lodIndex;
+					}
 
+					const U64 instanceListKey = CRenderManager::GetStaticMeshLODKey(staticMeshComponent->AssetReference.UID, lodIndex);
+					const std::vector<SDrawCallData>& drawCallData = lodIndex == 0 ? asset->DrawCallData : asset->LODs[lodIndex - 1].DrawCallData;
+
+					// Culled instances can still cast shadows into the view, so shadow casters get their own list while culling
+					const U64 shadowCasterListKey = occlusionCuller != nullptr ? CRenderManager::GetStaticMeshShadowCasterKey(instanceListKey) : instanceListKey;
+
+					if (!RenderManager->IsStaticMeshInInstancedRenderList(shadowCasterListKey, cameraEntity.GUID)) // if static, if instanced
+					{
 						for (const SDirectionalLightComponent* directionalLightComp : directionalLightComponents)
 						{
 							if (SComponent::IsValid(directionalLightComp) && directionalLightComp->IsActive)
@@ -94,8 +257,9 @@ namespace Havtorn
 								command.Type = ERenderCommandType::ShadowAtlasPrePassDirectional;
 								command.ShadowmapViews.push_back(directionalLightComp->ShadowmapView);
 								command.Matrices.push_back(transformComp->Transform.GetMatrix());
-								command.U32s.push_back(staticMeshComponent->AssetReference.UID);
-								command.DrawCallData = asset->DrawCallData;
+								command.U64s.push_back(shadowCasterListKey);
+								command.SetSortKey(0, staticMeshComponent->AssetReference.UID);
+								command.DrawCallData = drawCallData;
 								RenderManager->PushRenderCommand(command, cameraEntity.GUID);
 							}
 						}
@@ -107,8 +271,9 @@ namespace Havtorn
 								SRenderCommand command;
 								command.Type = ERenderCommandType::ShadowAtlasPrePassPoint;
 								command.Matrices.push_back(transformComp->Transform.GetMatrix());
-								command.U32s.push_back(staticMeshComponent->AssetReference.UID);
-								command.DrawCallData = asset->DrawCallData;
+								command.U64s.push_back(shadowCasterListKey);
+								command.SetSortKey(0, staticMeshComponent->AssetReference.UID);
+								command.DrawCallData = drawCallData;
 								command.SetShadowMapViews(pointLightComp->ShadowmapViews);
 								RenderManager->PushRenderCommand(command, cameraEntity.GUID);
 							}
@@ -121,13 +286,17 @@ namespace Havtorn
 								SRenderCommand command;
 								command.Type = ERenderCommandType::ShadowAtlasPrePassSpot;
 								command.Matrices.push_back(transformComp->Transform.GetMatrix());
-								command.U32s.push_back(staticMeshComponent->AssetReference.UID);
-								command.DrawCallData = asset->DrawCallData;
+								command.U64s.push_back(shadowCasterListKey);
+								command.SetSortKey(0, staticMeshComponent->AssetReference.UID);
+								command.DrawCallData = drawCallData;
 								command.ShadowmapViews.push_back(spotLightComp->ShadowmapView);
 								RenderManager->PushRenderCommand(command, cameraEntity.GUID);
 							}
 						}
+					}
 
+					if (isVisible && !RenderManager->IsStaticMeshInInstancedRenderList(instanceListKey, cameraEntity.GUID))
+					{
 						if (materialComp->AssetReferences.size() != asset->NumberOfMaterials)
 							materialComp->AssetReferences.resize(asset->NumberOfMaterials, SAssetReference("Resources/M_MeshPreview.hva"));
 
@@ -137,8 +306,9 @@ namespace Havtorn
 						{
 							SRenderCommand command;
 							command.Type = ERenderCommandType::GBufferDataInstanced;
-							command.U32s.push_back(staticMeshComponent->AssetReference.UID);
-							command.DrawCallData = asset->DrawCallData;
+							command.U64s.push_back(instanceListKey);
+							command.SetSortKey(GetMaterialSortKey(materialComp->AssetReferences), staticMeshComponent->AssetReference.UID);
+							command.DrawCallData = drawCallData;
 
 							for (SGraphicsMaterialAsset* materialAsset : materialAssets)
 							{
@@ -152,8 +322,9 @@ namespace Havtorn
 						{
 							SRenderCommand command;
 							command.Type = ERenderCommandType::GBufferDataInstancedEditor;
-							command.U32s.push_back(staticMeshComponent->AssetReference.UID);
-							command.DrawCallData = asset->DrawCallData;
+							command.U64s.push_back(instanceListKey);
+							command.SetSortKey(GetMaterialSortKey(materialComp->AssetReferences), staticMeshComponent->AssetReference.UID);
+							command.DrawCallData = drawCallData;
 
 							for (SGraphicsMaterialAsset* materialAsset : materialAssets)
 							{
@@ -165,7 +336,11 @@ namespace Havtorn
 						}
 					}
 
-					RenderManager->AddStaticMeshToInstancedRenderList(staticMeshComponent->AssetReference.UID, transformComp, cameraEntity.GUID);
+					if (shadowCasterListKey != instanceListKey)
+						RenderManager->AddStaticMeshToInstancedRenderList(shadowCasterListKey, transformComp, cameraEntity.GUID);
+
+					if (isVisible)
+						RenderManager->AddStaticMeshToInstancedRenderList(instanceListKey, transformComp, cameraEntity.GUID);
 				}
 
 				for (const SSkeletalMeshComponent* skeletalMeshComponent : scene->GetComponents<SSkeletalMeshComponent>())
@@ -224,7 +399,7 @@ namespace Havtorn
 						if (!SComponent::IsValid(scene->GetComponent<SSkeletalAnimationComponent>(transformComp)))
 							continue;
 
-						SSkeletalMeshAsset* asset = GEngine::GetAssetRegistry()->RequestAssetData<SSkeletalMeshAsset>(skeletalMeshComponent->AssetReference, skeletalMeshComponent->Owner.GUID);
+						SSkeletalMeshAsset* asset = GEngine::GetAssetRegistry()->RequestAssetDataAsync<SSkeletalMeshAsset>(skeletalMeshComponent->AssetReference, EAssetLoadPriority::Normal, skeletalMeshComponent->Owner.GUID);
 						if (asset == nullptr)
 							continue;
 
@@ -239,6 +414,7 @@ namespace Havtorn
 							command.Type = ERenderCommandType::GBufferSkeletalInstanced;
 							command.Matrices.push_back(transformComp->Transform.GetMatrix());
 							command.U32s.push_back(skeletalMeshComponent->AssetReference.UID);
+							command.SetSortKey(GetMaterialSortKey(materialComp->AssetReferences), skeletalMeshComponent->AssetReference.UID);
 							command.DrawCallData = asset->DrawCallData;
 
 							for (SGraphicsMaterialAsset* materialAsset : materialAssets)
@@ -255,6 +431,7 @@ namespace Havtorn
 							command.Type = ERenderCommandType::GBufferSkeletalInstancedEditor;
 							command.Matrices.push_back(transformComp->Transform.GetMatrix());
 							command.U32s.push_back(skeletalMeshComponent->AssetReference.UID);
+							command.SetSortKey(GetMaterialSortKey(materialComp->AssetReferences), skeletalMeshComponent->AssetReference.UID);
 							command.DrawCallData = asset->DrawCallData;
 
 							for (SGraphicsMaterialAsset* materialAsset : materialAssets)
@@ -455,6 +632,7 @@ namespace Havtorn
 							SRenderCommand command;
 							command.Type = ERenderCommandType::GBufferSpriteInstanced;
 							command.U32s.push_back(spriteComp->AssetReference.UID);
+							command.SetSortKey(0, spriteComp->AssetReference.UID);
 							command.RenderTextures.push_back(asset->RenderTexture);
 							RenderManager->PushRenderCommand(command, cameraEntity.GUID);
 						}
@@ -512,6 +690,8 @@ namespace Havtorn
 				}
 			}
 
+			previousStaticMeshLODs = std::move(selectedStaticMeshLODs);
+
 			// NW: Unique commands that are added once per active camera - automatically sorted into heap
 
 			{
@@ -569,4 +749,58 @@ namespace Havtorn
 			}
 		}
 	}
+
+	void CRenderSystem::SetOcclusionCullingEnabled(const bool isEnabled)
+	{
+		OcclusionCullingEnabled = isEnabled;
+	}
+
+	bool CRenderSystem::IsOcclusionCullingEnabled() const
+	{
+		return OcclusionCullingEnabled;
+	}
+
+	void CRenderSystem::SetLightClusteringEnabled(const bool isEnabled)
+	{
+		LightClusteringEnabled = isEnabled;
+	}
+
+	bool CRenderSystem::IsLightClusteringEnabled() const
+	{
+		return LightClusteringEnabled;
+	}
+
+	F32 CRenderSystem::GetProjectedScreenSize(const SCameraData& cameraData, const SStaticMeshAsset* asset, const STransformComponent* transformComp)
+	{
+		const SMatrix& meshMatrix = transformComp->Transform.GetMatrix();
+		const SVector scale = meshMatrix.GetScale();
+		const F32 radius = asset->BoundsRadius * UMath::Max(scale.X, UMath::Max(scale.Y, scale.Z));
+
+		const SCameraComponent* cameraComp = cameraData.CameraComponent;
+		if (cameraComp->ProjectionType == ECameraProjectionType::Orthographic)
+			return (2.0f * radius) / UMath::Max(cameraComp->ViewHeight, 0.0001f);
+
+		const SVector center = (SVector4(asset->BoundsCenter, 1.0f) * meshMatrix).ToVector3();
+		const F32 distance = (center - cameraData.TransformComponent->Transform.GetMatrix().GetTranslation()).Length();
+		if (distance <= radius)
+			return 1.0f;
+
+		// Projected diameter over screen height, FOV is vertical
+		return radius / (distance * UMath::Tan(UMath::DegToRad(cameraComp->FOV) * 0.5f));
+	}
+
+	U8 CRenderSystem::SelectStaticMeshLOD(const SStaticMeshAsset* asset, const F32 screenSize, const U8 previousLOD)
+	{
+		U8 lodIndex = 0;
+		for (U8 boundary = 1; boundary <= STATIC_U8(asset->LODs.size()); boundary++)
+		{
+			// Thresholds we're already past are widened, the ones ahead are narrowed
+			const F32 hysteresis = previousLOD >= boundary ? (1.0f + LODHysteresis) : (1.0f - LODHysteresis);
+			if (screenSize >= asset->LODs[boundary - 1].ScreenSize * hysteresis)
+				break;
+
+			lodIndex = boundary;
+		}
+		return lodIndex;
+	}
 }
@@ -9,6 +9,9 @@ namespace Havtorn
 	class CWorld;
 	struct SEntity;
 	struct SComponent;
+	struct SCameraData;
+	struct SStaticMeshAsset;
+	struct STransformComponent;
 
 	class CRenderSystem final : public ISystem
 	{
@@ -18,9 +21,30 @@ namespace Havtorn
 
 		void Update(std::vector<Ptr<CScene>>& scenes) override;
 
+		// Frustum and occlusion culling of static meshes, against meshes with an active occluder component. Occlusion culling
+		// is off by default, it only pays off in scenes with large occluders set up for it.
+		ENGINE_API void SetOcclusionCullingEnabled(const bool isEnabled);
+		ENGINE_API bool IsOcclusionCullingEnabled() const;
+
+		// Binning point and spot lights into the light clusters of every render view. Off until a lighting pass reads them.
+		ENGINE_API void SetLightClusteringEnabled(const bool isEnabled);
+		ENGINE_API bool IsLightClusteringEnabled() const;
+
 	private:
+		// Fraction of the screen height covered by the mesh bounding sphere
+		static F32 GetProjectedScreenSize(const SCameraData& cameraData, const SStaticMeshAsset* asset, const STransformComponent* transformComp);
+		static U8 SelectStaticMeshLOD(const SStaticMeshAsset* asset, const F32 screenSize, const U8 previousLOD);
+
+		// Relative distance the screen size has to move past a LOD threshold before switching, to avoid popping back and forth
+		static constexpr F32 LODHysteresis = 0.1f;
+
 		CRenderManager* RenderManager = nullptr;
 		CWorld* World = nullptr;
 		DelegateHandle Handle = {};
+		bool OcclusionCullingEnabled = false;
+		bool LightClusteringEnabled = false;
+
+		// Last selected LOD per camera entity and mesh entity
+		std::unordered_map<U64, std::unordered_map<U64, U8>> StaticMeshLODs;
 	};
 }
@@ -87,6 +87,7 @@ namespace Havtorn
 		GTime::BeginTracking(ETimerCategory::CPU);
 		
 		FileWatcher->FlushChanges();
+		AssetRegistry->UpdateAsyncLoads();
 		
 		return GTime::Mark();
 	}
@@ -95,7 +96,6 @@ namespace Havtorn
 	{
 		InputMapper->Update();
 		World->Update();
-		DebugDraw->Update();
 		
 		GTime::EndTracking(ETimerCategory::CPU);
 
@@ -112,6 +112,7 @@ namespace Havtorn
 
 	void GEngine::EndFrame()
 	{
+		DebugDraw->SyncCrossThreadResources(GTime::Dt());
 		RenderManager->SyncCrossThreadResources(World);
 		Framework->EndFrame();
 
@@ -158,6 +159,11 @@ namespace Havtorn
 		return Instance->Framework;
 	}
 
+	CRenderManager* GEngine::GetRenderManager()
+	{
+		return Instance->RenderManager;
+	}
+
 	void GEngine::OnWindowResolutionChanged(SVector2<U16> newResolution)
 	{
 		WindowResizeTarget = newResolution;
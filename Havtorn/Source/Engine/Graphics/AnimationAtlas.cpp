@@ -0,0 +1,104 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "AnimationAtlas.h"
+
+namespace Havtorn
+{
+	static_assert(sizeof(SMatrix) == 16 * sizeof(F32), "Bones are read as packed floats");
+
+	U16 UAnimationAtlas::FloatToHalf(const F32 value)
+	{
+		U32 bits = 0;
+		memcpy(&bits, &value, sizeof(F32));
+		const U32 sign = (bits >> 16) & 0x8000u;
+		const U32 magnitude = bits & 0x7FFFFFFFu;
+
+		// Infinity stays infinity, NaN stays NaN
+		if (magnitude >= 0x7F800000u)
+			return STATIC_U16(sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x200u : 0u));
+
+		// Under half of the smallest denormal
+		if (magnitude < 0x33000000u)
+			return STATIC_U16(sign);
+
+		U32 half = 0;
+		U32 remainder = 0;
+		U32 halfway = 0;
+		if (magnitude < 0x38800000u)
+		{
+			// Denormal half, the mantissa with its implicit bit shifted down to units of 2^-24
+			const U32 shift = 126u - (magnitude >> 23);
+			const U32 mantissa = (magnitude & 0x7FFFFFu) | 0x800000u;
+			half = mantissa >> shift;
+			remainder = mantissa & ((1u << shift) - 1u);
+			halfway = 1u << (shift - 1u);
+		}
+		else
+		{
+			// Rebiases the exponent from 127 to 15, a carry out of the mantissa moves up the exponent and past the largest
+			// half into infinity
+			half = (magnitude - 0x38000000u) >> 13;
+			remainder = magnitude & 0x1FFFu;
+			halfway = 0x1000u;
+		}
+
+		if (remainder > halfway || (remainder == halfway && (half & 1u) != 0))
+			half++;
+
+		return STATIC_U16(sign | UMath::Min(half, 0x7C00u));
+	}
+
+	F32 UAnimationAtlas::HalfToFloat(const U16 value)
+	{
+		const U32 sign = STATIC_U32(value & 0x8000u) << 16;
+		const U32 exponent = (value >> 10) & 0x1Fu;
+		const U32 mantissa = value & 0x3FFu;
+
+		U32 bits = 0;
+		if (exponent == 0x1Fu)
+		{
+			bits = sign | 0x7F800000u | (mantissa << 13);
+		}
+		else if (exponent == 0)
+		{
+			// Zero or denormal, exact as a float
+			const F32 magnitude = STATIC_F32(mantissa) * (1.0f / 16777216.0f);
+			return sign != 0 ? -magnitude : magnitude;
+		}
+		else
+		{
+			bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+		}
+
+		F32 result = 0.0f;
+		memcpy(&result, &bits, sizeof(F32));
+		return result;
+	}
+
+	void UAnimationAtlas::EncodeBones(const std::vector<SMatrix>& bones, std::vector<U16>& inOutHalves)
+	{
+		// The shaders read SMatrix memory column major, so their row r is element r of every SMatrix row
+		const U64 firstHalf = inOutHalves.size();
+		inOutHalves.resize(firstHalf + bones.size() * TexelsPerBone * HalvesPerTexel);
+		U16* halves = inOutHalves.data() + firstHalf;
+		for (const SMatrix& bone : bones)
+		{
+			for (U8 row = 0; row < TexelsPerBone; row++)
+			{
+				for (U8 column = 0; column < HalvesPerTexel; column++)
+					*halves++ = FloatToHalf(bone.data[column * 4 + row]);
+			}
+		}
+	}
+
+	SMatrix UAnimationAtlas::DecodeBone(const U16* halves)
+	{
+		SMatrix bone = SMatrix::Identity;
+		for (U8 row = 0; row < TexelsPerBone; row++)
+		{
+			for (U8 column = 0; column < HalvesPerTexel; column++)
+				bone.data[column * 4 + row] = HalfToFloat(halves[row * HalvesPerTexel + column]);
+		}
+		return bone;
+	}
+}
@@ -0,0 +1,31 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#pragma once
+#include "hvpch.h"
+
+namespace Havtorn
+{
+	// Clips baked to bone palettes at a fixed rate, back to back in one RGBA16F texture that far away skeletons read
+	// their frame from instead of being evaluated. A bone is the top three rows of its matrix as the shaders use it, the
+	// fourth is always (0, 0, 0, 1) for bones, so three texels and 24 bytes a bone. Conversions are done bit by bit so the
+	// same clip bakes to the same bytes everywhere.
+	class UAnimationAtlas
+	{
+	public:
+		static constexpr U32 Width = 1024;
+		static constexpr U32 Height = 1024;
+		static constexpr U32 TexelsPerBone = 3;
+		static constexpr U32 HalvesPerTexel = 4;
+		// Set on the number of bones in an instance's animation data when it reads the atlas instead of the view's palettes
+		static constexpr U32 InstanceFlag = 0x80000000u;
+
+		// Rounds to nearest even, out of range values become infinity
+		static ENGINE_API U16 FloatToHalf(const F32 value);
+		static ENGINE_API F32 HalfToFloat(const U16 value);
+
+		// Appends TexelsPerBone texels for every bone
+		static ENGINE_API void EncodeBones(const std::vector<SMatrix>& bones, std::vector<U16>& inOutHalves);
+		// One bone from TexelsPerBone texels
+		static ENGINE_API SMatrix DecodeBone(const U16* halves);
+	};
+}
@@ -0,0 +1,320 @@
+// Copyright 2022 Team Havtorn. All Rights Reserved.
+
+#include "ClusteredLightCulling.h"
+
+#include <MathTypes/EngineMathSSE.h>
+
+namespace Havtorn
+{
+	namespace
+	{
+		// Returns a 4 bit mask of which of the four clusters starting at clusterIndex intersect the sphere
+		inline I32 SphereVsClusterBounds4(const F32* minX, const F32* minY, const F32* minZ, const F32* maxX, const F32* maxY, const F32* maxZ, const U32 clusterIndex,
+			const VectorRegister& centerX, const VectorRegister& centerY, const VectorRegister& centerZ, const VectorRegister& radiusSquared)
+		{
+			const VectorRegister zero = VectorRegisterZero();
+
+			const VectorRegister deltaX = VectorRegisterAdd(
+				VectorRegisterMax(zero, VectorRegisterSubtract(VectorRegisterLoad(minX + clusterIndex), centerX)),
+				VectorRegisterMax(zero, VectorRegisterSubtract(centerX, VectorRegisterLoad(maxX + clusterIndex))));
+			const VectorRegister deltaY = VectorRegisterAdd(
+				VectorRegisterMax(zero, VectorRegisterSubtract(VectorRegisterLoad(minY + clusterIndex), centerY)),
+				VectorRegisterMax(zero, VectorRegisterSubtract(centerY, VectorRegisterLoad(maxY + clusterIndex))));
+			const VectorRegister deltaZ = VectorRegisterAdd(
+				VectorRegisterMax(zero, VectorRegisterSubtract(VectorRegisterLoad(minZ + clusterIndex), centerZ)),
+				VectorRegisterMax(zero, VectorRegisterSubtract(centerZ, VectorRegisterLoad(maxZ + clusterIndex))));
+
+			VectorRegister distanceSquared = VectorRegisterMultiply(deltaX, deltaX);
+			distanceSquared = VectorRegisterAdd(distanceSquared, VectorRegisterMultiply(deltaY, deltaY));
+			distanceSquared = VectorRegisterAdd(distanceSquared, VectorRegisterMultiply(deltaZ, deltaZ));
+
+			return VectorRegisterMoveMask(VectorRegisterCompareLessEqual(distanceSquared, radiusSquared));
+		}
+
+		// Cone vs cluster bounding sphere, four clusters at a time. See Bart Wronski, "Cull that cone!"
+		inline I32 ConeVsClusterSpheres4(const F32* sphereX, const F32* sphereY, const F32* sphereZ, const F32* sphereRadius, const U32 clusterIndex,
+			const VectorRegister& originX, const VectorRegister& originY, const VectorRegister& originZ,
+			const VectorRegister& directionX, const VectorRegister& directionY, const VectorRegister& directionZ,
+			const VectorRegister& range, const VectorRegister& cosAngle, const VectorRegister& sinAngle, const VectorRegister& backFaceScale)
+		{
+			const VectorRegister toSphereX = VectorRegisterSubtract(VectorRegisterLoad(sphereX + clusterIndex), originX);
+			const VectorRegister toSphereY = VectorRegisterSubtract(VectorRegisterLoad(sphereY + clusterIndex), originY);
+			const VectorRegister toSphereZ = VectorRegisterSubtract(VectorRegisterLoad(sphereZ + clusterIndex), originZ);
+			const VectorRegister radius = VectorRegisterLoad(sphereRadius + clusterIndex);
+
+			VectorRegister lengthSquared = VectorRegisterMultiply(toSphereX, toSphereX);
+			lengthSquared = VectorRegisterAdd(lengthSquared, VectorRegisterMultiply(toSphereY, toSphereY));
+			lengthSquared = VectorRegisterAdd(lengthSquared, VectorRegisterMultiply(toSphereZ, toSphereZ));
+
+			VectorRegister alongAxis = VectorRegisterMultiply(toSphereX, directionX);
+			alongAxis = VectorRegisterAdd(alongAxis, VectorRegisterMultiply(toSphereY, directionY));
+			alongAxis = VectorRegisterAdd(alongAxis, VectorRegisterMultiply(toSphereZ, directionZ));
+
+			const VectorRegister perpendicularSquared = VectorRegisterMax(VectorRegisterZero(), VectorRegisterSubtract(lengthSquared, VectorRegisterMultiply(alongAxis, alongAxis)));
+			const VectorRegister closestDistance = VectorRegisterSubtract(VectorRegisterMultiply(cosAngle, VectorRegisterSqrt(perpendicularSquared)), VectorRegisterMultiply(alongAxis, sinAngle));
+
+			const VectorRegister insideAngle = VectorRegisterCompareLessEqual(closestDistance, radius);
+			const VectorRegister beforeFront = VectorRegisterCompareLessEqual(alongAxis, VectorRegisterAdd(radius, range));
+			const VectorRegister afterBack = VectorRegisterCompareLessEqual(VectorRegisterMultiply(radius, backFaceScale), alongAxis);
+
+			return VectorRegisterMoveMask(VectorRegisterAnd(insideAngle, VectorRegisterAnd(beforeFront, afterBack)));
+		}
+	}
+
+	void CLightClusterGrid::Build(const SMatrix& cameraTransform, const SLightClusterFrustum& frustum, const std::vector<SClusteredPointLight>& pointLights, const std::vector<SClusteredSpotLight>& spotLights)
+	{
+		Stats = {};
+
+		if (!HasClusterBounds || !(frustum == CachedFrustum))
+			UpdateClusterBounds(frustum);
+
+		// Light indices are stored as U16
+		constexpr U64 maxLights = std::numeric_limits<U16>::max();
+		PointLights.assign(pointLights.begin(), pointLights.begin() + UMath::Min(pointLights.size(), maxLights));
+		SpotLights.assign(spotLights.begin(), spotLights.begin() + UMath::Min(spotLights.size(), maxLights));
+		Stats.NumberOfPointLights = STATIC_U32(PointLights.size());
+		Stats.NumberOfSpotLights = STATIC_U32(SpotLights.size());
+
+		ClusterScratch.resize(STATIC_U64(NumberOfClusters) * MaxLightsPerCluster);
+		ClusterScratchCounts.assign(NumberOfClusters, 0);
+		Clusters.assign(NumberOfClusters, SLightCluster());
+
+		const SMatrix toCameraFromWorld = cameraTransform.FastInverse();
+
+		for (U16 lightIndex = 0; lightIndex < STATIC_U16(PointLights.size()); ++lightIndex)
+		{
+			const SVector4& positionAndRange = PointLights[lightIndex].PositionAndRange;
+			const SVector4 viewPosition = SVector4(positionAndRange.X, positionAndRange.Y, positionAndRange.Z, 1.0f) * toCameraFromWorld;
+			const F32 range = positionAndRange.W;
+
+			if (viewPosition.Z + range < CachedFrustum.NearClip || viewPosition.Z - range > CachedFrustum.FarClip)
+				continue;
+
+			U16 firstSlice = 0, lastSlice = 0;
+			GetSliceRange(viewPosition.Z, range, firstSlice, lastSlice);
+
+			const VectorRegister centerX = VectorRegisterSet1(viewPosition.X);
+			const VectorRegister centerY = VectorRegisterSet1(viewPosition.Y);
+			const VectorRegister centerZ = VectorRegisterSet1(viewPosition.Z);
+			const VectorRegister radiusSquared = VectorRegisterSet1(range * range);
+
+			for (U32 slice = firstSlice; slice <= lastSlice; ++slice)
+			{
+				const U32 sliceStart = slice * ClustersPerSlice;
+				for (U32 clusterIndex = sliceStart; clusterIndex < sliceStart + ClustersPerSlice; clusterIndex += 4)
+				{
+					I32 mask = SphereVsClusterBounds4(BoundsMinX.data(), BoundsMinY.data(), BoundsMinZ.data(), BoundsMaxX.data(), BoundsMaxY.data(), BoundsMaxZ.data(), clusterIndex, centerX, centerY, centerZ, radiusSquared);
+					for (U32 lane = 0; mask != 0; ++lane, mask >>= 1)
+					{
+						if (mask & 1)
+							TryAddToCluster(clusterIndex + lane, lightIndex);
+					}
+				}
+			}
+		}
+
+		for (U32 clusterIndex = 0; clusterIndex < NumberOfClusters; ++clusterIndex)
+			Clusters[clusterIndex].NumberOfPointLights = ClusterScratchCounts[clusterIndex];
+
+		for (U16 lightIndex = 0; lightIndex < STATIC_U16(SpotLights.size()); ++lightIndex)
+		{
+			const SClusteredSpotLight& spotLight = SpotLights[lightIndex];
+			const SVector4& positionAndRange = spotLight.PositionAndRange;
+			const SVector4 viewPosition = SVector4(positionAndRange.X, positionAndRange.Y, positionAndRange.Z, 1.0f) * toCameraFromWorld;
+			const SVector viewDirection = (SVector4(spotLight.Direction.X, spotLight.Direction.Y, spotLight.Direction.Z, 0.0f) * toCameraFromWorld).ToVector3().GetNormalized();
+			const F32 range = positionAndRange.W;
+
+			if (viewPosition.Z + range < CachedFrustum.NearClip || viewPosition.Z - range > CachedFrustum.FarClip)
+				continue;
+
+			U16 firstSlice = 0, lastSlice = 0;
+			GetSliceRange(viewPosition.Z, range, firstSlice, lastSlice);
+
+			const VectorRegister centerX = VectorRegisterSet1(viewPosition.X);
+			const VectorRegister centerY = VectorRegisterSet1(viewPosition.Y);
+			const VectorRegister centerZ = VectorRegisterSet1(viewPosition.Z);
+			const VectorRegister radiusSquared = VectorRegisterSet1(range * range);
+			const VectorRegister directionX = VectorRegisterSet1(viewDirection.X);
+			const VectorRegister directionY = VectorRegisterSet1(viewDirection.Y);
+			const VectorRegister directionZ = VectorRegisterSet1(viewDirection.Z);
+			const VectorRegister rangeRegister = VectorRegisterSet1(range);
+			const VectorRegister cosAngle = VectorRegisterSet1(spotLight.CosOuterAngle);
+			const VectorRegister sinAngle = VectorRegisterSet1(spotLight.SinOuterAngle);
+
+			// Cones wider than a hemisphere can reach clusters behind the origin, so the back plane test is disabled for those
+			const VectorRegister backFaceScale = VectorRegisterSet1(spotLight.CosOuterAngle > 0.0f ? -1.0f : -std::numeric_limits<F32>::max());
+
+			for (U32 slice = firstSlice; slice <= lastSlice; ++slice)
+			{
+				const U32 sliceStart = slice * ClustersPerSlice;
+				for (U32 clusterIndex = sliceStart; clusterIndex < sliceStart + ClustersPerSlice; clusterIndex += 4)
+				{
+					I32 mask = SphereVsClusterBounds4(BoundsMinX.data(), BoundsMinY.data(), BoundsMinZ.data(), BoundsMaxX.data(), BoundsMaxY.data(), BoundsMaxZ.data(), clusterIndex, centerX, centerY, centerZ, radiusSquared);
+					if (mask == 0)
+						continue;
+
+					mask &= ConeVsClusterSpheres4(SphereX.data(), SphereY.data(), SphereZ.data(), SphereRadius.data(), clusterIndex, centerX, centerY, centerZ, directionX, directionY, directionZ, rangeRegister, cosAngle, sinAngle, backFaceScale);
+					for (U32 lane = 0; mask != 0; ++lane, mask >>= 1)
+					{
+						if (mask & 1)
+							TryAddToCluster(clusterIndex + lane, lightIndex);
+					}
+				}
+			}
+		}
+
+		// Compact the fixed size scratch lists into one contiguous index list
+		U32 offset = 0;
+		for (U32 clusterIndex = 0; clusterIndex < NumberOfClusters; ++clusterIndex)
+		{
+			SLightCluster& cluster = Clusters[clusterIndex];
+			const U16 count = ClusterScratchCounts[clusterIndex];
+			cluster.Offset = offset;
+			cluster.NumberOfSpotLights = count - cluster.NumberOfPointLights;
+			offset += count;
+
+			if (count > 0)
+				Stats.NumberOfOccupiedClusters++;
+
+			Stats.MaxLightsInCluster = UMath::Max(Stats.MaxLightsInCluster, STATIC_U32(count));
+		}
+
+		LightIndices.resize(offset);
+		for (U32 clusterIndex = 0; clusterIndex < NumberOfClusters; ++clusterIndex)
+		{
+			const U16 count = ClusterScratchCounts[clusterIndex];
+			if (count == 0)
+				continue;
+
+			memcpy(&LightIndices[Clusters[clusterIndex].Offset], &ClusterScratch[STATIC_U64(clusterIndex) * MaxLightsPerCluster], sizeof(U16) * count);
+		}
+
+		Stats.NumberOfLightAssignments = offset;
+	}
+
+	void CLightClusterGrid::Clear()
+	{
+		Clusters.clear();
+		LightIndices.clear();
+		PointLights.clear();
+		SpotLights.clear();
+		Stats = {};
+	}
+
+	U32 CLightClusterGrid::GetClusterIndex(const U16 x, const U16 y, const U16 z) const
+	{
+		return STATIC_U32(z) * ClustersPerSlice + STATIC_U32(y) * ClusterCountX + x;
+	}
+
+	U16 CLightClusterGrid::GetSliceFromViewDepth(const F32 viewDepth) const
+	{
+		if (viewDepth <= CachedFrustum.NearClip)
+			return 0;
+
+		F32 slice = 0.0f;
+		if (CachedFrustum.IsOrthographic)
+			slice = ((viewDepth - CachedFrustum.NearClip) / (CachedFrustum.FarClip - CachedFrustum.NearClip)) * ClusterCountZ;
+		else
+			slice = std::log(viewDepth / CachedFrustum.NearClip) * LogDepthScale;
+
+		return STATIC_U16(UMath::Clamp(STATIC_I32(slice), 0, ClusterCountZ - 1));
+	}
+
+	void CLightClusterGrid::UpdateClusterBounds(const SLightClusterFrustum& frustum)
+	{
+		CachedFrustum = frustum;
+		CachedFrustum.NearClip = UMath::Max(frustum.NearClip, 0.0001f);
+		CachedFrustum.FarClip = UMath::Max(frustum.FarClip, CachedFrustum.NearClip + 0.0001f);
+		LogDepthScale = ClusterCountZ / std::log(CachedFrustum.FarClip / CachedFrustum.NearClip);
+
+		for (std::vector<F32>* bounds : { &BoundsMinX, &BoundsMinY, &BoundsMinZ, &BoundsMaxX, &BoundsMaxY, &BoundsMaxZ, &SphereX, &SphereY, &SphereZ, &SphereRadius })
+			bounds->resize(NumberOfClusters);
+
+		const F32 nearClip = CachedFrustum.NearClip;
+		const F32 farClip = CachedFrustum.FarClip;
+		const F32 tanHalfFOVY = UMath::Tan(UMath::DegToRad(CachedFrustum.FOV) * 0.5f);
+		const F32 tanHalfFOVX = tanHalfFOVY * CachedFrustum.AspectRatio;
+
+		for (U16 z = 0; z < ClusterCountZ; ++z)
+		{
+			F32 sliceNear = 0.0f;
+			F32 sliceFar = 0.0f;
+			if (CachedFrustum.IsOrthographic)
+			{
+				sliceNear = UMath::Lerp(nearClip, farClip, STATIC_F32(z) / ClusterCountZ);
+				sliceFar = UMath::Lerp(nearClip, farClip, STATIC_F32(z + 1) / ClusterCountZ);
+			}
+			else
+			{
+				sliceNear = nearClip * UMath::Pow(farClip / nearClip, STATIC_F32(z) / ClusterCountZ);
+				sliceFar = nearClip * UMath::Pow(farClip / nearClip, STATIC_F32(z + 1) / ClusterCountZ);
+			}
+
+			for (U16 y = 0; y < ClusterCountY; ++y)
+			{
+				const F32 ndcMinY = -1.0f + 2.0f * STATIC_F32(y) / ClusterCountY;
+				const F32 ndcMaxY = -1.0f + 2.0f * STATIC_F32(y + 1) / ClusterCountY;
+
+				for (U16 x = 0; x < ClusterCountX; ++x)
+				{
+					const F32 ndcMinX = -1.0f + 2.0f * STATIC_F32(x) / ClusterCountX;
+					const F32 ndcMaxX = -1.0f + 2.0f * STATIC_F32(x + 1) / ClusterCountX;
+
+					SVector boundsMin;
+					SVector boundsMax;
+					if (CachedFrustum.IsOrthographic)
+					{
+						boundsMin = { ndcMinX * CachedFrustum.ViewWidth * 0.5f, ndcMinY * CachedFrustum.ViewHeight * 0.5f, sliceNear };
+						boundsMax = { ndcMaxX * CachedFrustum.ViewWidth * 0.5f, ndcMaxY * CachedFrustum.ViewHeight * 0.5f, sliceFar };
+					}
+					else
+					{
+						// The froxel widens with depth, so its AABB is spanned by the near and far corners
+						boundsMin.X = UMath::Min(ndcMinX * tanHalfFOVX * sliceNear, ndcMinX * tanHalfFOVX * sliceFar);
+						boundsMin.Y = UMath::Min(ndcMinY * tanHalfFOVY * sliceNear, ndcMinY * tanHalfFOVY * sliceFar);
+						boundsMin.Z = sliceNear;
+						boundsMax.X = UMath::Max(ndcMaxX * tanHalfFOVX * sliceNear, ndcMaxX * tanHalfFOVX * sliceFar);
+						boundsMax.Y = UMath::Max(ndcMaxY * tanHalfFOVY * sliceNear, ndcMaxY * tanHalfFOVY * sliceFar);
+						boundsMax.Z = sliceFar;
+					}
+
+					const U32 clusterIndex = GetClusterIndex(x, y, z);
+					BoundsMinX[clusterIndex] = boundsMin.X;
+					BoundsMinY[clusterIndex] = boundsMin.Y;
+					BoundsMinZ[clusterIndex] = boundsMin.Z;
+					BoundsMaxX[clusterIndex] = boundsMax.X;
+					BoundsMaxY[clusterIndex] = boundsMax.Y;
+					BoundsMaxZ[clusterIndex] = boundsMax.Z;
+
+					const SVector center = (boundsMin + boundsMax) * 0.5f;
+					SphereX[clusterIndex] = center.X;
+					SphereY[clusterIndex] = center.Y;
+					SphereZ[clusterIndex] = center.Z;
+					SphereRadius[clusterIndex] = (boundsMax - center).Length();
+				}
+			}
+		}
+
+		HasClusterBounds = true;
+	}
+
+	void CLightClusterGrid::GetSliceRange(const F32 viewDepth, const F32 radius, U16& outFirstSlice, U16& outLastSlice) const
+	{
+		outFirstSlice = GetSliceFromViewDepth(viewDepth - radius);
+		outLastSlice = GetSliceFromViewDepth(viewDepth + radius);
+	}
+
+	bool CLightClusterGrid::TryAddToCluster(const U32 clusterIndex, const U16 lightIndex)
+	{
+		U16& count = ClusterScratchCounts[clusterIndex];
+		if (count >= MaxLightsPerCluster)
+		{
+			Stats.NumberOfDroppedAssignments++;
+			return false;
+		}
+
+		ClusterScratch[STATIC_U64(clusterIndex) * MaxLightsPerCluster + count] = lightIndex;
+		count++;
+		return true;
+	}
+}
@@ -0,0 +1,104 @@
+// Copyright 2022 Team Havtorn. All Rights Reserved.
+
+#pragma once
+#include "hvpch.h"
+
+namespace Havtorn
+{
+	// Light data in the layout a tiled lighting pass would upload as structured buffers
+	struct SClusteredPointLight
+	{
+		SVector4 PositionAndRange;
+		SVector4 ColorAndIntensity;
+	};
+
+	struct SClusteredSpotLight
+	{
+		SVector4 PositionAndRange;
+		SVector4 ColorAndIntensity;
+		SVector4 Direction;
+		F32 CosOuterAngle = 0.0f;
+		F32 CosInnerAngle = 0.0f;
+		F32 SinOuterAngle = 0.0f;
+		F32 Padding = 0.0f;
+	};
+
+	// Points into CLightClusterGrid::LightIndices. Point light indices come first, then spot light indices.
+	struct SLightCluster
+	{
+		U32 Offset = 0;
+		U16 NumberOfPointLights = 0;
+		U16 NumberOfSpotLights = 0;
+	};
+
+	struct SLightClusterFrustum
+	{
+		bool IsOrthographic = false;
+		F32 FOV = 70.0f;
+		F32 AspectRatio = (16.0f / 9.0f);
+		F32 ViewWidth = 10.0f;
+		F32 ViewHeight = 10.0f;
+		F32 NearClip = 0.1f;
+		F32 FarClip = 1000.0f;
+
+		bool operator==(const SLightClusterFrustum& other) const = default;
+	};
+
+	struct SLightClusterStats
+	{
+		U32 NumberOfPointLights = 0;
+		U32 NumberOfSpotLights = 0;
+		U32 NumberOfLightAssignments = 0;
+		U32 NumberOfOccupiedClusters = 0;
+		U32 MaxLightsInCluster = 0;
+		U32 NumberOfDroppedAssignments = 0;
+	};
+
+	// Bins point and spot lights into a view space froxel grid with exponential depth slices.
+	// Pure CPU, so it can be built and inspected without a graphics device.
+	class ENGINE_API CLightClusterGrid
+	{
+	public:
+		static constexpr U16 ClusterCountX = 16;
+		static constexpr U16 ClusterCountY = 8;
+		static constexpr U16 ClusterCountZ = 24;
+		static constexpr U32 ClustersPerSlice = ClusterCountX * ClusterCountY;
+		static constexpr U32 NumberOfClusters = ClustersPerSlice * ClusterCountZ;
+		static constexpr U16 MaxLightsPerCluster = 64;
+
+		void Build(const SMatrix& cameraTransform, const SLightClusterFrustum& frustum, const std::vector<SClusteredPointLight>& pointLights, const std::vector<SClusteredSpotLight>& spotLights);
+		void Clear();
+
+		U32 GetClusterIndex(const U16 x, const U16 y, const U16 z) const;
+		U16 GetSliceFromViewDepth(const F32 viewDepth) const;
+
+		const std::vector<SLightCluster>& GetClusters() const { return Clusters; }
+		const std::vector<U16>& GetLightIndices() const { return LightIndices; }
+		const std::vector<SClusteredPointLight>& GetPointLights() const { return PointLights; }
+		const std::vector<SClusteredSpotLight>& GetSpotLights() const { return SpotLights; }
+		const SLightClusterStats& GetStats() const { return Stats; }
+
+	private:
+		void UpdateClusterBounds(const SLightClusterFrustum& frustum);
+		void GetSliceRange(const F32 viewDepth, const F32 radius, U16& outFirstSlice, U16& outLastSlice) const;
+		bool TryAddToCluster(const U32 clusterIndex, const U16 lightIndex);
+
+		// SoA view space cluster bounds, processed four clusters at a time
+		std::vector<F32> BoundsMinX, BoundsMinY, BoundsMinZ;
+		std::vector<F32> BoundsMaxX, BoundsMaxY, BoundsMaxZ;
+		std::vector<F32> SphereX, SphereY, SphereZ, SphereRadius;
+
+		std::vector<SLightCluster> Clusters;
+		std::vector<U16> LightIndices;
+		std::vector<U16> ClusterScratch;
+		std::vector<U16> ClusterScratchCounts;
+
+		std::vector<SClusteredPointLight> PointLights;
+		std::vector<SClusteredSpotLight> SpotLights;
+
+		SLightClusterFrustum CachedFrustum;
+		SLightClusterStats Stats;
+		F32 LogDepthScale = 0.0f;
+		bool HasClusterBounds = false;
+	};
+}
@@ -31,46 +31,76 @@ namespace Havtorn
 		{ EVertexBufferPrimitives::UVSphere, GeometryPrimitives::UVSphere},
 	};
 
-	void GDebugDraw::Update()
+	namespace
 	{
-		if (LiveData.empty())
-			return;
+		// One batch per vertex buffer primitive, screen space and depth mode, see GDebugDraw::GetBatchIndex
+		constexpr U64 NumberOfDebugShapeBatches = (STATIC_U64(EVertexBufferPrimitives::SkyboxCube) + 1) * 4;
+	}
+
+	GDebugDraw::~GDebugDraw()
+	{
+		if (Instance == this)
+			Instance = nullptr;
+	}
+
+	void GDebugDraw::SyncCrossThreadResources(const F32 deltaTime)
+	{
+		Stats.NumberOfFrameShapes = 0;
+		Stats.NumberOfTimedShapes = 0;
+		Stats.NumberOfBatches = 0;
+		Stats.NumberOfOverwrittenShapes = NumberOfOverwrittenShapes;
+		NumberOfOverwrittenShapes = 0;
+
+		for (SDebugShapeBatch& batch : Batches)
+		{
+			// Frame shapes are handed over as is, the game thread gets the buffers the render thread is done with to fill next
+			batch.RenderFrameShapes.Swap(batch.FrameShapes);
+			batch.FrameShapes.Clear();
 
-		const SEntity& mainCamera = GEngine::GetWorld()->GetMainCamera();
+			// Timed shapes live on, so the render thread gets a copy
+			batch.RenderTimedShapes.CopyDrawData(batch.TimedShapes);
+			batch.TimedShapes.Expire(deltaTime);
+		}
+
+		// Commands are pushed here rather than during the update, so shapes added after it, e.g. by the editor, are drawn as well
+		const bool hasShapes = std::ranges::any_of(Batches, [](const SDebugShapeBatch& batch) { return batch.RenderFrameShapes.Size() + batch.RenderTimedShapes.Size() > 0; });
+		const U64 mainCameraID = (RenderManager != nullptr && hasShapes) ? GEngine::GetWorld()->GetMainCamera().GUID : 0;
 
+		if (mainCameraID != 0)
 		{
 			// Push prepass render commands
 			SRenderCommand command(ERenderCommandType::PreDebugShape);
-			RenderManager->PushRenderCommand(command, mainCamera.GUID);
+			RenderManager->PushRenderCommand(command, mainCameraID);
 
 			command.Type = ERenderCommandType::PostToneMappingIgnoreDepth;
-			RenderManager->PushRenderCommand(command, mainCamera.GUID);
+			RenderManager->PushRenderCommand(command, mainCameraID);
 
 			command.Type = ERenderCommandType::PostToneMappingUseDepth;
-			RenderManager->PushRenderCommand(command, mainCamera.GUID);
+			RenderManager->PushRenderCommand(command, mainCameraID);
 		}
 
-		const F32 dt = GTime::Dt();
-		for (SDebugDrawData& data : LiveData)
+		for (U32 batchIndex = 0; batchIndex < STATIC_U32(Batches.size()); batchIndex++)
 		{
-			// TODO.NW: Support 2D lines with their own passes? The vast majority will be 3D lines for a while, so the "IsScreenSpace" flag is probably ok for a bit.
-			ERenderCommandType commandType = (data.IgnoreDepth) ? ERenderCommandType::DebugShapeIgnoreDepth : ERenderCommandType::DebugShapeUseDepth;
+			const SDebugShapeBatch& batch = Batches[batchIndex];
+			if (batch.RenderFrameShapes.Size() + batch.RenderTimedShapes.Size() == 0)
+				continue;
 
+			Stats.NumberOfFrameShapes += batch.RenderFrameShapes.Size();
+			Stats.NumberOfTimedShapes += batch.RenderTimedShapes.Size();
+			Stats.NumberOfBatches++;
+
+			if (mainCameraID == 0)
+				continue;
+
+			// TODO.NW: Support 2D lines with their own passes? The vast majority will be 3D lines for a while, so the "IsScreenSpace" flag is probably ok for a bit.
+			// The command only names the batch, the render thread reads its instances from the render buffers
 			SRenderCommand command;
-			command.Type = commandType;
-			command.Matrices.push_back(data.TransformMatrix);
-			command.Vectors.push_back(data.Color.AsVector4());
-			command.F32s.push_back(data.Thickness);
-			command.U16s.push_back(data.IndexCount);
-			command.U8s.push_back(data.VertexBufferIndex);
-			command.U8s.push_back(data.IndexBufferIndex);
-			command.Flags.push_back(data.IsScreenSpace);
-			RenderManager->PushRenderCommand(command, mainCamera.GUID);
-
-			data.LifeTime -= dt;
+			command.Type = (batch.IgnoreDepth) ? ERenderCommandType::DebugShapeIgnoreDepth : ERenderCommandType::DebugShapeUseDepth;
+			command.U32s.push_back(batchIndex);
+			// Screen space lines swap vertex shader, keep them last
+			command.SetSortKey(batch.IsScreenSpace ? 1 : 0, STATIC_U32(batch.VertexBuffer));
+			RenderManager->PushRenderCommand(std::move(command), mainCameraID);
 		}
-
-		std::erase_if(LiveData, [](const SDebugDrawData& data) { return data.LifeTime <= 0.0f; });
 	}
 
 	bool GDebugDraw::Init(CRenderManager* renderManager)
@@ -78,14 +108,29 @@ namespace Havtorn
 #ifdef USE_DEBUG_SHAPE
 		RenderManager = renderManager;
 
-		if (RenderManager == nullptr)
-			return false;
-
 		if (Instance != nullptr)
 			HV_LOG_WARN("GDebugDraw already exists, replacing existing Instance!");
 
 		Instance = this;
 
+		Batches.resize(NumberOfDebugShapeBatches);
+		for (const auto& [vertexBuffer, primitive] : PrimitivesMap)
+		{
+			for (const bool isScreenSpace : { false, true })
+			{
+				for (const bool ignoreDepth : { false, true })
+				{
+					SDebugShapeBatch& batch = Batches[GetBatchIndex(vertexBuffer, isScreenSpace, ignoreDepth)];
+					batch.VertexBuffer = vertexBuffer;
+					// EVertexBufferPrimitives and EDefaultIndexBuffers are 1:1
+					batch.IndexBuffer = static_cast<EDefaultIndexBuffers>(vertexBuffer);
+					batch.IndexCount = STATIC_U16(primitive.Indices.size());
+					batch.IgnoreDepth = ignoreDepth;
+					batch.IsScreenSpace = isScreenSpace;
+				}
+			}
+		}
+
 		HV_LOG_INFO("GDebugDraw: Instance initialized.");
 		return true;
 #else
@@ -101,11 +146,9 @@ namespace Havtorn
 		if (start.IsEqual(end))
 			return;
 
-		std::vector<SDebugDrawData> newData = { SDebugDrawData(EVertexBufferPrimitives::Line, EDefaultIndexBuffers::Line) };
-
-		TransformToFaceAndReach(start, end, newData[0].TransformMatrix);
-
-		TryAddShapes(color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, newData);
+		SMatrix transform;
+		TransformToFaceAndReach(start, end, transform);
+		TryAddShape(EVertexBufferPrimitives::Line, transform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
 	}
 
 	void GDebugDraw::AddLine2D(const SVector2<F32>& start, const SVector2<F32>& end, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth)
@@ -113,151 +156,117 @@ namespace Havtorn
 		if (start.IsEqual(end))
 			return;
 
-		std::vector<SDebugDrawData> newData = { SDebugDrawData(EVertexBufferPrimitives::Line, EDefaultIndexBuffers::Line) };
-		newData.back().IsScreenSpace = true;
-
-		TransformToFaceAndReach(start, end, newData[0].TransformMatrix);
-
-		TryAddShapes(color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, newData);
+		SMatrix transform;
+		TransformToFaceAndReach(start, end, transform);
+		TryAddShape(EVertexBufferPrimitives::Line, transform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, true);
 	}
 
 	void GDebugDraw::AddArrow(const SVector& start, const SVector& end, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth)
 	{
-		std::vector<SDebugDrawData> newData = { 
-			SDebugDrawData(EVertexBufferPrimitives::Pyramid, EDefaultIndexBuffers::Pyramid),
-			SDebugDrawData(EVertexBufferPrimitives::Line, EDefaultIndexBuffers::Line)
-		};
-		SMatrix& lineTransform = newData[1].TransformMatrix;
+		SMatrix lineTransform;
 		TransformToFaceAndReach(start, end, lineTransform);
 
 		constexpr F32 scale = 0.1f;
 		const SVector pyramidPos = end - lineTransform.GetForward().GetNormalized() * 0.1f;
 		// Default pyramid's height is along the Y axis, rotation offset of 90 degrees around X places it along the Z axis.
-		SMatrix::Recompose(pyramidPos, lineTransform.GetEuler() + SVector(90.0f, 0.0f, 0.0f), scale, newData[0].TransformMatrix);
-		if (TryAddShapes(color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, newData))
-		{
-		}	
+		SMatrix pyramidTransform;
+		SMatrix::Recompose(pyramidPos, lineTransform.GetEuler() + SVector(90.0f, 0.0f, 0.0f), scale, pyramidTransform);
+
+		TryAddShape(EVertexBufferPrimitives::Pyramid, pyramidTransform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
+		TryAddShape(EVertexBufferPrimitives::Line, lineTransform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
 	}
 
 	void GDebugDraw::AddCube(const SVector& center, const SVector& eulerRotation, const SVector& scale, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth)
 	{
-		std::vector<SDebugDrawData> newData = { SDebugDrawData(EVertexBufferPrimitives::BoundingBox, EDefaultIndexBuffers::BoundingBox)};
-		SMatrix::Recompose(center, eulerRotation, scale, newData[0].TransformMatrix);
-		if (TryAddShapes(color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, newData))
-		{
-		}
+		SMatrix transform;
+		SMatrix::Recompose(center, eulerRotation, scale, transform);
+		TryAddShape(EVertexBufferPrimitives::BoundingBox, transform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
 	}
 
 	void GDebugDraw::AddCamera(const SVector& origin, const SVector& eulerRotation, const F32 fov, const F32 aspectRatio, const F32 farZ, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth)
 	{
-		std::vector<SDebugDrawData> newData = { SDebugDrawData(EVertexBufferPrimitives::Camera, EDefaultIndexBuffers::Camera)};
 		// TODO.AG: Rework this. Does not seem to properly represent fov & farZ. Might have to use aspectratio?
 		F32 y = 2.0f * farZ * std::tanf(UMath::DegToRad(fov) * 0.5f);
 		F32 x = 2.0f * farZ * std::tanf(UMath::DegToRad(fov) * 0.5f) * aspectRatio;
 		SVector vScale(x, y, farZ);
-		SMatrix::Recompose(origin, eulerRotation, vScale, newData[0].TransformMatrix);
-		TryAddShapes(color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, newData);
-		AddCube(origin + newData[0].TransformMatrix.GetBackward() * 0.02f, eulerRotation, SVector(0.15f, 0.15f, 0.25f), color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
+		SMatrix transform;
+		SMatrix::Recompose(origin, eulerRotation, vScale, transform);
+		TryAddShape(EVertexBufferPrimitives::Camera, transform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
+		AddCube(origin + transform.GetBackward() * 0.02f, eulerRotation, SVector(0.15f, 0.15f, 0.25f), color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
 	}
 
 	void GDebugDraw::AddCircle(const SVector& origin, const SVector& eulerRotation, const F32 radius, const U8 segments, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth)
 	{
 		// AG. The Default Circle is across the XZ plane
 		EVertexBufferPrimitives vertexBufferPrimitive = EVertexBufferPrimitives::Circle16;
-		EDefaultIndexBuffers indexBuffer = EDefaultIndexBuffers::Circle16;
 
 		// if requested segments are closer to 32
 		if (segments > 24)
-		{
 			vertexBufferPrimitive = EVertexBufferPrimitives::Circle32;
-			indexBuffer = EDefaultIndexBuffers::Circle32;
-		}
 		// if requested segments are closer to 8
 		else if (segments < 12)
-		{
 			vertexBufferPrimitive = EVertexBufferPrimitives::Circle8;
-			indexBuffer = EDefaultIndexBuffers::Circle8;
-		}
 
-		std::vector<SDebugDrawData> newData = { SDebugDrawData(vertexBufferPrimitive, indexBuffer)};
 		SVector scale(radius / GeometryPrimitives::CircleRadius);
-		SMatrix::Recompose(origin, eulerRotation, scale, newData[0].TransformMatrix);
-		if (TryAddShapes(color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, newData))
-		{
-		}
+		SMatrix transform;
+		SMatrix::Recompose(origin, eulerRotation, scale, transform);
+		TryAddShape(vertexBufferPrimitive, transform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
 	}
 
 	void GDebugDraw::AddGrid(const SVector& origin, const SVector& eulerRotation, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth)
 	{
-		std::vector<SDebugDrawData> data = { SDebugDrawData(EVertexBufferPrimitives::Grid, EDefaultIndexBuffers::Grid)};
-		SMatrix::Recompose(origin, eulerRotation, SVector(1.0f), data[0].TransformMatrix);
-		if (TryAddShapes(color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, data))
-		{
-		}
+		SMatrix transform;
+		SMatrix::Recompose(origin, eulerRotation, SVector(1.0f), transform);
+		TryAddShape(EVertexBufferPrimitives::Grid, transform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
 	}
 
 	void GDebugDraw::AddAxis(const SVector& origin, const SVector& eulerRotation, const SVector& scale, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth)
 	{
-		std::vector<SDebugDrawData> newData = { SDebugDrawData(EVertexBufferPrimitives::Axis, EDefaultIndexBuffers::Axis)};
-		SMatrix::Recompose(origin, eulerRotation, scale, newData[0].TransformMatrix);
-		if (TryAddShapes(color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, newData))
-		{
-		}
+		SMatrix transform;
+		SMatrix::Recompose(origin, eulerRotation, scale, transform);
+		TryAddShape(EVertexBufferPrimitives::Axis, transform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
 	}
 
 	void GDebugDraw::AddPoint(const SVector& origin, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth)
 	{
-		std::vector<SDebugDrawData> newData = { SDebugDrawData(EVertexBufferPrimitives::Octahedron, EDefaultIndexBuffers::Octahedron)};
-		SMatrix::Recompose(origin, SVector(), SVector(0.1f), newData[0].TransformMatrix);
-		if (TryAddShapes(color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, newData))
-		{
-		}
+		SMatrix transform;
+		SMatrix::Recompose(origin, SVector(), SVector(0.1f), transform);
+		TryAddShape(EVertexBufferPrimitives::Octahedron, transform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
 	}
 
 	void GDebugDraw::AddRectangle(const SVector& center, const SVector& eulerRotation, const SVector& scale, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth)
 	{
-		std::vector<SDebugDrawData> newData = { SDebugDrawData(EVertexBufferPrimitives::Square, EDefaultIndexBuffers::Square)};
-		SMatrix::Recompose(center, eulerRotation, scale, newData[0].TransformMatrix);
-		if (TryAddShapes(color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, newData))
-		{
-		}
+		SMatrix transform;
+		SMatrix::Recompose(center, eulerRotation, scale, transform);
+		TryAddShape(EVertexBufferPrimitives::Square, transform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
 	}
 
 	void GDebugDraw::AddSphere(const SVector& center, const SVector& eulerRotation, const SVector& scale, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth)
 	{
-		std::vector<SDebugDrawData> newData = { SDebugDrawData(EVertexBufferPrimitives::UVSphere, EDefaultIndexBuffers::UVSphere)};
-		SMatrix::Recompose(center, eulerRotation, scale, newData[0].TransformMatrix);
-		if (TryAddShapes(color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, newData))
-		{
-		}
+		SMatrix transform;
+		SMatrix::Recompose(center, eulerRotation, scale, transform);
+		TryAddShape(EVertexBufferPrimitives::UVSphere, transform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
 	}
 
 	void GDebugDraw::AddConeRadius(const SVector& apexPosition, const SVector& direction, const F32 height, const F32 radius, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth)
 	{
-		std::vector<SDebugDrawData> newData = { 
-			SDebugDrawData(EVertexBufferPrimitives::Circle16, EDefaultIndexBuffers::Circle16),
-			SDebugDrawData(EVertexBufferPrimitives::Line, EDefaultIndexBuffers::Line),
-			SDebugDrawData(EVertexBufferPrimitives::Line, EDefaultIndexBuffers::Line),
-			SDebugDrawData(EVertexBufferPrimitives::Line, EDefaultIndexBuffers::Line),
-			SDebugDrawData(EVertexBufferPrimitives::Line, EDefaultIndexBuffers::Line),
-		};
-			const SVector base = apexPosition + direction.GetNormalized() * height;
-
-			const SVector scale(radius / GeometryPrimitives::CircleRadius);
-			const SVector up = direction.IsEqual(SVector::Up) ? SVector::Forward : SVector::Up;
-			const SMatrix lookAt = SMatrix::Face(apexPosition, direction, up);
-			
-			// Default circle lies on the XZ plane, adding a rotation offset of 90degrees around X rotates it to the XY plane.
-			SMatrix::Recompose(base, lookAt.GetEuler() + SVector(90.0f, 0.0f, 0.0f), scale, newData[0].TransformMatrix);
-
-			const SVector lookAtRight = lookAt.GetRight();
-			const SVector lookAtUp = lookAt.GetUp();
-			TransformToFaceAndReach(apexPosition, base + lookAtRight * radius, newData[1].TransformMatrix);
-			TransformToFaceAndReach(apexPosition, base + lookAtRight * -radius, newData[2].TransformMatrix);
-			TransformToFaceAndReach(apexPosition, base + lookAtUp * radius, newData[3].TransformMatrix);
-			TransformToFaceAndReach(apexPosition, base + lookAtUp * -radius, newData[4].TransformMatrix);
-		if (TryAddShapes(color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth, newData))
+		const SVector base = apexPosition + direction.GetNormalized() * height;
+
+		const SVector scale(radius / GeometryPrimitives::CircleRadius);
+		const SVector up = direction.IsEqual(SVector::Up) ? SVector::Forward : SVector::Up;
+		const SMatrix lookAt = SMatrix::Face(apexPosition, direction, up);
+
+		// Default circle lies on the XZ plane, adding a rotation offset of 90degrees around X rotates it to the XY plane.
+		SMatrix transform;
+		SMatrix::Recompose(base, lookAt.GetEuler() + SVector(90.0f, 0.0f, 0.0f), scale, transform);
+		TryAddShape(EVertexBufferPrimitives::Circle16, transform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
+
+		const SVector lookAtRight = lookAt.GetRight();
+		const SVector lookAtUp = lookAt.GetUp();
+		for (const SVector& rimPoint : { base + lookAtRight * radius, base + lookAtRight * -radius, base + lookAtUp * radius, base + lookAtUp * -radius })
 		{
+			TransformToFaceAndReach(apexPosition, rimPoint, transform);
+			TryAddShape(EVertexBufferPrimitives::Line, transform, color, lifeTimeSeconds, useLifeTime, thickness, ignoreDepth);
 		}
 	}
 
@@ -281,32 +290,119 @@ namespace Havtorn
 		return true;
 	}
 
-	bool GDebugDraw::TryAddShapes(const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth, std::vector<SDebugDrawData>& outData)
+	SDebugDrawStats GDebugDraw::GetStats()
+	{
+		return Instance != nullptr ? Instance->Stats : SDebugDrawStats();
+	}
+
+	U64 GDebugDraw::GetBatchIndex(const EVertexBufferPrimitives vertexBuffer, const bool isScreenSpace, const bool ignoreDepth)
+	{
+		return (STATIC_U64(vertexBuffer) * 4) + (isScreenSpace ? 2 : 0) + (ignoreDepth ? 1 : 0);
+	}
+
+	bool GDebugDraw::TryAddShape(const EVertexBufferPrimitives vertexBuffer, const SMatrix& transform, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth, const bool isScreenSpace)
 	{
 		if (!InstanceExists())
 			return false;
 
-		if (outData.empty())
+		SDebugShapeBatch& batch = Instance->Batches[GetBatchIndex(vertexBuffer, isScreenSpace, ignoreDepth)];
+		if (batch.IndexCount == 0)
 		{
-			HV_LOG_WARN("GDebugDraw: Tried to add shapes without any data to initialize from. Please supply index and vertex buffers enums to outData in TryAddShapes.");
+			HV_LOG_WARN("GDebugDraw: Tried to add a shape without a primitive. Please add the vertex buffer enum to GDebugDraw::PrimitivesMap.");
 			return false;
 		}
 
-		for (SDebugDrawData& data : outData)
+		// Shapes without a lifetime are drawn once
+		const bool isTimed = useLifeTime && lifeTimeSeconds > 0.0f;
+		SDebugShapeBuffer& buffer = isTimed ? batch.TimedShapes : batch.FrameShapes;
+
+		const U32 index = buffer.Allocate();
+		buffer.Transforms[index] = transform;
+		buffer.Colors[index] = color.AsVector4();
+		buffer.Thicknesses[index] = UMath::Clamp(thickness, ThicknessMinimum, ThicknessMaximum);
+		buffer.LifeTimes[index] = isTimed ? lifeTimeSeconds : 0.0f;
+		return true;
+	}
+
+	U32 GDebugDraw::SDebugShapeBuffer::Allocate()
+	{
+		if (Size() < MaxShapesPerBatch)
 		{
-			data.Color = color;
-			data.LifeTime = useLifeTime ? lifeTimeSeconds : -1.0f;
-			data.Thickness = UMath::Clamp(thickness, ThicknessMinimum, ThicknessMaximum);
-			data.IndexCount = STATIC_U16(PrimitivesMap.at(data.VertexBuffer).Indices.size());
-			data.VertexBufferIndex = STATIC_U8(data.VertexBuffer);
-			data.IndexBufferIndex = STATIC_U8(data.IndexBuffer);
-			data.IgnoreDepth = ignoreDepth;
+			Transforms.emplace_back();
+			Colors.emplace_back();
+			Thicknesses.emplace_back();
+			LifeTimes.emplace_back();
+			return Size() - 1;
 		}
 
-		auto iterator = std::ranges::find_if(Instance->LiveData, [outData](const SDebugDrawData& data) { return data.LifeTime > outData[0].LifeTime; });
-		Instance->LiveData.insert(iterator, outData.begin(), outData.end());
+		// Full, overwrite the oldest shape
+		const U32 index = Head;
+		Head = (Head + 1) % MaxShapesPerBatch;
+		Instance->NumberOfOverwrittenShapes++;
+		return index;
+	}
 
-		return true;
+	void GDebugDraw::SDebugShapeBuffer::Clear()
+	{
+		// Keeps capacity, so steady state adding does not allocate
+		Transforms.clear();
+		Colors.clear();
+		Thicknesses.clear();
+		LifeTimes.clear();
+		Head = 0;
+	}
+
+	void GDebugDraw::SDebugShapeBuffer::CopyDrawData(const SDebugShapeBuffer& other)
+	{
+		Transforms.assign(other.Transforms.begin(), other.Transforms.end());
+		Colors.assign(other.Colors.begin(), other.Colors.end());
+		Thicknesses.assign(other.Thicknesses.begin(), other.Thicknesses.end());
+		LifeTimes.clear();
+		Head = 0;
+	}
+
+	void GDebugDraw::SDebugShapeBuffer::Swap(SDebugShapeBuffer& other)
+	{
+		std::swap(Transforms, other.Transforms);
+		std::swap(Colors, other.Colors);
+		std::swap(Thicknesses, other.Thicknesses);
+		std::swap(LifeTimes, other.LifeTimes);
+		std::swap(Head, other.Head);
+	}
+
+	void GDebugDraw::SDebugShapeBuffer::Expire(const F32 deltaTime)
+	{
+		if (Head != 0)
+		{
+			// Unroll the ring so the oldest shape comes first
+			std::rotate(Transforms.begin(), Transforms.begin() + Head, Transforms.end());
+			std::rotate(Colors.begin(), Colors.begin() + Head, Colors.end());
+			std::rotate(Thicknesses.begin(), Thicknesses.begin() + Head, Thicknesses.end());
+			std::rotate(LifeTimes.begin(), LifeTimes.begin() + Head, LifeTimes.end());
+			Head = 0;
+		}
+
+		U32 numberOfLiveShapes = 0;
+		for (U32 index = 0; index < Size(); index++)
+		{
+			LifeTimes[index] -= deltaTime;
+			if (LifeTimes[index] <= 0.0f)
+				continue;
+
+			if (numberOfLiveShapes != index)
+			{
+				Transforms[numberOfLiveShapes] = Transforms[index];
+				Colors[numberOfLiveShapes] = Colors[index];
+				Thicknesses[numberOfLiveShapes] = Thicknesses[index];
+				LifeTimes[numberOfLiveShapes] = LifeTimes[index];
+			}
+			numberOfLiveShapes++;
+		}
+
+		Transforms.resize(numberOfLiveShapes);
+		Colors.resize(numberOfLiveShapes);
+		Thicknesses.resize(numberOfLiveShapes);
+		LifeTimes.resize(numberOfLiveShapes);
 	}
 
 	void GDebugDraw::TransformToFaceAndReach(const SVector& start, const SVector& end, SMatrix& transform)
@@ -422,30 +518,5 @@ namespace Havtorn
 		AddLine2D(SVector2<F32>(max, min), SVector2<F32>(min, min), SColor::Orange, 1.0f, true);
 		AddLine2D(SVector2<F32>(min, max), SVector2<F32>(min, min), SColor::Grey, 1.0f, true);
 	}
-
-	void GDebugDraw::AddMaxShapes()
-	{
-		const SVector posLowerBound(-100.0f);
-		const SVector posUpperBound(100.0f);
-		const SVector rotLowerBound(0.0f);
-		const SVector rotUpperBound(180.0f);
-		//const SVector sclLowerBound(0.5f);
-		//const SVector sclUpperBound(2.0f);
-		for (U16 i = 0; i < MaxShapes; i++)
-		{
-			//GDebugDraw::AddCircle(
-			//	SVector::Random(posLowerBound, posUpperBound), 
-			//	SVector::Random(rotLowerBound, rotUpperBound), 
-			//	0.5f,
-			//	32,
-			//	SColor::Black, 1.0f, false, ThicknessMaximum, i % 2 == 0);
-
-			GDebugDraw::AddGrid(
-				SVector::Random(posLowerBound, posUpperBound),
-				SVector::Random(rotLowerBound, rotUpperBound),
-				SColor::Black, 1.0f, false, 1.0f, i % 2 == 0);
-		}
-
-	}
 #endif
 }
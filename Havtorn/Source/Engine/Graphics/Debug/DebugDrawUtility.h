@@ -6,7 +6,6 @@
 #include "Graphics/GraphicsStructs.h"
 #include <Color.h>
 
-#include <queue>
 #include <map>
 
 #if defined _DEBUG || defined HV_EDITOR_BUILD
@@ -29,9 +28,29 @@ namespace Havtorn
 	class GEngine;
 	class CRenderManager;
 
+	struct SDebugDrawStats
+	{
+		U32 NumberOfFrameShapes = 0;
+		U32 NumberOfTimedShapes = 0;
+		// Instanced draw commands, one per primitive type and depth mode that has shapes
+		U32 NumberOfBatches = 0;
+		U32 NumberOfOverwrittenShapes = 0;
+	};
+
 	class GDebugDraw final
 	{
 		friend GEngine;
+		friend CRenderManager;
+
+	public:
+		GDebugDraw() = default;
+		ENGINE_API ~GDebugDraw();
+
+		// Without a render manager, shapes are still collected and handed over at sync but never drawn, as in the test runner
+		ENGINE_API bool Init(CRenderManager* renderManager);
+		// Hands this frame's shapes over to the render thread and pushes their draw commands, then ages the timed shapes by
+		// deltaTime. Called while the render thread waits, after everything this frame has added its shapes, see GEngine::EndFrame.
+		ENGINE_API void SyncCrossThreadResources(const F32 deltaTime);
 
 	public: // Static Add Shape functions.
 		/*
@@ -40,10 +59,11 @@ namespace Havtorn
 		*	+	Add entry to EVertexBufferPrimitives and EDefaultIndexBuffers in GraphicsEnum.h
 		*	+	In RenderManager.cpp: InitVertexBuffers() and InitIndexBuffers() call AddVertexBuffer(..)/AddIndexBuffer(..) for shape
 		*	+	In DebugShapeSystem.cpp: add EVertexBufferPrimitives entry and the corresponding SPrimitive to GDebugDraw::PrimitivesMap
-		*	+	Create a static function for the shape, use TryAddShapes(..) to set default parameters
+		*	+	Create a static function for the shape, use TryAddShape(..) for each primitive it is made of
 		*	+	Optional: add a call to the shape to TestAllShapes() and call it somewhere to see that everything is working as expected.
 		*/
-		static constexpr U16 MaxShapes = 0;
+		// Per primitive type, depth mode and lifetime bucket. When full, the oldest shapes are overwritten.
+		static constexpr U32 MaxShapesPerBatch = 1 << 20;
 		static constexpr F32 ThicknessMinimum = 0.005f;
 		static constexpr F32 ThicknessMaximum = 0.05f;
 
@@ -70,49 +90,54 @@ namespace Havtorn
 		//static void AddCapsule(const SVector& center, const SVector& eulerRotation, const F32 height, const F32 radius, const SColor& color = SColor::White, const F32 lifeTimeSeconds = -1.0f, const bool useLifeTime = true, const F32 thickness = ThicknessMinimum, const bool ignoreDepth = true);
 
 	private:
-		bool Init(CRenderManager* renderManager);
-		void Update();
-
 		static bool InstanceExists();
 
-		/*
-			TODO.AG: Adding several shapes at once: composite shapes.
-			Differing parameters: vertexBuffer, indexBuffer, transform
-		*/
-		struct SDebugDrawData
+		// SoA ring buffer of shape instances. Written linearly until full, after which Head points at the oldest entry.
+		struct SDebugShapeBuffer
 		{
-			EVertexBufferPrimitives VertexBuffer;
-			EDefaultIndexBuffers IndexBuffer;
+			std::vector<SMatrix> Transforms;
+			std::vector<SVector4> Colors;
+			std::vector<F32> Thicknesses;
+			std::vector<F32> LifeTimes;
+			U32 Head = 0;
+
+			[[nodiscard]] U32 Size() const { return STATIC_U32(Transforms.size()); }
+			U32 Allocate();
+			void Clear();
+			// Copies what the render thread needs into this buffer's existing capacity
+			void CopyDrawData(const SDebugShapeBuffer& other);
+			void Swap(SDebugShapeBuffer& other);
+			// Removes shapes whose lifetime has run out, keeping the rest in insertion order
+			void Expire(const F32 deltaTime);
+		};
 
-			SMatrix TransformMatrix;
-			SColor Color;
-			F32 LifeTime = 0.0f;
-			F32 Thickness = 1.0f;
+		// All shapes that can be drawn with one instanced draw. Shapes that only live for one frame are kept apart
+		// from timed shapes, so the frame bucket can be reset without touching lifetimes.
+		struct SDebugShapeBatch
+		{
+			SDebugShapeBuffer FrameShapes;
+			SDebugShapeBuffer TimedShapes;
+			// Read by the render thread, which uploads its instances straight from these
+			SDebugShapeBuffer RenderFrameShapes;
+			SDebugShapeBuffer RenderTimedShapes;
+			EVertexBufferPrimitives VertexBuffer = EVertexBufferPrimitives::Line;
+			EDefaultIndexBuffers IndexBuffer = EDefaultIndexBuffers::Line;
 			U16 IndexCount = 0;
-			U8 VertexBufferIndex = 0;
-			U8 IndexBufferIndex = 0;
 			bool IgnoreDepth = true;
 			bool IsScreenSpace = false;
-
-			SDebugDrawData() = delete;
-			SDebugDrawData(EVertexBufferPrimitives vertexBuffer, EDefaultIndexBuffers indexBuffer)
-				: VertexBuffer(vertexBuffer)
-				, IndexBuffer(indexBuffer)
-			{}
-
-			std::partial_ordering operator<=>(const SDebugDrawData& rhs) const { return LifeTime <=> rhs.LifeTime; }
 		};
 
-		static bool TryAddShapes(const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth, std::vector<SDebugDrawData>& outData);
+		static U64 GetBatchIndex(const EVertexBufferPrimitives vertexBuffer, const bool isScreenSpace, const bool ignoreDepth);
+		static bool TryAddShape(const EVertexBufferPrimitives vertexBuffer, const SMatrix& transform, const SColor& color, const F32 lifeTimeSeconds, const bool useLifeTime, const F32 thickness, const bool ignoreDepth, const bool isScreenSpace = false);
 		static void TransformToFaceAndReach(const SVector& start, const SVector& end, SMatrix& transform);
 		static void TransformToFaceAndReach(const SVector2<F32>& start, const SVector2<F32>& end, SMatrix& transform);
 
-#if _DEBUG
 	public:
+		static ENGINE_API SDebugDrawStats GetStats();
+
+#if _DEBUG
 		// TODO.AG: Should only be usable in debug.
 		static void ENGINE_API TestAllShapes();
-		// To stress test. Should use shape with most vertices & indices.
-		static void AddMaxShapes();
 #endif
 
 	private:
@@ -120,6 +145,9 @@ namespace Havtorn
 		CRenderManager* RenderManager = nullptr;
 
 		const static std::map<EVertexBufferPrimitives, const SPrimitive&> PrimitivesMap;
-		std::vector<SDebugDrawData> LiveData;
+		// Indexed by GetBatchIndex
+		std::vector<SDebugShapeBatch> Batches;
+		SDebugDrawStats Stats;
+		U32 NumberOfOverwrittenShapes = 0;
 	};
 }
\ No newline at end of file
@@ -30,6 +30,7 @@ namespace Havtorn
 		TransUVRectColorEntity2,
 		Pos3Nor3Tan3Bit3UV2BoneID4BoneWeight4AnimDataTrans,
 		Pos3Nor3Tan3Bit3UV2BoneID4BoneWeight4Entity2AnimDataTrans,
+		Position4TransColorThickness,
 		Null
 	};
 
@@ -49,6 +50,7 @@ namespace Havtorn
 		SkeletalMeshInstanced = 11,
 		SkeletalMeshInstancedEditor = 12,
 		Skybox = 13,
+		LineScreenSpace = 14,
 		Count,
 		Null = Count
 	};
@@ -101,10 +103,9 @@ namespace Havtorn
 	enum class EGeometryShaders
 	{
 		Line = 0,
-		Line2D = 1,
-		SpriteScreenSpace = 2,
-		SpriteWorldSpace = 3,
-		SpriteWorldSpaceEditor = 4,
+		SpriteScreenSpace = 1,
+		SpriteWorldSpace = 2,
+		SpriteWorldSpaceEditor = 3,
 		Count,
 		Null = Count
 	};
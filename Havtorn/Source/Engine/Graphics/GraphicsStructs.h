@@ -76,6 +76,13 @@ namespace Havtorn
 		U16 MaterialIndex = 0;
 	};
 
+	struct SStaticMeshLOD
+	{
+		// The LOD is used while the projected bounds of the mesh cover less than this fraction of the screen height
+		F32 ScreenSize = 0.0f;
+		std::vector<SStaticMesh> Meshes;
+	};
+
 	struct SSkeletalMesh
 	{
 		std::string Name;
@@ -84,6 +91,49 @@ namespace Havtorn
 		U16 MaterialIndex = 0;
 	};
 
+	struct SMeshBounds
+	{
+		SVector Min = SVector(FLT_MAX);
+		SVector Max = SVector(-FLT_MAX);
+		// The sphere is centered on the box, but only reaches the farthest vertex instead of the box corners
+		SVector Center = SVector(0.0f);
+		F32 Radius = 0.0f;
+
+		[[nodiscard]] bool IsValid() const { return Min.X <= Max.X; }
+	};
+
+	// Compact vertices are a storage format, model files saved with them are decoded to the full vertices when read.
+	// Positions and UVs are unorm within the ranges in SVertexQuantization, directions are octahedral snorm.
+	struct SCompactStaticMeshVertex
+	{
+		U16 x, y, z;
+		I16 nx, ny;
+		I16 tx, ty;
+		I16 bx, by;
+		U16 u, v;
+	};
+
+	struct SCompactSkeletalMeshVertex
+	{
+		U16 x, y, z;
+		I16 nx, ny;
+		I16 tx, ty;
+		I16 bx, by;
+		U16 u, v;
+		U8 BoneIndices[4];
+		// Unorm, always adds up to 255 unless the vertex has no weights at all
+		U8 BoneWeights[4];
+	};
+
+	// Ranges shared by every compact vertex in a model file
+	struct SVertexQuantization
+	{
+		SVector PositionMin = SVector(0.0f);
+		SVector PositionExtent = SVector(0.0f);
+		SVector2<F32> UVMin = SVector2<F32>::Zero;
+		SVector2<F32> UVExtent = SVector2<F32>::Zero;
+	};
+
 	struct SSkeletalMeshBone
 	{
 		CHavtornStaticString<255> Name;
@@ -134,13 +184,67 @@ namespace Havtorn
 		}
 	};
 
-	struct SSkeletalPosedNode
+	// Compact keys are a storage format like compact vertices, animation files saved with them are decoded to the full keys
+	// when read. Translations and scales are unorm within the ranges in SAnimationQuantization, rotations keep the three smallest
+	// components of the quaternion, see UAnimationCompression. Key times are whole ticks.
+	struct SCompactVecAnimationKey
 	{
-		SMatrix LocalTransform;
-		SMatrix GlobalTransform;
+		U16 x, y, z;
+		U16 Tick;
+	};
 
-		// TODO.NW: Probably want to just hash the name assuming this doesn't need to be serialized. Harder to debug though
-		CHavtornStaticString<255> Name;
+	struct SCompactQuatAnimationKey
+	{
+		// 48 bits, three 15 bit components, the index of the one left out and whether the quaternion was negated
+		U16 SmallestThree[3];
+		U16 Tick;
+	};
+
+	struct SCompactBoneAnimationTrack
+	{
+		std::vector<SCompactVecAnimationKey> TranslationKeys;
+		std::vector<SCompactQuatAnimationKey> RotationKeys;
+		std::vector<SCompactVecAnimationKey> ScaleKeys;
+	};
+
+	// Ranges shared by every compact key in an animation file
+	struct SAnimationQuantization
+	{
+		SVector TranslationMin = SVector(0.0f);
+		SVector TranslationExtent = SVector(0.0f);
+		SVector ScaleMin = SVector(0.0f);
+		SVector ScaleExtent = SVector(0.0f);
+	};
+
+	// Keys a playing track sampled last time. Playback moves forward, so the next sample is almost always in the same
+	// or one of the following segments.
+	struct SBoneTrackCursor
+	{
+		U32 TranslationKey = 0;
+		U32 RotationKey = 0;
+		U32 ScaleKey = 0;
+	};
+
+	// Local space pose, one entry per node of the mesh (see SSkeletalAnimationBinding). Kept as separate translation,
+	// rotation and scale arrays so sampling and blending only touch what they need, matrices are only built for the bone palette.
+	struct SSkeletalPose
+	{
+		std::vector<SVector> Translations;
+		std::vector<SQuaternion> Rotations;
+		std::vector<SVector> Scales;
+
+		// Only allocates the first time, or when the skeleton grows
+		void Resize(const U64 numberOfNodes)
+		{
+			Translations.resize(numberOfNodes, SVector::Zero);
+			Rotations.resize(numberOfNodes, SQuaternion::Identity);
+			Scales.resize(numberOfNodes, SVector(1.0f));
+		}
+
+		[[nodiscard]] U64 Size() const
+		{
+			return Translations.size();
+		}
 	};
 
 	struct SBoneAnimationClip
@@ -48,7 +48,7 @@ namespace Havtorn
 			UFileSystem::Deserialize(filePath, data, STATIC_U32(fileSize));
 
 			STextureFileHeader assetFile;
-			assetFile.Deserialize(data);
+			assetFile.Deserialize(data, fileSize);
 
 			DirectX::ScratchImage scratchImage;
 			DirectX::TexMetadata metaData = {};
@@ -0,0 +1,312 @@
+// Copyright 2022 Team Havtorn. All Rights Reserved.
+
+#include "OcclusionCulling.h"
+#include "Threading/ThreadManager.h"
+
+#include <MathTypes/EngineMathSSE.h>
+
+namespace Havtorn
+{
+	namespace
+	{
+		constexpr U32 QueriesPerJob = 256;
+
+		inline void ToScreenSpace(const SVector4& clipPosition, F32& outX, F32& outY, F32& outDepth)
+		{
+			const F32 inverseW = 1.0f / clipPosition.W;
+			outX = (clipPosition.X * inverseW * 0.5f + 0.5f) * STATIC_F32(COcclusionCuller::BufferWidth);
+			outY = (0.5f - clipPosition.Y * inverseW * 0.5f) * STATIC_F32(COcclusionCuller::BufferHeight);
+			outDepth = clipPosition.Z * inverseW;
+		}
+	}
+
+	void COcclusionCuller::BeginFrame(const SMatrix& viewProjection)
+	{
+		ViewProjection = viewProjection;
+		Triangles.clear();
+		DepthBuffer.assign(STATIC_U64(BufferWidth) * BufferHeight, 1.0f);
+		TileMaxDepth.assign(STATIC_U64(TileCountX) * TileCountY, 1.0f);
+		Stats = SOcclusionCullingStats();
+	}
+
+	void COcclusionCuller::AddOccluder(const std::vector<SVector>& positions, const std::vector<U32>& indices, const SMatrix& transform)
+	{
+		if (positions.empty() || indices.size() < 3)
+			return;
+
+		const SMatrix toClipSpace = transform * ViewProjection;
+
+		std::vector<SVector4> clipPositions;
+		clipPositions.reserve(positions.size());
+		for (const SVector& position : positions)
+			clipPositions.emplace_back(SVector4(position, 1.0f) * toClipSpace);
+
+		Stats.NumberOfOccluders++;
+
+		for (U64 i = 0; i + 2 < indices.size(); i += 3)
+		{
+			const SVector4* corners[3] = { &clipPositions[indices[i]], &clipPositions[indices[i + 1]], &clipPositions[indices[i + 2]] };
+
+			// No near plane clipping, dropping occluder triangles only ever makes culling less aggressive
+			if (corners[0]->Z < 0.0f || corners[1]->Z < 0.0f || corners[2]->Z < 0.0f)
+				continue;
+
+			F32 x[3], y[3], depth[3];
+			for (U8 corner = 0; corner < 3; corner++)
+				ToScreenSpace(*corners[corner], x[corner], y[corner], depth[corner]);
+
+			F32 area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+			if (UMath::Abs(area) < 0.0001f)
+				continue;
+
+			// Occluders are two sided, wind every triangle the same way
+			if (area < 0.0f)
+			{
+				std::swap(x[1], x[2]);
+				std::swap(y[1], y[2]);
+				std::swap(depth[1], depth[2]);
+				area = -area;
+			}
+
+			STriangleSetup setup;
+			setup.MinX = UMath::Max(0, STATIC_I32(std::floor(UMath::Min(x[0], UMath::Min(x[1], x[2])))));
+			setup.MaxX = UMath::Min(BufferWidth - 1, STATIC_I32(std::floor(UMath::Max(x[0], UMath::Max(x[1], x[2])))));
+			setup.MinY = UMath::Max(0, STATIC_I32(std::floor(UMath::Min(y[0], UMath::Min(y[1], y[2])))));
+			setup.MaxY = UMath::Min(BufferHeight - 1, STATIC_I32(std::floor(UMath::Max(y[0], UMath::Max(y[1], y[2])))));
+			if (setup.MinX > setup.MaxX || setup.MinY > setup.MaxY)
+				continue;
+
+			// Edge i is opposite of corner i, which makes edge i / area the barycentric weight of corner i
+			for (U8 edge = 0; edge < 3; edge++)
+			{
+				const U8 from = (edge + 1) % 3;
+				const U8 to = (edge + 2) % 3;
+				setup.EdgeA[edge] = y[from] - y[to];
+				setup.EdgeB[edge] = x[to] - x[from];
+
+				// Both triangles sharing an edge measure it from the same corner, so their edge functions are exact
+				// negations of each other and a pixel center on the edge can't be rejected by both
+				const U8 origin = (x[from] < x[to] || (x[from] == x[to] && y[from] < y[to])) ? from : to;
+				setup.EdgeOriginX[edge] = x[origin];
+				setup.EdgeOriginY[edge] = y[origin];
+				setup.Depth[edge] = depth[edge];
+			}
+			setup.InverseArea = 1.0f / area;
+
+			Triangles.emplace_back(setup);
+		}
+
+		Stats.NumberOfOccluderTriangles = STATIC_U32(Triangles.size());
+	}
+
+	void COcclusionCuller::RasterizeOccluders(CThreadManager* threadManager)
+	{
+		if (Triangles.empty())
+			return;
+
+		const U32 numberOfJobs = threadManager != nullptr ? UMath::Min(STATIC_U32(TileCountY), STATIC_U32(threadManager->GetNumberOfThreads()) + 1) : 1;
+		auto rasterizeBand = [this, numberOfJobs](const U32 jobIndex)
+		{
+			RasterizeTileRows(STATIC_U16(TileCountY * jobIndex / numberOfJobs), STATIC_U16(TileCountY * (jobIndex + 1) / numberOfJobs));
+		};
+
+		if (threadManager != nullptr)
+			threadManager->ParallelFor(numberOfJobs, rasterizeBand);
+		else
+			rasterizeBand(0);
+	}
+
+	void COcclusionCuller::RasterizeTileRows(const U16 firstTileRow, const U16 lastTileRow)
+	{
+		const I32 firstRow = firstTileRow * TileSize;
+		const I32 lastRow = lastTileRow * TileSize - 1;
+
+		const VectorRegister zero = VectorRegisterZero();
+		const VectorRegister laneOffsets = MakeVectorRegister(0.5f, 1.5f, 2.5f, 3.5f);
+
+		for (const STriangleSetup& triangle : Triangles)
+		{
+			const I32 minY = UMath::Max(triangle.MinY, firstRow);
+			const I32 maxY = UMath::Min(triangle.MaxY, lastRow);
+			if (minY > maxY)
+				continue;
+
+			// Rows are processed in groups of four pixels, the edge functions reject lanes outside the triangle
+			const I32 startX = triangle.MinX & ~3;
+			const VectorRegister startPixelX = VectorRegisterAdd(VectorRegisterSet1(STATIC_F32(startX)), laneOffsets);
+
+			VectorRegister edgeA[3], edgeOriginX[3], depth[3];
+			for (U8 edge = 0; edge < 3; edge++)
+			{
+				edgeA[edge] = VectorRegisterSet1(triangle.EdgeA[edge]);
+				edgeOriginX[edge] = VectorRegisterSet1(triangle.EdgeOriginX[edge]);
+				depth[edge] = VectorRegisterSet1(triangle.Depth[edge]);
+			}
+			const VectorRegister inverseArea = VectorRegisterSet1(triangle.InverseArea);
+			const VectorRegister pixelStep = VectorRegisterSet1(4.0f);
+
+			for (I32 y = minY; y <= maxY; y++)
+			{
+				const F32 pixelY = STATIC_F32(y) + 0.5f;
+
+				VectorRegister edgeRow[3];
+				for (U8 edge = 0; edge < 3; edge++)
+					edgeRow[edge] = VectorRegisterSet1(triangle.EdgeB[edge] * (pixelY - triangle.EdgeOriginY[edge]));
+
+				// Edge functions are evaluated per pixel rather than stepped, stepping would break the symmetry of shared edges
+				VectorRegister pixelX = startPixelX;
+				F32* row = &DepthBuffer[STATIC_U64(y) * BufferWidth];
+				for (I32 x = startX; x <= triangle.MaxX; x += 4)
+				{
+					VectorRegister edgeValue[3];
+					for (U8 edge = 0; edge < 3; edge++)
+						edgeValue[edge] = VectorRegisterAdd(VectorRegisterMultiply(edgeA[edge], VectorRegisterSubtract(pixelX, edgeOriginX[edge])), edgeRow[edge]);
+
+					const VectorRegister inside = VectorRegisterAnd(VectorRegisterAnd(
+						VectorRegisterCompareGreaterEqual(edgeValue[0], zero),
+						VectorRegisterCompareGreaterEqual(edgeValue[1], zero)),
+						VectorRegisterCompareGreaterEqual(edgeValue[2], zero));
+
+					if (VectorRegisterMoveMask(inside) != 0)
+					{
+						VectorRegister pixelDepth = VectorRegisterMultiply(edgeValue[0], depth[0]);
+						pixelDepth = VectorRegisterAdd(pixelDepth, VectorRegisterMultiply(edgeValue[1], depth[1]));
+						pixelDepth = VectorRegisterAdd(pixelDepth, VectorRegisterMultiply(edgeValue[2], depth[2]));
+						pixelDepth = VectorRegisterMultiply(pixelDepth, inverseArea);
+
+						const VectorRegister currentDepth = VectorRegisterLoad(row + x);
+						VectorRegisterStore(VectorRegisterSelect(inside, VectorRegisterMin(currentDepth, pixelDepth), currentDepth), row + x);
+					}
+
+					pixelX = VectorRegisterAdd(pixelX, pixelStep);
+				}
+			}
+		}
+
+		for (U16 tileY = firstTileRow; tileY < lastTileRow; tileY++)
+		{
+			for (U16 tileX = 0; tileX < TileCountX; tileX++)
+			{
+				VectorRegister maxDepth = VectorRegisterZero();
+				for (U16 y = 0; y < TileSize; y++)
+				{
+					const F32* row = &DepthBuffer[STATIC_U64(tileY * TileSize + y) * BufferWidth + STATIC_U64(tileX) * TileSize];
+					maxDepth = VectorRegisterMax(maxDepth, VectorRegisterMax(VectorRegisterLoad(row), VectorRegisterLoad(row + 4)));
+				}
+
+				alignas(16) F32 lanes[4];
+				VectorRegisterStore(maxDepth, lanes);
+				TileMaxDepth[STATIC_U64(tileY) * TileCountX + tileX] = UMath::Max(UMath::Max(lanes[0], lanes[1]), UMath::Max(lanes[2], lanes[3]));
+			}
+		}
+	}
+
+	EOcclusionResult COcclusionCuller::TestBounds(const SVector& boundsMin, const SVector& boundsMax, const SMatrix& transform) const
+	{
+		const SMatrix toClipSpace = transform * ViewProjection;
+
+		F32 minX = FLT_MAX, minY = FLT_MAX, minDepth = FLT_MAX;
+		F32 maxX = -FLT_MAX, maxY = -FLT_MAX;
+		U8 numberOfCornersBehindNearPlane = 0;
+		for (U8 corner = 0; corner < 8; corner++)
+		{
+			const SVector position = SVector((corner & 1) ? boundsMax.X : boundsMin.X, (corner & 2) ? boundsMax.Y : boundsMin.Y, (corner & 4) ? boundsMax.Z : boundsMin.Z);
+			const SVector4 clipPosition = SVector4(position, 1.0f) * toClipSpace;
+			if (clipPosition.Z < 0.0f)
+			{
+				numberOfCornersBehindNearPlane++;
+				continue;
+			}
+
+			F32 x, y, depth;
+			ToScreenSpace(clipPosition, x, y, depth);
+			minX = UMath::Min(minX, x);
+			maxX = UMath::Max(maxX, x);
+			minY = UMath::Min(minY, y);
+			maxY = UMath::Max(maxY, y);
+			minDepth = UMath::Min(minDepth, depth);
+		}
+
+		if (numberOfCornersBehindNearPlane == 8)
+			return EOcclusionResult::OutsideFrustum;
+
+		// Crosses the near plane, the projected rect can't be trusted
+		if (numberOfCornersBehindNearPlane > 0)
+			return EOcclusionResult::Visible;
+
+		if (maxX < 0.0f || minX > STATIC_F32(BufferWidth) || maxY < 0.0f || minY > STATIC_F32(BufferHeight) || minDepth > 1.0f)
+			return EOcclusionResult::OutsideFrustum;
+
+		if (Triangles.empty())
+			return EOcclusionResult::Visible;
+
+		// Every pixel the rect touches counts, not just the ones whose centers it covers
+		const I32 pixelMinX = UMath::Max(0, STATIC_I32(std::floor(minX)));
+		const I32 pixelMaxX = UMath::Min(BufferWidth - 1, STATIC_I32(std::floor(maxX)));
+		const I32 pixelMinY = UMath::Max(0, STATIC_I32(std::floor(minY)));
+		const I32 pixelMaxY = UMath::Min(BufferHeight - 1, STATIC_I32(std::floor(maxY)));
+
+		for (I32 tileY = pixelMinY / TileSize; tileY <= pixelMaxY / TileSize; tileY++)
+		{
+			for (I32 tileX = pixelMinX / TileSize; tileX <= pixelMaxX / TileSize; tileX++)
+			{
+				// Every occluder in this tile is in front of the bounds
+				if (TileMaxDepth[STATIC_U64(tileY) * TileCountX + tileX] < minDepth)
+					continue;
+
+				const I32 tileMinY = UMath::Max(pixelMinY, tileY * TileSize);
+				const I32 tileMaxY = UMath::Min(pixelMaxY, tileY * TileSize + TileSize - 1);
+				const I32 tileMinX = UMath::Max(pixelMinX, tileX * TileSize);
+				const I32 tileMaxX = UMath::Min(pixelMaxX, tileX * TileSize + TileSize - 1);
+				for (I32 y = tileMinY; y <= tileMaxY; y++)
+				{
+					const F32* row = &DepthBuffer[STATIC_U64(y) * BufferWidth];
+					for (I32 x = tileMinX; x <= tileMaxX; x++)
+					{
+						if (row[x] >= minDepth)
+							return EOcclusionResult::Visible;
+					}
+				}
+			}
+		}
+
+		return EOcclusionResult::Occluded;
+	}
+
+	void COcclusionCuller::TestBounds(const std::vector<SOcclusionQuery>& queries, std::vector<EOcclusionResult>& outResults, CThreadManager* threadManager)
+	{
+		outResults.resize(queries.size());
+
+		const U32 numberOfJobs = STATIC_U32((queries.size() + QueriesPerJob - 1) / QueriesPerJob);
+		auto testQueries = [&](const U32 jobIndex)
+		{
+			const U64 end = UMath::Min(STATIC_U64(queries.size()), STATIC_U64(jobIndex + 1) * QueriesPerJob);
+			for (U64 i = STATIC_U64(jobIndex) * QueriesPerJob; i < end; i++)
+				outResults[i] = TestBounds(queries[i].BoundsMin, queries[i].BoundsMax, queries[i].Transform);
+		};
+
+		if (threadManager != nullptr && numberOfJobs > 1)
+			threadManager->ParallelFor(numberOfJobs, testQueries);
+		else
+		{
+			for (U32 jobIndex = 0; jobIndex < numberOfJobs; jobIndex++)
+				testQueries(jobIndex);
+		}
+
+		for (const EOcclusionResult result : outResults)
+		{
+			switch (result)
+			{
+			case EOcclusionResult::Visible:
+				Stats.NumberOfVisibleInstances++;
+				break;
+			case EOcclusionResult::OutsideFrustum:
+				Stats.NumberOfFrustumCulledInstances++;
+				break;
+			case EOcclusionResult::Occluded:
+				Stats.NumberOfOccludedInstances++;
+				break;
+			}
+		}
+	}
+}
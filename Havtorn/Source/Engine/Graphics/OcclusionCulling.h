@@ -0,0 +1,83 @@
+// Copyright 2022 Team Havtorn. All Rights Reserved.
+
+#pragma once
+#include "hvpch.h"
+
+namespace Havtorn
+{
+	class CThreadManager;
+
+	enum class EOcclusionResult : U8
+	{
+		Visible,
+		OutsideFrustum,
+		Occluded
+	};
+
+	struct SOcclusionQuery
+	{
+		SMatrix Transform;
+		SVector BoundsMin;
+		SVector BoundsMax;
+	};
+
+	struct SOcclusionCullingStats
+	{
+		U32 NumberOfOccluders = 0;
+		U32 NumberOfOccluderTriangles = 0;
+		U32 NumberOfVisibleInstances = 0;
+		U32 NumberOfFrustumCulledInstances = 0;
+		U32 NumberOfOccludedInstances = 0;
+	};
+
+	// Software occlusion culling along the lines of masked occlusion culling. Designated occluders are rasterized
+	// into a small depth buffer, four pixels at a time, keeping the closest NDC depth per pixel. Every tile also
+	// keeps the farthest depth of its pixels, so most bounds tests are answered without looking at single pixels.
+	// Pure CPU, the thread manager is optional and everything runs on the calling thread without one.
+	class ENGINE_API COcclusionCuller
+	{
+	public:
+		static constexpr U16 BufferWidth = 256;
+		static constexpr U16 BufferHeight = 128;
+		static constexpr U16 TileSize = 8;
+		static constexpr U16 TileCountX = BufferWidth / TileSize;
+		static constexpr U16 TileCountY = BufferHeight / TileSize;
+
+		void BeginFrame(const SMatrix& viewProjection);
+		void AddOccluder(const std::vector<SVector>& positions, const std::vector<U32>& indices, const SMatrix& transform);
+		void RasterizeOccluders(CThreadManager* threadManager);
+
+		[[nodiscard]] EOcclusionResult TestBounds(const SVector& boundsMin, const SVector& boundsMax, const SMatrix& transform) const;
+		// Also updates the instance stats
+		void TestBounds(const std::vector<SOcclusionQuery>& queries, std::vector<EOcclusionResult>& outResults, CThreadManager* threadManager);
+
+		[[nodiscard]] bool HasOccluders() const { return !Triangles.empty(); }
+		[[nodiscard]] const std::vector<F32>& GetDepthBuffer() const { return DepthBuffer; }
+		[[nodiscard]] const SOcclusionCullingStats& GetStats() const { return Stats; }
+
+	private:
+		// Edge functions are set up so all three are positive inside the triangle, depth is interpolated from them.
+		// Edge i at pixel p is EdgeA[i] * (p.x - EdgeOriginX[i]) + EdgeB[i] * (p.y - EdgeOriginY[i]).
+		struct STriangleSetup
+		{
+			F32 EdgeA[3] = {};
+			F32 EdgeB[3] = {};
+			F32 EdgeOriginX[3] = {};
+			F32 EdgeOriginY[3] = {};
+			F32 Depth[3] = {};
+			F32 InverseArea = 0.0f;
+			I32 MinX = 0;
+			I32 MaxX = 0;
+			I32 MinY = 0;
+			I32 MaxY = 0;
+		};
+
+		void RasterizeTileRows(const U16 firstTileRow, const U16 lastTileRow);
+
+		SMatrix ViewProjection;
+		std::vector<STriangleSetup> Triangles;
+		std::vector<F32> DepthBuffer;
+		std::vector<F32> TileMaxDepth;
+		SOcclusionCullingStats Stats;
+	};
+}
@@ -70,6 +70,7 @@ namespace Havtorn
 		std::vector<U8> U8s;
 		std::vector<U16> U16s;
 		std::vector<U32> U32s;
+		std::vector<U64> U64s;
 		std::vector<bool> Flags;
 		std::vector<std::string> Strings;
 		std::vector<SDrawCallData> DrawCallData;
@@ -78,14 +79,20 @@ namespace Havtorn
 		std::vector<SEngineGraphicsMaterial> Materials;
 		std::vector<std::map<U32, CStaticRenderTexture>> MaterialRenderTextures;
 		U64 RenderViewID = 0;
+		// Orders commands of the same type, so commands sharing shaders, materials and buffers run back to back
+		U64 SortKey = 0;
 
-		~SRenderCommand() = default;
-	
 		void SetShadowMapViews(const std::array<SShadowmapViewData, 6>& shadowmapViews)
 		{
 			ShadowmapViews.assign(shadowmapViews.begin(), shadowmapViews.end());
 		}
 
+		// Material first, since that is the more expensive state to switch
+		void SetSortKey(const U32 materialKey, const U32 meshKey)
+		{
+			SortKey = (STATIC_U64(materialKey) << 32) | meshKey;
+		}
+
 		void SetVolumetricDataFromComponent(const SVolumetricLightComponent& component)
 		{
 			F32s.push_back(component.NumberOfSamples);
@@ -17,6 +17,7 @@
 
 #include "GraphicsStructs.h"
 #include "GeometryPrimitives.h"
+#include "AnimationAtlas.h"
 #include "Assets/FileHeaderDeclarations.h"
 
 #include <algorithm>
@@ -118,8 +119,8 @@ namespace Havtorn
 		AntiAliasedTexture = RenderTextureFactory.CreateTexture(windowResolution, DXGI_FORMAT_R16G16B16A16_FLOAT);
 		EditorDataTexture = RenderTextureFactory.CreateTexture(windowResolution, DXGI_FORMAT_R32G32_UINT, true);
 		WorldPositionTexture = RenderTextureFactory.CreateTexture(windowResolution, DXGI_FORMAT_R32G32B32A32_FLOAT, true);
-		SkeletalAnimationDataTextureCPU = RenderTextureFactory.CreateTexture({ 256, 256 }, DXGI_FORMAT_R32G32B32A32_FLOAT, true);
-		SkeletalAnimationDataTextureGPU = RenderTextureFactory.CreateTexture({ 256, 256 }, DXGI_FORMAT_R32G32B32A32_FLOAT);
+		SkeletalAnimationDataTextureCPU = RenderTextureFactory.CreateTexture({ UAnimationAtlas::Width, UAnimationAtlas::Height }, DXGI_FORMAT_R16G16B16A16_FLOAT, true);
+		SkeletalAnimationDataTextureGPU = RenderTextureFactory.CreateTexture({ UAnimationAtlas::Width, UAnimationAtlas::Height }, DXGI_FORMAT_R16G16B16A16_FLOAT);
 		GBuffer = RenderTextureFactory.CreateGBuffer(windowResolution);
 	}
 
@@ -210,6 +211,11 @@ namespace Havtorn
 
 			ShouldBlurVolumetricBuffer = false;
 			CRenderManager::NumberOfDrawCallsThisFrame = 0;
+			CRenderStateManager::NumberOfStateBindsThisFrame = 0;
+			CRenderStateManager::NumberOfStateBindsAvoidedThisFrame = 0;
+
+			// The editor GUI renders on the same context between frames
+			RenderStateManager.InvalidateStateCache();
 
 			Backbuffer.ClearTexture();
 
@@ -236,8 +242,13 @@ namespace Havtorn
 				WorldPositionTexture.UnmapFromCPU();
 			}
 
-			if (RendererSkeletalAnimationBoneData != nullptr)
-				SkeletalAnimationDataTextureCPU.WriteToCPUTexture(RendererSkeletalAnimationBoneData, SkeletalAnimationBoneDataSize);
+			if (!RendererSkeletalAnimationBoneData.empty())
+			{
+				constexpr U64 atlasRowSize = UAnimationAtlas::Width * UAnimationAtlas::HalvesPerTexel * sizeof(U16);
+				SkeletalAnimationDataTextureCPU.WriteToCPUTexture(RendererSkeletalAnimationBoneData.data(), RendererSkeletalAnimationBoneData.size() * sizeof(U16), atlasRowSize);
+				SkeletalAnimationDataTextureGPU.CopyFromTexture(SkeletalAnimationDataTextureCPU.GetTexture());
+				RendererSkeletalAnimationBoneData.clear();
+			}
 
 			EditorWidgetDepth.ClearDepth();
 
@@ -260,9 +271,12 @@ namespace Havtorn
 				GBuffer.ClearTextures(ClearColor, renderViewID == WorldMainCameraEntity.GUID);
 				ShadowAtlasDepth.SetAsDepthTarget(&IntermediateTexture);
 
+				if (!view.BonePalettes.empty())
+					BonePaletteBuffer.BindBuffer(view.BonePalettes);
+
 				while (!view.RenderCommands.empty())
 				{
-					SRenderCommand currentCommand = view.RenderCommands.top();
+					const SRenderCommand& currentCommand = view.RenderCommands.top();
 					RenderFunctions[currentCommand.Type](currentCommand);
 					view.RenderCommands.pop();
 				}
@@ -292,6 +306,7 @@ namespace Havtorn
 		GEngine::Instance->Framework->GetContext()->OMSetRenderTargets(0, 0, 0);
 		GEngine::Instance->Framework->GetContext()->OMGetDepthStencilState(0, 0);
 		GEngine::Instance->Framework->GetContext()->ClearState();
+		RenderStateManager.InvalidateStateCache();
 
 		// TODO.NR: Implement this properly for window resizing
 
@@ -365,42 +380,49 @@ namespace Havtorn
 		return SVector4::Zero;
 	}
 
-	U32 CRenderManager::WriteToAnimationDataTexture(const std::string& /*animationName*/)
+	void CRenderManager::WriteToAnimationDataTexture(const std::vector<U16>& atlasHalves)
 	{
-		//if (!LoadedSkeletalAnims.contains(animationName))
-		//	return 0;
-
-		//SSkeletalAnimationAsset& asset = LoadedSkeletalAnims.at(animationName);
-		//SystemSkeletalAnimationBoneData = asset.EncodedBoneAnimTransforms.data();
-		//SkeletalAnimationBoneDataSize = sizeof(SBoneAnimDataTransform) * asset.EncodedBoneAnimTransforms.size();
-
-		// TODO.NR: Return index of animation in texture
-		return 0;
+		// The whole texture is rewritten, so the rest of the last row is zeroed rather than left to the staging texture
+		constexpr U64 halvesPerRow = UAnimationAtlas::Width * UAnimationAtlas::HalvesPerTexel;
+		constexpr U64 maxHalves = halvesPerRow * UAnimationAtlas::Height;
+		const U64 numberOfHalves = UMath::Min(atlasHalves.size(), maxHalves);
+		SystemSkeletalAnimationBoneData.assign(atlasHalves.begin(), atlasHalves.begin() + numberOfHalves);
+		SystemSkeletalAnimationBoneData.resize(UMath::Max(((numberOfHalves + halvesPerRow - 1) / halvesPerRow) * halvesPerRow, halvesPerRow), 0);
 	}
 
-	bool Havtorn::CRenderManager::IsStaticMeshInInstancedRenderList(const U32 meshUID, const U64 renderViewID)
+	bool Havtorn::CRenderManager::IsStaticMeshInInstancedRenderList(const U64 instanceListKey, const U64 renderViewID)
 	{
 		// TODO.NW: Maybe move this to RenderView class
 		if (GameThreadRenderViews->contains(renderViewID))
-			return GameThreadRenderViews->at(renderViewID).StaticMeshInstanceData.contains(meshUID);
+			return GameThreadRenderViews->at(renderViewID).StaticMeshInstanceData.contains(instanceListKey);
 
 		return false;
 	}
 
-	void CRenderManager::AddStaticMeshToInstancedRenderList(const U32 meshUID, const STransformComponent* component, const U64 renderViewID)
+	U64 CRenderManager::GetStaticMeshLODKey(const U32 meshUID, const U8 lodIndex)
 	{
-		std::unordered_map<U32, SStaticMeshInstanceData>* renderList = nullptr;
+		return STATIC_U64(meshUID) | (STATIC_U64(lodIndex) << 32);
+	}
+
+	U64 CRenderManager::GetStaticMeshShadowCasterKey(const U64 instanceListKey)
+	{
+		return instanceListKey | (STATIC_U64(1) << 40);
+	}
+
+	void CRenderManager::AddStaticMeshToInstancedRenderList(const U64 instanceListKey, const STransformComponent* component, const U64 renderViewID)
+	{
+		std::unordered_map<U64, SStaticMeshInstanceData>* renderList = nullptr;
 
 		if (GameThreadRenderViews->contains(renderViewID))
 			renderList = &GameThreadRenderViews->at(renderViewID).StaticMeshInstanceData;
 		else
 			return;
 
-		if (!renderList->contains(meshUID))
-			renderList->emplace(meshUID, SStaticMeshInstanceData());
+		if (!renderList->contains(instanceListKey))
+			renderList->emplace(instanceListKey, SStaticMeshInstanceData());
 
-		renderList->at(meshUID).Transforms.emplace_back(component->Transform.GetMatrix());
-		renderList->at(meshUID).Entities.emplace_back(component->Owner);
+		renderList->at(instanceListKey).Transforms.emplace_back(component->Transform.GetMatrix());
+		renderList->at(instanceListKey).Entities.emplace_back(component->Owner);
 	}
 
 	bool CRenderManager::IsSkeletalMeshInInstancedRenderList(const U32 meshUID, const U64 renderViewID)
@@ -413,23 +435,33 @@ namespace Havtorn
 
 	void CRenderManager::AddSkeletalMeshToInstancedRenderList(const U32 meshUID, const STransformComponent* transformComponent, const SSkeletalAnimationComponent* animationComponent, const U64 renderViewID)
 	{
-		std::unordered_map<U32, SSkeletalMeshInstanceData>* renderList = nullptr;
-
-		if (GameThreadRenderViews->contains(renderViewID))
-			renderList = &GameThreadRenderViews->at(renderViewID).SkeletalMeshInstanceData;
-		else
+		if (!GameThreadRenderViews->contains(renderViewID))
 			return;
 
-		if (!renderList->contains(meshUID))
-			renderList->emplace(meshUID, SSkeletalMeshInstanceData());
+		AddSkeletalMeshToRenderView(GameThreadRenderViews->at(renderViewID), meshUID, transformComponent, animationComponent, BonePaletteLimit);
+	}
 
-		renderList->at(meshUID).Transforms.emplace_back(transformComponent->Transform.GetMatrix());
-		renderList->at(meshUID).Entities.emplace_back(transformComponent->Owner);
+	void CRenderManager::AddSkeletalMeshToRenderView(SRenderView& renderView, const U32 meshUID, const STransformComponent* transformComponent, const SSkeletalAnimationComponent* animationComponent, const U32 bonePaletteLimit)
+	{
+		SSkeletalMeshInstanceData& instanceData = renderView.SkeletalMeshInstanceData[meshUID];
+		instanceData.Transforms.emplace_back(transformComponent->Transform.GetMatrix());
+		instanceData.Entities.emplace_back(transformComponent->Owner);
+
+		if (SComponent::IsValid(animationComponent) && animationComponent->AtlasNumberOfBones > 0)
+		{
+			instanceData.AnimationData.emplace_back(animationComponent->AtlasFrameTexel, animationComponent->AtlasNumberOfBones | UAnimationAtlas::InstanceFlag);
+			return;
+		}
+
+		const U32 paletteOffset = STATIC_U32(renderView.BonePalettes.size());
+		if (!SComponent::IsValid(animationComponent) || animationComponent->Bones.empty() || paletteOffset + animationComponent->Bones.size() > bonePaletteLimit)
+		{
+			instanceData.AnimationData.emplace_back(paletteOffset, 0);
+			return;
+		}
 
-		if (SComponent::IsValid(animationComponent))
-			renderList->at(meshUID).Bones = animationComponent->Bones;
-		//else
-		//	SystemSkeletalMeshInstanceData[meshName].Bones.emplace_back({});
+		renderView.BonePalettes.insert(renderView.BonePalettes.end(), animationComponent->Bones.begin(), animationComponent->Bones.end());
+		instanceData.AnimationData.emplace_back(paletteOffset, STATIC_U32(animationComponent->Bones.size()));
 	}
 
 	bool CRenderManager::IsSpriteInWorldSpaceInstancedRenderList(const U32 assetReferenceUID, const U64 renderViewID)
@@ -553,6 +585,11 @@ namespace Havtorn
 
 	void CRenderManager::SyncCrossThreadResources(const CWorld* world)
 	{
+		// Stats of the frame the game thread just finished, read by the editor while the render thread draws it
+		const U64 mainCameraID = world->GetMainCamera().GUID;
+		MainCameraLightClusterStats = GameThreadRenderViews->contains(mainCameraID) ? GameThreadRenderViews->at(mainCameraID).LightClusters.GetStats() : SLightClusterStats();
+		MainCameraOcclusionCullingStats = GameThreadRenderViews->contains(mainCameraID) ? GameThreadRenderViews->at(mainCameraID).OcclusionCuller.GetStats() : SOcclusionCullingStats();
+
 		SwapRenderViews();
 		std::swap(SystemSkeletalAnimationBoneData, RendererSkeletalAnimationBoneData);
 		SetWorldMainCameraEntity(world->GetMainCamera());
@@ -585,7 +622,7 @@ namespace Havtorn
 		if (!GameThreadRenderViews->contains(renderViewID))
 			return;
 
-		GameThreadRenderViews->at(renderViewID).RenderCommands.push(command);
+		GameThreadRenderViews->at(renderViewID).RenderCommands.push(std::move(command));
 	}
 
 	void CRenderManager::SwapRenderViews()
@@ -632,6 +669,7 @@ namespace Havtorn
 		{
 			renderViewPair.second.StaticMeshInstanceData.clear();
 			renderViewPair.second.SkeletalMeshInstanceData.clear();
+			renderViewPair.second.BonePalettes.clear();
 			renderViewPair.second.WorldSpaceSpriteInstanceData.clear();
 			renderViewPair.second.ScreenSpaceSpriteInstanceData.clear();
 		}
@@ -687,6 +725,32 @@ namespace Havtorn
 		return STATIC_U32(GameThreadRenderViews->size());
 	}
 
+	CLightClusterGrid* CRenderManager::GetLightClusterGrid(const U64 renderViewID)
+	{
+		if (!GameThreadRenderViews->contains(renderViewID))
+			return nullptr;
+
+		return &GameThreadRenderViews->at(renderViewID).LightClusters;
+	}
+
+	SLightClusterStats CRenderManager::GetMainCameraLightClusterStats() const
+	{
+		return MainCameraLightClusterStats;
+	}
+
+	COcclusionCuller* CRenderManager::GetOcclusionCuller(const U64 renderViewID)
+	{
+		if (!GameThreadRenderViews->contains(renderViewID))
+			return nullptr;
+
+		return &GameThreadRenderViews->at(renderViewID).OcclusionCuller;
+	}
+
+	SOcclusionCullingStats CRenderManager::GetMainCameraOcclusionCullingStats() const
+	{
+		return MainCameraOcclusionCullingStats;
+	}
+
 	void CRenderManager::Clear(SVector4 /*clearColor*/)
 	{
 		//Backbuffer.ClearTexture(clearColor);
@@ -698,7 +762,6 @@ namespace Havtorn
 		FrameBuffer.CreateBuffer("Frame Buffer", Framework, sizeof(SFrameBufferData));
 		ObjectBuffer.CreateBuffer("Object Buffer", Framework, sizeof(SObjectBufferData));
 		MaterialBuffer.CreateBuffer("Material Buffer", Framework, sizeof(SMaterialBufferData));
-		DebugShapeObjectBuffer.CreateBuffer("Debug Shape Object Buffer", Framework, sizeof(SDebugShapeObjectBufferData));
 		DecalBuffer.CreateBuffer("Decal Buffer", Framework, sizeof(SDecalBufferData));
 		SpriteBuffer.CreateBuffer("Sprite Buffer", Framework, sizeof(SSpriteBufferData));
 		DirectionalLightBuffer.CreateBuffer("Directional Light Buffer", Framework, sizeof(SDirectionalLightBufferData));
@@ -711,9 +774,11 @@ namespace Havtorn
 
 		InstancedTransformBuffer.CreateBuffer("Instanced Transform Buffer", Framework, sizeof(SMatrix) * InstancedDrawInstanceLimit, nullptr, EDataBufferType::Vertex);
 		InstancedAnimationDataBuffer.CreateBuffer("Instanced Animation Data Buffer", Framework, sizeof(SVector2<U32>) * InstancedDrawInstanceLimit, nullptr, EDataBufferType::Vertex);
+		BonePaletteBuffer.CreateStructuredBuffer("Bone Palette Buffer", Framework, sizeof(SMatrix), BonePaletteLimit);
 		InstancedEntityIDBuffer.CreateBuffer("Instanced Entity ID Buffer", Framework, sizeof(U64) * InstancedDrawInstanceLimit, nullptr, EDataBufferType::Vertex);
 		InstancedUVRectBuffer.CreateBuffer("Instanced UV Rect Buffer", Framework, sizeof(SVector4) * InstancedDrawInstanceLimit, nullptr, EDataBufferType::Vertex);
 		InstancedColorBuffer.CreateBuffer("Instanced Color Buffer", Framework, sizeof(SVector4) * InstancedDrawInstanceLimit, nullptr, EDataBufferType::Vertex);
+		InstancedThicknessBuffer.CreateBuffer("Instanced Thickness Buffer", Framework, sizeof(F32) * InstancedDrawInstanceLimit, nullptr, EDataBufferType::Vertex);
 	}
 
 	void CRenderManager::ShadowAtlasPrePassDirectional(const SRenderCommand& command)
@@ -736,7 +801,7 @@ namespace Havtorn
 		//ObjectBufferData.ToWorldFromObject = command.Matrices[0];
 		//ObjectBuffer.BindBuffer(ObjectBufferData);
 
-		const std::vector<SMatrix>& matrices = RenderThreadRenderViews->at(command.RenderViewID).StaticMeshInstanceData[command.U32s[0]].Transforms;
+		const std::vector<SMatrix>& matrices = RenderThreadRenderViews->at(command.RenderViewID).StaticMeshInstanceData[command.U64s[0]].Transforms;
 		InstancedTransformBuffer.BindBuffer(matrices);
 
 		//RenderStateManager.VSSetConstantBuffer(1, ObjectBuffer);
@@ -768,7 +833,7 @@ namespace Havtorn
 		//ObjectBufferData.ToWorldFromObject = command.Matrices[0];
 		//ObjectBuffer.BindBuffer(ObjectBufferData);
 
-		const std::vector<SMatrix>& matrices = RenderThreadRenderViews->at(command.RenderViewID).StaticMeshInstanceData[command.U32s[0]].Transforms;
+		const std::vector<SMatrix>& matrices = RenderThreadRenderViews->at(command.RenderViewID).StaticMeshInstanceData[command.U64s[0]].Transforms;
 		InstancedTransformBuffer.BindBuffer(matrices);
 
 		//RenderStateManager.VSSetConstantBuffer(1, ObjectBuffer);
@@ -828,7 +893,7 @@ namespace Havtorn
 
 		// =============
 
-		const std::vector<SMatrix>& matrices = RenderThreadRenderViews->at(command.RenderViewID).StaticMeshInstanceData[command.U32s[0]].Transforms;
+		const std::vector<SMatrix>& matrices = RenderThreadRenderViews->at(command.RenderViewID).StaticMeshInstanceData[command.U64s[0]].Transforms;
 		InstancedTransformBuffer.BindBuffer(matrices);
 
 		//RenderStateManager.VSSetConstantBuffer(1, ObjectBuffer);
@@ -877,7 +942,7 @@ namespace Havtorn
 		if (!RenderThreadRenderViews->contains(command.RenderViewID))
 			return;
 
-		const std::vector<SMatrix>& matrices = RenderThreadRenderViews->at(command.RenderViewID).StaticMeshInstanceData[command.U32s[0]].Transforms;
+		const std::vector<SMatrix>& matrices = RenderThreadRenderViews->at(command.RenderViewID).StaticMeshInstanceData[command.U64s[0]].Transforms;
 		InstancedTransformBuffer.BindBuffer(matrices);
 
 		//RenderStateManager.VSSetConstantBuffer(1, ObjectBuffer);
@@ -930,7 +995,7 @@ namespace Havtorn
 		if (!RenderThreadRenderViews->contains(command.RenderViewID))
 			return;
 
-		SStaticMeshInstanceData& meshData = RenderThreadRenderViews->at(command.RenderViewID).StaticMeshInstanceData[command.U32s[0]];
+		SStaticMeshInstanceData& meshData = RenderThreadRenderViews->at(command.RenderViewID).StaticMeshInstanceData[command.U64s[0]];
 
 		const std::vector<SMatrix>& matrices = meshData.Transforms;
 		InstancedTransformBuffer.BindBuffer(matrices);
@@ -1034,11 +1099,15 @@ namespace Havtorn
 		if (!RenderThreadRenderViews->contains(command.RenderViewID))
 			return;
 
-		const std::vector<SMatrix>& matrices = RenderThreadRenderViews->at(command.RenderViewID).SkeletalMeshInstanceData[command.U32s[0]].Transforms;
+		const SSkeletalMeshInstanceData& meshData = RenderThreadRenderViews->at(command.RenderViewID).SkeletalMeshInstanceData[command.U32s[0]];
+
+		const std::vector<SMatrix>& matrices = meshData.Transforms;
 		InstancedTransformBuffer.BindBuffer(matrices);
+		InstancedAnimationDataBuffer.BindBuffer(meshData.AnimationData);
 
 		RenderStateManager.VSSetConstantBuffer(1, ObjectBuffer);
-		RenderStateManager.VSSetConstantBuffer(6, BoneBuffer);
+		RenderStateManager.VSSetResources(25, 1, &BonePaletteBuffer.ShaderResource);
+		SkeletalAnimationDataTextureGPU.SetAsVSResourceOnSlot(24);
 		RenderStateManager.IASetTopology(ETopologies::TriangleList);
 		RenderStateManager.IASetInputLayout(EInputLayoutType::Pos3Nor3Tan3Bit3UV2BoneID4BoneWeight4AnimDataTrans);
 
@@ -1096,11 +1165,11 @@ namespace Havtorn
 		const std::vector<SEntity>& entities = meshData.Entities;
 		InstancedEntityIDBuffer.BindBuffer(entities);
 
-		const std::vector<SMatrix>& boneMatrices = meshData.Bones;
-		BoneBuffer.BindBuffer(boneMatrices);
+		InstancedAnimationDataBuffer.BindBuffer(meshData.AnimationData);
 
 		RenderStateManager.VSSetConstantBuffer(1, ObjectBuffer);
-		RenderStateManager.VSSetConstantBuffer(6, BoneBuffer);
+		RenderStateManager.VSSetResources(25, 1, &BonePaletteBuffer.ShaderResource);
+		SkeletalAnimationDataTextureGPU.SetAsVSResourceOnSlot(24);
 		RenderStateManager.IASetTopology(ETopologies::TriangleList);
 		RenderStateManager.IASetInputLayout(EInputLayoutType::Pos3Nor3Tan3Bit3UV2BoneID4BoneWeight4Entity2AnimDataTrans);
 
@@ -2010,7 +2079,7 @@ namespace Havtorn
 		RenderStateManager.OMSetBlendState(CRenderStateManager::EBlendStates::AlphaBlend);
 
 		RenderStateManager.IASetTopology(ETopologies::LineList);
-		RenderStateManager.IASetInputLayout(EInputLayoutType::Position4);
+		RenderStateManager.IASetInputLayout(EInputLayoutType::Position4TransColorThickness);
 
 		RenderStateManager.GSSetShader(EGeometryShaders::Line);
 		RenderStateManager.VSSetShader(EVertexShaders::Line);
@@ -2065,27 +2134,40 @@ namespace Havtorn
 
 	inline void CRenderManager::DebugShapes(const SRenderCommand& command)
 	{
-		DebugShapeObjectBufferData.ToWorldFromObject = command.Matrices[0];
-		DebugShapeObjectBufferData.Color = command.Vectors[0];
-		DebugShapeObjectBufferData.HalfThickness = command.F32s[0] /** 0.5f?*/;
-
-		DebugShapeObjectBuffer.BindBuffer(DebugShapeObjectBufferData);
+		if (GDebugDraw::Instance == nullptr)
+			return;
 
-		RenderStateManager.IASetVertexBuffer(0, RenderStateManager.VertexBuffers[command.U8s[0]], RenderStateManager.MeshVertexStrides[1], RenderStateManager.MeshVertexOffsets[0]);
-		RenderStateManager.IASetIndexBuffer(RenderStateManager.IndexBuffers[command.U8s[1]]);
+		// One command per debug shape batch. Instances are uploaded straight from the batch's render thread buffers,
+		// in chunks that fit the instance buffers.
+		const GDebugDraw::SDebugShapeBatch& batch = GDebugDraw::Instance->Batches[command.U32s[0]];
+		const U8 vertexBufferIndex = STATIC_U8(batch.VertexBuffer);
 
-		RenderStateManager.GSSetConstantBuffer(1, DebugShapeObjectBuffer);
+		if (batch.IsScreenSpace)
+			RenderStateManager.VSSetShader(EVertexShaders::LineScreenSpace);
 
-		// IsScreenSpace
-		if (command.Flags[0])
-			RenderStateManager.GSSetShader(EGeometryShaders::Line2D);
+		RenderStateManager.IASetIndexBuffer(RenderStateManager.IndexBuffers[STATIC_U8(batch.IndexBuffer)]);
 
-		RenderStateManager.VSSetConstantBuffer(1, DebugShapeObjectBuffer);
-		RenderStateManager.DrawIndexed(command.U16s[0], 0, 0);
-		NumberOfDrawCallsThisFrame++;
+		for (const GDebugDraw::SDebugShapeBuffer* shapes : { &batch.RenderFrameShapes, &batch.RenderTimedShapes })
+		{
+			const U32 numberOfInstances = shapes->Size();
+			for (U32 firstInstance = 0; firstInstance < numberOfInstances; firstInstance += InstancedDrawInstanceLimit)
+			{
+				const U32 instanceCount = UMath::Min(numberOfInstances - firstInstance, STATIC_U32(InstancedDrawInstanceLimit));
+				InstancedTransformBuffer.BindBuffer(&shapes->Transforms[firstInstance], instanceCount);
+				InstancedColorBuffer.BindBuffer(&shapes->Colors[firstInstance], instanceCount);
+				InstancedThicknessBuffer.BindBuffer(&shapes->Thicknesses[firstInstance], instanceCount);
+
+				const std::vector<CDataBuffer> buffers = { RenderStateManager.VertexBuffers[vertexBufferIndex], InstancedTransformBuffer, InstancedColorBuffer, InstancedThicknessBuffer };
+				const U32 strides[4] = { RenderStateManager.MeshVertexStrides[1], sizeof(SMatrix), sizeof(SVector4), sizeof(F32) };
+				const U32 offsets[4] = { RenderStateManager.MeshVertexOffsets[0], 0, 0, 0 };
+				RenderStateManager.IASetVertexBuffers(0, 4, buffers, strides, offsets);
+				RenderStateManager.DrawIndexedInstanced(batch.IndexCount, instanceCount, 0, 0, 0);
+				NumberOfDrawCallsThisFrame++;
+			}
+		}
 
-		if (command.Flags[0])
-			RenderStateManager.GSSetShader(EGeometryShaders::Line);
+		if (batch.IsScreenSpace)
+			RenderStateManager.VSSetShader(EVertexShaders::Line);
 	}
 
 	void CRenderManager::DebugShadowAtlas()
@@ -2254,6 +2336,10 @@ namespace Havtorn
 
 	bool SRenderCommandComparer::operator()(const SRenderCommand& a, const SRenderCommand& b) const
 	{
-		return 	STATIC_U16(a.Type) > STATIC_U16(b.Type);
+		// Passes run in ERenderCommandType order, within a pass commands sharing state end up next to each other
+		if (a.Type != b.Type)
+			return STATIC_U16(a.Type) > STATIC_U16(b.Type);
+
+		return a.SortKey > b.SortKey;
 	}
 }
@@ -9,6 +9,8 @@
 #include "GraphicsEnums.h"
 #include "GraphicsMaterial.h"
 #include "RenderCommand.h"
+#include "ClusteredLightCulling.h"
+#include "OcclusionCulling.h"
 #include "Scene/World.h"
 
 #include "RenderingPrimitives/DataBuffer.h"
@@ -66,7 +68,8 @@ namespace Havtorn
 	struct SSkeletalMeshInstanceData
 	{
 		std::vector<SMatrix> Transforms{};
-		std::vector<SMatrix> Bones{};
+		// Per instance, the first matrix of its palette in SRenderView::BonePalettes and its number of bones, 0 for bind pose
+		std::vector<SVector2<U32>> AnimationData{};
 		std::vector<SEntity> Entities{};
 	};
 
@@ -83,10 +86,15 @@ namespace Havtorn
 		CRenderTexture RenderTarget;
 		CRenderCommandHeap RenderCommands;
 
-		std::unordered_map<U32, SStaticMeshInstanceData> StaticMeshInstanceData;
+		std::unordered_map<U64, SStaticMeshInstanceData> StaticMeshInstanceData;
 		std::unordered_map<U32, SSkeletalMeshInstanceData> SkeletalMeshInstanceData;
 		std::unordered_map<U32, SSpriteInstanceData> WorldSpaceSpriteInstanceData;
 		std::unordered_map<U32, SSpriteInstanceData> ScreenSpaceSpriteInstanceData;
+		// Bone palettes of every skeletal mesh instance in the view back to back, uploaded once per view
+		std::vector<SMatrix> BonePalettes;
+
+		CLightClusterGrid LightClusters;
+		COcclusionCuller OcclusionCuller;
 	};
 
 	class CRenderManager
@@ -109,14 +117,22 @@ namespace Havtorn
 		ENGINE_API U64 GetEntityGUIDFromData(U64 dataIndex) const;
 		ENGINE_API SVector4 GetWorldPositionFromData(U64 dataIndex) const;
 
-		U32 WriteToAnimationDataTexture(const std::string& animationName);
+		// Uploads baked animation frames to the animation atlas on the next render, see UAnimationAtlas
+		ENGINE_API void WriteToAnimationDataTexture(const std::vector<U16>& atlasHalves);
 
 		// TODO.NW: Might want to generalize these render view resources somehow still
-		ENGINE_API bool IsStaticMeshInInstancedRenderList(const U32 meshUID, const U64 renderViewEntity);
-		ENGINE_API void AddStaticMeshToInstancedRenderList(const U32 meshUID, const STransformComponent* component, const U64 renderViewEntity);
+		ENGINE_API bool IsStaticMeshInInstancedRenderList(const U64 instanceListKey, const U64 renderViewEntity);
+		// Instanced render list key for a mesh LOD. LOD0 uses the mesh UID as is, other LODs put their index above the 32 bit UID.
+		static ENGINE_API U64 GetStaticMeshLODKey(const U32 meshUID, const U8 lodIndex);
+		// Separate instanced render list for shadow casters, so instances culled from the view still cast shadows
+		static ENGINE_API U64 GetStaticMeshShadowCasterKey(const U64 instanceListKey);
+		ENGINE_API void AddStaticMeshToInstancedRenderList(const U64 instanceListKey, const STransformComponent* component, const U64 renderViewEntity);
 
 		ENGINE_API bool IsSkeletalMeshInInstancedRenderList(const U32 meshUID, const U64 renderViewEntity);
 		ENGINE_API void AddSkeletalMeshToInstancedRenderList(const U32 meshUID, const STransformComponent* transformComponent, const SSkeletalAnimationComponent* animationComponent, const U64 renderViewEntity);
+		// Appends the instance's bones to the view's palettes, or points it at its atlas frame. Instances without bones or past
+		// bonePaletteLimit are drawn in bind pose.
+		static ENGINE_API void AddSkeletalMeshToRenderView(SRenderView& renderView, const U32 meshUID, const STransformComponent* transformComponent, const SSkeletalAnimationComponent* animationComponent, const U32 bonePaletteLimit);
 
 		ENGINE_API bool IsSpriteInWorldSpaceInstancedRenderList(const U32 assetReferenceUID, const U64 renderViewEntity);
 		ENGINE_API void AddSpriteToWorldSpaceInstancedRenderList(const U32 assetReferenceUID, const STransformComponent* worldSpaceTransform, const SSpriteComponent* spriteComponent, const U64 renderViewEntity);
@@ -143,6 +159,13 @@ namespace Havtorn
 		const SVector2<F32>& GetShadowAtlasResolution() const;
 		ENGINE_API U32 GetNumberOfRenderViews() const;
 
+		// Returns the game thread light clusters of the render view, to be rebuilt every frame
+		ENGINE_API CLightClusterGrid* GetLightClusterGrid(const U64 renderViewID);
+		// Game thread, copied from the main camera's render view at every sync
+		ENGINE_API SLightClusterStats GetMainCameraLightClusterStats() const;
+		ENGINE_API COcclusionCuller* GetOcclusionCuller(const U64 renderViewID);
+		ENGINE_API SOcclusionCullingStats GetMainCameraOcclusionCullingStats() const;
+
 	public:
 		ENGINE_API static U32 NumberOfDrawCallsThisFrame;
 
@@ -239,15 +262,6 @@ namespace Havtorn
 		} MaterialBufferData;
 		HV_ASSERT_BUFFER(SMaterialBufferData)
 
-		struct SDebugShapeObjectBufferData
-		{
-			SMatrix ToWorldFromObject;
-			SVector4 Color;
-			F32 HalfThickness = 0.5f;
-			F32 Padding[3] = {};
-		} DebugShapeObjectBufferData;
-		HV_ASSERT_BUFFER(SDebugShapeObjectBufferData)
-
 		struct SDecalBufferData
 		{
 			SMatrix ToWorld;
@@ -334,7 +348,6 @@ namespace Havtorn
 		CDataBuffer FrameBuffer;
 		CDataBuffer ObjectBuffer;
 		CDataBuffer MaterialBuffer;
-		CDataBuffer DebugShapeObjectBuffer;
 		CDataBuffer DecalBuffer;
 		CDataBuffer SpriteBuffer;
 		CDataBuffer DirectionalLightBuffer;
@@ -381,6 +394,8 @@ namespace Havtorn
 		std::map<U64, SRenderView>* GameThreadRenderViews = &RenderViewsA;
 		std::map<U64, SRenderView>* RenderThreadRenderViews = &RenderViewsB;
 		std::map<U64, std::function<void(CRenderTexture&)>> RenderViewCallbacks;
+		SLightClusterStats MainCameraLightClusterStats;
+		SOcclusionCullingStats MainCameraOcclusionCullingStats;
 
 		SVector4 ClearColor = SVector4(0.5f, 0.5f, 0.5f, 1.0f);
 
@@ -391,11 +406,15 @@ namespace Havtorn
 		CDataBuffer InstancedTransformBuffer;
 		CDataBuffer InstancedEntityIDBuffer;
 		CDataBuffer InstancedAnimationDataBuffer;
+		CDataBuffer BonePaletteBuffer;
 
 		// NW: Used together with the InstancedTransformBuffer to batch World Space Sprites as well as Screen Space Sprites
 		CDataBuffer InstancedUVRectBuffer;
 		CDataBuffer InstancedColorBuffer;
 
+		// Used together with the InstancedTransformBuffer and InstancedColorBuffer to batch debug shapes
+		CDataBuffer InstancedThicknessBuffer;
+
 		SVector2<F32> ShadowAtlasResolution = SVector2<F32>::Zero;
 		SVector2<U16> CurrentWindowResolution = SVector2<U16>::Zero;
 
@@ -409,10 +428,12 @@ namespace Havtorn
 		void* WorldPositionPerPixelData = nullptr;
 		U64 WorldPositionPerPixelDataSize = 0;
 
-		void* SystemSkeletalAnimationBoneData = nullptr;
-		void* RendererSkeletalAnimationBoneData = nullptr;
-		U64 SkeletalAnimationBoneDataSize = 0;
+		// Animation atlas halves waiting for upload, empty when nothing changed
+		std::vector<U16> SystemSkeletalAnimationBoneData;
+		std::vector<U16> RendererSkeletalAnimationBoneData;
 		
 		const U16 InstancedDrawInstanceLimit = 65535;
+		// Matrices in BonePaletteBuffer, instances past it in a view are drawn in bind pose
+		const U32 BonePaletteLimit = 65536;
 	};
 }
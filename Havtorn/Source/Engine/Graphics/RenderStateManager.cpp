@@ -13,6 +13,9 @@
 
 namespace Havtorn
 {
+    U32 CRenderStateManager::NumberOfStateBindsThisFrame = 0;
+    U32 CRenderStateManager::NumberOfStateBindsAvoidedThisFrame = 0;
+
     CRenderStateManager::~CRenderStateManager()
     {
         Context = nullptr;
@@ -63,15 +66,19 @@ namespace Havtorn
             initData[STATIC_U64(EVertexShaders::PointAndSpotLight)]             = { ShaderRoot + "PointLight_VS.cso", true, EInputLayoutType::Position4 };
             initData[STATIC_U64(EVertexShaders::EditorPreviewStaticMesh)]       = { ShaderRoot + "EditorPreview_VS.cso", false };
             initData[STATIC_U64(EVertexShaders::EditorPreviewSkeletalMesh)]     = { ShaderRoot + "EditorPreviewSkeletal_VS.cso", false };
-            initData[STATIC_U64(EVertexShaders::Line)]                          = { ShaderRoot + "Line_VS.cso", false };
+            initData[STATIC_U64(EVertexShaders::Line)]                          = { ShaderRoot + "Line_VS.cso", true, EInputLayoutType::Position4TransColorThickness };
             initData[STATIC_U64(EVertexShaders::SpriteInstanced)]               = { ShaderRoot + "SpriteInstanced_VS.cso", true, EInputLayoutType::TransUVRectColor };
             initData[STATIC_U64(EVertexShaders::StaticMeshInstancedEditor)]     = { ShaderRoot + "DeferredInstancedMeshEditor_VS.cso", true, EInputLayoutType::Pos3Nor3Tan3Bit3UV2Entity2Trans };
             initData[STATIC_U64(EVertexShaders::SpriteInstancedEditor)]         = { ShaderRoot + "SpriteInstancedEditor_VS.cso", true, EInputLayoutType::TransUVRectColorEntity2 };
             initData[STATIC_U64(EVertexShaders::SkeletalMeshInstanced)]         = { ShaderRoot + "DeferredInstancedAnimation_VS.cso", true, EInputLayoutType::Pos3Nor3Tan3Bit3UV2BoneID4BoneWeight4AnimDataTrans };
             initData[STATIC_U64(EVertexShaders::SkeletalMeshInstancedEditor)]   = { ShaderRoot + "DeferredInstancedAnimationEditor_VS.cso", true, EInputLayoutType::Pos3Nor3Tan3Bit3UV2BoneID4BoneWeight4Entity2AnimDataTrans };
             initData[STATIC_U64(EVertexShaders::Skybox)]                        = { ShaderRoot + "Skybox_VS.cso", true, EInputLayoutType::Position4 };
+            initData[STATIC_U64(EVertexShaders::LineScreenSpace)]               = { ShaderRoot + "LineScreenSpace_VS.cso", true, EInputLayoutType::Position4TransColorThickness };
         }
 
+        // Layouts are looked up by EInputLayoutType, several shaders may share one. The Null layout stays nullptr.
+        InputLayouts.resize(STATIC_U64(EInputLayoutType::Null) + 1, nullptr);
+
         for (U64 i = 0; i < STATIC_U64(EVertexShaders::Count); i++)
         {
             std::string vsData = AddShader(initData[i].FileName, i, EShaderType::Vertex);
@@ -81,7 +88,6 @@ namespace Havtorn
 
         // NW: Null shader. Adding this to avoid branching in state setting functions
         VertexShaders[STATIC_U64(EVertexShaders::Count)] = nullptr;
-        InputLayouts.emplace_back(nullptr);
     }
 
     void CRenderStateManager::InitPixelShaders()
@@ -140,10 +146,9 @@ namespace Havtorn
     void CRenderStateManager::InitGeometryShaders()
     {
         AddShader(ShaderRoot + "Line_GS.cso", 0, EShaderType::Geometry);
-        AddShader(ShaderRoot + "LineScreenSpace_GS.cso", 1, EShaderType::Geometry);
-        AddShader(ShaderRoot + "SpriteScreenSpace_GS.cso", 2, EShaderType::Geometry);
-        AddShader(ShaderRoot + "SpriteWorldSpace_GS.cso", 3, EShaderType::Geometry);
-        AddShader(ShaderRoot + "SpriteWorldSpaceEditor_GS.cso", 4, EShaderType::Geometry);
+        AddShader(ShaderRoot + "SpriteScreenSpace_GS.cso", 1, EShaderType::Geometry);
+        AddShader(ShaderRoot + "SpriteWorldSpace_GS.cso", 2, EShaderType::Geometry);
+        AddShader(ShaderRoot + "SpriteWorldSpaceEditor_GS.cso", 3, EShaderType::Geometry);
 
         // NW: Null shader. Adding this to avoid branching in state setting functions
         GeometryShaders[STATIC_U64(EGeometryShaders::Count)] = nullptr;
@@ -217,7 +222,7 @@ namespace Havtorn
         AddMeshVertexOffset(0);
     }
 
-    U16 CRenderStateManager::AddIndexBuffer(const std::vector<U32>& indices)
+    U16 CRenderStateManager::AddIndexBuffer(const std::span<const U32> indices)
     {
         IndexBuffers.emplace_back(CDataBuffer());
         IndexBuffers.back().CreateBuffer("Index Buffer", Framework, sizeof(U32) * STATIC_U32(indices.size()), indices.data(), EDataBufferType::Index, EDataBufferUsage::Immutable, EDataBufferCPUAccess::None);
@@ -290,6 +295,9 @@ namespace Havtorn
 
     void CRenderStateManager::AddInputLayout(const std::string& vsData, EInputLayoutType layoutType)
     {
+        if (InputLayouts[STATIC_U64(layoutType)] != nullptr)
+            return;
+
         std::vector<D3D11_INPUT_ELEMENT_DESC> layout;
         switch (layoutType)
         {
@@ -403,10 +411,23 @@ namespace Havtorn
                 {"ENTITY"		,       0, DXGI_FORMAT_R32G32_UINT,	       3, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
             };
             break;
+
+        case EInputLayoutType::Position4TransColorThickness:
+            layout =
+            {
+                {"POSITION"	,	        0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+                {"INSTANCETRANSFORM",	0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+                {"INSTANCETRANSFORM",	1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+                {"INSTANCETRANSFORM",	2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+                {"INSTANCETRANSFORM",	3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+                {"INSTANCECOLOR",		0, DXGI_FORMAT_R32G32B32A32_FLOAT, 2, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+                {"INSTANCETHICKNESS",	0, DXGI_FORMAT_R32_FLOAT,          3, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1}
+            };
+            break;
         }
         ID3D11InputLayout* inputLayout;
         ENGINE_HR_MESSAGE(Framework->GetDevice()->CreateInputLayout(layout.data(), STATIC_U32(layout.size()), vsData.data(), vsData.size(), &inputLayout), "Input Layout could not be created.")
-            InputLayouts.emplace_back(inputLayout);
+            InputLayouts[STATIC_U64(layoutType)] = inputLayout;
     }
 
     void CRenderStateManager::AddSampler(ESamplerType samplerType)
@@ -462,44 +483,77 @@ namespace Havtorn
 
     void CRenderStateManager::IASetTopology(ETopologies topology) const
     {
-        Context->IASetPrimitiveTopology(Topologies[STATIC_U8(topology)]);
+        const D3D11_PRIMITIVE_TOPOLOGY d3dTopology = Topologies[STATIC_U8(topology)];
+        if (TryBind(BoundState.Topology, d3dTopology))
+            Context->IASetPrimitiveTopology(d3dTopology);
     }
 
     void CRenderStateManager::IASetInputLayout(EInputLayoutType layout) const
     {
-        Context->IASetInputLayout(InputLayouts[STATIC_U8(layout)]);
+        ID3D11InputLayout* inputLayout = InputLayouts[STATIC_U8(layout)];
+        if (TryBind(BoundState.InputLayout, inputLayout))
+            Context->IASetInputLayout(inputLayout);
     }
 
     void CRenderStateManager::IASetVertexBuffer(U8 startSlot, const CDataBuffer& buffer, U32 stride, U32 offset) const
     {
-        Context->IASetVertexBuffers(startSlot, 1, &buffer.Buffer, &stride, &offset);
+        if (TryBind(BoundState.VertexBuffers[startSlot], SVertexBufferBinding{ buffer.Buffer, stride, offset }))
+            Context->IASetVertexBuffers(startSlot, 1, &buffer.Buffer, &stride, &offset);
     }
 
     void CRenderStateManager::IASetVertexBuffers(U8 startSlot, U8 numberOfBuffers, const std::vector<CDataBuffer>& buffers, const U32* strides, const U32* offsets) const
     {
-        std::vector<ID3D11Buffer*> bufferPointers;
-        for (const CDataBuffer& buffer : buffers)
-            bufferPointers.emplace_back(buffer.Buffer);
+        std::array<ID3D11Buffer*, D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT> bufferPointers = {};
+        bool hasChanged = false;
+        for (U8 i = 0; i < numberOfBuffers; i++)
+        {
+            bufferPointers[i] = buffers[i].Buffer;
 
+            SCachedBinding<SVertexBufferBinding>& binding = BoundState.VertexBuffers[startSlot + i];
+            const SVertexBufferBinding newBinding = { bufferPointers[i], strides[i], offsets[i] };
+            if (binding.IsBound && binding.Value == newBinding)
+                continue;
+
+            binding.Value = newBinding;
+            binding.IsBound = true;
+            hasChanged = true;
+        }
+
+        if (!hasChanged)
+        {
+            NumberOfStateBindsAvoidedThisFrame++;
+            return;
+        }
+
+        NumberOfStateBindsThisFrame++;
         Context->IASetVertexBuffers(startSlot, numberOfBuffers, bufferPointers.data(), strides, offsets);
     }
 
     void CRenderStateManager::IASetIndexBuffer(const CDataBuffer& buffer) const
     {
+        if (!TryBind(BoundState.IndexBuffer, buffer.Buffer))
+            return;
+
         if (buffer.Buffer == nullptr)
-			Context->IASetIndexBuffer(nullptr, DXGI_FORMAT_UNKNOWN, 0);
+        {
+            Context->IASetIndexBuffer(nullptr, DXGI_FORMAT_UNKNOWN, 0);
+            return;
+        }
 
     	Context->IASetIndexBuffer(buffer.Buffer, DXGI_FORMAT_R32_UINT, 0);
     }
 
     void CRenderStateManager::VSSetShader(EVertexShaders shader) const
     {
-        Context->VSSetShader(VertexShaders[STATIC_U8(shader)], nullptr, 0);
+        ID3D11VertexShader* vertexShader = VertexShaders[STATIC_U8(shader)];
+        if (TryBind(BoundState.VertexShader, vertexShader))
+            Context->VSSetShader(vertexShader, nullptr, 0);
     }
 
     void CRenderStateManager::VSSetConstantBuffer(U8 slot, const CDataBuffer& buffer)
     {
-        Context->VSSetConstantBuffers(slot, 1, &buffer.Buffer);
+        if (TryBind(BoundState.VSConstantBuffers[slot], buffer.Buffer))
+            Context->VSSetConstantBuffers(slot, 1, &buffer.Buffer);
     }
 
     void CRenderStateManager::VSSetResources(U8 startSlot, U8 numberOfResources, ID3D11ShaderResourceView* const* resources)
@@ -509,28 +563,35 @@ namespace Havtorn
 
     void CRenderStateManager::GSSetShader(EGeometryShaders shader) const
     {
-        Context->GSSetShader(GeometryShaders[STATIC_U8(shader)], nullptr, 0);
+        ID3D11GeometryShader* geometryShader = GeometryShaders[STATIC_U8(shader)];
+        if (TryBind(BoundState.GeometryShader, geometryShader))
+            Context->GSSetShader(geometryShader, nullptr, 0);
     }
 
     void CRenderStateManager::GSSetConstantBuffer(U8 slot, const CDataBuffer& buffer) const
     {
-        Context->GSSetConstantBuffers(slot, 1, &buffer.Buffer);
+        if (TryBind(BoundState.GSConstantBuffers[slot], buffer.Buffer))
+            Context->GSSetConstantBuffers(slot, 1, &buffer.Buffer);
     }
 
     void CRenderStateManager::PSSetSampler(U8 slot, ESamplers sampler) const
     {
         ID3D11SamplerState* samplerState = Samplers[STATIC_U8(sampler)];
-        Context->PSSetSamplers(slot, 1, &samplerState);
+        if (TryBind(BoundState.PSSamplers[slot], samplerState))
+            Context->PSSetSamplers(slot, 1, &samplerState);
     }
 
     void CRenderStateManager::PSSetShader(EPixelShaders shader) const
     {
-        Context->PSSetShader(PixelShaders[STATIC_U8(shader)], nullptr, 0);
+        ID3D11PixelShader* pixelShader = PixelShaders[STATIC_U8(shader)];
+        if (TryBind(BoundState.PixelShader, pixelShader))
+            Context->PSSetShader(pixelShader, nullptr, 0);
     }
 
     void CRenderStateManager::PSSetConstantBuffer(U8 slot, const CDataBuffer& buffer) const
     {
-        Context->PSSetConstantBuffers(slot, 1, &buffer.Buffer);
+        if (TryBind(BoundState.PSConstantBuffers[slot], buffer.Buffer))
+            Context->PSSetConstantBuffers(slot, 1, &buffer.Buffer);
     }
 
     void CRenderStateManager::PSSetResources(U8 startSlot, U8 numberOfResources, ID3D11ShaderResourceView* const* resources)
@@ -545,18 +606,27 @@ namespace Havtorn
 
     void CRenderStateManager::RSSetRasterizerState(ERasterizerStates rasterizerState) const
     {
-        Context->RSSetState(RasterizerStates[(size_t)rasterizerState]);
+        ID3D11RasterizerState* state = RasterizerStates[(size_t)rasterizerState];
+        if (TryBind(BoundState.RasterizerState, state))
+            Context->RSSetState(state);
     }
 
     void CRenderStateManager::OMSetBlendState(EBlendStates blendState) const
     {
+        // Blend factors and sample mask are always the same, so the state object is enough to compare
+        ID3D11BlendState* state = BlendStates[(U64)blendState];
+        if (!TryBind(BoundState.BlendState, state))
+            return;
+
         std::array<F32, 4> blendFactors = { 0.5f, 0.5f, 0.5f, 0.5f };
-        Context->OMSetBlendState(BlendStates[(U64)blendState], blendFactors.data(), 0xFFFFFFFFu);
+        Context->OMSetBlendState(state, blendFactors.data(), 0xFFFFFFFFu);
     }
 
     void CRenderStateManager::OMSetDepthStencilState(EDepthStencilStates depthStencilState, U32 stencilRef) const
     {
-        Context->OMSetDepthStencilState(DepthStencilStates[(U64)depthStencilState], stencilRef);
+        ID3D11DepthStencilState* state = DepthStencilStates[(U64)depthStencilState];
+        if (TryBind(BoundState.DepthStencilState, SDepthStencilBinding{ state, stencilRef }))
+            Context->OMSetDepthStencilState(state, stencilRef);
     }
 
     void CRenderStateManager::OMSetRenderTargets(U8 numberOfTargets, ID3D11RenderTargetView* const* targetViews, ID3D11DepthStencilView* depthStencilView) const
@@ -602,6 +672,12 @@ namespace Havtorn
     void CRenderStateManager::ClearState()
     {
         Context->ClearState();
+        InvalidateStateCache();
+    }
+
+    void CRenderStateManager::InvalidateStateCache() const
+    {
+        BoundState = SBoundStateCache();
     }
 
     void CRenderStateManager::ClearShaderResources() const
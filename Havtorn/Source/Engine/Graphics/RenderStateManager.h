@@ -4,6 +4,7 @@
 #include <array>
 #include <queue>
 #include <mutex>
+#include <span>
 
 #include "GraphicsEnums.h"
 #include "RenderingPrimitives/DataBuffer.h"
@@ -70,7 +71,10 @@ namespace Havtorn
 	private:
 		template<typename T>
 		U16 AddVertexBuffer(const std::vector<T>& vertices);
-		U16 AddIndexBuffer(const std::vector<U32>& indices);
+		// Spans can point straight into a mapped asset file
+		template<typename T>
+		U16 AddVertexBuffer(const std::span<const T> vertices);
+		U16 AddIndexBuffer(const std::span<const U32> indices);
 		U16 AddMeshVertexStride(U32 stride);
 		U16 AddMeshVertexOffset(U32 offset);
 
@@ -123,12 +127,19 @@ namespace Havtorn
 
 		void ClearState();
 
+		// Forgets all bound state, call when the context may have been changed without going through the state manager
+		void InvalidateStateCache() const;
+
 		void ClearShaderResources() const;
 
 		void Release();
 
 		void FlushShaderChanges();
 
+	public:
+		ENGINE_API static U32 NumberOfStateBindsThisFrame;
+		ENGINE_API static U32 NumberOfStateBindsAvoidedThisFrame;
+
 	private:
 		void OnShaderSourceChange(const std::string& filePath);
 		const U64 OnShaderSourceChangeFunctionHandle = 200;
@@ -137,6 +148,55 @@ namespace Havtorn
 		bool CreateDepthStencilStates(ID3D11Device* device);
 		bool CreateRasterizerStates(ID3D11Device* device);
 
+		template<typename T>
+		struct SCachedBinding
+		{
+			T Value = {};
+			bool IsBound = false;
+		};
+
+		struct SVertexBufferBinding
+		{
+			ID3D11Buffer* Buffer = nullptr;
+			U32 Stride = 0;
+			U32 Offset = 0;
+
+			bool operator==(const SVertexBufferBinding& other) const = default;
+		};
+
+		struct SDepthStencilBinding
+		{
+			ID3D11DepthStencilState* State = nullptr;
+			U32 StencilRef = 0;
+
+			bool operator==(const SDepthStencilBinding& other) const = default;
+		};
+
+		// State as last bound through the state manager. Shader resources are bound directly by render textures and the GBuffer, so they are not tracked.
+		struct SBoundStateCache
+		{
+			SCachedBinding<D3D11_PRIMITIVE_TOPOLOGY> Topology;
+			SCachedBinding<ID3D11InputLayout*> InputLayout;
+			std::array<SCachedBinding<SVertexBufferBinding>, D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT> VertexBuffers;
+			SCachedBinding<ID3D11Buffer*> IndexBuffer;
+
+			SCachedBinding<ID3D11VertexShader*> VertexShader;
+			SCachedBinding<ID3D11GeometryShader*> GeometryShader;
+			SCachedBinding<ID3D11PixelShader*> PixelShader;
+			std::array<SCachedBinding<ID3D11Buffer*>, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT> VSConstantBuffers;
+			std::array<SCachedBinding<ID3D11Buffer*>, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT> GSConstantBuffers;
+			std::array<SCachedBinding<ID3D11Buffer*>, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT> PSConstantBuffers;
+			std::array<SCachedBinding<ID3D11SamplerState*>, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT> PSSamplers;
+
+			SCachedBinding<ID3D11RasterizerState*> RasterizerState;
+			SCachedBinding<ID3D11BlendState*> BlendState;
+			SCachedBinding<SDepthStencilBinding> DepthStencilState;
+		};
+
+		// Returns false and counts the bind as avoided if the value is already bound
+		template<typename T>
+		static bool TryBind(SCachedBinding<T>& binding, const T& value);
+
 	private:
 		const std::string ShaderRoot = "Shaders/";
 
@@ -168,10 +228,33 @@ namespace Havtorn
 		std::map<std::string, SShaderInitData> ShaderInitData;
 		std::queue<std::string> QueuedShaderRecompiles;
 		std::mutex ShaderRecompileMutex;
+
+		mutable SBoundStateCache BoundState;
 	};
 
+	template<typename T>
+	bool CRenderStateManager::TryBind(SCachedBinding<T>& binding, const T& value)
+	{
+		if (binding.IsBound && binding.Value == value)
+		{
+			NumberOfStateBindsAvoidedThisFrame++;
+			return false;
+		}
+
+		binding.Value = value;
+		binding.IsBound = true;
+		NumberOfStateBindsThisFrame++;
+		return true;
+	}
+
 	template <typename T>
 	U16 CRenderStateManager::AddVertexBuffer(const std::vector<T>& vertices)
+	{
+		return AddVertexBuffer(std::span<const T>(vertices));
+	}
+
+	template <typename T>
+	U16 CRenderStateManager::AddVertexBuffer(const std::span<const T> vertices)
 	{
 		VertexBuffers.emplace_back(CDataBuffer());
 		VertexBuffers.back().CreateBuffer("Vertex Buffer", Framework, sizeof(T) * STATIC_U32(vertices.size()), vertices.data(), EDataBufferType::Vertex, EDataBufferUsage::Immutable, EDataBufferCPUAccess::None);
@@ -10,6 +10,30 @@
 
 namespace Havtorn
 {
+	HRESULT CreateShaderResourceViewFromMemory(ID3D11Device* device, const ETextureFormat format, const std::string& textureData, ID3D11ShaderResourceView** outShaderResourceView)
+	{
+		DirectX::ScratchImage scratchImage;
+		DirectX::TexMetadata metaData = {};
+
+		const uint8_t* source = reinterpret_cast<const uint8_t*>(textureData.data());
+		switch (format)
+		{
+		case ETextureFormat::DDS:
+			GetMetadataFromDDSMemory(source, textureData.size(), DirectX::DDS_FLAGS_NONE, metaData);
+			LoadFromDDSMemory(source, textureData.size(), DirectX::DDS_FLAGS_NONE, &metaData, scratchImage);
+
+			break;
+		case ETextureFormat::TGA:
+			GetMetadataFromTGAMemory(source, textureData.size(), DirectX::TGA_FLAGS_NONE, metaData);
+			LoadFromTGAMemory(source, textureData.size(), DirectX::TGA_FLAGS_NONE, &metaData, scratchImage);
+			break;
+		}
+
+		const DirectX::Image* image = scratchImage.GetImage(0, 0, 0);
+
+		return DirectX::CreateShaderResourceView(device, image, scratchImage.GetImageCount(), metaData, outShaderResourceView);
+	}
+
 	HRESULT CreateShaderResourceViewFromAsset(ID3D11Device* device, const std::string& filePath, const EAssetType assetType, ID3D11ShaderResourceView** outShaderResourceView)
 	{
 		const U64 fileSize = UFileSystem::GetFileSize(filePath);
@@ -23,38 +47,21 @@ namespace Havtorn
 		if (assetType == EAssetType::Texture)
 		{
 			STextureFileHeader assetFile;
-			assetFile.Deserialize(data);
+			assetFile.Deserialize(data, fileSize);
 			format = assetFile.OriginalFormat;
-			fileData = assetFile.Data;
+			fileData = std::move(assetFile.Data);
 		}
 		else if (assetType == EAssetType::TextureCube)
 		{
 			STextureCubeFileHeader assetFile;
-			assetFile.Deserialize(data);
+			assetFile.Deserialize(data, fileSize);
 			format = assetFile.OriginalFormat;
-			fileData = assetFile.Data;
-		}
-
-		DirectX::ScratchImage scratchImage;
-		DirectX::TexMetadata metaData = {};
-
-		switch (format)
-		{
-		case ETextureFormat::DDS:
-			GetMetadataFromDDSMemory(reinterpret_cast<uint8_t*>(fileData.data()), fileData.size(), DirectX::DDS_FLAGS_NONE, metaData);
-			LoadFromDDSMemory(reinterpret_cast<uint8_t*>(fileData.data()), fileData.size(), DirectX::DDS_FLAGS_NONE, &metaData, scratchImage);
-
-			break;
-		case ETextureFormat::TGA:
-			GetMetadataFromTGAMemory(reinterpret_cast<uint8_t*>(fileData.data()), fileData.size(), DirectX::TGA_FLAGS_NONE, metaData);
-			LoadFromTGAMemory(reinterpret_cast<uint8_t*>(fileData.data()), fileData.size(), DirectX::TGA_FLAGS_NONE, &metaData, scratchImage);
-			break;
+			fileData = std::move(assetFile.Data);
 		}
 
 		delete[] data;
-		const DirectX::Image* image = scratchImage.GetImage(0, 0, 0);
 
-		return DirectX::CreateShaderResourceView(device, image, scratchImage.GetImageCount(), metaData, outShaderResourceView);
+		return CreateShaderResourceViewFromMemory(device, format, fileData, outShaderResourceView);
 	}
 
 
@@ -305,6 +312,14 @@ namespace Havtorn
 		return std::move(returnTexture);
 	}
 
+	CStaticRenderTexture CRenderTextureFactory::CreateStaticTexture(const ETextureFormat format, const std::string& textureData)
+	{
+		CStaticRenderTexture returnTexture;
+		returnTexture.Context = Framework->GetContext();
+		ENGINE_HR_MESSAGE(CreateShaderResourceViewFromMemory(Framework->GetDevice(), format, textureData, &returnTexture.ShaderResource), "SRV could not be created from texture data");
+		return std::move(returnTexture);
+	}
+
 	CGBuffer CRenderTextureFactory::CreateGBuffer(SVector2<U16> size)
 	{
 		std::array<DXGI_FORMAT, static_cast<size_t>(CGBuffer::EGBufferTextures::Count)> textureFormats =
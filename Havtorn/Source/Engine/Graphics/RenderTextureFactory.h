@@ -28,6 +28,8 @@ namespace Havtorn
 		CRenderTexture CreateTextureFromData(const SVector2<U16> size, const DXGI_FORMAT format, void* data, const U64 elementSize);
 
 		ENGINE_API CStaticRenderTexture CreateStaticTexture(const std::string& filePath, const EAssetType assetType);
+		// Creates the texture from already deserialized file data, without going back to disk
+		ENGINE_API CStaticRenderTexture CreateStaticTexture(const ETextureFormat format, const std::string& textureData);
 
 		CGBuffer CreateGBuffer(SVector2<U16> size);
 
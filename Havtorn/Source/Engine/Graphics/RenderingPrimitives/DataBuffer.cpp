@@ -31,6 +31,28 @@ namespace Havtorn
 		}
 	}
 
+	void CDataBuffer::CreateStructuredBuffer(const std::string& bufferName, const CGraphicsFramework* framework, U32 elementSize, U32 numberOfElements)
+	{
+		Name = bufferName;
+		Context = framework->GetContext();
+
+		D3D11_BUFFER_DESC bufferDescription = CD3D11_BUFFER_DESC{};
+		bufferDescription.Usage = D3D11_USAGE_DYNAMIC;
+		bufferDescription.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		bufferDescription.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		bufferDescription.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+		bufferDescription.ByteWidth = elementSize * numberOfElements;
+		bufferDescription.StructureByteStride = elementSize;
+		ENGINE_HR_MESSAGE(framework->GetDevice()->CreateBuffer(&bufferDescription, nullptr, &Buffer), "%s could not be created.", Name.c_str());
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC resourceDescription = {};
+		resourceDescription.Format = DXGI_FORMAT_UNKNOWN;
+		resourceDescription.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+		resourceDescription.Buffer.FirstElement = 0;
+		resourceDescription.Buffer.NumElements = numberOfElements;
+		ENGINE_HR_MESSAGE(framework->GetDevice()->CreateShaderResourceView(Buffer, &resourceDescription, &ShaderResource), "%s shader resource could not be created.", Name.c_str());
+	}
+
 	CDataBuffer::CDataBuffer(const std::string& name, ID3D11DeviceContext* context, ID3D11Buffer* buffer)
 		: Name(name)
 		, Context(context)
@@ -39,6 +39,8 @@ namespace Havtorn
 		~CDataBuffer() = default;
 
 		void CreateBuffer(const std::string& bufferName, const CGraphicsFramework* framework, U32 byteWidth, const void* subResourceData = nullptr, EDataBufferType bufferType = EDataBufferType::Constant, EDataBufferUsage usage = EDataBufferUsage::Dynamic, EDataBufferCPUAccess cpuAccess = EDataBufferCPUAccess::CPUAccessWrite);
+		// Dynamic StructuredBuffer of numberOfElements elements, read by shaders through ShaderResource
+		void CreateStructuredBuffer(const std::string& bufferName, const CGraphicsFramework* framework, U32 elementSize, U32 numberOfElements);
 
 		template<class T>
 		void BindBuffer(const T& bufferData)
@@ -64,11 +66,24 @@ namespace Havtorn
 			Context->Unmap(Buffer, 0);
 		}
 
+		template<class T>
+		void BindBuffer(const T* bufferData, const U64 numberOfElements)
+		{
+			D3D11_MAPPED_SUBRESOURCE localBufferData;
+			ZeroMemory(&localBufferData, sizeof(D3D11_MAPPED_SUBRESOURCE));
+			const std::string errorMessage = Name + " could not be bound.";
+			ENGINE_HR_MESSAGE(Context->Map(Buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &localBufferData), errorMessage.c_str());
+
+			memcpy(localBufferData.pData, bufferData, sizeof(T) * numberOfElements);
+			Context->Unmap(Buffer, 0);
+		}
+
 	private:
 		CDataBuffer(const std::string& name, ID3D11DeviceContext* context, ID3D11Buffer* buffer);
 
 		std::string Name;
 		ID3D11DeviceContext* Context = nullptr;
 		ID3D11Buffer* Buffer = nullptr;
+		ID3D11ShaderResourceView* ShaderResource = nullptr;
 	};
 }
\ No newline at end of file
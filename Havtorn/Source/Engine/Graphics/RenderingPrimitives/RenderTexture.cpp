@@ -111,7 +111,7 @@ namespace Havtorn
 		Context->CopyResource(Texture, texture);
 	}
 
-	void CRenderTexture::WriteToCPUTexture(void* data, U64 size)
+	void CRenderTexture::WriteToCPUTexture(const void* data, U64 size, U64 rowSize)
 	{
 		if (!CPUAccess)
 		{
@@ -122,7 +122,17 @@ namespace Havtorn
 		D3D11_MAPPED_SUBRESOURCE resourceDesc = {};
 		Context->Map(Texture, 0, D3D11_MAP_WRITE, 0, &resourceDesc);
 		
-		memcpy(resourceDesc.pData, data, size);
+		if (rowSize == 0 || rowSize == resourceDesc.RowPitch)
+		{
+			memcpy(resourceDesc.pData, data, size);
+		}
+		else
+		{
+			const U8* source = reinterpret_cast<const U8*>(data);
+			U8* destination = reinterpret_cast<U8*>(resourceDesc.pData);
+			for (U64 offset = 0; offset < size; offset += rowSize, destination += resourceDesc.RowPitch)
+				memcpy(destination, source + offset, UMath::Min(rowSize, size - offset));
+		}
 
 		Context->Unmap(Texture, 0);
 	}
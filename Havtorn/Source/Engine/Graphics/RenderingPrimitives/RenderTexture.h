@@ -57,7 +57,8 @@ namespace Havtorn
 		void SetAsVSResourceOnSlot(U16 slot);
 		void* MapToCPUFromGPUTexture(ID3D11Texture2D* gpuTexture);
 		void CopyFromTexture(ID3D11Texture2D* texture);
-		void WriteToCPUTexture(void* data, U64 size);
+		// Copies rowSize bytes at a time to the texture's rows when given, the driver may pad them
+		void WriteToCPUTexture(const void* data, U64 size, U64 rowSize = 0);
 		void UnmapFromCPU();
 		void ReleaseTexture();
 		void ReleaseDepth();
@@ -226,6 +226,56 @@ Texture2D SSAOTexture           : register(t23);
 
 Texture2D MeshAnimationsTexture : register(t24);
 
+// Bone palettes of every skeletal mesh instance in the view back to back. An instance's AnimationData holds the first
+// matrix of its palette and its number of bones, 0 for instances drawn in bind pose.
+StructuredBuffer<matrix> BonePalettes : register(t25);
+
+// Matches UAnimationAtlas
+#define ANIMATION_ATLAS_WIDTH 1024
+#define ANIMATION_ATLAS_TEXELS_PER_BONE 3
+#define ANIMATION_ATLAS_INSTANCE_FLAG 0x80000000
+
+// A baked bone is the top three rows of its matrix, one texel each
+matrix LoadAtlasBone(uint frameTexel, uint boneIndex)
+{
+    const uint texel = frameTexel + boneIndex * ANIMATION_ATLAS_TEXELS_PER_BONE;
+    float4 rows[ANIMATION_ATLAS_TEXELS_PER_BONE];
+    [unroll]
+    for (uint row = 0; row < ANIMATION_ATLAS_TEXELS_PER_BONE; row++)
+    {
+        const uint rowTexel = texel + row;
+        rows[row] = MeshAnimationsTexture.Load(int3(rowTexel % ANIMATION_ATLAS_WIDTH, rowTexel / ANIMATION_ATLAS_WIDTH, 0));
+    }
+    return matrix(rows[0], rows[1], rows[2], float4(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+float4 SkinPosition(uint2 animationData, uint4 boneIndices, float4 weights, float4 pos)
+{
+    if (animationData.y == 0)
+        return pos;
+
+    // Far away instances point at a baked frame in the atlas instead of a palette of their own
+    if (animationData.y & ANIMATION_ATLAS_INSTANCE_FLAG)
+    {
+        const uint4 atlasBoneIndices = min(boneIndices, (animationData.y & ~ANIMATION_ATLAS_INSTANCE_FLAG) - 1);
+        float4 atlasPos = 0;
+        atlasPos += weights.x * mul(LoadAtlasBone(animationData.x, atlasBoneIndices.x), pos);
+        atlasPos += weights.y * mul(LoadAtlasBone(animationData.x, atlasBoneIndices.y), pos);
+        atlasPos += weights.z * mul(LoadAtlasBone(animationData.x, atlasBoneIndices.z), pos);
+        atlasPos += weights.w * mul(LoadAtlasBone(animationData.x, atlasBoneIndices.w), pos);
+        return atlasPos;
+    }
+
+    // Clamped so a bad bone index can't read the palette of another instance
+    const uint4 paletteIndices = animationData.x + min(boneIndices, animationData.y - 1);
+    float4 skinnedPos = 0;
+    skinnedPos += weights.x * mul(BonePalettes[paletteIndices.x], pos);
+    skinnedPos += weights.y * mul(BonePalettes[paletteIndices.y], pos);
+    skinnedPos += weights.z * mul(BonePalettes[paletteIndices.z], pos);
+    skinnedPos += weights.w * mul(BonePalettes[paletteIndices.w], pos);
+    return skinnedPos;
+}
+
 sampler defaultSampler : register(s0);
 sampler shadowSampler  : register(s1);
 
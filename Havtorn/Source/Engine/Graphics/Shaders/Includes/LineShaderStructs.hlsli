@@ -2,13 +2,17 @@
 
 struct LineVertexInput
 {
-    float4 Position   : POSITION;
+    float4 Position     : POSITION;
+    float4x4 Transform  : INSTANCETRANSFORM;
+    float4 Color        : INSTANCECOLOR;
+    float Thickness     : INSTANCETHICKNESS;
 };
 
 struct LineVertexToGeometry
 {
-    float4 Position : SV_POSITION;
-    float4 Color    : COLOR;
+    float4 Position     : SV_POSITION;
+    float4 Color        : COLOR;
+    float HalfThickness : THICKNESS;
 };
 
 struct LineGeometryToPixel
@@ -30,10 +34,3 @@ cbuffer FrameBuffer : register(b0)
     float4x4 ToCameraFromProjection;
     float4 CameraPosition;
 }
-
-cbuffer ObjectBuffer : register(b1)
-{
-    float4x4 ToWorld;
-    float4 Color;
-    float HalfThickness;
-}
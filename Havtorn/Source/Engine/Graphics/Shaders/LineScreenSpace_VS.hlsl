@@ -0,0 +1,17 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "Includes/LineShaderStructs.hlsli"
+
+LineVertexToGeometry main(LineVertexInput input)
+{
+    // Transform places the line in normalized screen coordinates, [0, 1] is mapped to [-1, 1]
+    float4 vertexObjectPos = input.Position.xyzw;
+    float4 vertexScreenPos = mul(input.Transform, vertexObjectPos);
+    vertexScreenPos.xy = (vertexScreenPos.xy * 2.0f) - 1.0f;
+
+    LineVertexToGeometry returnValue;
+    returnValue.Position = vertexScreenPos;
+    returnValue.Color = input.Color;
+    returnValue.HalfThickness = input.Thickness;
+    return returnValue;
+}
@@ -12,8 +12,8 @@ void main(line LineVertexToGeometry input[2], inout TriangleStream<LineGeometryT
     const float4 horizontal = float4(1, 0, 0, 0) / aspectRatio;
     const float4 vertical = float4(0, 1, 0, 0);
     
-    const float4 hIncrement = horizontal * HalfThickness;
-    const float4 vIncrement = vertical * HalfThickness;
+    const float4 hIncrement = horizontal * input[0].HalfThickness;
+    const float4 vIncrement = vertical * input[0].HalfThickness;
     
     /*
            .
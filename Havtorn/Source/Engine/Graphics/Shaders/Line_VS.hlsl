@@ -5,13 +5,14 @@
 LineVertexToGeometry main(LineVertexInput input)
 {
     float4 vertexObjectPos = input.Position.xyzw;
-    float4 vertexWorldPos = mul(ToWorld, vertexObjectPos);
+    float4 vertexWorldPos = mul(input.Transform, vertexObjectPos);
     float4 vertexViewPos = mul(ToCameraSpace, vertexWorldPos);
     float4 vertexProjectionPos = mul(ToProjectionSpace, vertexViewPos);
     
     LineVertexToGeometry returnValue;
     returnValue.Position = vertexProjectionPos;
-    returnValue.Color = Color;
+    returnValue.Color = input.Color;
+    returnValue.HalfThickness = input.Thickness;
     return returnValue;
 }
 
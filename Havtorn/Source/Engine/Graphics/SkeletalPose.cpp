@@ -0,0 +1,298 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "SkeletalPose.h"
+
+#include <MathTypes/EngineMathSSE.h>
+
+namespace Havtorn
+{
+	static_assert(sizeof(SVector) == 3 * sizeof(F32), "Pose translations and scales are read as packed floats");
+	static_assert(sizeof(SQuaternion) == 4 * sizeof(F32), "Pose rotations are read as one register each");
+	static_assert(sizeof(SMatrix) == 16 * sizeof(F32), "Transforms are blended as packed floats");
+
+	namespace
+	{
+		void LerpFloats(const F32* a, const F32* b, const F32 weight, F32* outValues, const U64 count)
+		{
+			const VectorRegister weights = VectorRegisterSet1(weight);
+
+			U64 i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				const VectorRegister valuesA = VectorRegisterLoad(a + i);
+				const VectorRegister valuesB = VectorRegisterLoad(b + i);
+				VectorRegisterStore(VectorRegisterAdd(valuesA, VectorRegisterMultiply(VectorRegisterSubtract(valuesB, valuesA), weights)), outValues + i);
+			}
+
+			for (; i < count; i++)
+				outValues[i] = a[i] + (b[i] - a[i]) * weight;
+		}
+
+		SQuaternion NlerpRotation(const SQuaternion& a, const SQuaternion& b, const F32 weight)
+		{
+			const F32 dot = a.X * b.X + a.Y * b.Y + a.Z * b.Z + a.W * b.W;
+			const F32 weightA = 1.0f - weight;
+			const F32 weightB = dot >= 0.0f ? weight : -weight;
+
+			SQuaternion result(a.X * weightA + b.X * weightB, a.Y * weightA + b.Y * weightB, a.Z * weightA + b.Z * weightB, a.W * weightA + b.W * weightB);
+			const F32 inverseLength = 1.0f / UMath::Sqrt(result.X * result.X + result.Y * result.Y + result.Z * result.Z + result.W * result.W);
+			result.X *= inverseLength;
+			result.Y *= inverseLength;
+			result.Z *= inverseLength;
+			result.W *= inverseLength;
+			return result;
+		}
+
+		void AccumulateRotation(const SQuaternion& rotation, const F32 weight, SQuaternion& inOutSum)
+		{
+			const F32 dot = inOutSum.X * rotation.X + inOutSum.Y * rotation.Y + inOutSum.Z * rotation.Z + inOutSum.W * rotation.W;
+			const F32 signedWeight = dot >= 0.0f ? weight : -weight;
+			inOutSum.X += rotation.X * signedWeight;
+			inOutSum.Y += rotation.Y * signedWeight;
+			inOutSum.Z += rotation.Z * signedWeight;
+			inOutSum.W += rotation.W * signedWeight;
+		}
+	}
+
+	void USkeletalPose::Blend(const SSkeletalPose& a, const SSkeletalPose& b, const F32 weight, SSkeletalPose& outPose)
+	{
+		const U64 numberOfNodes = UMath::Min(a.Size(), b.Size());
+		outPose.Resize(numberOfNodes);
+		if (numberOfNodes == 0)
+			return;
+
+		// Translations and scales are lerped as plain floats, no matter which node or axis they belong to
+		LerpFloats(&a.Translations[0].X, &b.Translations[0].X, weight, &outPose.Translations[0].X, numberOfNodes * 3);
+		LerpFloats(&a.Scales[0].X, &b.Scales[0].X, weight, &outPose.Scales[0].X, numberOfNodes * 3);
+
+		const VectorRegister zero = VectorRegisterZero();
+		const VectorRegister one = VectorRegisterSet1(1.0f);
+		const VectorRegister weightsA = VectorRegisterSet1(1.0f - weight);
+		const VectorRegister weightsB = VectorRegisterSet1(weight);
+
+		U64 i = 0;
+		for (; i + 4 <= numberOfNodes; i += 4)
+		{
+			// One quaternion per register, transposed so every register holds one component of four nodes
+			VectorRegister aX = VectorRegisterLoad(&a.Rotations[i].X);
+			VectorRegister aY = VectorRegisterLoad(&a.Rotations[i + 1].X);
+			VectorRegister aZ = VectorRegisterLoad(&a.Rotations[i + 2].X);
+			VectorRegister aW = VectorRegisterLoad(&a.Rotations[i + 3].X);
+			VectorRegisterTranspose(aX, aY, aZ, aW);
+
+			VectorRegister bX = VectorRegisterLoad(&b.Rotations[i].X);
+			VectorRegister bY = VectorRegisterLoad(&b.Rotations[i + 1].X);
+			VectorRegister bZ = VectorRegisterLoad(&b.Rotations[i + 2].X);
+			VectorRegister bW = VectorRegisterLoad(&b.Rotations[i + 3].X);
+			VectorRegisterTranspose(bX, bY, bZ, bW);
+
+			// Shortest arc, b is flipped where the two point away from each other
+			const VectorRegister dot = VectorRegisterAdd(VectorRegisterAdd(VectorRegisterMultiply(aX, bX), VectorRegisterMultiply(aY, bY)), VectorRegisterAdd(VectorRegisterMultiply(aZ, bZ), VectorRegisterMultiply(aW, bW)));
+			const VectorRegister signedWeightsB = VectorRegisterSelect(VectorRegisterCompareGreaterEqual(dot, zero), weightsB, VectorRegisterSubtract(zero, weightsB));
+
+			VectorRegister x = VectorRegisterAdd(VectorRegisterMultiply(aX, weightsA), VectorRegisterMultiply(bX, signedWeightsB));
+			VectorRegister y = VectorRegisterAdd(VectorRegisterMultiply(aY, weightsA), VectorRegisterMultiply(bY, signedWeightsB));
+			VectorRegister z = VectorRegisterAdd(VectorRegisterMultiply(aZ, weightsA), VectorRegisterMultiply(bZ, signedWeightsB));
+			VectorRegister w = VectorRegisterAdd(VectorRegisterMultiply(aW, weightsA), VectorRegisterMultiply(bW, signedWeightsB));
+
+			const VectorRegister lengthSquared = VectorRegisterAdd(VectorRegisterAdd(VectorRegisterMultiply(x, x), VectorRegisterMultiply(y, y)), VectorRegisterAdd(VectorRegisterMultiply(z, z), VectorRegisterMultiply(w, w)));
+			const VectorRegister inverseLength = VectorRegisterDivide(one, VectorRegisterSqrt(lengthSquared));
+			x = VectorRegisterMultiply(x, inverseLength);
+			y = VectorRegisterMultiply(y, inverseLength);
+			z = VectorRegisterMultiply(z, inverseLength);
+			w = VectorRegisterMultiply(w, inverseLength);
+
+			VectorRegisterTranspose(x, y, z, w);
+			VectorRegisterStore(x, &outPose.Rotations[i].X);
+			VectorRegisterStore(y, &outPose.Rotations[i + 1].X);
+			VectorRegisterStore(z, &outPose.Rotations[i + 2].X);
+			VectorRegisterStore(w, &outPose.Rotations[i + 3].X);
+		}
+
+		for (; i < numberOfNodes; i++)
+			outPose.Rotations[i] = NlerpRotation(a.Rotations[i], b.Rotations[i], weight);
+	}
+
+	void USkeletalPose::ComposeTransforms(const SSkeletalPose& pose, std::vector<SMatrix>& outTransforms)
+	{
+		const U64 numberOfNodes = pose.Size();
+		outTransforms.resize(numberOfNodes);
+
+		const VectorRegister zero = VectorRegisterZero();
+		const VectorRegister one = VectorRegisterSet1(1.0f);
+		const VectorRegister two = VectorRegisterSet1(2.0f);
+		const VectorRegister epsilon = VectorRegisterSet1(FLT_EPSILON);
+		const VectorRegister minScale = VectorRegisterSet1(SMATRIX_MIN_SCALE);
+
+		U64 i = 0;
+		for (; i + 4 <= numberOfNodes; i += 4)
+		{
+			VectorRegister x = VectorRegisterLoad(&pose.Rotations[i].X);
+			VectorRegister y = VectorRegisterLoad(&pose.Rotations[i + 1].X);
+			VectorRegister z = VectorRegisterLoad(&pose.Rotations[i + 2].X);
+			VectorRegister w = VectorRegisterLoad(&pose.Rotations[i + 3].X);
+			VectorRegisterTranspose(x, y, z, w);
+
+			const SVector* scales = &pose.Scales[i];
+			const SVector* translations = &pose.Translations[i];
+
+			// Same clamp as SMatrix::SetScale
+			const VectorRegister scaleX = MakeVectorRegister(scales[0].X, scales[1].X, scales[2].X, scales[3].X);
+			const VectorRegister scaleY = MakeVectorRegister(scales[0].Y, scales[1].Y, scales[2].Y, scales[3].Y);
+			const VectorRegister scaleZ = MakeVectorRegister(scales[0].Z, scales[1].Z, scales[2].Z, scales[3].Z);
+			const VectorRegister validScaleX = VectorRegisterSelect(VectorRegisterCompareGreaterEqual(scaleX, epsilon), scaleX, minScale);
+			const VectorRegister validScaleY = VectorRegisterSelect(VectorRegisterCompareGreaterEqual(scaleY, epsilon), scaleY, minScale);
+			const VectorRegister validScaleZ = VectorRegisterSelect(VectorRegisterCompareGreaterEqual(scaleZ, epsilon), scaleZ, minScale);
+
+			// Same terms as SMatrix::CreateRotationFromQuaternion
+			const VectorRegister xx2 = VectorRegisterMultiply(two, VectorRegisterMultiply(x, x));
+			const VectorRegister yy2 = VectorRegisterMultiply(two, VectorRegisterMultiply(y, y));
+			const VectorRegister zz2 = VectorRegisterMultiply(two, VectorRegisterMultiply(z, z));
+			const VectorRegister xy2 = VectorRegisterMultiply(two, VectorRegisterMultiply(x, y));
+			const VectorRegister xz2 = VectorRegisterMultiply(two, VectorRegisterMultiply(x, z));
+			const VectorRegister xw2 = VectorRegisterMultiply(two, VectorRegisterMultiply(x, w));
+			const VectorRegister yz2 = VectorRegisterMultiply(two, VectorRegisterMultiply(y, z));
+			const VectorRegister yw2 = VectorRegisterMultiply(two, VectorRegisterMultiply(y, w));
+			const VectorRegister zw2 = VectorRegisterMultiply(two, VectorRegisterMultiply(z, w));
+
+			// Every register holds one matrix element of four nodes, transposed into one row of each node's matrix
+			VectorRegister row0[4] = {
+				VectorRegisterMultiply(VectorRegisterSubtract(VectorRegisterSubtract(one, yy2), zz2), validScaleX),
+				VectorRegisterMultiply(VectorRegisterAdd(xy2, zw2), validScaleX),
+				VectorRegisterMultiply(VectorRegisterSubtract(xz2, yw2), validScaleX),
+				zero };
+			VectorRegister row1[4] = {
+				VectorRegisterMultiply(VectorRegisterSubtract(xy2, zw2), validScaleY),
+				VectorRegisterMultiply(VectorRegisterSubtract(VectorRegisterSubtract(one, xx2), zz2), validScaleY),
+				VectorRegisterMultiply(VectorRegisterAdd(yz2, xw2), validScaleY),
+				zero };
+			VectorRegister row2[4] = {
+				VectorRegisterMultiply(VectorRegisterAdd(xz2, yw2), validScaleZ),
+				VectorRegisterMultiply(VectorRegisterSubtract(yz2, xw2), validScaleZ),
+				VectorRegisterMultiply(VectorRegisterSubtract(VectorRegisterSubtract(one, xx2), yy2), validScaleZ),
+				zero };
+			VectorRegister row3[4] = {
+				MakeVectorRegister(translations[0].X, translations[1].X, translations[2].X, translations[3].X),
+				MakeVectorRegister(translations[0].Y, translations[1].Y, translations[2].Y, translations[3].Y),
+				MakeVectorRegister(translations[0].Z, translations[1].Z, translations[2].Z, translations[3].Z),
+				one };
+
+			VectorRegisterTranspose(row0[0], row0[1], row0[2], row0[3]);
+			VectorRegisterTranspose(row1[0], row1[1], row1[2], row1[3]);
+			VectorRegisterTranspose(row2[0], row2[1], row2[2], row2[3]);
+			VectorRegisterTranspose(row3[0], row3[1], row3[2], row3[3]);
+
+			for (U8 node = 0; node < 4; node++)
+			{
+				SMatrix& transform = outTransforms[i + node];
+				VectorRegisterStore(row0[node], transform.M[0]);
+				VectorRegisterStore(row1[node], transform.M[1]);
+				VectorRegisterStore(row2[node], transform.M[2]);
+				VectorRegisterStore(row3[node], transform.M[3]);
+			}
+		}
+
+		for (; i < numberOfNodes; i++)
+			SMatrix::Recompose(pose.Translations[i], pose.Rotations[i], pose.Scales[i], outTransforms[i]);
+	}
+
+	void USkeletalPose::BlendTransforms(const std::vector<SMatrix>& a, const std::vector<SMatrix>& b, const F32 weight, std::vector<SMatrix>& outTransforms)
+	{
+		const U64 numberOfTransforms = UMath::Min(a.size(), b.size());
+		outTransforms.resize(numberOfTransforms);
+		if (numberOfTransforms > 0)
+			LerpFloats(a[0].data, b[0].data, weight, outTransforms[0].data, numberOfTransforms * 16);
+	}
+
+	void USkeletalPose::Multiply(const SMatrix& a, const SMatrix& b, SMatrix& outMatrix)
+	{
+		// Rows of b are loaded first, so writing to either input is safe
+		const VectorRegister b0 = VectorRegisterLoad(b.M[0]);
+		const VectorRegister b1 = VectorRegisterLoad(b.M[1]);
+		const VectorRegister b2 = VectorRegisterLoad(b.M[2]);
+		const VectorRegister b3 = VectorRegisterLoad(b.M[3]);
+
+		for (U8 row = 0; row < 4; row++)
+		{
+			VectorRegister result = VectorRegisterMultiply(VectorRegisterSet1(a.M[row][0]), b0);
+			result = VectorRegisterAdd(result, VectorRegisterMultiply(VectorRegisterSet1(a.M[row][1]), b1));
+			result = VectorRegisterAdd(result, VectorRegisterMultiply(VectorRegisterSet1(a.M[row][2]), b2));
+			result = VectorRegisterAdd(result, VectorRegisterMultiply(VectorRegisterSet1(a.M[row][3]), b3));
+			VectorRegisterStore(result, outMatrix.M[row]);
+		}
+	}
+
+	void USkeletalPose::Clear(const std::vector<U32>& nodeIndices, SSkeletalPose& inOutPose)
+	{
+		for (const U32 nodeIndex : nodeIndices)
+		{
+			inOutPose.Translations[nodeIndex] = SVector::Zero;
+			inOutPose.Rotations[nodeIndex] = SQuaternion(0.0f, 0.0f, 0.0f, 0.0f);
+			inOutPose.Scales[nodeIndex] = SVector::Zero;
+		}
+	}
+
+	void USkeletalPose::Scale(const F32 weight, const std::vector<U32>& nodeIndices, SSkeletalPose& inOutPose)
+	{
+		for (const U32 nodeIndex : nodeIndices)
+		{
+			SQuaternion& rotation = inOutPose.Rotations[nodeIndex];
+			inOutPose.Translations[nodeIndex] *= weight;
+			rotation.X *= weight;
+			rotation.Y *= weight;
+			rotation.Z *= weight;
+			rotation.W *= weight;
+			inOutPose.Scales[nodeIndex] *= weight;
+		}
+	}
+
+	void USkeletalPose::Accumulate(const SSkeletalPose& pose, const F32 weight, const std::vector<U32>& nodeIndices, SSkeletalPose& inOutPose)
+	{
+		for (const U32 nodeIndex : nodeIndices)
+		{
+			inOutPose.Translations[nodeIndex] += pose.Translations[nodeIndex] * weight;
+			AccumulateRotation(pose.Rotations[nodeIndex], weight, inOutPose.Rotations[nodeIndex]);
+			inOutPose.Scales[nodeIndex] += pose.Scales[nodeIndex] * weight;
+		}
+	}
+
+	void USkeletalPose::AccumulateAdditive(const SSkeletalPose& pose, const SSkeletalPose& referencePose, const F32 weight, const std::vector<U32>& nodeIndices, SSkeletalPose& inOutDelta)
+	{
+		for (const U32 nodeIndex : nodeIndices)
+		{
+			inOutDelta.Translations[nodeIndex] += (pose.Translations[nodeIndex] - referencePose.Translations[nodeIndex]) * weight;
+			AccumulateRotation(referencePose.Rotations[nodeIndex].Inverse() * pose.Rotations[nodeIndex], weight, inOutDelta.Rotations[nodeIndex]);
+			inOutDelta.Scales[nodeIndex] += (pose.Scales[nodeIndex] - referencePose.Scales[nodeIndex]) * weight;
+		}
+	}
+
+	void USkeletalPose::NormalizeRotations(const std::vector<U32>& nodeIndices, SSkeletalPose& inOutPose)
+	{
+		for (const U32 nodeIndex : nodeIndices)
+		{
+			SQuaternion& rotation = inOutPose.Rotations[nodeIndex];
+			const F32 lengthSquared = rotation.X * rotation.X + rotation.Y * rotation.Y + rotation.Z * rotation.Z + rotation.W * rotation.W;
+			if (lengthSquared <= SMALL_NUMBER)
+			{
+				rotation = SQuaternion::Identity;
+				continue;
+			}
+
+			const F32 inverseLength = 1.0f / UMath::Sqrt(lengthSquared);
+			rotation.X *= inverseLength;
+			rotation.Y *= inverseLength;
+			rotation.Z *= inverseLength;
+			rotation.W *= inverseLength;
+		}
+	}
+
+	void USkeletalPose::ApplyAdditive(const SSkeletalPose& delta, const F32 weight, const std::vector<U32>& nodeIndices, SSkeletalPose& inOutPose)
+	{
+		for (const U32 nodeIndex : nodeIndices)
+		{
+			inOutPose.Translations[nodeIndex] += delta.Translations[nodeIndex] * weight;
+			inOutPose.Rotations[nodeIndex] = inOutPose.Rotations[nodeIndex] * NlerpRotation(SQuaternion::Identity, delta.Rotations[nodeIndex], weight);
+			inOutPose.Scales[nodeIndex] += delta.Scales[nodeIndex] * weight;
+		}
+	}
+}
@@ -0,0 +1,44 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#pragma once
+#include "hvpch.h"
+#include "Graphics/GraphicsStructs.h"
+
+namespace Havtorn
+{
+	// Pose math for many nodes at once, four nodes per SSE register with a scalar tail. Rotations are blended with a
+	// normalized lerp along the shortest arc. It stays close to slerp for the angles poses are blended over and needs no
+	// trigonometry, so a whole skeleton fits in a few registers at a time.
+	class USkeletalPose
+	{
+	public:
+		// Lerps translations and scales and nlerps rotations, for as many nodes as both poses have. outPose may be a or b.
+		static ENGINE_API void Blend(const SSkeletalPose& a, const SSkeletalPose& b, const F32 weight, SSkeletalPose& outPose);
+
+		// SMatrix::Recompose of every node
+		static ENGINE_API void ComposeTransforms(const SSkeletalPose& pose, std::vector<SMatrix>& outTransforms);
+
+		// Lerps every element, for as many transforms as both have. Only meant for blending between close poses.
+		static ENGINE_API void BlendTransforms(const std::vector<SMatrix>& a, const std::vector<SMatrix>& b, const F32 weight, std::vector<SMatrix>& outTransforms);
+
+		// a * b like SMatrix::operator*, outMatrix may be either of them
+		static ENGINE_API void Multiply(const SMatrix& a, const SMatrix& b, SMatrix& outMatrix);
+
+		// Weighted sums for blend trees. These only touch the listed nodes, so masked layers don't pay for the rest of the
+		// skeleton, and go one node at a time since the listed nodes aren't next to each other. Rotations are summed on the
+		// hemisphere of what is already there, NormalizeRotations turns the sum into the blended rotation.
+
+		// Zero translations, rotations and scales of nodes
+		static ENGINE_API void Clear(const std::vector<U32>& nodeIndices, SSkeletalPose& inOutPose);
+		// inOutPose * weight
+		static ENGINE_API void Scale(const F32 weight, const std::vector<U32>& nodeIndices, SSkeletalPose& inOutPose);
+		// inOutPose + pose * weight
+		static ENGINE_API void Accumulate(const SSkeletalPose& pose, const F32 weight, const std::vector<U32>& nodeIndices, SSkeletalPose& inOutPose);
+		// inOutDelta + (pose - referencePose) * weight, rotations as the rotation from the reference to the pose
+		static ENGINE_API void AccumulateAdditive(const SSkeletalPose& pose, const SSkeletalPose& referencePose, const F32 weight, const std::vector<U32>& nodeIndices, SSkeletalPose& inOutDelta);
+		// Rotations summed to nothing become identity
+		static ENGINE_API void NormalizeRotations(const std::vector<U32>& nodeIndices, SSkeletalPose& inOutPose);
+		// inOutPose + delta * weight, the delta rotation nlerped from identity by weight
+		static ENGINE_API void ApplyAdditive(const SSkeletalPose& delta, const F32 weight, const std::vector<U32>& nodeIndices, SSkeletalPose& inOutPose);
+	};
+}
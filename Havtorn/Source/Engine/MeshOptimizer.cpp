@@ -0,0 +1,419 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "MeshOptimizer.h"
+
+namespace Havtorn
+{
+	namespace
+	{
+		// Forsyth's vertex score: vertices of the last triangle get a fixed score so its neighbours don't all tie, the rest
+		// fall off with their cache position. Vertices with few triangles left are boosted so they get finished off.
+		F32 GetVertexScore(const I32 cachePosition, const U32 numberOfRemainingTriangles)
+		{
+			if (numberOfRemainingTriangles == 0)
+				return -1.0f;
+
+			F32 score = 0.0f;
+			if (cachePosition >= 0 && cachePosition < 3)
+				score = 0.75f;
+			else if (cachePosition >= 3)
+				score = UMath::Pow(1.0f - STATIC_F32(cachePosition - 3) / STATIC_F32(UMeshOptimizer::VertexCacheSize - 3), 1.5f);
+
+			return score + 2.0f / UMath::Sqrt(STATIC_F32(numberOfRemainingTriangles));
+		}
+
+		void OptimizeVertexCache(std::vector<U32>& indices, const U32 numberOfVertices)
+		{
+			const U32 numberOfTriangles = STATIC_U32(indices.size() / 3);
+			if (numberOfTriangles == 0)
+				return;
+
+			// Triangles of every vertex, vertex v owns [TriangleOffsets[v], TriangleOffsets[v] + RemainingTriangles[v]).
+			// Emitted triangles are swapped out of the end of the range.
+			std::vector<U32> remainingTriangles(numberOfVertices, 0);
+			for (const U32 index : indices)
+				remainingTriangles[index]++;
+
+			std::vector<U32> triangleOffsets(numberOfVertices, 0);
+			U32 offset = 0;
+			for (U32 v = 0; v < numberOfVertices; v++)
+			{
+				triangleOffsets[v] = offset;
+				offset += remainingTriangles[v];
+			}
+
+			std::vector<U32> vertexTriangles(indices.size());
+			{
+				std::vector<U32> filled(numberOfVertices, 0);
+				for (U32 t = 0; t < numberOfTriangles; t++)
+				{
+					for (U32 k = 0; k < 3; k++)
+					{
+						const U32 v = indices[t * 3 + k];
+						vertexTriangles[triangleOffsets[v] + filled[v]++] = t;
+					}
+				}
+			}
+
+			std::vector<I32> cachePositions(numberOfVertices, -1);
+			std::vector<F32> vertexScores(numberOfVertices);
+			for (U32 v = 0; v < numberOfVertices; v++)
+				vertexScores[v] = GetVertexScore(-1, remainingTriangles[v]);
+
+			I64 bestTriangle = -1;
+			F32 bestScore = -1.0f;
+			std::vector<F32> triangleScores(numberOfTriangles);
+			for (U32 t = 0; t < numberOfTriangles; t++)
+			{
+				triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+				if (triangleScores[t] > bestScore)
+				{
+					bestScore = triangleScores[t];
+					bestTriangle = t;
+				}
+			}
+
+			std::vector<U8> isEmitted(numberOfTriangles, 0);
+			std::vector<U32> output;
+			output.reserve(indices.size());
+
+			U32 cache[UMeshOptimizer::VertexCacheSize + 3] = {};
+			U32 cacheCount = 0;
+			U32 fallbackCursor = 0;
+
+			for (U32 emittedCount = 0; emittedCount < numberOfTriangles; emittedCount++)
+			{
+				// Nothing in the cache has triangles left, start over somewhere else
+				if (bestTriangle < 0)
+				{
+					while (isEmitted[fallbackCursor])
+						fallbackCursor++;
+
+					bestTriangle = fallbackCursor;
+				}
+
+				const U32 triangle = STATIC_U32(bestTriangle);
+				const U32 triangleVertices[3] = { indices[triangle * 3], indices[triangle * 3 + 1], indices[triangle * 3 + 2] };
+				isEmitted[triangle] = 1;
+				output.insert(output.end(), std::begin(triangleVertices), std::end(triangleVertices));
+
+				for (const U32 v : triangleVertices)
+				{
+					U32* triangles = &vertexTriangles[triangleOffsets[v]];
+					U32& count = remainingTriangles[v];
+					for (U32 i = 0; i < count; i++)
+					{
+						if (triangles[i] == triangle)
+						{
+							std::swap(triangles[i], triangles[count - 1]);
+							count--;
+							break;
+						}
+					}
+				}
+
+				// The triangle's vertices move to the front, the rest shift back and may fall out
+				U32 newCache[UMeshOptimizer::VertexCacheSize + 3] = {};
+				U32 newCacheCount = 0;
+				for (const U32 v : triangleVertices)
+				{
+					if (std::find(newCache, newCache + newCacheCount, v) == newCache + newCacheCount)
+						newCache[newCacheCount++] = v;
+				}
+
+				for (U32 i = 0; i < cacheCount; i++)
+				{
+					const U32 v = cache[i];
+					if (v != triangleVertices[0] && v != triangleVertices[1] && v != triangleVertices[2])
+						newCache[newCacheCount++] = v;
+				}
+
+				for (U32 i = 0; i < newCacheCount; i++)
+				{
+					const U32 v = newCache[i];
+					cachePositions[v] = i < UMeshOptimizer::VertexCacheSize ? STATIC_I32(i) : -1;
+					vertexScores[v] = GetVertexScore(cachePositions[v], remainingTriangles[v]);
+				}
+
+				// Only triangles touching the cache changed score, the next one is picked among those
+				bestTriangle = -1;
+				bestScore = -1.0f;
+				for (U32 i = 0; i < newCacheCount; i++)
+				{
+					const U32 v = newCache[i];
+					const U32* triangles = &vertexTriangles[triangleOffsets[v]];
+					for (U32 j = 0; j < remainingTriangles[v]; j++)
+					{
+						const U32 t = triangles[j];
+						triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+						if (triangleScores[t] > bestScore)
+						{
+							bestScore = triangleScores[t];
+							bestTriangle = t;
+						}
+					}
+				}
+
+				cacheCount = UMath::Min(newCacheCount, UMeshOptimizer::VertexCacheSize);
+				std::copy(newCache, newCache + cacheCount, cache);
+			}
+
+			indices.swap(output);
+		}
+
+		// Counts misses of a FIFO cache. A vertex is cached while fewer than CacheSize misses happened since its own, so
+		// moving the timestamp past CacheSize empties the cache without touching every vertex.
+		struct SFIFOCache
+		{
+			SFIFOCache(const U32 numberOfVertices, const U32 cacheSize)
+				: Timestamps(numberOfVertices, 0)
+				, CacheSize(cacheSize)
+				, Timestamp(cacheSize + 1)
+			{
+			}
+
+			U32 AddTriangle(const U32* triangle)
+			{
+				U32 misses = 0;
+				for (U32 k = 0; k < 3; k++)
+				{
+					if (Timestamp - Timestamps[triangle[k]] > CacheSize)
+					{
+						Timestamps[triangle[k]] = Timestamp++;
+						misses++;
+					}
+				}
+				return misses;
+			}
+
+			void Reset() { Timestamp += CacheSize + 1; }
+
+			std::vector<U32> Timestamps;
+			U32 CacheSize = 0;
+			U32 Timestamp = 0;
+		};
+
+		template<typename TVertex>
+		SVector GetPosition(const TVertex& vertex)
+		{
+			return SVector(vertex.x, vertex.y, vertex.z);
+		}
+
+		template<typename TVertex>
+		void OptimizeOverdraw(const std::vector<TVertex>& vertices, std::vector<U32>& indices)
+		{
+			const U32 numberOfTriangles = STATIC_U32(indices.size() / 3);
+			if (numberOfTriangles < 2)
+				return;
+
+			const U32 numberOfVertices = STATIC_U32(vertices.size());
+
+			// Hard boundaries are where the vertex cache order already misses on every vertex, so the order of what
+			// comes before and after doesn't matter to the cache. Soft boundaries split those further as long as the ACMR
+			// of the piece stays within OverdrawThreshold of the whole, which is what bounds the ACMR cost of the sort.
+			std::vector<U32> clusterStarts;
+			{
+				SFIFOCache cache(numberOfVertices, UMeshOptimizer::FIFOCacheSize);
+				std::vector<U32> hardStarts;
+				for (U32 t = 0; t < numberOfTriangles; t++)
+				{
+					if (cache.AddTriangle(&indices[t * 3]) == 3 || t == 0)
+						hardStarts.push_back(t);
+				}
+				hardStarts.push_back(numberOfTriangles);
+
+				for (U64 h = 0; h + 1 < hardStarts.size(); h++)
+				{
+					const U32 start = hardStarts[h];
+					const U32 end = hardStarts[h + 1];
+
+					cache.Reset();
+					U32 clusterMisses = 0;
+					for (U32 t = start; t < end; t++)
+						clusterMisses += cache.AddTriangle(&indices[t * 3]);
+
+					const F32 clusterACMR = STATIC_F32(clusterMisses) / STATIC_F32(end - start);
+
+					cache.Reset();
+					clusterStarts.push_back(start);
+					U32 runningMisses = 0;
+					U32 runningTriangles = 0;
+					for (U32 t = start; t < end; t++)
+					{
+						runningMisses += cache.AddTriangle(&indices[t * 3]);
+						runningTriangles++;
+
+						if (t + 1 < end && STATIC_F32(runningMisses) / STATIC_F32(runningTriangles) <= clusterACMR * UMeshOptimizer::OverdrawThreshold)
+						{
+							clusterStarts.push_back(t + 1);
+							cache.Reset();
+							runningMisses = 0;
+							runningTriangles = 0;
+						}
+					}
+				}
+				clusterStarts.push_back(numberOfTriangles);
+			}
+
+			const U64 numberOfClusters = clusterStarts.size() - 1;
+			if (numberOfClusters < 2)
+				return;
+
+			SVector meshCentroid = SVector::Zero;
+			F32 meshArea = 0.0f;
+			std::vector<SVector> clusterCentroids(numberOfClusters, SVector::Zero);
+			std::vector<SVector> clusterNormals(numberOfClusters, SVector::Zero);
+			for (U64 cluster = 0; cluster < numberOfClusters; cluster++)
+			{
+				F32 clusterArea = 0.0f;
+				for (U32 t = clusterStarts[cluster]; t < clusterStarts[cluster + 1]; t++)
+				{
+					const SVector a = GetPosition(vertices[indices[t * 3]]);
+					const SVector b = GetPosition(vertices[indices[t * 3 + 1]]);
+					const SVector c = GetPosition(vertices[indices[t * 3 + 2]]);
+
+					// Area weighted, so slivers don't skew the cluster
+					const SVector normal = (b - a).Cross(c - a);
+					const F32 area = normal.Length();
+					const SVector centroid = (a + b + c) * (1.0f / 3.0f);
+
+					clusterCentroids[cluster] += centroid * area;
+					clusterNormals[cluster] += normal;
+					clusterArea += area;
+				}
+
+				meshCentroid += clusterCentroids[cluster];
+				meshArea += clusterArea;
+				clusterCentroids[cluster] = clusterArea > 0.0f ? clusterCentroids[cluster] * (1.0f / clusterArea) : GetPosition(vertices[indices[clusterStarts[cluster] * 3]]);
+			}
+
+			if (meshArea <= 0.0f)
+				return;
+
+			meshCentroid = meshCentroid * (1.0f / meshArea);
+
+			// Clusters facing away from the center are the outside of the mesh and the likeliest to occlude the rest,
+			// so they go first. Imports are converted to clockwise front faces, for which (b - a) x (c - a) points out.
+			std::vector<F32> sortKeys(numberOfClusters);
+			for (U64 c = 0; c < numberOfClusters; c++)
+			{
+				const F32 normalLength = clusterNormals[c].Length();
+				sortKeys[c] = normalLength > 0.0f ? (clusterCentroids[c] - meshCentroid).Dot(clusterNormals[c] * (1.0f / normalLength)) : 0.0f;
+			}
+
+			std::vector<U32> clusterOrder(numberOfClusters);
+			for (U32 c = 0; c < STATIC_U32(numberOfClusters); c++)
+				clusterOrder[c] = c;
+
+			std::ranges::stable_sort(clusterOrder, [&sortKeys](const U32 a, const U32 b) { return sortKeys[a] > sortKeys[b]; });
+
+			std::vector<U32> output;
+			output.reserve(indices.size());
+			for (const U32 c : clusterOrder)
+				output.insert(output.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+
+			indices.swap(output);
+		}
+
+		template<typename TVertex>
+		void OptimizeVertexFetch(std::vector<TVertex>& vertices, std::vector<U32>& indices)
+		{
+			std::vector<U32> remap(vertices.size(), UINT32_MAX);
+			std::vector<TVertex> output;
+			output.reserve(vertices.size());
+
+			for (U32& index : indices)
+			{
+				if (remap[index] == UINT32_MAX)
+				{
+					remap[index] = STATIC_U32(output.size());
+					output.push_back(vertices[index]);
+				}
+
+				index = remap[index];
+			}
+
+			vertices.swap(output);
+		}
+
+		template<typename TVertex>
+		void OptimizeMesh(std::vector<TVertex>& vertices, std::vector<U32>& indices)
+		{
+			// Everything here assumes a triangle list with valid indices, leave anything else as imported
+			if (indices.size() % 3 != 0 || std::ranges::any_of(indices, [&vertices](const U32 index) { return index >= vertices.size(); }))
+				return;
+
+			OptimizeVertexCache(indices, STATIC_U32(vertices.size()));
+			OptimizeOverdraw(vertices, indices);
+			OptimizeVertexFetch(vertices, indices);
+		}
+
+		template<typename TVertex>
+		SMeshBounds GetMeshBounds(const std::vector<std::span<const TVertex>>& meshVertices)
+		{
+			SMeshBounds bounds;
+			for (const std::span<const TVertex>& vertices : meshVertices)
+			{
+				for (const TVertex& vertex : vertices)
+				{
+					bounds.Min.X = UMath::Min(vertex.x, bounds.Min.X);
+					bounds.Min.Y = UMath::Min(vertex.y, bounds.Min.Y);
+					bounds.Min.Z = UMath::Min(vertex.z, bounds.Min.Z);
+
+					bounds.Max.X = UMath::Max(vertex.x, bounds.Max.X);
+					bounds.Max.Y = UMath::Max(vertex.y, bounds.Max.Y);
+					bounds.Max.Z = UMath::Max(vertex.z, bounds.Max.Z);
+				}
+			}
+
+			if (!bounds.IsValid())
+				return bounds;
+
+			bounds.Center = bounds.Min + (bounds.Max - bounds.Min) * 0.5f;
+
+			F32 radiusSquared = 0.0f;
+			for (const std::span<const TVertex>& vertices : meshVertices)
+			{
+				for (const TVertex& vertex : vertices)
+					radiusSquared = UMath::Max((GetPosition(vertex) - bounds.Center).LengthSquared(), radiusSquared);
+			}
+			bounds.Radius = UMath::Sqrt(radiusSquared);
+
+			return bounds;
+		}
+	}
+
+	void UMeshOptimizer::Optimize(std::vector<SStaticMeshVertex>& vertices, std::vector<U32>& indices)
+	{
+		OptimizeMesh(vertices, indices);
+	}
+
+	void UMeshOptimizer::Optimize(std::vector<SSkeletalMeshVertex>& vertices, std::vector<U32>& indices)
+	{
+		OptimizeMesh(vertices, indices);
+	}
+
+	F32 UMeshOptimizer::GetACMR(std::span<const U32> indices, const U32 numberOfVertices, const U32 cacheSize)
+	{
+		const U32 numberOfTriangles = STATIC_U32(indices.size() / 3);
+		if (numberOfTriangles == 0)
+			return 0.0f;
+
+		SFIFOCache cache(numberOfVertices, cacheSize);
+		U32 misses = 0;
+		for (U32 t = 0; t < numberOfTriangles; t++)
+			misses += cache.AddTriangle(&indices[t * 3]);
+
+		return STATIC_F32(misses) / STATIC_F32(numberOfTriangles);
+	}
+
+	SMeshBounds UMeshOptimizer::GetBounds(const std::vector<std::span<const SStaticMeshVertex>>& meshVertices)
+	{
+		return GetMeshBounds(meshVertices);
+	}
+
+	SMeshBounds UMeshOptimizer::GetBounds(const std::vector<std::span<const SSkeletalMeshVertex>>& meshVertices)
+	{
+		return GetMeshBounds(meshVertices);
+	}
+}
@@ -0,0 +1,35 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#pragma once
+
+#include "Graphics/GraphicsStructs.h"
+
+#include <span>
+
+namespace Havtorn
+{
+	class UMeshOptimizer
+	{
+	public:
+		// LRU cache size the vertex cache order is scored against
+		static constexpr U32 VertexCacheSize = 32;
+		// FIFO cache size GetACMR simulates, close to what current GPUs reuse in practice
+		static constexpr U32 FIFOCacheSize = 16;
+		// How much the overdraw order may raise the ACMR of the vertex cache order
+		static constexpr F32 OverdrawThreshold = 1.05f;
+
+		// Reorders the triangles for the post-transform vertex cache (Forsyth), then sorts clusters of them so outward facing
+		// ones are drawn first to cut overdraw (Sander et al.), then reorders the vertices in the order the indices first use
+		// them so vertex fetch walks the buffer linearly. Vertices no index uses are dropped.
+		static ENGINE_API void Optimize(std::vector<SStaticMeshVertex>& vertices, std::vector<U32>& indices);
+		static ENGINE_API void Optimize(std::vector<SSkeletalMeshVertex>& vertices, std::vector<U32>& indices);
+
+		// Average cache misses, i.e. vertex shader invocations, per triangle with a FIFO cache of cacheSize.
+		// 3 means no reuse at all, around 0.5 is the best a regular grid can do.
+		[[nodiscard]] static ENGINE_API F32 GetACMR(std::span<const U32> indices, const U32 numberOfVertices, const U32 cacheSize = FIFOCacheSize);
+
+		// Box and sphere around every vertex of every mesh
+		[[nodiscard]] static ENGINE_API SMeshBounds GetBounds(const std::vector<std::span<const SStaticMeshVertex>>& meshVertices);
+		[[nodiscard]] static ENGINE_API SMeshBounds GetBounds(const std::vector<std::span<const SSkeletalMeshVertex>>& meshVertices);
+	};
+}
@@ -0,0 +1,403 @@
+// Copyright 2022 Team Havtorn. All Rights Reserved.
+
+#include "MeshSimplifier.h"
+
+#include <queue>
+
+namespace Havtorn
+{
+	namespace
+	{
+		struct SQuadric
+		{
+			F32 A2 = 0.0f, AB = 0.0f, AC = 0.0f, AD = 0.0f;
+			F32 B2 = 0.0f, BC = 0.0f, BD = 0.0f;
+			F32 C2 = 0.0f, CD = 0.0f;
+			F32 D2 = 0.0f;
+
+			static SQuadric FromPlane(const SVector& normal, const F32 distance, const F32 weight)
+			{
+				SQuadric quadric;
+				quadric.A2 = normal.X * normal.X * weight; quadric.AB = normal.X * normal.Y * weight; quadric.AC = normal.X * normal.Z * weight; quadric.AD = normal.X * distance * weight;
+				quadric.B2 = normal.Y * normal.Y * weight; quadric.BC = normal.Y * normal.Z * weight; quadric.BD = normal.Y * distance * weight;
+				quadric.C2 = normal.Z * normal.Z * weight; quadric.CD = normal.Z * distance * weight;
+				quadric.D2 = distance * distance * weight;
+				return quadric;
+			}
+
+			void operator+=(const SQuadric& other)
+			{
+				A2 += other.A2; AB += other.AB; AC += other.AC; AD += other.AD;
+				B2 += other.B2; BC += other.BC; BD += other.BD;
+				C2 += other.C2; CD += other.CD;
+				D2 += other.D2;
+			}
+
+			F32 Evaluate(const SVector& p) const
+			{
+				const F32 error = A2 * p.X * p.X + 2.0f * AB * p.X * p.Y + 2.0f * AC * p.X * p.Z + 2.0f * AD * p.X
+					+ B2 * p.Y * p.Y + 2.0f * BC * p.Y * p.Z + 2.0f * BD * p.Y
+					+ C2 * p.Z * p.Z + 2.0f * CD * p.Z
+					+ D2;
+				return UMath::Max(error, 0.0f);
+			}
+		};
+
+		struct SCollapse
+		{
+			F32 Cost = 0.0f;
+			U32 From = 0;
+			U32 To = 0;
+			U32 FromVersion = 0;
+			U32 ToVersion = 0;
+
+			bool operator>(const SCollapse& other) const { return Cost > other.Cost; }
+		};
+
+		struct SPositionKey
+		{
+			F32 X, Y, Z;
+
+			bool operator==(const SPositionKey& other) const { return X == other.X && Y == other.Y && Z == other.Z; }
+		};
+
+		struct SPositionKeyHasher
+		{
+			U64 operator()(const SPositionKey& key) const
+			{
+				U32 bits[3];
+				memcpy(bits, &key, sizeof(bits));
+				return (STATIC_U64(bits[0]) * 73856093) ^ (STATIC_U64(bits[1]) * 19349663) ^ (STATIC_U64(bits[2]) * 83492791);
+			}
+		};
+
+		F32 GetAttributeDistance(const SStaticMeshVertex& a, const SStaticMeshVertex& b)
+		{
+			const F32 du = a.u - b.u;
+			const F32 dv = a.v - b.v;
+			const F32 normalDot = a.nx * b.nx + a.ny * b.ny + a.nz * b.nz;
+			return du * du + dv * dv + (1.0f - normalDot);
+		}
+	}
+
+	F32 UMeshSimplifier::Simplify(const SStaticMesh& mesh, const F32 targetTriangleRatio, const F32 maxError, SStaticMesh& outMesh)
+	{
+		outMesh.Name = mesh.Name;
+		outMesh.MaterialIndex = mesh.MaterialIndex;
+		outMesh.Vertices.clear();
+		outMesh.Indices.clear();
+
+		const U32 numberOfTriangles = STATIC_U32(mesh.Indices.size() / 3);
+		const U32 targetTriangles = UMath::Max(1u, STATIC_U32(STATIC_F32(numberOfTriangles) * UMath::Clamp(targetTriangleRatio, 0.0f, 1.0f)));
+		if (numberOfTriangles == 0 || mesh.Vertices.empty())
+			return 0.0f;
+
+		// Work in a normalized space so the error is relative to the mesh extent and F32 quadrics stay well conditioned
+		SVector boundsMin = SVector(FLT_MAX);
+		SVector boundsMax = SVector(-FLT_MAX);
+		for (const SStaticMeshVertex& vertex : mesh.Vertices)
+		{
+			boundsMin = { UMath::Min(boundsMin.X, vertex.x), UMath::Min(boundsMin.Y, vertex.y), UMath::Min(boundsMin.Z, vertex.z) };
+			boundsMax = { UMath::Max(boundsMax.X, vertex.x), UMath::Max(boundsMax.Y, vertex.y), UMath::Max(boundsMax.Z, vertex.z) };
+		}
+		const SVector center = (boundsMin + boundsMax) * 0.5f;
+		const SVector extents = boundsMax - boundsMin;
+		const F32 scale = 1.0f / UMath::Max(UMath::Max(extents.X, extents.Y), UMath::Max(extents.Z, FLT_EPSILON));
+
+		// Weld vertices that share a position. Each position holds the list of its vertices (wedges), more than one means a seam.
+		std::vector<U32> vertexToPosition(mesh.Vertices.size());
+		std::vector<SVector> positions;
+		std::vector<std::vector<U32>> positionWedges;
+		{
+			std::unordered_map<SPositionKey, U32, SPositionKeyHasher> positionLookup;
+			positionLookup.reserve(mesh.Vertices.size());
+			for (U32 vertexIndex = 0; vertexIndex < STATIC_U32(mesh.Vertices.size()); ++vertexIndex)
+			{
+				const SStaticMeshVertex& vertex = mesh.Vertices[vertexIndex];
+				const auto [it, wasInserted] = positionLookup.try_emplace({ vertex.x, vertex.y, vertex.z }, STATIC_U32(positions.size()));
+				if (wasInserted)
+				{
+					positions.emplace_back((SVector(vertex.x, vertex.y, vertex.z) - center) * scale);
+					positionWedges.emplace_back();
+				}
+
+				vertexToPosition[vertexIndex] = it->second;
+				positionWedges[it->second].push_back(vertexIndex);
+			}
+		}
+
+		const U32 numberOfPositions = STATIC_U32(positions.size());
+		std::vector<U32> indices = mesh.Indices;
+		std::vector<bool> isTriangleAlive(numberOfTriangles, true);
+		std::vector<std::vector<U32>> positionTriangles(numberOfPositions);
+		std::vector<SQuadric> quadrics(numberOfPositions);
+
+		auto getTrianglePosition = [&](const U32 triangle, const U32 corner) { return vertexToPosition[indices[triangle * 3 + corner]]; };
+
+		for (U32 triangle = 0; triangle < numberOfTriangles; ++triangle)
+		{
+			const SVector& p0 = positions[getTrianglePosition(triangle, 0)];
+			const SVector& p1 = positions[getTrianglePosition(triangle, 1)];
+			const SVector& p2 = positions[getTrianglePosition(triangle, 2)];
+			const SVector cross = (p1 - p0).Cross(p2 - p0);
+			const F32 doubleArea = cross.Length();
+			if (doubleArea > 0.0f)
+			{
+				const SVector normal = cross * (1.0f / doubleArea);
+				const SQuadric quadric = SQuadric::FromPlane(normal, -normal.Dot(p0), doubleArea * 0.5f);
+				for (U32 corner = 0; corner < 3; ++corner)
+					quadrics[getTrianglePosition(triangle, corner)] += quadric;
+			}
+
+			for (U32 corner = 0; corner < 3; ++corner)
+				positionTriangles[getTrianglePosition(triangle, corner)].push_back(triangle);
+		}
+
+		// Lock open borders, edges used by a single triangle
+		std::vector<bool> isLocked(numberOfPositions, false);
+		{
+			std::unordered_map<U64, U32> edgeUseCount;
+			edgeUseCount.reserve(STATIC_U64(numberOfTriangles) * 3);
+			auto makeEdgeKey = [](U32 a, U32 b) { if (a > b) std::swap(a, b); return (STATIC_U64(a) << 32) | b; };
+
+			for (U32 triangle = 0; triangle < numberOfTriangles; ++triangle)
+			{
+				for (U32 corner = 0; corner < 3; ++corner)
+					edgeUseCount[makeEdgeKey(getTrianglePosition(triangle, corner), getTrianglePosition(triangle, (corner + 1) % 3))]++;
+			}
+
+			for (const auto& [edgeKey, count] : edgeUseCount)
+			{
+				if (count != 1)
+					continue;
+
+				isLocked[STATIC_U32(edgeKey >> 32)] = true;
+				isLocked[STATIC_U32(edgeKey & 0xFFFFFFFF)] = true;
+			}
+		}
+
+		// Seam edges are the ones where the triangles on either side use different wedges. Per position, the positions it shares
+		// a seam edge with.
+		std::vector<std::vector<U32>> seamNeighbours(numberOfPositions);
+		{
+			std::unordered_map<U64, U64> edgeWedges;
+			edgeWedges.reserve(STATIC_U64(numberOfTriangles) * 3);
+			for (U32 triangle = 0; triangle < numberOfTriangles; ++triangle)
+			{
+				for (U32 corner = 0; corner < 3; ++corner)
+				{
+					U32 a = indices[triangle * 3 + corner];
+					U32 b = indices[triangle * 3 + (corner + 1) % 3];
+					if (vertexToPosition[a] > vertexToPosition[b])
+						std::swap(a, b);
+
+					const U32 positionA = vertexToPosition[a];
+					const U32 positionB = vertexToPosition[b];
+					const auto [it, wasInserted] = edgeWedges.try_emplace((STATIC_U64(positionA) << 32) | positionB, (STATIC_U64(a) << 32) | b);
+					if (wasInserted || it->second == ((STATIC_U64(a) << 32) | b) || positionA == positionB)
+						continue;
+
+					if (std::ranges::find(seamNeighbours[positionA], positionB) == seamNeighbours[positionA].end())
+					{
+						seamNeighbours[positionA].push_back(positionB);
+						seamNeighbours[positionB].push_back(positionA);
+					}
+				}
+			}
+		}
+
+		auto isSeam = [&](const U32 position) { return positionWedges[position].size() > 1; };
+
+		std::vector<U32> versions(numberOfPositions, 0);
+		std::vector<bool> isRemoved(numberOfPositions, false);
+		std::priority_queue<SCollapse, std::vector<SCollapse>, std::greater<SCollapse>> collapses;
+
+		auto pushCollapse = [&](const U32 from, const U32 to)
+		{
+			if (from == to || isLocked[from])
+				return;
+
+			// Seam vertices may only slide along their seam, otherwise UVs get dragged across it. Where seams meet or end, there is
+			// no single seam to slide along.
+			if (isSeam(from) && (seamNeighbours[from].size() != 2 || std::ranges::find(seamNeighbours[from], to) == seamNeighbours[from].end()))
+				return;
+
+			SQuadric combined = quadrics[from];
+			combined += quadrics[to];
+			collapses.push({ combined.Evaluate(positions[to]), from, to, versions[from], versions[to] });
+		};
+
+		auto pushCollapsesAround = [&](const U32 position)
+		{
+			for (const U32 triangle : positionTriangles[position])
+			{
+				if (!isTriangleAlive[triangle])
+					continue;
+
+				for (U32 corner = 0; corner < 3; ++corner)
+				{
+					const U32 a = getTrianglePosition(triangle, corner);
+					const U32 b = getTrianglePosition(triangle, (corner + 1) % 3);
+					pushCollapse(a, b);
+					pushCollapse(b, a);
+				}
+			}
+		};
+
+		for (U32 triangle = 0; triangle < numberOfTriangles; ++triangle)
+		{
+			for (U32 corner = 0; corner < 3; ++corner)
+			{
+				const U32 a = getTrianglePosition(triangle, corner);
+				const U32 b = getTrianglePosition(triangle, (corner + 1) % 3);
+				pushCollapse(a, b);
+				pushCollapse(b, a);
+			}
+		}
+
+		const F32 maxCost = maxError * maxError;
+		F32 resultError = 0.0f;
+		U32 aliveTriangles = numberOfTriangles;
+		std::vector<U32> wedgeRemap;
+
+		while (aliveTriangles > targetTriangles && !collapses.empty())
+		{
+			const SCollapse collapse = collapses.top();
+			collapses.pop();
+
+			if (collapse.Cost > maxCost)
+				break;
+
+			if (isRemoved[collapse.From] || isRemoved[collapse.To] || collapse.FromVersion != versions[collapse.From] || collapse.ToVersion != versions[collapse.To])
+				continue;
+
+			// Reject collapses that flip or degenerate the triangles that remain around the removed position
+			bool isValid = true;
+			for (const U32 triangle : positionTriangles[collapse.From])
+			{
+				if (!isTriangleAlive[triangle])
+					continue;
+
+				SVector oldCorners[3];
+				SVector newCorners[3];
+				bool containsTo = false;
+				for (U32 corner = 0; corner < 3; ++corner)
+				{
+					const U32 position = getTrianglePosition(triangle, corner);
+					containsTo |= position == collapse.To;
+					oldCorners[corner] = positions[position];
+					newCorners[corner] = position == collapse.From ? positions[collapse.To] : positions[position];
+				}
+
+				if (containsTo)
+					continue;
+
+				const SVector oldNormal = (oldCorners[1] - oldCorners[0]).Cross(oldCorners[2] - oldCorners[0]);
+				const SVector newNormal = (newCorners[1] - newCorners[0]).Cross(newCorners[2] - newCorners[0]);
+				if (oldNormal.Dot(newNormal) <= 0.25f * oldNormal.Length() * newNormal.Length())
+				{
+					isValid = false;
+					break;
+				}
+			}
+
+			if (!isValid)
+				continue;
+
+			// Map every wedge of the removed position to the wedge at the kept position with the closest attributes
+			const std::vector<U32>& fromWedges = positionWedges[collapse.From];
+			const std::vector<U32>& toWedges = positionWedges[collapse.To];
+			wedgeRemap.resize(fromWedges.size());
+			for (U64 wedgeIndex = 0; wedgeIndex < fromWedges.size(); ++wedgeIndex)
+			{
+				F32 bestDistance = FLT_MAX;
+				for (const U32 toWedge : toWedges)
+				{
+					const F32 distance = GetAttributeDistance(mesh.Vertices[fromWedges[wedgeIndex]], mesh.Vertices[toWedge]);
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						wedgeRemap[wedgeIndex] = toWedge;
+					}
+				}
+			}
+
+			for (const U32 triangle : positionTriangles[collapse.From])
+			{
+				if (!isTriangleAlive[triangle])
+					continue;
+
+				bool containsTo = false;
+				for (U32 corner = 0; corner < 3; ++corner)
+				{
+					U32& index = indices[triangle * 3 + corner];
+					containsTo |= vertexToPosition[index] == collapse.To;
+					if (vertexToPosition[index] != collapse.From)
+						continue;
+
+					const auto it = std::ranges::find(fromWedges, index);
+					index = wedgeRemap[std::distance(fromWedges.begin(), it)];
+				}
+
+				if (containsTo)
+				{
+					isTriangleAlive[triangle] = false;
+					aliveTriangles--;
+				}
+				else
+				{
+					positionTriangles[collapse.To].push_back(triangle);
+				}
+			}
+
+			// The seam edges of the removed position now end at the kept one
+			std::erase(seamNeighbours[collapse.To], collapse.From);
+			for (const U32 neighbour : seamNeighbours[collapse.From])
+			{
+				if (neighbour == collapse.To)
+					continue;
+
+				std::vector<U32>& neighbourSeams = seamNeighbours[neighbour];
+				std::erase(neighbourSeams, collapse.From);
+				if (std::ranges::find(neighbourSeams, collapse.To) == neighbourSeams.end())
+				{
+					neighbourSeams.push_back(collapse.To);
+					seamNeighbours[collapse.To].push_back(neighbour);
+				}
+			}
+			seamNeighbours[collapse.From].clear();
+
+			quadrics[collapse.To] += quadrics[collapse.From];
+			isRemoved[collapse.From] = true;
+			positionTriangles[collapse.From].clear();
+			versions[collapse.To]++;
+			resultError = UMath::Max(resultError, collapse.Cost);
+
+			std::erase_if(positionTriangles[collapse.To], [&](const U32 triangle) { return !isTriangleAlive[triangle]; });
+			pushCollapsesAround(collapse.To);
+		}
+
+		// Compact to the vertices still referenced by living triangles
+		std::vector<U32> vertexRemap(mesh.Vertices.size(), UINT32_MAX);
+		outMesh.Indices.reserve(STATIC_U64(aliveTriangles) * 3);
+		for (U32 triangle = 0; triangle < numberOfTriangles; ++triangle)
+		{
+			if (!isTriangleAlive[triangle])
+				continue;
+
+			for (U32 corner = 0; corner < 3; ++corner)
+			{
+				const U32 index = indices[triangle * 3 + corner];
+				if (vertexRemap[index] == UINT32_MAX)
+				{
+					vertexRemap[index] = STATIC_U32(outMesh.Vertices.size());
+					outMesh.Vertices.push_back(mesh.Vertices[index]);
+				}
+
+				outMesh.Indices.push_back(vertexRemap[index]);
+			}
+		}
+
+		return UMath::Sqrt(resultError);
+	}
+}
@@ -0,0 +1,18 @@
+// Copyright 2022 Team Havtorn. All Rights Reserved.
+
+#pragma once
+
+#include "Graphics/GraphicsStructs.h"
+
+namespace Havtorn
+{
+	class UMeshSimplifier
+	{
+	public:
+		// Quadric error edge collapse (Garland & Heckbert). Collapses vertices into existing neighbours, so the output only
+		// contains vertices from the input mesh. Open borders are locked and UV/normal seams only collapse along the seam.
+		// targetTriangleRatio is relative to the input triangle count, maxError is relative to the mesh bounds extent.
+		// Returns the relative error of the most expensive collapse that was performed.
+		static ENGINE_API F32 Simplify(const SStaticMesh& mesh, const F32 targetTriangleRatio, const F32 maxError, SStaticMesh& outMesh);
+	};
+}
@@ -9,6 +9,8 @@
 
 #include "Engine.h"
 #include "Assets/FileHeaderDeclarations.h"
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
 
 #include <FileSystem.h>
 
@@ -136,7 +138,7 @@ namespace Havtorn
 		return havtornKey;
 	}
 
-	SAssetFileHeader UModelImporter::ImportFBX(const std::string& filePath, const SSourceAssetData& sourceData)
+	SAssetFileHeader UModelImporter::ImportFBX(const std::string& filePath, const SSourceAssetData& sourceData, const SStaticMeshLODImportSettings& lodSettings)
 	{
 		if (!UFileSystem::Exists(filePath))
 		{
@@ -199,10 +201,10 @@ namespace Havtorn
 		if (hasBones)
 			HV_LOG_WARN("ModelImporter expected %s to be a static mesh file, but it contains bone information!", filePath.c_str());
 
-		return ImportStaticMesh(assimpScene, sourceData);
+		return ImportStaticMesh(assimpScene, sourceData, lodSettings);
 	}
 
-	SStaticModelFileHeader UModelImporter::ImportStaticMesh(const aiScene* assimpScene, const SSourceAssetData& sourceData)
+	SStaticModelFileHeader UModelImporter::ImportStaticMesh(const aiScene* assimpScene, const SSourceAssetData& sourceData, const SStaticMeshLODImportSettings& lodSettings)
 	{
 		SStaticModelFileHeader fileHeader;
 		fileHeader.AssetType = EAssetType::StaticMesh;
@@ -271,9 +273,66 @@ namespace Havtorn
 		// Material Count
 		fileHeader.NumberOfMaterials = STATIC_U8(assimpScene->mNumMaterials);
 
+		std::vector<std::span<const SStaticMeshVertex>> meshVertices;
+		for (SStaticMesh& mesh : fileHeader.Meshes)
+		{
+			UMeshOptimizer::Optimize(mesh.Vertices, mesh.Indices);
+			meshVertices.emplace_back(mesh.Vertices);
+		}
+		fileHeader.Bounds = UMeshOptimizer::GetBounds(meshVertices);
+
+		GenerateStaticMeshLODs(fileHeader, lodSettings);
+
 		return fileHeader;
 	}
 
+	void UModelImporter::GenerateStaticMeshLODs(SStaticModelFileHeader& fileHeader, const SStaticMeshLODImportSettings& lodSettings)
+	{
+		fileHeader.LODImportSettings = lodSettings;
+		fileHeader.LODs.reserve(lodSettings.NumberOfLODs);
+
+		U64 previousTriangles = 0;
+		for (const SStaticMesh& mesh : fileHeader.Meshes)
+			previousTriangles += mesh.Indices.size() / 3;
+
+		F32 triangleRatio = 1.0f;
+		F32 screenSize = lodSettings.FirstScreenSize;
+
+		// A LOD has to remove at least a fifth of the triangles it was asked to remove, relative to the previous LOD.
+		// Derived from the ratio, since a fixed threshold would reject every LOD of ratios close to 1.
+		const F32 maxTrianglesKept = 1.0f - (1.0f - lodSettings.TriangleRatio) * 0.2f;
+		for (U8 lodIndex = 0; lodIndex < lodSettings.NumberOfLODs; lodIndex++)
+		{
+			// Always simplify from LOD0 rather than from the previous LOD, so errors don't accumulate
+			triangleRatio *= lodSettings.TriangleRatio;
+
+			SStaticMeshLOD lod;
+			lod.ScreenSize = screenSize;
+			lod.Meshes.resize(fileHeader.NumberOfMeshes);
+
+			U64 lodTriangles = 0;
+			for (U32 n = 0; n < fileHeader.NumberOfMeshes; n++)
+			{
+				UMeshSimplifier::Simplify(fileHeader.Meshes[n], triangleRatio, lodSettings.MaxError, lod.Meshes[n]);
+				UMeshOptimizer::Optimize(lod.Meshes[n].Vertices, lod.Meshes[n].Indices);
+				lodTriangles += lod.Meshes[n].Indices.size() / 3;
+			}
+
+			// Stop once the error bound keeps the simplifier from making meaningful progress
+			if (lodTriangles == 0 || STATIC_F32(lodTriangles) > STATIC_F32(previousTriangles) * maxTrianglesKept)
+			{
+				HV_LOG_INFO("ModelImporter stopped generating LODs for %s at LOD%i, could not reduce %i triangles further.", fileHeader.Name.c_str(), lodIndex + 1, STATIC_I32(previousTriangles));
+				break;
+			}
+
+			previousTriangles = lodTriangles;
+			fileHeader.LODs.emplace_back(std::move(lod));
+			screenSize *= 0.5f;
+		}
+
+		fileHeader.NumberOfLODs = STATIC_U8(fileHeader.LODs.size());
+	}
+
 	void ExtractNodes(const aiScene* scene, const SSourceAssetData& sourceData, aiNode* node, const std::vector<SSkeletalMeshBone>& bindPose, std::vector<SSkeletalMeshNode>& nodesToPopulate)
 	{
 		if (nodesToPopulate.size() > 0)
@@ -417,6 +476,14 @@ namespace Havtorn
 		fileHeader.NumberOfMaterials = STATIC_U8(assimpScene->mNumMaterials);
 		fileHeader.NumberOfNodes = STATIC_U32(fileHeader.Nodes.size());
 
+		std::vector<std::span<const SSkeletalMeshVertex>> meshVertices;
+		for (SSkeletalMesh& mesh : fileHeader.Meshes)
+		{
+			UMeshOptimizer::Optimize(mesh.Vertices, mesh.Indices);
+			meshVertices.emplace_back(mesh.Vertices);
+		}
+		fileHeader.Bounds = UMeshOptimizer::GetBounds(meshVertices);
+
 		return fileHeader;
 	}
 
@@ -436,18 +503,16 @@ namespace Havtorn
 			
 		std::vector<SSkeletalMeshBone> bones;
 		{
+			// Only the bones are needed, so the rig's vertices are viewed in the mapped file rather than copied
 			std::string rigFilePath = fileHeader.SourceData.AssetDependencyPath.AsString();
-			const U64 fileSize = UFileSystem::GetFileSize(rigFilePath);
-			char* data = new char[fileSize];
-
-			UFileSystem::Deserialize(rigFilePath, data, STATIC_U32(fileSize));
-
-			SSkeletalModelFileHeader rigHeader;
-			rigHeader.Deserialize(data);
-
-			bones = rigHeader.BindPoseBones;
+			CMappedFile rigFile;
+			if (rigFile.Open(rigFilePath))
+			{
+				SSkeletalModelFileHeader rigHeader;
+				rigHeader.Deserialize(rigFile.GetData(), rigFile.GetSize(), true);
 
-			delete[] data;
+				bones = rigHeader.BindPoseBones;
+			}
 		}
 
 		fileHeader.NumberOfBones = STATIC_U32(animation->mNumChannels);
@@ -20,10 +20,14 @@ namespace Havtorn
 	class UModelImporter
 	{
 	public:
-		static ENGINE_API SAssetFileHeader ImportFBX(const std::string& filePath, const SSourceAssetData& sourceAssetData);
+		// Part of the derived data cache key, bump it whenever the imported file headers change so older imports are redone
+		static constexpr U32 Version = 2;
+
+		static ENGINE_API SAssetFileHeader ImportFBX(const std::string& filePath, const SSourceAssetData& sourceAssetData, const SStaticMeshLODImportSettings& lodSettings = {});
 
 	private:
-		static SStaticModelFileHeader ImportStaticMesh(const aiScene* assimpScene, const SSourceAssetData& sourceAssetData);
+		static SStaticModelFileHeader ImportStaticMesh(const aiScene* assimpScene, const SSourceAssetData& sourceAssetData, const SStaticMeshLODImportSettings& lodSettings);
+		static void GenerateStaticMeshLODs(SStaticModelFileHeader& fileHeader, const SStaticMeshLODImportSettings& lodSettings);
 		static SSkeletalModelFileHeader ImportSkeletalMesh(const aiScene* assimpScene, const SSourceAssetData& sourceAssetData);
 		static SSkeletalAnimationFileHeader ImportAnimation(const aiScene* assimpScene, const SSourceAssetData& sourceAssetData);
 	};
@@ -3,6 +3,8 @@
 #include "ThreadManager.h"
 #include "Graphics/RenderManager.h"
 
+#include <atomic>
+
 namespace Havtorn
 {
 	std::mutex CThreadManager::RenderMutex;
@@ -25,7 +27,8 @@ namespace Havtorn
 
 	bool CThreadManager::Init(CRenderManager* renderManager)
 	{
-		RenderThread = std::thread(&CRenderManager::Render, renderManager);
+		if (renderManager != nullptr)
+			RenderThread = std::thread(&CRenderManager::Render, renderManager);
 
 		for (U8 i = 0; i < NumberOfThreads; ++i)
 		{
@@ -36,8 +39,10 @@ namespace Havtorn
 
 	void CThreadManager::WaitAndPerformJobs()
 	{
-		while (!Terminate)
+		while (true)
 		{
+			JobSignature job;
+
 			// Code blocks used to unlock mutex when lock variables go out of scope - RAII
 			{
 				std::unique_lock<std::mutex> lock(QueueMutex);
@@ -47,14 +52,15 @@ namespace Havtorn
 					return !JobQueue.empty() || Terminate;
 				});
 
-				if (!JobQueue.empty())
-				{
-					Job = JobQueue.front();
-					JobQueue.pop();
-					Job();
-				}
+				if (Terminate)
+					return;
+
+				job = std::move(JobQueue.front());
+				JobQueue.pop();
 			}
 
+			// Run outside the lock, otherwise long running jobs (like the file watcher) block all other job threads
+			job();
 		}
 	}
 
@@ -68,10 +74,48 @@ namespace Havtorn
 		Condition.notify_one();
 	}
 
+	void CThreadManager::ParallelFor(const U32 numberOfJobs, const std::function<void(const U32 jobIndex)>& job)
+	{
+		if (numberOfJobs == 0)
+			return;
+
+		// Shared so that job threads picking this up after everything is done don't touch a dead stack frame
+		struct SParallelForState
+		{
+			std::atomic<U32> NextJobIndex = 0;
+			std::atomic<U32> NumberOfFinishedJobs = 0;
+			const std::function<void(const U32)>* Job = nullptr;
+			U32 NumberOfJobs = 0;
+		};
+
+		auto state = std::make_shared<SParallelForState>();
+		state->Job = &job;
+		state->NumberOfJobs = numberOfJobs;
+
+		auto performJobs = [state]()
+		{
+			for (U32 jobIndex = state->NextJobIndex++; jobIndex < state->NumberOfJobs; jobIndex = state->NextJobIndex++)
+			{
+				(*state->Job)(jobIndex);
+				state->NumberOfFinishedJobs++;
+				state->NumberOfFinishedJobs.notify_one();
+			}
+		};
+
+		const U32 numberOfHelpers = UMath::Min(numberOfJobs - 1, STATIC_U32(NumberOfThreads));
+		for (U32 i = 0; i < numberOfHelpers; i++)
+			PushJob(performJobs);
+
+		performJobs();
+
+		for (U32 finished = state->NumberOfFinishedJobs; finished < numberOfJobs; finished = state->NumberOfFinishedJobs)
+			state->NumberOfFinishedJobs.wait(finished);
+	}
+
 	void CThreadManager::Shutdown()
 	{
 		{
-			std::unique_lock<std::mutex> lock(ThreadPoolMutex);
+			std::unique_lock<std::mutex> lock(QueueMutex);
 			Terminate = true; // use this flag in condition.wait
 		}
 
@@ -85,9 +129,12 @@ namespace Havtorn
 
 		JobThreads.clear();
 		
-		RunRenderThread = false;
-		RenderCondition.notify_one();
-		RenderThread.join();
+		if (RenderThread.joinable())
+		{
+			RunRenderThread = false;
+			RenderCondition.notify_one();
+			RenderThread.join();
+		}
 
 		IsTerminated = true; // use this flag in destructor, if not set, call shutdown() 
 	}
@@ -18,7 +18,7 @@ namespace Havtorn
 
 	typedef std::function<void()> JobSignature;
 
-	class CThreadManager
+	class ENGINE_API CThreadManager
 	{
 	public:
 		CThreadManager();
@@ -28,11 +28,17 @@ namespace Havtorn
 		CThreadManager operator=(const CThreadManager&) = delete;
 		CThreadManager operator=(const CThreadManager&&) = delete;
 
+		// Without a render manager only the job threads are started, e.g. in the tests
 		bool Init(CRenderManager* renderManager);
-		[[noreturn]] void WaitAndPerformJobs();
+		void WaitAndPerformJobs();
 		void PushJob(JobSignature job);
 		void Shutdown();
 
+		// Runs job(0) to job(numberOfJobs - 1) on the job threads and the calling thread, returns when all are done.
+		// The calling thread keeps taking jobs itself, so this finishes even if every job thread is busy.
+		void ParallelFor(const U32 numberOfJobs, const std::function<void(const U32 jobIndex)>& job);
+		U8 GetNumberOfThreads() const { return NumberOfThreads; }
+
 		static std::mutex RenderMutex;
 		static std::condition_variable RenderCondition;
 		static ERenderThreadStatus RenderThreadStatus;
@@ -44,10 +50,9 @@ namespace Havtorn
 		std::vector<std::thread> JobThreads;
 		std::queue<JobSignature> JobQueue;
 		std::thread RenderThread;
+		// Also guards Terminate, so a job thread can't miss the wake up between checking it and waiting
 		std::mutex QueueMutex;
-		std::mutex ThreadPoolMutex;
 		std::condition_variable Condition;
-		JobSignature Job;
 
 		U8 NumberOfThreads;
 		bool Terminate;
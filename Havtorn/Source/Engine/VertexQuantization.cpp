@@ -0,0 +1,295 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "VertexQuantization.h"
+
+namespace Havtorn
+{
+	namespace
+	{
+		constexpr F32 UnormMax = 65535.0f;
+		constexpr F32 SnormMax = 32767.0f;
+
+		U16 EncodeUnorm(const F32 value, const F32 min, const F32 extent)
+		{
+			if (extent <= 0.0f)
+				return 0;
+
+			return STATIC_U16(UMath::Clamp((value - min) / extent, 0.0f, 1.0f) * UnormMax + 0.5f);
+		}
+
+		F32 DecodeUnorm(const U16 value, const F32 min, const F32 extent)
+		{
+			return min + STATIC_F32(value) * (extent / UnormMax);
+		}
+
+		SVector DecodeOctahedral(const I16 x, const I16 y)
+		{
+			const F32 u = UMath::Max(STATIC_F32(x) / SnormMax, -1.0f);
+			const F32 v = UMath::Max(STATIC_F32(y) / SnormMax, -1.0f);
+
+			SVector direction(u, v, 1.0f - UMath::Abs(u) - UMath::Abs(v));
+			const F32 fold = UMath::Max(-direction.Z, 0.0f);
+			direction.X += direction.X >= 0.0f ? -fold : fold;
+			direction.Y += direction.Y >= 0.0f ? -fold : fold;
+			return direction.GetNormalized();
+		}
+
+		// Only the direction is kept, zero vectors come back as +Z
+		void EncodeOctahedral(const F32 x, const F32 y, const F32 z, I16& outX, I16& outY)
+		{
+			outX = 0;
+			outY = 0;
+
+			const F32 manhattanLength = UMath::Abs(x) + UMath::Abs(y) + UMath::Abs(z);
+			if (manhattanLength <= 0.0f)
+				return;
+
+			F32 u = x / manhattanLength;
+			F32 v = y / manhattanLength;
+			if (z < 0.0f)
+			{
+				const F32 foldedU = (1.0f - UMath::Abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+				const F32 foldedV = (1.0f - UMath::Abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+				u = foldedU;
+				v = foldedV;
+			}
+
+			// Rounding each to nearest doesn't always give the closest direction, so all four neighbours are tried
+			const SVector direction = SVector(x, y, z).GetNormalized();
+			const F32 floorU = UMath::Floor(u * SnormMax);
+			const F32 floorV = UMath::Floor(v * SnormMax);
+			F32 bestDot = -2.0f;
+			for (U8 i = 0; i < 4; i++)
+			{
+				const I16 candidateX = STATIC_I16(UMath::Clamp(floorU + STATIC_F32(i & 1), -SnormMax, SnormMax));
+				const I16 candidateY = STATIC_I16(UMath::Clamp(floorV + STATIC_F32(i >> 1), -SnormMax, SnormMax));
+				const F32 dot = DecodeOctahedral(candidateX, candidateY).Dot(direction);
+				if (dot > bestDot)
+				{
+					bestDot = dot;
+					outX = candidateX;
+					outY = candidateY;
+				}
+			}
+		}
+
+		F32 GetAngle(const F32 x, const F32 y, const F32 z, const SVector& decoded)
+		{
+			const SVector original(x, y, z);
+			if (original.LengthSquared() <= 1e-12f)
+				return 0.0f;
+
+			return UMath::ACos(UMath::Clamp(original.GetNormalized().Dot(decoded), -1.0f, 1.0f));
+		}
+
+		template<typename TVertex>
+		SVertexQuantization GetVertexQuantization(const std::vector<std::span<const TVertex>>& meshVertices)
+		{
+			SVector positionMin = SVector(FLT_MAX);
+			SVector positionMax = SVector(-FLT_MAX);
+			SVector2<F32> uvMin = SVector2<F32>(FLT_MAX, FLT_MAX);
+			SVector2<F32> uvMax = SVector2<F32>(-FLT_MAX, -FLT_MAX);
+			for (const std::span<const TVertex>& vertices : meshVertices)
+			{
+				for (const TVertex& vertex : vertices)
+				{
+					positionMin = SVector(UMath::Min(vertex.x, positionMin.X), UMath::Min(vertex.y, positionMin.Y), UMath::Min(vertex.z, positionMin.Z));
+					positionMax = SVector(UMath::Max(vertex.x, positionMax.X), UMath::Max(vertex.y, positionMax.Y), UMath::Max(vertex.z, positionMax.Z));
+					uvMin = SVector2<F32>(UMath::Min(vertex.u, uvMin.X), UMath::Min(vertex.v, uvMin.Y));
+					uvMax = SVector2<F32>(UMath::Max(vertex.u, uvMax.X), UMath::Max(vertex.v, uvMax.Y));
+				}
+			}
+
+			SVertexQuantization quantization;
+			if (positionMin.X > positionMax.X)
+				return quantization;
+
+			quantization.PositionMin = positionMin;
+			quantization.PositionExtent = positionMax - positionMin;
+			quantization.UVMin = uvMin;
+			quantization.UVExtent = SVector2<F32>(uvMax.X - uvMin.X, uvMax.Y - uvMin.Y);
+			return quantization;
+		}
+
+		// Shared by both vertex types, everything but the bone data
+		template<typename TVertex, typename TCompactVertex>
+		void EncodeCommon(const TVertex& vertex, const SVertexQuantization& quantization, TCompactVertex& outVertex)
+		{
+			outVertex.x = EncodeUnorm(vertex.x, quantization.PositionMin.X, quantization.PositionExtent.X);
+			outVertex.y = EncodeUnorm(vertex.y, quantization.PositionMin.Y, quantization.PositionExtent.Y);
+			outVertex.z = EncodeUnorm(vertex.z, quantization.PositionMin.Z, quantization.PositionExtent.Z);
+			EncodeOctahedral(vertex.nx, vertex.ny, vertex.nz, outVertex.nx, outVertex.ny);
+			EncodeOctahedral(vertex.tx, vertex.ty, vertex.tz, outVertex.tx, outVertex.ty);
+			EncodeOctahedral(vertex.bx, vertex.by, vertex.bz, outVertex.bx, outVertex.by);
+			outVertex.u = EncodeUnorm(vertex.u, quantization.UVMin.X, quantization.UVExtent.X);
+			outVertex.v = EncodeUnorm(vertex.v, quantization.UVMin.Y, quantization.UVExtent.Y);
+		}
+
+		template<typename TCompactVertex, typename TVertex>
+		void DecodeCommon(const TCompactVertex& vertex, const SVertexQuantization& quantization, TVertex& outVertex)
+		{
+			outVertex.x = DecodeUnorm(vertex.x, quantization.PositionMin.X, quantization.PositionExtent.X);
+			outVertex.y = DecodeUnorm(vertex.y, quantization.PositionMin.Y, quantization.PositionExtent.Y);
+			outVertex.z = DecodeUnorm(vertex.z, quantization.PositionMin.Z, quantization.PositionExtent.Z);
+
+			const SVector normal = DecodeOctahedral(vertex.nx, vertex.ny);
+			outVertex.nx = normal.X; outVertex.ny = normal.Y; outVertex.nz = normal.Z;
+			const SVector tangent = DecodeOctahedral(vertex.tx, vertex.ty);
+			outVertex.tx = tangent.X; outVertex.ty = tangent.Y; outVertex.tz = tangent.Z;
+			const SVector bitangent = DecodeOctahedral(vertex.bx, vertex.by);
+			outVertex.bx = bitangent.X; outVertex.by = bitangent.Y; outVertex.bz = bitangent.Z;
+
+			outVertex.u = DecodeUnorm(vertex.u, quantization.UVMin.X, quantization.UVExtent.X);
+			outVertex.v = DecodeUnorm(vertex.v, quantization.UVMin.Y, quantization.UVExtent.Y);
+		}
+
+		template<typename TVertex>
+		SVertexQuantizationError MeasureCommon(const TVertex& original, const TVertex& decoded)
+		{
+			SVertexQuantizationError error;
+			error.Position = (SVector(original.x, original.y, original.z) - SVector(decoded.x, decoded.y, decoded.z)).Length();
+			error.Direction = UMath::Max(GetAngle(original.nx, original.ny, original.nz, SVector(decoded.nx, decoded.ny, decoded.nz)),
+				UMath::Max(GetAngle(original.tx, original.ty, original.tz, SVector(decoded.tx, decoded.ty, decoded.tz)),
+					GetAngle(original.bx, original.by, original.bz, SVector(decoded.bx, decoded.by, decoded.bz))));
+			error.UV = UMath::Max(UMath::Abs(original.u - decoded.u), UMath::Abs(original.v - decoded.v));
+			return error;
+		}
+
+		// Rounds every weight down and hands the units that are left to the largest remainders, so the sum is kept as
+		// well as 8 bits allow instead of drifting by up to two units
+		void EncodeBoneWeights(const F32 (&weights)[4], U8 (&outWeights)[4])
+		{
+			F32 sum = 0.0f;
+			for (const F32 weight : weights)
+				sum += UMath::Max(weight, 0.0f);
+
+			const I32 targetSum = STATIC_I32(UMath::Min(sum, 1.0f) * 255.0f + 0.5f);
+
+			F32 remainders[4] = {};
+			I32 quantizedSum = 0;
+			for (U8 i = 0; i < 4; i++)
+			{
+				const F32 scaled = UMath::Clamp(weights[i], 0.0f, 1.0f) * 255.0f;
+				outWeights[i] = STATIC_U8(UMath::Floor(scaled));
+				remainders[i] = scaled - STATIC_F32(outWeights[i]);
+				quantizedSum += outWeights[i];
+			}
+
+			for (; quantizedSum < targetSum; quantizedSum++)
+			{
+				U8 largest = 0;
+				for (U8 i = 1; i < 4; i++)
+				{
+					if (remainders[i] > remainders[largest])
+						largest = i;
+				}
+
+				if (outWeights[largest] == 255)
+					break;
+
+				outWeights[largest]++;
+				remainders[largest] = -1.0f;
+			}
+		}
+	}
+
+	SVertexQuantization UVertexQuantization::GetQuantization(const std::vector<std::span<const SStaticMeshVertex>>& meshVertices)
+	{
+		return GetVertexQuantization(meshVertices);
+	}
+
+	SVertexQuantization UVertexQuantization::GetQuantization(const std::vector<std::span<const SSkeletalMeshVertex>>& meshVertices)
+	{
+		return GetVertexQuantization(meshVertices);
+	}
+
+	SVertexQuantizationError UVertexQuantization::Encode(std::span<const SStaticMeshVertex> vertices, const SVertexQuantization& quantization, std::vector<SCompactStaticMeshVertex>& outVertices)
+	{
+		SVertexQuantizationError error;
+		outVertices.resize(vertices.size());
+		for (U64 i = 0; i < vertices.size(); i++)
+		{
+			EncodeCommon(vertices[i], quantization, outVertices[i]);
+
+			SStaticMeshVertex decoded = {};
+			DecodeCommon(outVertices[i], quantization, decoded);
+			error.Add(MeasureCommon(vertices[i], decoded));
+		}
+		return error;
+	}
+
+	SVertexQuantizationError UVertexQuantization::Encode(std::span<const SSkeletalMeshVertex> vertices, const SVertexQuantization& quantization, std::vector<SCompactSkeletalMeshVertex>& outVertices)
+	{
+		SVertexQuantizationError error;
+		outVertices.resize(vertices.size());
+		for (U64 i = 0; i < vertices.size(); i++)
+		{
+			const SSkeletalMeshVertex& vertex = vertices[i];
+			SCompactSkeletalMeshVertex& compactVertex = outVertices[i];
+			EncodeCommon(vertex, quantization, compactVertex);
+
+			const F32 boneIndices[4] = { vertex.bix, vertex.biy, vertex.biz, vertex.biw };
+			for (U8 j = 0; j < 4; j++)
+			{
+				if (boneIndices[j] < 0.0f || boneIndices[j] > 255.0f || boneIndices[j] != UMath::Floor(boneIndices[j]))
+					error.HasUnsupportedBoneIndices = true;
+
+				compactVertex.BoneIndices[j] = STATIC_U8(UMath::Clamp(boneIndices[j], 0.0f, 255.0f));
+			}
+
+			const F32 boneWeights[4] = { vertex.bwx, vertex.bwy, vertex.bwz, vertex.bww };
+			EncodeBoneWeights(boneWeights, compactVertex.BoneWeights);
+
+			SSkeletalMeshVertex decoded = {};
+			DecodeCommon(compactVertex, quantization, decoded);
+			error.Add(MeasureCommon(vertex, decoded));
+			for (U8 j = 0; j < 4; j++)
+				error.BoneWeight = UMath::Max(error.BoneWeight, UMath::Abs(boneWeights[j] - STATIC_F32(compactVertex.BoneWeights[j]) / 255.0f));
+		}
+		return error;
+	}
+
+	void UVertexQuantization::Decode(std::span<const SCompactStaticMeshVertex> vertices, const SVertexQuantization& quantization, std::vector<SStaticMeshVertex>& outVertices)
+	{
+		outVertices.resize(vertices.size());
+		for (U64 i = 0; i < vertices.size(); i++)
+			DecodeCommon(vertices[i], quantization, outVertices[i]);
+	}
+
+	void UVertexQuantization::Decode(std::span<const SCompactSkeletalMeshVertex> vertices, const SVertexQuantization& quantization, std::vector<SSkeletalMeshVertex>& outVertices)
+	{
+		outVertices.resize(vertices.size());
+		for (U64 i = 0; i < vertices.size(); i++)
+		{
+			const SCompactSkeletalMeshVertex& vertex = vertices[i];
+			SSkeletalMeshVertex& outVertex = outVertices[i];
+			DecodeCommon(vertex, quantization, outVertex);
+
+			outVertex.bix = STATIC_F32(vertex.BoneIndices[0]);
+			outVertex.biy = STATIC_F32(vertex.BoneIndices[1]);
+			outVertex.biz = STATIC_F32(vertex.BoneIndices[2]);
+			outVertex.biw = STATIC_F32(vertex.BoneIndices[3]);
+
+			outVertex.bwx = STATIC_F32(vertex.BoneWeights[0]) / 255.0f;
+			outVertex.bwy = STATIC_F32(vertex.BoneWeights[1]) / 255.0f;
+			outVertex.bwz = STATIC_F32(vertex.BoneWeights[2]) / 255.0f;
+			outVertex.bww = STATIC_F32(vertex.BoneWeights[3]) / 255.0f;
+		}
+	}
+
+	bool UVertexQuantization::IsWithinErrorBounds(const SVertexQuantizationError& error, const SVertexQuantization& quantization)
+	{
+		// Half a step on every axis, plus what F32 loses on the decode itself
+		const SVector& extent = quantization.PositionExtent;
+		const SVector& min = quantization.PositionMin;
+		const F32 halfStep = 0.5f * UMath::Max(extent.X, UMath::Max(extent.Y, extent.Z)) / UnormMax;
+		const F32 magnitude = UMath::Max(UMath::Abs(min.X) + extent.X, UMath::Max(UMath::Abs(min.Y) + extent.Y, UMath::Abs(min.Z) + extent.Z));
+		const F32 maxPositionError = halfStep * UMath::Sqrt(3.0f) + magnitude * 4.0f * FLT_EPSILON;
+
+		return !error.HasUnsupportedBoneIndices
+			&& error.Position <= maxPositionError
+			&& error.Direction <= MaxDirectionError
+			&& error.UV <= MaxUVError
+			&& error.BoneWeight <= MaxBoneWeightError;
+	}
+}
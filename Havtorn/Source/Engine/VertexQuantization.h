@@ -0,0 +1,54 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#pragma once
+
+#include "Graphics/GraphicsStructs.h"
+
+#include <span>
+
+namespace Havtorn
+{
+	// Largest difference between vertices and their compact round trip
+	struct SVertexQuantizationError
+	{
+		F32 Position = 0.0f;
+		// Radians, over normals, tangents and bitangents
+		F32 Direction = 0.0f;
+		F32 UV = 0.0f;
+		F32 BoneWeight = 0.0f;
+		// Bone indices have to be whole numbers below 256 to fit, they are never approximated
+		bool HasUnsupportedBoneIndices = false;
+
+		void Add(const SVertexQuantizationError& other)
+		{
+			Position = UMath::Max(Position, other.Position);
+			Direction = UMath::Max(Direction, other.Direction);
+			UV = UMath::Max(UV, other.UV);
+			BoneWeight = UMath::Max(BoneWeight, other.BoneWeight);
+			HasUnsupportedBoneIndices = HasUnsupportedBoneIndices || other.HasUnsupportedBoneIndices;
+		}
+	};
+
+	class UVertexQuantization
+	{
+	public:
+		// Fixed bounds, well below what can be seen on screen. Position and UV errors are also checked against the
+		// half step their range allows, anything above that is a bug rather than precision.
+		static constexpr F32 MaxDirectionError = 0.001f;
+		static constexpr F32 MaxUVError = 1.0f / 8192.0f;
+		static constexpr F32 MaxBoneWeightError = 1.0f / 255.0f;
+
+		// Position and UV ranges covering every vertex
+		[[nodiscard]] static ENGINE_API SVertexQuantization GetQuantization(const std::vector<std::span<const SStaticMeshVertex>>& meshVertices);
+		[[nodiscard]] static ENGINE_API SVertexQuantization GetQuantization(const std::vector<std::span<const SSkeletalMeshVertex>>& meshVertices);
+
+		// Encodes, decodes the result again and measures the difference, which IsWithinErrorBounds then checks
+		static ENGINE_API SVertexQuantizationError Encode(std::span<const SStaticMeshVertex> vertices, const SVertexQuantization& quantization, std::vector<SCompactStaticMeshVertex>& outVertices);
+		static ENGINE_API SVertexQuantizationError Encode(std::span<const SSkeletalMeshVertex> vertices, const SVertexQuantization& quantization, std::vector<SCompactSkeletalMeshVertex>& outVertices);
+
+		static ENGINE_API void Decode(std::span<const SCompactStaticMeshVertex> vertices, const SVertexQuantization& quantization, std::vector<SStaticMeshVertex>& outVertices);
+		static ENGINE_API void Decode(std::span<const SCompactSkeletalMeshVertex> vertices, const SVertexQuantization& quantization, std::vector<SSkeletalMeshVertex>& outVertices);
+
+		[[nodiscard]] static ENGINE_API bool IsWithinErrorBounds(const SVertexQuantizationError& error, const SVertexQuantization& quantization);
+	};
+}
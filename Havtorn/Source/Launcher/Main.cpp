@@ -4,6 +4,7 @@
 #include <CommandLine.h>
 
 #include "Application/Application.h"
+#include <Assets/AssetRegistry.h>
 #include <../Platform/PlatformProcess.h>
 #include <../Engine/Application/EngineProcess.h>
 #include <../Game/GameProcess.h>
@@ -111,6 +112,22 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 #endif
 
 	engineProcess->Init(platformProcess->PlatformManager);
+
+	// Headless runs that exit once done, without the editor.
+	// -WarmDerivedDataCache=Assets/ imports every mesh and animation source under Assets/ into the derived data cache.
+	const std::string warmDirectory = UCommandLine::GetOptionParameter("WarmDerivedDataCache");
+	if (UCommandLine::IsOptionParameterValid(warmDirectory))
+	{
+		GEngine::GetAssetRegistry()->WarmDerivedDataCache(warmDirectory);
+
+		delete application;
+
+#ifdef USE_CONSOLE
+		CloseConsole();
+#endif
+
+		return 0;
+	}
 	
 #ifdef HV_EDITOR_BUILD
 	// TODO.NW: guiProcess init should handle InitGUI, need hold of the render backend somehow. maybe still move render backend to platform manager
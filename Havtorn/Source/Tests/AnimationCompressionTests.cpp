@@ -0,0 +1,155 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <AnimationCompression.h>
+#include <Assets/FileHeaderDeclarations.h>
+
+#include <cstring>
+
+namespace Havtorn
+{
+	namespace
+	{
+		constexpr U32 DurationInTicks = 60;
+
+		// A key on every tick. One track moves linearly, one holds still and one moves along waves on every channel.
+		SSkeletalAnimationFileHeader MakeAnimation()
+		{
+			SSkeletalAnimationFileHeader header;
+			header.Name = "CompressionTestAnimation";
+			header.DurationInTicks = DurationInTicks;
+			header.TickRate = 30;
+
+			header.BoneAnimationTracks.resize(3);
+			SBoneAnimationTrack& linearTrack = header.BoneAnimationTracks[0];
+			linearTrack.TrackName = std::string("Linear");
+			SBoneAnimationTrack& constantTrack = header.BoneAnimationTracks[1];
+			constantTrack.TrackName = std::string("Constant");
+			SBoneAnimationTrack& waveTrack = header.BoneAnimationTracks[2];
+			waveTrack.TrackName = std::string("Wave");
+
+			for (U32 tick = 0; tick <= DurationInTicks; tick++)
+			{
+				const F32 time = STATIC_F32(tick);
+				linearTrack.TranslationKeys.push_back({ SVector(0.02f * time, 1.0f, -0.01f * time), time });
+				linearTrack.RotationKeys.push_back({ SQuaternion::Identity, time });
+
+				constantTrack.TranslationKeys.push_back({ SVector(0.0f, 0.5f, 0.0f), time });
+				constantTrack.RotationKeys.push_back({ SQuaternion(SVector(0.0f, 1.0f, 0.0f), 30.0f), time });
+				constantTrack.ScaleKeys.push_back({ SVector(1.0f), time });
+
+				waveTrack.TranslationKeys.push_back({ SVector(0.3f * UMath::Sin(time * 0.2f), 0.5f, 0.1f * UMath::Cos(time * 0.3f)), time });
+				waveTrack.RotationKeys.push_back({ SQuaternion(SVector(0.6f, 0.0f, 0.8f), 40.0f * UMath::Sin(time * 0.15f)), time });
+				waveTrack.ScaleKeys.push_back({ SVector(1.0f + 0.1f * UMath::Sin(time * 0.1f)), time });
+			}
+
+			header.NumberOfBones = STATIC_U32(header.BoneAnimationTracks.size());
+			return header;
+		}
+
+		std::vector<SBoneAnimationTrack> DecodeTracks(const SSkeletalAnimationFileHeader& header)
+		{
+			std::vector<SBoneAnimationTrack> tracks(header.CompactTracks.size());
+			for (U64 i = 0; i < tracks.size(); i++)
+			{
+				const SCompactBoneAnimationTrack& compactTrack = header.CompactTracks[i];
+				UAnimationCompression::Decode(compactTrack.TranslationKeys, header.Quantization.TranslationMin, header.Quantization.TranslationExtent, tracks[i].TranslationKeys);
+				UAnimationCompression::Decode(compactTrack.RotationKeys, tracks[i].RotationKeys);
+				UAnimationCompression::Decode(compactTrack.ScaleKeys, header.Quantization.ScaleMin, header.Quantization.ScaleExtent, tracks[i].ScaleKeys);
+			}
+			return tracks;
+		}
+
+		// Half a step of a unorm16 range on every axis
+		F32 GetQuantizationError(const SVector& extent)
+		{
+			return 0.5f * UMath::Max(extent.X, UMath::Max(extent.Y, extent.Z)) / 65535.0f * UMath::Sqrt(3.0f);
+		}
+
+		template<typename TKey>
+		bool AreSameKeys(const std::vector<TKey>& a, const std::vector<TKey>& b)
+		{
+			return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(TKey)) == 0;
+		}
+	}
+
+	HV_TEST(AnimationCompression_ReducesRedundantKeys)
+	{
+		SSkeletalAnimationFileHeader header = MakeAnimation();
+		UAnimationCompression::ReduceKeys(header.BoneAnimationTracks);
+
+		const SBoneAnimationTrack& linearTrack = header.BoneAnimationTracks[0];
+		HV_CHECK(linearTrack.TranslationKeys.size() == 2);
+		HV_CHECK(linearTrack.TranslationKeys.front().Time == 0.0f && linearTrack.TranslationKeys.back().Time == STATIC_F32(DurationInTicks));
+		HV_CHECK(linearTrack.RotationKeys.size() == 1);
+
+		const SBoneAnimationTrack& constantTrack = header.BoneAnimationTracks[1];
+		HV_CHECK(constantTrack.TranslationKeys.size() == 1);
+		HV_CHECK(constantTrack.RotationKeys.size() == 1);
+		HV_CHECK(constantTrack.ScaleKeys.size() == 1);
+
+		const SBoneAnimationTrack& waveTrack = header.BoneAnimationTracks[2];
+		HV_CHECK(waveTrack.TranslationKeys.size() > 2);
+		HV_CHECK(waveTrack.TranslationKeys.size() <= DurationInTicks + 1);
+	}
+
+	HV_TEST(AnimationCompression_DecodedKeysWithinErrorBounds)
+	{
+		SSkeletalAnimationFileHeader header = MakeAnimation();
+		const std::vector<SBoneAnimationTrack> originalTracks = header.BoneAnimationTracks;
+		HV_CHECK(header.CompressTracks());
+		HV_CHECK(header.CompactTracks.size() == originalTracks.size());
+
+		// Key reduction and quantization together, measured against the keys before either
+		const std::vector<SBoneAnimationTrack> decodedTracks = DecodeTracks(header);
+		SAnimationCompressionError error;
+		for (U64 i = 0; i < originalTracks.size(); i++)
+			error.Add(UAnimationCompression::Measure(originalTracks[i], decodedTracks[i]));
+
+		HV_CHECK(!error.HasUnsupportedKeyTimes);
+		HV_CHECK(error.Translation <= 2.0f * UAnimationCompression::MaxTranslationError + GetQuantizationError(header.Quantization.TranslationExtent));
+		HV_CHECK(error.Rotation <= 2.0f * UAnimationCompression::MaxRotationError + 0.0001f);
+		HV_CHECK(error.Scale <= 2.0f * UAnimationCompression::MaxScaleError + GetQuantizationError(header.Quantization.ScaleExtent));
+	}
+
+	HV_TEST(AnimationCompression_FileRoundTrips)
+	{
+		SSkeletalAnimationFileHeader header = MakeAnimation();
+		HV_CHECK(header.CompressTracks());
+		const std::vector<SBoneAnimationTrack> decodedTracks = DecodeTracks(header);
+
+		// Once as is and once with compressed payloads, both read back to the decoded keys
+		for (const bool shouldCompress : { false, true })
+		{
+			if (shouldCompress)
+				header.CompressPayloads();
+
+			std::vector<char> data(header.GetSize());
+			header.Serialize(data.data());
+
+			SSkeletalAnimationFileHeader readHeader;
+			HV_CHECK(readHeader.Deserialize(data.data(), data.size()));
+			HV_CHECK(readHeader.DurationInTicks == header.DurationInTicks);
+			HV_CHECK(readHeader.BoneAnimationTracks.size() == decodedTracks.size());
+			for (U64 i = 0; i < UMath::Min(readHeader.BoneAnimationTracks.size(), decodedTracks.size()); i++)
+			{
+				const SBoneAnimationTrack& track = readHeader.BoneAnimationTracks[i];
+				HV_CHECK(track.TrackName == header.BoneAnimationTracks[i].TrackName);
+				HV_CHECK(AreSameKeys(track.TranslationKeys, decodedTracks[i].TranslationKeys));
+				HV_CHECK(AreSameKeys(track.RotationKeys, decodedTracks[i].RotationKeys));
+				HV_CHECK(AreSameKeys(track.ScaleKeys, decodedTracks[i].ScaleKeys));
+			}
+		}
+	}
+
+	HV_TEST(AnimationCompression_KeepsFullKeysBetweenTicks)
+	{
+		SSkeletalAnimationFileHeader header = MakeAnimation();
+		// The last key is always kept, so the reduction can't drop it
+		header.BoneAnimationTracks[2].TranslationKeys.back().Time += 0.5f;
+
+		HV_CHECK(!header.CompressTracks());
+		HV_CHECK(header.CompactTracks.empty());
+	}
+}
@@ -0,0 +1,894 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <Assets/RuntimeAssetDeclarations.h>
+#include <ECS/Components/SkeletalAnimationComponent.h>
+#include <ECS/Systems/AnimatorGraphSystem.h>
+#include <Graphics/AnimationAtlas.h>
+#include <Graphics/SkeletalPose.h>
+#include <Threading/ThreadManager.h>
+
+#include <chrono>
+#include <random>
+
+namespace Havtorn
+{
+	namespace
+	{
+		constexpr U32 DurationInTicks = 48;
+		constexpr U32 TickRate = 30;
+
+		std::string GetNodeName(const U32 nodeIndex)
+		{
+			return "Node" + std::to_string(nodeIndex);
+		}
+
+		// Binary tree of nodes, every node but the root is a bone. One more bone has no node driving it.
+		SSkeletalMeshAsset MakeSkeleton(const U32 numberOfNodes)
+		{
+			SSkeletalMeshAsset mesh;
+			std::vector<SMatrix> globalTransforms(numberOfNodes);
+			for (U32 nodeIndex = 0; nodeIndex < numberOfNodes; nodeIndex++)
+			{
+				SSkeletalMeshNode& node = mesh.Nodes.emplace_back();
+				node.Name = GetNodeName(nodeIndex);
+				SMatrix::Recompose(SVector(0.1f * STATIC_F32(nodeIndex % 3), 0.5f, 0.05f * STATIC_F32(nodeIndex)), SQuaternion(SVector(0.0f, 0.0f, 1.0f), 5.0f * STATIC_F32(nodeIndex % 4)), SVector(1.0f), node.NodeTransform);
+
+				globalTransforms[nodeIndex] = node.NodeTransform;
+				if (nodeIndex > 0)
+				{
+					const U32 parentIndex = (nodeIndex - 1) / 2;
+					mesh.Nodes[parentIndex].ChildIndices.push_back(nodeIndex);
+					globalTransforms[nodeIndex] = node.NodeTransform * globalTransforms[parentIndex];
+				}
+			}
+
+			for (U32 nodeIndex = 1; nodeIndex < numberOfNodes; nodeIndex++)
+			{
+				SSkeletalMeshBone& bone = mesh.BindPoseBones.emplace_back();
+				bone.Name = GetNodeName(nodeIndex);
+				bone.InverseBindPoseTransform = globalTransforms[nodeIndex].Inverse();
+			}
+
+			mesh.BindPoseBones.emplace_back().Name = std::string("Unbound");
+			return mesh;
+		}
+
+		// Keys on whole ticks at different rates per channel. Tracks are in reverse node order, the last node has no track, one
+		// track animates no node, one node has a single scale key and another none at all.
+		SSkeletalAnimationAsset MakeClip(const U32 numberOfNodes, const F32 amplitude)
+		{
+			SSkeletalAnimationAsset animation;
+			animation.DurationInTicks = DurationInTicks;
+			animation.TickRate = TickRate;
+
+			animation.BoneAnimationTracks.emplace_back().TrackName = std::string("Unused");
+			for (I32 nodeIndex = STATIC_I32(numberOfNodes) - 2; nodeIndex >= 0; nodeIndex--)
+			{
+				SBoneAnimationTrack& track = animation.BoneAnimationTracks.emplace_back();
+				track.TrackName = GetNodeName(STATIC_U32(nodeIndex));
+				const F32 phase = 0.7f * STATIC_F32(nodeIndex);
+
+				for (U32 tick = 0; tick <= DurationInTicks; tick += 4)
+					track.TranslationKeys.push_back({ SVector(0.1f * UMath::Sin(STATIC_F32(tick) * 0.2f + phase), 0.5f, 0.05f * STATIC_F32(nodeIndex)), STATIC_F32(tick) });
+
+				for (U32 tick = 0; tick <= DurationInTicks; tick += 3)
+					track.RotationKeys.push_back({ SQuaternion(SVector(0.6f, 0.0f, 0.8f), amplitude * UMath::Sin(STATIC_F32(tick) * 0.15f + phase)), STATIC_F32(tick) });
+
+				if (nodeIndex == 2)
+					track.ScaleKeys.push_back({ SVector(1.1f), 0.0f });
+				else if (nodeIndex != 3)
+					for (U32 tick = 0; tick <= DurationInTicks; tick += 6)
+						track.ScaleKeys.push_back({ SVector(1.0f + 0.1f * UMath::Sin(STATIC_F32(tick) * 0.1f + phase)), STATIC_F32(tick) });
+			}
+
+			return animation;
+		}
+
+		// Reference sampling, a linear search for the segment every time
+		template<typename TKey>
+		U64 FindKeyByScan(const std::vector<TKey>& keys, const F32 animationTime)
+		{
+			U64 index = 0;
+			while (index + 2 < keys.size() && !(animationTime < keys[index + 1].Time))
+				index++;
+			return index;
+		}
+
+		SVector InterpolateKeys(const SVector& a, const SVector& b, const F32 factor)
+		{
+			return a * (1 - factor) + b * factor;
+		}
+
+		SQuaternion InterpolateKeys(const SQuaternion& a, const SQuaternion& b, const F32 factor)
+		{
+			return SQuaternion::Slerp(a, b, factor).GetNormalized();
+		}
+
+		template<typename TKey>
+		decltype(TKey::Value) SampleKeysByScan(const std::vector<TKey>& keys, const F32 animationTime, const decltype(TKey::Value)& defaultValue)
+		{
+			if (keys.empty())
+				return defaultValue;
+
+			if (keys.size() == 1)
+				return keys[0].Value;
+
+			const U64 index = FindKeyByScan(keys, animationTime);
+			const F32 deltaTime = keys[index + 1].Time - keys[index].Time;
+			const F32 factor = UMath::Clamp((animationTime - keys[index].Time) / deltaTime);
+			return InterpolateKeys(keys[index].Value, keys[index + 1].Value, factor);
+		}
+
+		const SBoneAnimationTrack* FindTrackByName(const SSkeletalAnimationAsset& animation, const std::string& name)
+		{
+			for (const SBoneAnimationTrack& track : animation.BoneAnimationTracks)
+				if (track.TrackName.AsString() == name)
+					return &track;
+			return nullptr;
+		}
+
+		// Reference evaluation, looking up tracks and bones by name and multiplying matrices down the hierarchy
+		void ApplyPoseByName(const SSkeletalMeshAsset& mesh, const SSkeletalAnimationAsset& animation, const F32 animationTime, const U32 nodeIndex, const SMatrix& parentTransform, std::vector<SMatrix>& inOutGlobalTransforms)
+		{
+			const SSkeletalMeshNode& node = mesh.Nodes[nodeIndex];
+			SMatrix nodeTransform = node.NodeTransform;
+			if (const SBoneAnimationTrack* track = FindTrackByName(animation, node.Name.AsString()))
+			{
+				const SVector translation = SampleKeysByScan(track->TranslationKeys, animationTime, SVector::Zero);
+				const SQuaternion rotation = SampleKeysByScan(track->RotationKeys, animationTime, SQuaternion::Identity);
+				const SVector scale = SampleKeysByScan(track->ScaleKeys, animationTime, SVector(1.0f));
+				SMatrix::Recompose(translation, rotation, scale, nodeTransform);
+			}
+
+			inOutGlobalTransforms[nodeIndex] = nodeTransform * parentTransform;
+			for (const U32 childIndex : node.ChildIndices)
+				ApplyPoseByName(mesh, animation, animationTime, childIndex, inOutGlobalTransforms[nodeIndex], inOutGlobalTransforms);
+		}
+
+		std::vector<SMatrix> EvaluateByName(const SSkeletalMeshAsset& mesh, const SSkeletalAnimationAsset& animation, const F32 animationTime)
+		{
+			std::vector<SMatrix> globalTransforms(mesh.Nodes.size());
+			ApplyPoseByName(mesh, animation, animationTime, 0, SMatrix::Identity, globalTransforms);
+
+			std::vector<SMatrix> bones(mesh.BindPoseBones.size(), SMatrix::Identity);
+			for (U64 boneIndex = 0; boneIndex < bones.size(); boneIndex++)
+				for (U64 nodeIndex = 0; nodeIndex < mesh.Nodes.size(); nodeIndex++)
+					if (mesh.Nodes[nodeIndex].Name.AsString() == mesh.BindPoseBones[boneIndex].Name.AsString())
+					{
+						bones[boneIndex] = mesh.BindPoseBones[boneIndex].InverseBindPoseTransform * globalTransforms[nodeIndex];
+						break;
+					}
+			return bones;
+		}
+
+		std::vector<SMatrix> Evaluate(const SSkeletalMeshAsset& mesh, const SSkeletalAnimationAsset& animation, const SSkeletalAnimationBinding& binding, const F32 animationTime, std::vector<SBoneTrackCursor>& cursors)
+		{
+			SSkeletalPose localPose;
+			CAnimatorGraphSystem::ReadAnimationLocalPose(&animation, binding, animationTime, binding.EvaluationOrder, cursors, localPose);
+			std::vector<SMatrix> globalTransforms;
+			CAnimatorGraphSystem::ApplyLocalPoseToHierarchy(binding, localPose, SMatrix::Identity, globalTransforms);
+			std::vector<SMatrix> bones;
+			CAnimatorGraphSystem::ApplyInverseBindPose(&mesh, binding, globalTransforms, bones);
+			return bones;
+		}
+
+		F32 GetMaxDifference(const SMatrix& a, const SMatrix& b, const U8 firstElement, const U8 lastElement)
+		{
+			F32 maxDifference = 0.0f;
+			for (U8 i = firstElement; i <= lastElement; i++)
+				maxDifference = UMath::Max(maxDifference, std::abs(a.data[i] - b.data[i]));
+			return maxDifference;
+		}
+
+		F32 GetMaxDifference(const std::vector<SMatrix>& a, const std::vector<SMatrix>& b)
+		{
+			F32 maxDifference = 0.0f;
+			for (U64 i = 0; i < a.size(); i++)
+				maxDifference = UMath::Max(maxDifference, GetMaxDifference(a[i], b[i], 0, 15));
+			return maxDifference;
+		}
+
+		// Same rotation, either sign
+		F32 GetRotationDifference(const SQuaternion& a, const SQuaternion& b)
+		{
+			return 1.0f - std::abs(a.X * b.X + a.Y * b.Y + a.Z * b.Z + a.W * b.W);
+		}
+
+		// Characters blending a walk and a run, offset in time and blend value so they don't all sample the same keys.
+		// Gathers the same evaluations Update would for them.
+		struct SCrowd
+		{
+			SCrowd(const U32 numberOfCharacters, const U32 numberOfNodes)
+				: Mesh(MakeSkeleton(numberOfNodes))
+				, Walk(MakeClip(numberOfNodes, 20.0f))
+				, Run(MakeClip(numberOfNodes, -15.0f))
+				, Characters(numberOfCharacters)
+				, Evaluations(numberOfCharacters)
+				, Clips(STATIC_U64(numberOfCharacters) * 2)
+			{
+				CAnimatorGraphSystem::BuildBinding(&Mesh, &Walk, WalkBinding);
+				CAnimatorGraphSystem::BuildBinding(&Mesh, &Run, RunBinding);
+				for (U32 character = 0; character < numberOfCharacters; character++)
+				{
+					Characters[character].PlayData.resize(2);
+					Characters[character].BlendValue = fmodf(STATIC_F32(character) * 0.618f, 1.0f);
+				}
+			}
+
+			void Gather(const U32 frame)
+			{
+				Evaluations.resize(Characters.size());
+				for (U32 character = 0; character < STATIC_U32(Characters.size()); character++)
+				{
+					SSkeletalAnimationComponent& component = Characters[character];
+					const F32 animationTime = fmodf(STATIC_F32(frame) * 0.5f + STATIC_F32(character) * 0.37f, STATIC_F32(DurationInTicks));
+					Clips[STATIC_U64(character) * 2] = { &component.PlayData[0], &Walk, &WalkBinding, nullptr, animationTime, 0, 1.0f - component.BlendValue };
+					Clips[STATIC_U64(character) * 2 + 1] = { &component.PlayData[1], &Run, &RunBinding, nullptr, fmodf(animationTime + 7.5f, STATIC_F32(DurationInTicks)), 0, component.BlendValue };
+
+					SSkeletalAnimationEvaluation& evaluation = Evaluations[character];
+					evaluation.Component = &component;
+					evaluation.Mesh = &Mesh;
+					evaluation.Binding = &WalkBinding;
+					evaluation.FirstClip = character * 2;
+					evaluation.NumberOfClips = 2;
+				}
+			}
+
+			// Every character plays the walk or the run alone, started on one of numberOfPhases phases like an ambient crowd
+			void GatherPhases(const U32 frame, const U32 numberOfPhases)
+			{
+				Evaluations.resize(Characters.size());
+				for (U32 character = 0; character < STATIC_U32(Characters.size()); character++)
+				{
+					SSkeletalAnimationComponent& component = Characters[character];
+					const bool isRunning = character % 2 == 1;
+					const U32 phase = (character / 2) % numberOfPhases;
+					const F32 animationTime = fmodf(STATIC_F32(frame) * 0.5f + STATIC_F32(phase * DurationInTicks) / STATIC_F32(numberOfPhases), STATIC_F32(DurationInTicks));
+					const SSkeletalAnimationBinding* binding = isRunning ? &RunBinding : &WalkBinding;
+					Clips[character] = { &component.PlayData[isRunning ? 1 : 0], isRunning ? &Run : &Walk, binding, nullptr, animationTime, 0, 1.0f };
+
+					SSkeletalAnimationEvaluation& evaluation = Evaluations[character];
+					evaluation.Component = &component;
+					evaluation.Mesh = &Mesh;
+					evaluation.Binding = binding;
+					evaluation.FirstClip = character;
+					evaluation.NumberOfClips = 1;
+				}
+			}
+
+			F32 GetMaxDifference(const std::vector<std::vector<SMatrix>>& bones) const
+			{
+				F32 maxDifference = 0.0f;
+				for (U64 character = 0; character < Characters.size(); character++)
+					maxDifference = UMath::Max(maxDifference, Havtorn::GetMaxDifference(Characters[character].Bones, bones[character]));
+				return maxDifference;
+			}
+
+			std::vector<std::vector<SMatrix>> CopyBones() const
+			{
+				std::vector<std::vector<SMatrix>> bones;
+				for (const SSkeletalAnimationComponent& component : Characters)
+					bones.push_back(component.Bones);
+				return bones;
+			}
+
+			SSkeletalMeshAsset Mesh;
+			SSkeletalAnimationAsset Walk;
+			SSkeletalAnimationAsset Run;
+			SSkeletalAnimationBinding WalkBinding;
+			SSkeletalAnimationBinding RunBinding;
+			std::vector<SSkeletalAnimationComponent> Characters;
+			std::vector<SSkeletalAnimationEvaluation> Evaluations;
+			std::vector<SSkeletalAnimationClipEvaluation> Clips;
+		};
+	}
+
+	HV_TEST(Animation_BindingMapsNodesByName)
+	{
+		const SSkeletalMeshAsset mesh = MakeSkeleton(15);
+		const SSkeletalAnimationAsset animation = MakeClip(15, 20.0f);
+
+		SSkeletalAnimationBinding binding;
+		CAnimatorGraphSystem::BuildBinding(&mesh, &animation, binding);
+
+		HV_CHECK(binding.EvaluationOrder.size() == mesh.Nodes.size());
+		HV_CHECK(binding.EvaluationOrder.front() == 0);
+		HV_CHECK(binding.ParentIndices[0] == -1);
+		HV_CHECK(binding.NumberOfTracks == animation.BoneAnimationTracks.size());
+
+		// Parents are evaluated before their children
+		std::vector<bool> isEvaluated(mesh.Nodes.size(), false);
+		for (const U32 nodeIndex : binding.EvaluationOrder)
+		{
+			const I32 parentIndex = binding.ParentIndices[nodeIndex];
+			HV_CHECK(parentIndex < 0 || isEvaluated[parentIndex]);
+			isEvaluated[nodeIndex] = true;
+		}
+
+		for (U64 nodeIndex = 0; nodeIndex < mesh.Nodes.size(); nodeIndex++)
+		{
+			const I32 trackIndex = binding.TrackIndices[nodeIndex];
+			if (nodeIndex == mesh.Nodes.size() - 1)
+				HV_CHECK(trackIndex == -1);
+			else
+				HV_CHECK(trackIndex >= 0 && animation.BoneAnimationTracks[trackIndex].TrackName.AsString() == mesh.Nodes[nodeIndex].Name.AsString());
+		}
+
+		for (U64 boneIndex = 0; boneIndex < mesh.BindPoseBones.size(); boneIndex++)
+		{
+			const I32 nodeIndex = binding.BoneNodeIndices[boneIndex];
+			if (boneIndex == mesh.BindPoseBones.size() - 1)
+				HV_CHECK(nodeIndex == -1);
+			else
+				HV_CHECK(nodeIndex >= 0 && mesh.Nodes[nodeIndex].Name.AsString() == mesh.BindPoseBones[boneIndex].Name.AsString());
+		}
+	}
+
+	HV_TEST(Animation_CursorSamplingMatchesScan)
+	{
+		const SSkeletalMeshAsset mesh = MakeSkeleton(15);
+		const SSkeletalAnimationAsset animation = MakeClip(15, 20.0f);
+
+		SSkeletalAnimationBinding binding;
+		CAnimatorGraphSystem::BuildBinding(&mesh, &animation, binding);
+
+		// Two loops of playback with a few jumps back and forth, which the cursors have to recover from
+		std::mt19937 random(1337);
+		std::uniform_real_distribution<F32> jumpTime(0.0f, STATIC_F32(DurationInTicks));
+		std::vector<SBoneTrackCursor> cursors;
+		SSkeletalPose pose;
+		F32 playTime = 0.0f;
+		for (U32 frame = 0; frame < 240; frame++)
+		{
+			playTime += 0.4f;
+			const F32 animationTime = (frame % 50 == 49) ? jumpTime(random) : fmodf(playTime, STATIC_F32(DurationInTicks));
+			CAnimatorGraphSystem::ReadAnimationLocalPose(&animation, binding, animationTime, binding.EvaluationOrder, cursors, pose);
+
+			for (U64 nodeIndex = 0; nodeIndex < mesh.Nodes.size(); nodeIndex++)
+			{
+				const I32 trackIndex = binding.TrackIndices[nodeIndex];
+				if (trackIndex < 0)
+					continue;
+
+				const SBoneAnimationTrack& track = animation.BoneAnimationTracks[trackIndex];
+				const SVector translation = SampleKeysByScan(track.TranslationKeys, animationTime, SVector::Zero);
+				const SQuaternion rotation = SampleKeysByScan(track.RotationKeys, animationTime, SQuaternion::Identity);
+				const SVector scale = SampleKeysByScan(track.ScaleKeys, animationTime, SVector(1.0f));
+				HV_CHECK(pose.Translations[nodeIndex].X == translation.X && pose.Translations[nodeIndex].Y == translation.Y && pose.Translations[nodeIndex].Z == translation.Z);
+				HV_CHECK(pose.Rotations[nodeIndex].X == rotation.X && pose.Rotations[nodeIndex].Y == rotation.Y && pose.Rotations[nodeIndex].Z == rotation.Z && pose.Rotations[nodeIndex].W == rotation.W);
+				HV_CHECK(pose.Scales[nodeIndex].X == scale.X && pose.Scales[nodeIndex].Y == scale.Y && pose.Scales[nodeIndex].Z == scale.Z);
+			}
+		}
+	}
+
+	HV_TEST(Animation_BonesMatchEvaluationByName)
+	{
+		const SSkeletalMeshAsset mesh = MakeSkeleton(15);
+		const SSkeletalAnimationAsset animation = MakeClip(15, 20.0f);
+
+		SSkeletalAnimationBinding binding;
+		CAnimatorGraphSystem::BuildBinding(&mesh, &animation, binding);
+
+		std::vector<SBoneTrackCursor> cursors;
+		for (F32 animationTime = 0.0f; animationTime < STATIC_F32(DurationInTicks); animationTime += 1.3f)
+		{
+			const std::vector<SMatrix> bones = Evaluate(mesh, animation, binding, animationTime, cursors);
+			const std::vector<SMatrix> referenceBones = EvaluateByName(mesh, animation, animationTime);
+			HV_CHECK(bones.size() == referenceBones.size());
+			HV_CHECK(GetMaxDifference(bones, referenceBones) < 0.0001f);
+			HV_CHECK(GetMaxDifference(bones.back(), SMatrix::Identity, 0, 15) == 0.0f);
+		}
+	}
+
+	HV_TEST(Animation_ResampledClipMatchesKeysOnSamples)
+	{
+		const SSkeletalMeshAsset mesh = MakeSkeleton(15);
+		const SSkeletalAnimationAsset animation = MakeClip(15, 20.0f);
+
+		SSkeletalAnimationBinding binding;
+		CAnimatorGraphSystem::BuildBinding(&mesh, &animation, binding);
+
+		SResampledAnimationClip clip;
+		CAnimatorGraphSystem::ResampleClip(&animation, 1.0f, clip);
+		HV_CHECK(clip.NumberOfSamples == DurationInTicks + 1);
+		HV_CHECK(clip.NumberOfTracks == animation.BoneAnimationTracks.size());
+
+		std::vector<SBoneTrackCursor> cursors;
+		SSkeletalPose pose;
+		SSkeletalPose resampledPose;
+		SSkeletalPose scratchPose;
+		for (U32 tick = 0; tick <= DurationInTicks; tick++)
+		{
+			CAnimatorGraphSystem::ReadAnimationLocalPose(&animation, binding, STATIC_F32(tick), binding.EvaluationOrder, cursors, pose);
+			CAnimatorGraphSystem::ReadResampledLocalPose(clip, binding, STATIC_F32(tick), binding.EvaluationOrder, scratchPose, resampledPose);
+			for (U64 nodeIndex = 0; nodeIndex < mesh.Nodes.size(); nodeIndex++)
+			{
+				HV_CHECK_NEAR(resampledPose.Translations[nodeIndex].X, pose.Translations[nodeIndex].X, 0.00001f);
+				HV_CHECK_NEAR(resampledPose.Translations[nodeIndex].Z, pose.Translations[nodeIndex].Z, 0.00001f);
+				HV_CHECK_NEAR(resampledPose.Scales[nodeIndex].Y, pose.Scales[nodeIndex].Y, 0.00001f);
+				HV_CHECK(GetRotationDifference(resampledPose.Rotations[nodeIndex], pose.Rotations[nodeIndex]) < 0.00001f);
+			}
+		}
+	}
+
+	HV_TEST(Animation_BatchedBlendMatchesScalar)
+	{
+		const SSkeletalMeshAsset mesh = MakeSkeleton(31);
+		const SSkeletalAnimationAsset walk = MakeClip(31, 20.0f);
+		const SSkeletalAnimationAsset run = MakeClip(31, -15.0f);
+
+		SSkeletalAnimationBinding walkBinding;
+		CAnimatorGraphSystem::BuildBinding(&mesh, &walk, walkBinding);
+		SSkeletalAnimationBinding runBinding;
+		CAnimatorGraphSystem::BuildBinding(&mesh, &run, runBinding);
+
+		std::vector<SBoneTrackCursor> walkCursors;
+		std::vector<SBoneTrackCursor> runCursors;
+		SSkeletalPose walkPose;
+		SSkeletalPose runPose;
+		SSkeletalPose blendedPose;
+		for (F32 weight = 0.0f; weight <= 1.0f; weight += 0.125f)
+		{
+			const F32 animationTime = weight * STATIC_F32(DurationInTicks);
+			CAnimatorGraphSystem::ReadAnimationLocalPose(&walk, walkBinding, animationTime, walkBinding.EvaluationOrder, walkCursors, walkPose);
+			CAnimatorGraphSystem::ReadAnimationLocalPose(&run, runBinding, animationTime, runBinding.EvaluationOrder, runCursors, runPose);
+			USkeletalPose::Blend(walkPose, runPose, weight, blendedPose);
+
+			// Per node lerp and slerp, composed and multiplied down the hierarchy one matrix at a time
+			std::vector<SMatrix> referenceGlobalTransforms(mesh.Nodes.size());
+			for (const U32 nodeIndex : walkBinding.EvaluationOrder)
+			{
+				const SVector translation = InterpolateKeys(walkPose.Translations[nodeIndex], runPose.Translations[nodeIndex], weight);
+				const SQuaternion rotation = InterpolateKeys(walkPose.Rotations[nodeIndex], runPose.Rotations[nodeIndex], weight);
+				const SVector scale = InterpolateKeys(walkPose.Scales[nodeIndex], runPose.Scales[nodeIndex], weight);
+				HV_CHECK(GetRotationDifference(blendedPose.Rotations[nodeIndex], rotation) < 0.0001f);
+
+				SMatrix localTransform;
+				SMatrix::Recompose(translation, rotation, scale, localTransform);
+				const I32 parentIndex = walkBinding.ParentIndices[nodeIndex];
+				referenceGlobalTransforms[nodeIndex] = parentIndex < 0 ? localTransform : localTransform * referenceGlobalTransforms[parentIndex];
+			}
+
+			std::vector<SMatrix> referenceBones(mesh.BindPoseBones.size(), SMatrix::Identity);
+			for (U64 boneIndex = 0; boneIndex < referenceBones.size(); boneIndex++)
+				if (const I32 nodeIndex = walkBinding.BoneNodeIndices[boneIndex]; nodeIndex >= 0)
+					referenceBones[boneIndex] = mesh.BindPoseBones[boneIndex].InverseBindPoseTransform * referenceGlobalTransforms[nodeIndex];
+
+			std::vector<SMatrix> globalTransforms;
+			CAnimatorGraphSystem::ApplyLocalPoseToHierarchy(walkBinding, blendedPose, SMatrix::Identity, globalTransforms);
+			std::vector<SMatrix> bones;
+			CAnimatorGraphSystem::ApplyInverseBindPose(&mesh, walkBinding, globalTransforms, bones);
+
+			// Nlerp against slerp, the poses are close enough for the difference to stay small down the hierarchy
+			HV_CHECK(GetMaxDifference(bones, referenceBones) < 0.05f);
+		}
+	}
+
+	HV_TEST(Animation_EvaluateComponentBlendsLayers)
+	{
+		const SSkeletalMeshAsset mesh = MakeSkeleton(15);
+		const SSkeletalAnimationAsset walk = MakeClip(15, 20.0f);
+		const SSkeletalAnimationAsset run = MakeClip(15, -15.0f);
+
+		SSkeletalAnimationBinding walkBinding;
+		CAnimatorGraphSystem::BuildBinding(&mesh, &walk, walkBinding);
+		SSkeletalAnimationBinding runBinding;
+		CAnimatorGraphSystem::BuildBinding(&mesh, &run, runBinding);
+
+		SSkeletalAnimationComponent component;
+		component.PlayData.resize(2);
+
+		SSkeletalAnimationEvaluation evaluation;
+		evaluation.Component = &component;
+		evaluation.Mesh = &mesh;
+		evaluation.Binding = &walkBinding;
+		evaluation.NumberOfClips = 2;
+
+		constexpr F32 animationTime = 17.5f;
+		constexpr F32 runWeight = 0.3f;
+		std::vector<SSkeletalAnimationClipEvaluation> clips(2);
+		clips[0] = { &component.PlayData[0], &walk, &walkBinding, nullptr, animationTime, 0, 1.0f - runWeight };
+		clips[1] = { &component.PlayData[1], &run, &runBinding, nullptr, animationTime, 0, runWeight };
+		CAnimatorGraphSystem::EvaluateComponent(evaluation, clips);
+
+		// The two clips blended by hand
+		std::vector<SBoneTrackCursor> cursors;
+		SSkeletalPose walkPose;
+		CAnimatorGraphSystem::ReadAnimationLocalPose(&walk, walkBinding, animationTime, walkBinding.EvaluationOrder, cursors, walkPose);
+		SSkeletalPose runPose;
+		CAnimatorGraphSystem::ReadAnimationLocalPose(&run, runBinding, animationTime, runBinding.EvaluationOrder, cursors, runPose);
+		SSkeletalPose blendedPose;
+		USkeletalPose::Blend(walkPose, runPose, runWeight, blendedPose);
+		std::vector<SMatrix> globalTransforms;
+		CAnimatorGraphSystem::ApplyLocalPoseToHierarchy(walkBinding, blendedPose, SMatrix::Identity, globalTransforms);
+		std::vector<SMatrix> bones;
+		CAnimatorGraphSystem::ApplyInverseBindPose(&mesh, walkBinding, globalTransforms, bones);
+
+		HV_CHECK(component.Bones.size() == bones.size());
+		HV_CHECK(GetMaxDifference(component.Bones, bones) < 0.00001f);
+
+		// A half weight override layer on top of the walk, masked to the subtree under the first child of the root
+		component.Layers.resize(2);
+		SSkeletalAnimationLayer& baseLayer = component.Layers[0];
+		SSkeletalAnimationLayer& upperLayer = component.Layers[1];
+		upperLayer.Weight = 0.5f;
+		upperLayer.MaskRoots = { GetNodeName(1) };
+		for (const U32 nodeIndex : walkBinding.EvaluationOrder)
+		{
+			bool isUnderMaskRoot = false;
+			for (I32 index = STATIC_I32(nodeIndex); index >= 0; index = walkBinding.ParentIndices[index])
+				isUnderMaskRoot = isUnderMaskRoot || index == 1;
+			if (isUnderMaskRoot)
+				upperLayer.MaskNodeIndices.push_back(nodeIndex);
+		}
+		upperLayer.MaskNumberOfNodes = mesh.Nodes.size();
+		baseLayer.Weight = 1.0f;
+		clips[0].Weight = 1.0f;
+		clips[1].LayerIndex = 1;
+		clips[1].Weight = 1.0f;
+		CAnimatorGraphSystem::EvaluateComponent(evaluation, clips);
+
+		// Nodes outside the mask only play the walk, the ones under it are halfway to the run
+		SSkeletalPose layeredPose = walkPose;
+		USkeletalPose::Blend(walkPose, runPose, 0.5f, blendedPose);
+		for (const U32 nodeIndex : upperLayer.MaskNodeIndices)
+		{
+			layeredPose.Translations[nodeIndex] = blendedPose.Translations[nodeIndex];
+			layeredPose.Rotations[nodeIndex] = blendedPose.Rotations[nodeIndex];
+			layeredPose.Scales[nodeIndex] = blendedPose.Scales[nodeIndex];
+		}
+		CAnimatorGraphSystem::ApplyLocalPoseToHierarchy(walkBinding, layeredPose, SMatrix::Identity, globalTransforms);
+		CAnimatorGraphSystem::ApplyInverseBindPose(&mesh, walkBinding, globalTransforms, bones);
+		HV_CHECK(GetMaxDifference(component.Bones, bones) < 0.0001f);
+	}
+
+	HV_TEST(Animation_EvaluateComponentsOnJobsMatchesSerial)
+	{
+		SCrowd crowd(100, 31);
+		crowd.Gather(3);
+		CAnimatorGraphSystem::EvaluateComponents(crowd.Evaluations, crowd.Clips, nullptr);
+		const std::vector<std::vector<SMatrix>> serialBones = crowd.CopyBones();
+
+		// Every character is evaluated by exactly one job, into its own buffers
+		CThreadManager threadManager;
+		threadManager.Init(nullptr);
+		for (SSkeletalAnimationComponent& component : crowd.Characters)
+			component.Bones.clear();
+		CAnimatorGraphSystem::EvaluateComponents(crowd.Evaluations, crowd.Clips, &threadManager);
+		threadManager.Shutdown();
+
+		for (const SSkeletalAnimationComponent& component : crowd.Characters)
+			HV_CHECK(component.Bones.size() == crowd.Mesh.BindPoseBones.size());
+		HV_CHECK(crowd.GetMaxDifference(serialBones) == 0.0f);
+	}
+
+	HV_TEST(Animation_PoseCacheSharesWithinQuantizationWindow)
+	{
+		const SSkeletalMeshAsset mesh = MakeSkeleton(15);
+		const SSkeletalAnimationAsset walk = MakeClip(15, 20.0f);
+		const SSkeletalAnimationAsset run = MakeClip(15, -15.0f);
+
+		SSkeletalAnimationBinding walkBinding;
+		CAnimatorGraphSystem::BuildBinding(&mesh, &walk, walkBinding);
+		SSkeletalAnimationBinding runBinding;
+		CAnimatorGraphSystem::BuildBinding(&mesh, &run, runBinding);
+
+		// At the clip's tick rate every tick is a sample, so 10.2 and 10.4 round to 10 and 10.6 to 11. The last character is in
+		// the first one's window, but plays another clip.
+		constexpr F32 samplesPerSecond = STATIC_F32(TickRate);
+		const F32 animationTimes[4] = { 10.2f, 10.4f, 10.6f, 10.2f };
+		std::vector<SSkeletalAnimationComponent> characters(4);
+		std::vector<SSkeletalAnimationClipEvaluation> clips(4);
+		std::vector<SSkeletalAnimationEvaluation> evaluations(4);
+		auto gather = [&]()
+			{
+				evaluations.resize(4);
+				for (U32 character = 0; character < 4; character++)
+				{
+					const bool isRunning = character == 3;
+					characters[character].PlayData.resize(1);
+					clips[character] = { &characters[character].PlayData[0], isRunning ? &run : &walk, isRunning ? &runBinding : &walkBinding, nullptr, animationTimes[character], 0, 1.0f };
+					evaluations[character] = { &characters[character], &mesh, clips[character].Binding, SMatrix::Identity, character, 1 };
+				}
+			};
+
+		gather();
+		SAnimationPoseCache cache;
+		CAnimatorGraphSystem::AssignPoseCache(cache, evaluations, clips, samplesPerSecond);
+		HV_CHECK(cache.NumberOfLookups == 4);
+		HV_CHECK(cache.SharedPoses.size() == 1);
+		HV_CHECK(evaluations.size() == 3);
+		if (cache.SharedPoses.size() == 1)
+		{
+			HV_CHECK(cache.SharedPoses[0].Component == &characters[1]);
+			HV_CHECK(cache.SharedPoses[0].Source == &characters[0]);
+		}
+
+		CAnimatorGraphSystem::EvaluateComponents(evaluations, clips, nullptr);
+		CAnimatorGraphSystem::ApplySharedPoses(cache);
+		HV_CHECK(characters[1].Bones == characters[0].Bones);
+
+		// The evaluated characters play the rounded time
+		std::vector<SBoneTrackCursor> cursors;
+		HV_CHECK(GetMaxDifference(characters[0].Bones, Evaluate(mesh, walk, walkBinding, 10.0f, cursors)) < 0.00001f);
+		HV_CHECK(GetMaxDifference(characters[2].Bones, Evaluate(mesh, walk, walkBinding, 11.0f, cursors)) < 0.00001f);
+		HV_CHECK(GetMaxDifference(characters[2].Bones, characters[0].Bones) > 0.0001f);
+		HV_CHECK(GetMaxDifference(characters[3].Bones, characters[0].Bones) > 0.0001f);
+
+		// Half the samples widens the windows to two ticks, all three walking characters round to 5 and share a palette
+		gather();
+		CAnimatorGraphSystem::AssignPoseCache(cache, evaluations, clips, samplesPerSecond * 0.5f);
+		HV_CHECK(cache.NumberOfLookups == 4);
+		HV_CHECK(cache.SharedPoses.size() == 2);
+		HV_CHECK(evaluations.size() == 2);
+
+		// Off, nothing is looked up or rounded
+		gather();
+		CAnimatorGraphSystem::AssignPoseCache(cache, evaluations, clips, 0.0f);
+		HV_CHECK(cache.NumberOfLookups == 0);
+		HV_CHECK(evaluations.size() == 4);
+		HV_CHECK(clips[0].AnimationTime == animationTimes[0]);
+	}
+
+	HV_TEST(Animation_AtlasBakeIsDeterministicAndDecodes)
+	{
+		const SSkeletalMeshAsset mesh = MakeSkeleton(15);
+		const SSkeletalAnimationAsset animation = MakeClip(15, 20.0f);
+
+		SSkeletalAnimationBinding binding;
+		CAnimatorGraphSystem::BuildBinding(&mesh, &animation, binding);
+
+		constexpr F32 samplesPerSecond = 30.0f;
+		SBakedAnimationClip clip;
+		CAnimatorGraphSystem::BakeClip(&mesh, &animation, binding, samplesPerSecond, clip);
+		SBakedAnimationClip secondClip;
+		CAnimatorGraphSystem::BakeClip(&mesh, &animation, binding, samplesPerSecond, secondClip);
+
+		const U64 halvesPerFrame = STATIC_U64(clip.NumberOfBones) * UAnimationAtlas::TexelsPerBone * UAnimationAtlas::HalvesPerTexel;
+		HV_CHECK(clip.NumberOfFrames == STATIC_U32(std::ceil(STATIC_F32(DurationInTicks) / TickRate * samplesPerSecond)));
+		HV_CHECK(clip.NumberOfBones == mesh.BindPoseBones.size());
+		HV_CHECK(clip.Halves.size() == clip.NumberOfFrames * halvesPerFrame);
+		HV_CHECK(clip.Halves == secondClip.Halves);
+
+		F32 maxRotationError = 0.0f;
+		F32 maxTranslationError = 0.0f;
+		for (U32 frame = 0; frame < clip.NumberOfFrames; frame++)
+		{
+			std::vector<SBoneTrackCursor> cursors;
+			const F32 animationTime = fmodf(STATIC_F32(frame) / samplesPerSecond * TickRate, STATIC_F32(DurationInTicks));
+			const std::vector<SMatrix> bones = Evaluate(mesh, animation, binding, animationTime, cursors);
+			for (U32 boneIndex = 0; boneIndex < clip.NumberOfBones; boneIndex++)
+			{
+				const SMatrix decodedBone = UAnimationAtlas::DecodeBone(&clip.Halves[frame * halvesPerFrame + STATIC_U64(boneIndex) * UAnimationAtlas::TexelsPerBone * UAnimationAtlas::HalvesPerTexel]);
+				maxRotationError = UMath::Max(maxRotationError, GetMaxDifference(decodedBone, bones[boneIndex], 0, 11));
+				maxTranslationError = UMath::Max(maxTranslationError, GetMaxDifference(decodedBone, bones[boneIndex], 12, 15));
+			}
+		}
+
+		// Half precision, translations are a few units at most
+		HV_CHECK(maxRotationError < 0.002f);
+		HV_CHECK(maxTranslationError < 0.01f);
+	}
+
+	HV_BENCHMARK(Animation_EvaluateCrowd)
+	{
+		constexpr U32 numberOfCharacters = 1000;
+		constexpr U32 numberOfFrames = 60;
+		SCrowd crowd(numberOfCharacters, 63);
+
+		// One character at a time, both clips read and blended by hand
+		SSkeletalPose walkPose;
+		SSkeletalPose runPose;
+		SSkeletalPose blendedPose;
+		std::vector<SMatrix> globalTransforms;
+		std::vector<SMatrix> bones;
+		auto startTime = std::chrono::high_resolution_clock::now();
+		for (U32 frame = 0; frame < numberOfFrames; frame++)
+		{
+			crowd.Gather(frame);
+			for (const SSkeletalAnimationEvaluation& evaluation : crowd.Evaluations)
+			{
+				const SSkeletalAnimationClipEvaluation& walk = crowd.Clips[evaluation.FirstClip];
+				const SSkeletalAnimationClipEvaluation& run = crowd.Clips[evaluation.FirstClip + 1];
+				CAnimatorGraphSystem::ReadAnimationLocalPose(walk.Animation, *walk.Binding, walk.AnimationTime, walk.Binding->EvaluationOrder, walk.PlayData->TrackCursors, walkPose);
+				CAnimatorGraphSystem::ReadAnimationLocalPose(run.Animation, *run.Binding, run.AnimationTime, run.Binding->EvaluationOrder, run.PlayData->TrackCursors, runPose);
+				USkeletalPose::Blend(walkPose, runPose, run.Weight, blendedPose);
+				CAnimatorGraphSystem::ApplyLocalPoseToHierarchy(*evaluation.Binding, blendedPose, SMatrix::Identity, globalTransforms);
+				CAnimatorGraphSystem::ApplyInverseBindPose(evaluation.Mesh, *evaluation.Binding, globalTransforms, bones);
+			}
+		}
+		const F32 milliseconds = std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		// The crowd as Update evaluates it, on the calling thread and then fanned out over the job threads
+		auto timeEvaluation = [&](CThreadManager* threadManager)
+			{
+				const auto evaluationStartTime = std::chrono::high_resolution_clock::now();
+				for (U32 frame = 0; frame < numberOfFrames; frame++)
+				{
+					crowd.Gather(frame);
+					CAnimatorGraphSystem::EvaluateComponents(crowd.Evaluations, crowd.Clips, threadManager);
+				}
+				return std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - evaluationStartTime).count();
+			};
+
+		const F32 serialMilliseconds = timeEvaluation(nullptr);
+		const std::vector<std::vector<SMatrix>> serialBones = crowd.CopyBones();
+
+		CThreadManager threadManager;
+		threadManager.Init(nullptr);
+		const F32 parallelMilliseconds = timeEvaluation(&threadManager);
+		const U32 numberOfThreads = STATIC_U32(threadManager.GetNumberOfThreads()) + 1;
+		threadManager.Shutdown();
+
+		// The same characters evaluated by name, the way poses were read before bindings
+		const U32 numberOfReferenceCharacters = numberOfCharacters / 10;
+		const auto referenceStartTime = std::chrono::high_resolution_clock::now();
+		std::vector<SMatrix> referenceBones;
+		for (U32 character = 0; character < numberOfReferenceCharacters; character++)
+			referenceBones = EvaluateByName(crowd.Mesh, crowd.Walk, fmodf(STATIC_F32(character) * 0.37f, STATIC_F32(DurationInTicks)));
+		const F32 referenceMilliseconds = std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - referenceStartTime).count();
+
+		HV_LOG_INFO("Animation: %u characters blending 2 clips of %u bones, per frame: one at a time %.3f ms, batched %.3f ms, batched on %u threads %.3f ms. By name %.3f ms for one clip.",
+			numberOfCharacters, STATIC_U32(crowd.Mesh.BindPoseBones.size()), milliseconds / numberOfFrames, serialMilliseconds / numberOfFrames,
+			numberOfThreads, parallelMilliseconds / numberOfFrames, referenceMilliseconds * (numberOfCharacters / numberOfReferenceCharacters));
+		HV_CHECK(bones.size() == crowd.Mesh.BindPoseBones.size());
+		HV_CHECK(referenceBones.size() == crowd.Mesh.BindPoseBones.size());
+		HV_CHECK(crowd.GetMaxDifference(serialBones) == 0.0f);
+	}
+
+	HV_BENCHMARK(Animation_BlendTreeCrowd)
+	{
+		constexpr U32 numberOfCharacters = 1000;
+		constexpr U32 numberOfFrames = 60;
+		constexpr U32 numberOfTreeClips = 6;
+		SCrowd crowd(numberOfCharacters, 63);
+
+		// The walk and the run twice each in the corners of a 2D blend space, then once each on an override and an additive
+		// layer masked to a subtree a third down the skeleton
+		const std::vector<U32>& evaluationOrder = crowd.WalkBinding.EvaluationOrder;
+		const std::string maskRoot = crowd.Mesh.Nodes[evaluationOrder[evaluationOrder.size() / 3]].Name.AsString();
+		const SVector2<F32> cornerPositions[4] = { SVector2<F32>(0.0f, 0.0f), SVector2<F32>(1.0f, 0.0f), SVector2<F32>(0.0f, 1.0f), SVector2<F32>(1.0f, 1.0f) };
+		for (SSkeletalAnimationComponent& component : crowd.Characters)
+		{
+			component.PlayData.assign(numberOfTreeClips, SSkeletalAnimationPlayData());
+			for (U32 i = 0; i < numberOfTreeClips; i++)
+			{
+				component.PlayData[i].LayerIndex = i < 4 ? 0 : i - 3;
+				component.PlayData[i].BlendPosition = i < 4 ? cornerPositions[i] : SVector2<F32>::Zero;
+			}
+
+			component.Layers.assign(3, SSkeletalAnimationLayer());
+			component.Layers[1].MaskRoots = { maskRoot };
+			component.Layers[1].Weight = 0.75f;
+			component.Layers[2].BlendMode = ESkeletalAnimationLayerBlendMode::Additive;
+			component.Layers[2].MaskRoots = { maskRoot };
+			component.Layers[2].Weight = 0.5f;
+		}
+
+		// Gathered and weighed the way Update does, with the blend parameter circling the space
+		std::vector<SSkeletalAnimationClipEvaluation> clips;
+		std::vector<SVector2<F32>> blendPositions;
+		std::vector<F32> blendWeights;
+		auto gather = [&](const U32 frame)
+			{
+				clips.clear();
+				for (U32 character = 0; character < numberOfCharacters; character++)
+				{
+					SSkeletalAnimationComponent& component = crowd.Characters[character];
+					const F32 angle = STATIC_F32(character) * 0.618f + STATIC_F32(frame) * 0.05f;
+					component.Layers[0].BlendParameter = SVector2<F32>(0.5f + 0.5f * UMath::Cos(angle), 0.5f + 0.5f * UMath::Sin(angle));
+
+					SSkeletalAnimationEvaluation& evaluation = crowd.Evaluations[character];
+					evaluation.Component = &component;
+					evaluation.Mesh = &crowd.Mesh;
+					evaluation.Binding = &crowd.WalkBinding;
+					evaluation.FirstClip = STATIC_U32(clips.size());
+					for (U32 i = 0; i < numberOfTreeClips; i++)
+					{
+						const bool isRunning = i % 2 == 1;
+						const F32 animationTime = fmodf(STATIC_F32(frame) * 0.5f + STATIC_F32(character) * 0.37f + STATIC_F32(i) * 0.25f, STATIC_F32(DurationInTicks));
+						clips.push_back({ &component.PlayData[i], isRunning ? &crowd.Run : &crowd.Walk, isRunning ? &crowd.RunBinding : &crowd.WalkBinding, nullptr, animationTime, component.PlayData[i].LayerIndex, 1.0f });
+					}
+
+					CAnimatorGraphSystem::WeighClips(evaluation, clips, blendPositions, blendWeights);
+				}
+			};
+
+		auto timeEvaluation = [&](CThreadManager* threadManager)
+			{
+				const auto startTime = std::chrono::high_resolution_clock::now();
+				for (U32 frame = 0; frame < numberOfFrames; frame++)
+				{
+					gather(frame);
+					CAnimatorGraphSystem::EvaluateComponents(crowd.Evaluations, clips, threadManager);
+				}
+				return std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+			};
+
+		const F32 serialMilliseconds = timeEvaluation(nullptr);
+		const std::vector<std::vector<SMatrix>> serialBones = crowd.CopyBones();
+
+		CThreadManager threadManager;
+		threadManager.Init(nullptr);
+		const F32 parallelMilliseconds = timeEvaluation(&threadManager);
+		const U32 numberOfThreads = STATIC_U32(threadManager.GetNumberOfThreads()) + 1;
+		threadManager.Shutdown();
+
+		// Node samples of the last frame, against reading every clip for every node
+		U64 sampledNodes = 0;
+		U64 fullySampledNodes = 0;
+		U32 maxNumberOfClips = 0;
+		for (const SSkeletalAnimationEvaluation& evaluation : crowd.Evaluations)
+		{
+			for (U32 i = evaluation.FirstClip; i < evaluation.FirstClip + evaluation.NumberOfClips; i++)
+			{
+				const SSkeletalAnimationLayer& layer = evaluation.Component->Layers[clips[i].LayerIndex];
+				sampledNodes += layer.MaskRoots.empty() ? evaluation.Binding->EvaluationOrder.size() : layer.MaskNodeIndices.size();
+			}
+			fullySampledNodes += STATIC_U64(numberOfTreeClips) * evaluation.Binding->EvaluationOrder.size();
+			maxNumberOfClips = UMath::Max(maxNumberOfClips, evaluation.NumberOfClips);
+		}
+
+		const F32 sampledPercentage = fullySampledNodes > 0 ? 100.0f * STATIC_F32(sampledNodes) / STATIC_F32(fullySampledNodes) : 0.0f;
+		HV_LOG_INFO("Blend tree: %u characters, %u clips on 3 layers, per frame: %.3f ms on one thread, %.3f ms on %u threads. %.1f%% of the node samples of reading every clip in full.",
+			numberOfCharacters, numberOfTreeClips, serialMilliseconds / numberOfFrames, parallelMilliseconds / numberOfFrames, numberOfThreads, sampledPercentage);
+
+		// The blend space never weighs more than the three corners of a triangle, and the masks leave most of the skeleton out
+		HV_CHECK(maxNumberOfClips <= 5);
+		HV_CHECK(!crowd.Characters[0].Layers[1].MaskNodeIndices.empty());
+		HV_CHECK(crowd.Characters[0].Layers[1].MaskNodeIndices.size() < evaluationOrder.size());
+		HV_CHECK(sampledNodes < fullySampledNodes);
+		HV_CHECK(crowd.GetMaxDifference(serialBones) == 0.0f);
+	}
+
+	HV_BENCHMARK(Animation_PoseCacheCrowd)
+	{
+		constexpr U32 numberOfCharacters = 1000;
+		constexpr U32 numberOfFrames = 60;
+		constexpr U32 numberOfPhases = 16;
+		constexpr F32 samplesPerSecond = 60.0f;
+		SCrowd crowd(numberOfCharacters, 63);
+
+		CThreadManager threadManager;
+		threadManager.Init(nullptr);
+
+		// Every character evaluated in full, against sharing the palette of the first character in the same clip and phase
+		auto startTime = std::chrono::high_resolution_clock::now();
+		for (U32 frame = 0; frame < numberOfFrames; frame++)
+		{
+			crowd.GatherPhases(frame, numberOfPhases);
+			CAnimatorGraphSystem::EvaluateComponents(crowd.Evaluations, crowd.Clips, &threadManager);
+		}
+		const F32 uncachedMilliseconds = std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		const std::vector<std::vector<SMatrix>> uncachedBones = crowd.CopyBones();
+
+		SAnimationPoseCache cache;
+		U64 numberOfLookups = 0;
+		U64 numberOfSharedPoses = 0;
+		startTime = std::chrono::high_resolution_clock::now();
+		for (U32 frame = 0; frame < numberOfFrames; frame++)
+		{
+			crowd.GatherPhases(frame, numberOfPhases);
+			CAnimatorGraphSystem::AssignPoseCache(cache, crowd.Evaluations, crowd.Clips, samplesPerSecond);
+			CAnimatorGraphSystem::EvaluateComponents(crowd.Evaluations, crowd.Clips, &threadManager);
+			CAnimatorGraphSystem::ApplySharedPoses(cache);
+			numberOfLookups += cache.NumberOfLookups;
+			numberOfSharedPoses += cache.SharedPoses.size();
+		}
+		const F32 cachedMilliseconds = std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		const U32 numberOfThreads = STATIC_U32(threadManager.GetNumberOfThreads()) + 1;
+		threadManager.Shutdown();
+
+		// Times advance by half a tick per frame from phases on whole ticks, which are all on the cache's samples
+		const F32 maxDifference = crowd.GetMaxDifference(uncachedBones);
+		const F32 hitRate = numberOfLookups > 0 ? 100.0f * STATIC_F32(numberOfSharedPoses) / STATIC_F32(numberOfLookups) : 0.0f;
+		HV_LOG_INFO("Pose cache: %u characters playing 2 clips in %u phases on %u threads, %.0f samples per second. %.1f%% hit rate, %.3f ms per frame against %.3f ms uncached, %.3f ms saved. Max difference %.6f.",
+			numberOfCharacters, numberOfPhases, numberOfThreads, samplesPerSecond, hitRate, cachedMilliseconds / numberOfFrames, uncachedMilliseconds / numberOfFrames,
+			(uncachedMilliseconds - cachedMilliseconds) / numberOfFrames, maxDifference);
+		HV_CHECK(numberOfLookups == STATIC_U64(numberOfCharacters) * numberOfFrames);
+		HV_CHECK(numberOfSharedPoses == STATIC_U64(numberOfCharacters - 2 * numberOfPhases) * numberOfFrames);
+		HV_CHECK(maxDifference < 0.0001f);
+	}
+}
@@ -0,0 +1,242 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <Assets/AssetArchive.h>
+#include <Assets/AssetIndex.h>
+#include <Assets/FileHeaderDeclarations.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace Havtorn
+{
+	namespace
+	{
+		SStaticModelFileHeader MakeModel(const U32 resolution, const F32 height)
+		{
+			SStaticModelFileHeader header;
+			header.Name = "ArchiveTestModel";
+			header.NumberOfMaterials = 1;
+			header.NumberOfMeshes = 1;
+
+			SStaticMesh& mesh = header.Meshes.emplace_back();
+			mesh.Name = "Grid";
+			for (U32 z = 0; z <= resolution; z++)
+			{
+				for (U32 x = 0; x <= resolution; x++)
+				{
+					const F32 u = STATIC_F32(x) / resolution;
+					const F32 v = STATIC_F32(z) / resolution;
+					mesh.Vertices.push_back({ u, height * u * v, v, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, u, v });
+				}
+			}
+
+			for (U32 z = 0; z < resolution; z++)
+			{
+				for (U32 x = 0; x < resolution; x++)
+				{
+					const U32 corner = z * (resolution + 1) + x;
+					mesh.Indices.insert(mesh.Indices.end(), { corner, corner + resolution + 1, corner + 1, corner + 1, corner + resolution + 1, corner + resolution + 2 });
+				}
+			}
+			return header;
+		}
+
+		void WriteModel(const std::string& filePath, const SStaticModelFileHeader& header)
+		{
+			std::vector<char> data(header.GetSize());
+			header.Serialize(data.data());
+			std::ofstream stream(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+			stream.write(data.data(), STATIC_I64(data.size()));
+		}
+
+		// Models spread over nested directories, plus a file that isn't an asset in every directory. Returns the model paths.
+		std::vector<std::string> MakeAssetTree(const std::string& rootPath, const U32 numberOfDirectories, const U32 modelsPerDirectory, const U32 resolution)
+		{
+			std::vector<std::string> filePaths;
+			std::string directory = rootPath;
+			for (U32 directoryIndex = 0; directoryIndex < numberOfDirectories; directoryIndex++)
+			{
+				directory += "/Directory" + std::to_string(directoryIndex);
+				std::filesystem::create_directories(directory);
+				std::ofstream(directory + "/Notes.txt") << "Not an asset";
+
+				for (U32 modelIndex = 0; modelIndex < modelsPerDirectory; modelIndex++)
+				{
+					const std::string filePath = directory + "/Model" + std::to_string(modelIndex) + ".hva";
+					WriteModel(filePath, MakeModel(resolution, STATIC_F32(directoryIndex * modelsPerDirectory + modelIndex)));
+					filePaths.push_back(filePath);
+				}
+			}
+			return filePaths;
+		}
+
+		std::vector<char> ReadFile(const std::string& filePath)
+		{
+			CMappedFile file;
+			if (!file.Open(filePath))
+				return {};
+
+			return std::vector<char>(file.GetData(), file.GetData() + file.GetSize());
+		}
+	}
+
+	HV_TEST(AssetArchive_EntriesMatchLooseFiles)
+	{
+		const CTestDirectory directory("AssetArchive");
+		const std::vector<std::string> filePaths = MakeAssetTree(directory.Path + "/Assets", 3, 4, 16);
+
+		for (const bool shouldCompress : { false, true })
+		{
+			const std::string archivePath = directory.Path + (shouldCompress ? "/Compressed.hvpak" : "/Stored.hvpak");
+			HV_CHECK(UAssetArchivePacker::Pack({ directory.Path + "/Assets" }, archivePath, shouldCompress));
+
+			CAssetArchive archive;
+			HV_CHECK(archive.Mount(archivePath));
+			HV_CHECK(archive.GetEntries().size() == filePaths.size());
+			HV_CHECK(archive.FindEntry(SAssetReference(directory.Path + "/Assets/Missing.hva").UID) == nullptr);
+
+			U32 numberOfCompressedEntries = 0;
+			std::vector<char> buffer;
+			for (const SAssetArchiveEntry& entry : archive.GetEntries())
+			{
+				const std::string entryPath = archive.GetEntryPath(entry);
+				HV_CHECK(archive.FindEntry(SAssetReference(entryPath).UID) == &entry);
+
+				const std::vector<char> looseData = ReadFile(entryPath);
+				HV_CHECK(entry.Size == looseData.size());
+
+				const char* data = nullptr;
+				HV_CHECK(archive.ReadEntry(entry, buffer, data));
+				HV_CHECK(data != nullptr && std::memcmp(data, looseData.data(), looseData.size()) == 0);
+
+				if (entry.IsCompressed())
+					numberOfCompressedEntries++;
+				else
+					HV_CHECK(entry.Offset % SerializedBlobAlignment == 0);
+			}
+
+			HV_CHECK(shouldCompress ? numberOfCompressedEntries > 0 : numberOfCompressedEntries == 0);
+			archive.Unmount();
+		}
+	}
+
+	HV_TEST(AssetIndex_RefreshOnlyListsChangedDirectories)
+	{
+		const CTestDirectory directory("AssetIndex");
+		const std::string rootPath = directory.Path + "/Assets";
+		std::vector<std::string> filePaths = MakeAssetTree(rootPath, 4, 3, 4);
+
+		CAssetIndex index;
+		HV_CHECK(index.Refresh({ rootPath }) == 5);
+		HV_CHECK(index.GetEntries().size() == filePaths.size());
+		for (const std::string& filePath : filePaths)
+		{
+			const SAssetIndexEntry* entry = index.FindEntry(SAssetReference(filePath).UID);
+			HV_CHECK(entry != nullptr && entry->Type == EAssetType::StaticMesh);
+		}
+
+		// Nothing changed, so no directory is listed again
+		HV_CHECK(index.Refresh({ rootPath }) == 0);
+		HV_CHECK(index.GetEntries().size() == filePaths.size());
+
+		const std::string newFilePath = rootPath + "/Directory0/Directory1/NewModel.hva";
+		WriteModel(newFilePath, MakeModel(4, 0.0f));
+		HV_CHECK(index.Refresh({ rootPath }) == 1);
+		HV_CHECK(index.FindEntry(SAssetReference(newFilePath).UID) != nullptr);
+		HV_CHECK(index.GetEntries().size() == filePaths.size() + 1);
+
+		// The saved index knows every directory, so a refresh after loading it lists none
+		const std::string indexPath = directory.Path + "/AssetIndex.hvix";
+		HV_CHECK(index.Save(indexPath));
+		CAssetIndex loadedIndex;
+		HV_CHECK(loadedIndex.Load(indexPath));
+		HV_CHECK(loadedIndex.GetEntries().size() == index.GetEntries().size());
+		HV_CHECK(loadedIndex.Refresh({ rootPath }) == 0);
+	}
+
+	HV_BENCHMARK(AssetLoading_MappedArchiveAndIndex)
+	{
+		const CTestDirectory directory("AssetLoading");
+		const std::string rootPath = directory.Path + "/Assets";
+		const std::vector<std::string> filePaths = MakeAssetTree(rootPath, 8, 16, 64);
+		using SClock = std::chrono::high_resolution_clock;
+		auto getMilliseconds = [](const SClock::time_point startTime) { return std::chrono::duration<F32, std::milli>(SClock::now() - startTime).count(); };
+
+		// Read into a buffer and copied out of it, against used in place from a mapping
+		U64 numberOfVertices = 0;
+		auto startTime = SClock::now();
+		for (const std::string& filePath : filePaths)
+		{
+			const std::vector<char> data = ReadFile(filePath);
+			SStaticModelFileHeader header;
+			header.Deserialize(data.data(), data.size());
+			numberOfVertices += header.GetVertices(0, 0).size();
+		}
+		const F32 bufferedMilliseconds = getMilliseconds(startTime);
+
+		U64 numberOfMappedVertices = 0;
+		startTime = SClock::now();
+		for (const std::string& filePath : filePaths)
+		{
+			CMappedFile file;
+			HV_CHECK(file.Open(filePath));
+			SStaticModelFileHeader header;
+			header.Deserialize(file.GetData(), file.GetSize(), true);
+			numberOfMappedVertices += header.GetVertices(0, 0).size();
+		}
+		const F32 mappedMilliseconds = getMilliseconds(startTime);
+		HV_CHECK(numberOfMappedVertices == numberOfVertices);
+
+		// Every file read from one mounted archive
+		const std::string archivePath = directory.Path + "/Assets.hvpak";
+		HV_CHECK(UAssetArchivePacker::Pack({ rootPath }, archivePath, false));
+		startTime = SClock::now();
+		CAssetArchive archive;
+		HV_CHECK(archive.Mount(archivePath));
+		std::vector<char> buffer;
+		U64 numberOfArchiveVertices = 0;
+		for (const std::string& filePath : filePaths)
+		{
+			const SAssetArchiveEntry* entry = archive.FindEntry(SAssetReference(filePath).UID);
+			const char* data = nullptr;
+			if (entry == nullptr || !archive.ReadEntry(*entry, buffer, data))
+				continue;
+
+			SStaticModelFileHeader header;
+			header.Deserialize(data, entry->Size, true);
+			numberOfArchiveVertices += header.GetVertices(0, 0).size();
+		}
+		const F32 archiveMilliseconds = getMilliseconds(startTime);
+		HV_CHECK(numberOfArchiveVertices == numberOfVertices);
+
+		// Walking every directory and opening every asset, against refreshing an index nothing changed for
+		startTime = SClock::now();
+		U32 numberOfWalkedFiles = 0;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(rootPath))
+		{
+			if (entry.is_directory() || entry.path().extension() != ".hva")
+				continue;
+
+			CMappedFile file;
+			U64 pointerPosition = 0;
+			if (file.Open(entry.path().string()) && DeserializeAssetType(file.GetData(), pointerPosition) != EAssetType::None)
+				numberOfWalkedFiles++;
+		}
+		const F32 walkMilliseconds = getMilliseconds(startTime);
+
+		CAssetIndex index;
+		index.Refresh({ rootPath });
+		startTime = SClock::now();
+		const U32 numberOfListedDirectories = index.Refresh({ rootPath });
+		const F32 refreshMilliseconds = getMilliseconds(startTime);
+		HV_CHECK(numberOfWalkedFiles == filePaths.size());
+		HV_CHECK(numberOfListedDirectories == 0);
+
+		HV_LOG_INFO("Asset loading: %u files, buffered %.2f ms, mapped %.2f ms, archive %.2f ms. Directory walk %.2f ms, index refresh %.2f ms.",
+			STATIC_U32(filePaths.size()), bufferedMilliseconds, mappedMilliseconds, archiveMilliseconds, walkMilliseconds, refreshMilliseconds);
+	}
+}
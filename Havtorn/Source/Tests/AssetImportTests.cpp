@@ -0,0 +1,173 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <Assets/AssetRegistry.h>
+#include <Threading/ThreadManager.h>
+
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+
+namespace Havtorn
+{
+	namespace
+	{
+		void WriteFile(const std::string& filePath, const char* data, const U64 size)
+		{
+			std::ofstream stream(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+			stream.write(data, STATIC_I64(size));
+		}
+
+		// Uncompressed 32 bit TGA, a gradient with some noise so compressed saves have something to do
+		std::vector<char> MakeTexture(const U16 textureSize, const U32 seed)
+		{
+			std::vector<char> data(18 + STATIC_U64(textureSize) * textureSize * 4, 0);
+			data[2] = 2;
+			memcpy(&data[12], &textureSize, sizeof(U16));
+			memcpy(&data[14], &textureSize, sizeof(U16));
+			data[16] = 32;
+			data[17] = 0x28;
+
+			U32 noise = seed + 1;
+			for (U64 pixel = 0; pixel < STATIC_U64(textureSize) * textureSize; pixel++)
+			{
+				noise = noise * 1664525u + 1013904223u;
+				char* texel = &data[18 + pixel * 4];
+				texel[0] = STATIC_I8((pixel % textureSize) + seed);
+				texel[1] = STATIC_I8((pixel / textureSize) + (noise >> 29));
+				texel[2] = STATIC_I8(seed * 16);
+				texel[3] = STATIC_I8(255);
+			}
+			return data;
+		}
+
+		// A wavy grid with positions, UVs and normals, which is all the model importer needs
+		std::string MakeModel(const U32 resolution, const U32 seed)
+		{
+			std::string obj;
+			for (U32 z = 0; z <= resolution; z++)
+			{
+				for (U32 x = 0; x <= resolution; x++)
+				{
+					const F32 u = STATIC_F32(x) / resolution;
+					const F32 v = STATIC_F32(z) / resolution;
+					obj += std::format("v {} {} {}\nvt {} {}\nvn 0 1 0\n", u, 0.1f * UMath::Sin(u * 6.0f + STATIC_F32(seed)) * UMath::Cos(v * 5.0f), v, u, v);
+				}
+			}
+
+			// OBJ indices start at 1, and every vertex has its own UV and normal
+			auto addTriangle = [&obj](const U32 a, const U32 b, const U32 c)
+				{
+					obj += std::format("f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", a + 1, b + 1, c + 1);
+				};
+
+			for (U32 z = 0; z < resolution; z++)
+			{
+				for (U32 x = 0; x < resolution; x++)
+				{
+					const U32 corner = z * (resolution + 1) + x;
+					addTriangle(corner, corner + resolution + 1, corner + 1);
+					addTriangle(corner + 1, corner + resolution + 1, corner + resolution + 2);
+				}
+			}
+			return obj;
+		}
+	}
+
+	HV_BENCHMARK(AssetImport_BatchThroughput)
+	{
+		constexpr U32 numberOfTextures = 48;
+		constexpr U32 numberOfModels = 16;
+		constexpr U16 textureSize = 512;
+		constexpr U32 modelResolution = 64;
+		const CTestDirectory directory("ImportBenchmark");
+
+		CAssetRegistry assetRegistry;
+		U64 corpusBytes = 0;
+
+		// Every pass imports its own copies of the sources, keyed on their paths in the derived data cache, so none of them is
+		// served from it. Straight through RunImportBatch, without a database to add them to.
+		auto makeBatch = [&](const std::string& passName, SAssetBatchImportState& outBatch)
+			{
+				const std::string sourceDirectory = std::format("{}/{}Source/", directory.Path, passName);
+				const std::string destinationDirectory = std::format("{}/{}/", directory.Path, passName);
+				std::filesystem::create_directories(sourceDirectory);
+				std::filesystem::create_directories(destinationDirectory);
+				corpusBytes = 0;
+
+				for (U32 fileIndex = 0; fileIndex < numberOfTextures; fileIndex++)
+				{
+					const std::vector<char> texture = MakeTexture(textureSize, fileIndex);
+					SAssetImportRequest& request = outBatch.Requests.emplace_back();
+					request.FilePath = std::format("{}T_ImportBenchmark{}_c.tga", sourceDirectory, fileIndex);
+					request.DestinationPath = destinationDirectory;
+					request.SourceData.AssetType = EAssetType::Texture;
+					request.SourceData.SourcePath = request.FilePath;
+					WriteFile(request.FilePath, texture.data(), texture.size());
+					corpusBytes += texture.size();
+				}
+
+				for (U32 fileIndex = 0; fileIndex < numberOfModels; fileIndex++)
+				{
+					const std::string model = MakeModel(modelResolution, fileIndex);
+					SAssetImportRequest& request = outBatch.Requests.emplace_back();
+					request.FilePath = std::format("{}SM_ImportBenchmark{}.obj", sourceDirectory, fileIndex);
+					request.DestinationPath = destinationDirectory;
+					request.SourceData.AssetType = EAssetType::StaticMesh;
+					request.SourceData.SourcePath = request.FilePath;
+					WriteFile(request.FilePath, model.data(), model.size());
+					corpusBytes += model.size();
+				}
+			};
+
+		auto timeImport = [&](SAssetBatchImportState& batch, CThreadManager* threadManager)
+			{
+				const auto startTime = std::chrono::high_resolution_clock::now();
+				assetRegistry.RunImportBatch(batch, threadManager);
+				return std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+			};
+
+		SAssetBatchImportState serialBatch;
+		makeBatch("Serial", serialBatch);
+		const F32 serialMilliseconds = timeImport(serialBatch, nullptr);
+
+		CThreadManager threadManager;
+		threadManager.Init(nullptr);
+		SAssetBatchImportState parallelBatch;
+		makeBatch("Parallel", parallelBatch);
+		const F32 parallelMilliseconds = timeImport(parallelBatch, &threadManager);
+		const U32 numberOfThreads = STATIC_U32(threadManager.GetNumberOfThreads()) + 1;
+		threadManager.Shutdown();
+
+		// The models were added to the derived data cache on the way, take them out again
+		for (const SAssetBatchImportState* batch : { &serialBatch, &parallelBatch })
+		{
+			for (const SAssetImportRequest& request : batch->Requests)
+			{
+				if (request.SourceData.AssetType != EAssetType::StaticMesh)
+					continue;
+
+				std::error_code error;
+				const U64 key = CDerivedDataCache::GetKey(request.FilePath, request.SourceData, request.LODSettings, assetRegistry.ShouldCompressPayloads, assetRegistry.ShouldQuantizeVertices);
+				std::filesystem::remove(CDerivedDataCache::GetEntryPath(key), error);
+			}
+		}
+
+		constexpr U32 numberOfFiles = numberOfTextures + numberOfModels;
+		HV_LOG_INFO("Asset import: %u textures and %u models, %.2f MB per pass | Serial: %.2f ms (%.1f files/s) | Batch on %u threads: %.2f ms (%.1f files/s)",
+			numberOfTextures, numberOfModels, STATIC_F32(corpusBytes) / (1024.0f * 1024.0f),
+			serialMilliseconds, STATIC_F32(numberOfFiles) * 1000.0f / UMath::Max(serialMilliseconds, 0.001f),
+			numberOfThreads, parallelMilliseconds, STATIC_F32(numberOfFiles) * 1000.0f / UMath::Max(parallelMilliseconds, 0.001f));
+
+		HV_CHECK(serialBatch.NumberOfFailed == 0);
+		HV_CHECK(parallelBatch.NumberOfFailed == 0);
+		HV_CHECK(serialBatch.NumberOfFinished == numberOfFiles);
+		HV_CHECK(parallelBatch.NumberOfFinished == numberOfFiles);
+		HV_CHECK(serialBatch.ImportedPaths.size() == numberOfFiles);
+		HV_CHECK(parallelBatch.ImportedPaths.size() == numberOfFiles);
+		for (const std::string& hvaPath : parallelBatch.ImportedPaths)
+			HV_CHECK(std::filesystem::exists(hvaPath));
+	}
+}
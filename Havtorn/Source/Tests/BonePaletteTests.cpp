@@ -0,0 +1,147 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <ECS/Components/SkeletalAnimationComponent.h>
+#include <ECS/Components/TransformComponent.h>
+#include <Graphics/AnimationAtlas.h>
+#include <Graphics/RenderManager.h>
+
+namespace Havtorn
+{
+	namespace
+	{
+		constexpr U32 NumberOfMeshes = 3;
+
+		U32 GetNumberOfBones(const U32 meshUID)
+		{
+			return 16 + 24 * meshUID;
+		}
+
+		// Every bone of every instance is told apart by its translation
+		SVector GetBoneTranslation(const U32 instance, const U32 bone, const U32 meshUID)
+		{
+			return SVector(STATIC_F32(instance), STATIC_F32(bone), STATIC_F32(meshUID));
+		}
+
+		struct SBonePaletteInstance
+		{
+			STransformComponent Transform;
+			SSkeletalAnimationComponent Animation;
+			U32 MeshUID = 0;
+		};
+
+		// Every 17th instance has an animation component without an owner, every 23rd reads its frame from the atlas
+		std::vector<SBonePaletteInstance> MakeInstances(const U32 numberOfInstances)
+		{
+			std::vector<SBonePaletteInstance> instances(numberOfInstances);
+			for (U32 instance = 0; instance < numberOfInstances; instance++)
+			{
+				SBonePaletteInstance& data = instances[instance];
+				const SEntity entity = { STATIC_U64(instance) + 1 };
+				data.MeshUID = instance % NumberOfMeshes;
+				data.Transform.Owner = entity;
+				data.Transform.Transform.Translate(SVector(STATIC_F32(instance), 0.0f, 0.0f));
+
+				if (instance % 17 != 16)
+					data.Animation.Owner = entity;
+
+				if (instance % 23 == 22)
+				{
+					data.Animation.AtlasFrameTexel = instance * 100;
+					data.Animation.AtlasNumberOfBones = GetNumberOfBones(data.MeshUID);
+					continue;
+				}
+
+				for (U32 bone = 0; bone < GetNumberOfBones(data.MeshUID); bone++)
+				{
+					SMatrix& matrix = data.Animation.Bones.emplace_back(SMatrix::Identity);
+					matrix.SetTranslation(GetBoneTranslation(instance, bone, data.MeshUID));
+				}
+			}
+			return instances;
+		}
+
+		// Walks the view's instance lists in the order the instances were added to them and checks their animation data
+		void CheckRenderView(const SRenderView& renderView, const std::vector<SBonePaletteInstance>& instances, const U32 bonePaletteLimit)
+		{
+			HV_CHECK(renderView.BonePalettes.size() <= bonePaletteLimit);
+
+			std::vector<U64> instanceIndices(NumberOfMeshes, 0);
+			U32 nextPaletteOffset = 0;
+			for (U32 instance = 0; instance < instances.size(); instance++)
+			{
+				const SBonePaletteInstance& data = instances[instance];
+				HV_CHECK(renderView.SkeletalMeshInstanceData.contains(data.MeshUID));
+				const SSkeletalMeshInstanceData& instanceData = renderView.SkeletalMeshInstanceData.at(data.MeshUID);
+				const U64 instanceIndex = instanceIndices[data.MeshUID]++;
+				HV_CHECK(instanceData.Entities[instanceIndex] == data.Transform.Owner);
+				HV_CHECK(instanceData.Transforms[instanceIndex].GetTranslation().X == STATIC_F32(instance));
+
+				const SVector2<U32>& animationData = instanceData.AnimationData[instanceIndex];
+				const bool isValid = SComponent::IsValid(&data.Animation);
+				if (isValid && data.Animation.AtlasNumberOfBones > 0)
+				{
+					HV_CHECK(animationData.X == data.Animation.AtlasFrameTexel);
+					HV_CHECK(animationData.Y == (data.Animation.AtlasNumberOfBones | UAnimationAtlas::InstanceFlag));
+					continue;
+				}
+
+				// Palettes are back to back, bind pose only for instances without bones or past the limit
+				HV_CHECK(animationData.X == nextPaletteOffset);
+				const U32 numberOfBones = STATIC_U32(data.Animation.Bones.size());
+				const bool fitsInLimit = nextPaletteOffset + numberOfBones <= bonePaletteLimit;
+				if (!isValid || !fitsInLimit)
+				{
+					HV_CHECK(animationData.Y == 0);
+					continue;
+				}
+
+				HV_CHECK(animationData.Y == numberOfBones);
+				for (U32 bone = 0; bone < numberOfBones; bone++)
+				{
+					const SVector translation = renderView.BonePalettes[STATIC_U64(nextPaletteOffset) + bone].GetTranslation();
+					const SVector expectedTranslation = GetBoneTranslation(instance, bone, data.MeshUID);
+					HV_CHECK(translation.X == expectedTranslation.X && translation.Y == expectedTranslation.Y && translation.Z == expectedTranslation.Z);
+				}
+				nextPaletteOffset += numberOfBones;
+			}
+
+			HV_CHECK(renderView.BonePalettes.size() == nextPaletteOffset);
+			for (U32 meshUID = 0; meshUID < NumberOfMeshes; meshUID++)
+			{
+				const SSkeletalMeshInstanceData& instanceData = renderView.SkeletalMeshInstanceData.at(meshUID);
+				HV_CHECK(instanceData.AnimationData.size() == instanceIndices[meshUID]);
+				HV_CHECK(instanceData.Transforms.size() == instanceIndices[meshUID]);
+			}
+		}
+	}
+
+	HV_TEST(BonePalettes_InstancesPointAtTheirOwnPalettes)
+	{
+		const std::vector<SBonePaletteInstance> instances = MakeInstances(300);
+		constexpr U32 bonePaletteLimit = 65536;
+
+		SRenderView renderView;
+		for (const SBonePaletteInstance& data : instances)
+			CRenderManager::AddSkeletalMeshToRenderView(renderView, data.MeshUID, &data.Transform, &data.Animation, bonePaletteLimit);
+
+		CheckRenderView(renderView, instances, bonePaletteLimit);
+	}
+
+	HV_TEST(BonePalettes_InstancesPastTheLimitUseBindPose)
+	{
+		const std::vector<SBonePaletteInstance> instances = MakeInstances(1000);
+		constexpr U32 bonePaletteLimit = 4096;
+
+		SRenderView renderView;
+		for (const SBonePaletteInstance& data : instances)
+			CRenderManager::AddSkeletalMeshToRenderView(renderView, data.MeshUID, &data.Transform, &data.Animation, bonePaletteLimit);
+
+		CheckRenderView(renderView, instances, bonePaletteLimit);
+
+		// The last instance with bones no longer fits, so it is drawn in bind pose
+		const SSkeletalMeshInstanceData& instanceData = renderView.SkeletalMeshInstanceData.at(instances.back().MeshUID);
+		HV_CHECK(instanceData.AnimationData.back().Y == 0);
+	}
+}
@@ -0,0 +1,238 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <Graphics/ClusteredLightCulling.h>
+
+#include <chrono>
+#include <random>
+
+namespace Havtorn
+{
+	namespace
+	{
+		SClusteredPointLight MakePointLight(const SVector& position, const F32 range)
+		{
+			SClusteredPointLight light;
+			light.PositionAndRange = SVector4(position.X, position.Y, position.Z, range);
+			light.ColorAndIntensity = SVector4(1.0f, 1.0f, 1.0f, 1.0f);
+			return light;
+		}
+
+		SClusteredSpotLight MakeSpotLight(const SVector& position, const SVector& direction, const F32 range, const F32 outerAngleDegrees)
+		{
+			SClusteredSpotLight light;
+			light.PositionAndRange = SVector4(position.X, position.Y, position.Z, range);
+			light.ColorAndIntensity = SVector4(1.0f, 1.0f, 1.0f, 1.0f);
+			light.Direction = SVector4(direction.X, direction.Y, direction.Z, 0.0f);
+			light.CosOuterAngle = UMath::Cos(UMath::DegToRad(outerAngleDegrees));
+			light.SinOuterAngle = UMath::Sin(UMath::DegToRad(outerAngleDegrees));
+			light.CosInnerAngle = light.CosOuterAngle;
+			return light;
+		}
+
+		// The cluster containing a view space point, using the same projection as the grid
+		U32 GetClusterAtViewPosition(const CLightClusterGrid& grid, const SLightClusterFrustum& frustum, const SVector& viewPosition)
+		{
+			const F32 tanHalfFOVY = UMath::Tan(UMath::DegToRad(frustum.FOV) * 0.5f);
+			const F32 tanHalfFOVX = tanHalfFOVY * frustum.AspectRatio;
+			const F32 ndcX = viewPosition.X / (viewPosition.Z * tanHalfFOVX);
+			const F32 ndcY = viewPosition.Y / (viewPosition.Z * tanHalfFOVY);
+			const U16 x = STATIC_U16(UMath::Clamp(STATIC_I32((ndcX + 1.0f) * 0.5f * CLightClusterGrid::ClusterCountX), 0, CLightClusterGrid::ClusterCountX - 1));
+			const U16 y = STATIC_U16(UMath::Clamp(STATIC_I32((ndcY + 1.0f) * 0.5f * CLightClusterGrid::ClusterCountY), 0, CLightClusterGrid::ClusterCountY - 1));
+			return grid.GetClusterIndex(x, y, grid.GetSliceFromViewDepth(viewPosition.Z));
+		}
+
+		bool ClusterHasSpotLight(const CLightClusterGrid& grid, const U32 clusterIndex, const U16 lightIndex)
+		{
+			const SLightCluster& cluster = grid.GetClusters()[clusterIndex];
+			for (U32 i = 0; i < cluster.NumberOfSpotLights; ++i)
+			{
+				if (grid.GetLightIndices()[cluster.Offset + cluster.NumberOfPointLights + i] == lightIndex)
+					return true;
+			}
+			return false;
+		}
+
+		bool ClusterHasPointLight(const CLightClusterGrid& grid, const U32 clusterIndex, const U16 lightIndex)
+		{
+			const SLightCluster& cluster = grid.GetClusters()[clusterIndex];
+			for (U32 i = 0; i < cluster.NumberOfPointLights; ++i)
+			{
+				if (grid.GetLightIndices()[cluster.Offset + i] == lightIndex)
+					return true;
+			}
+			return false;
+		}
+
+		void CheckClusterListsAreConsistent(const CLightClusterGrid& grid)
+		{
+			const std::vector<SLightCluster>& clusters = grid.GetClusters();
+			HV_CHECK(clusters.size() == CLightClusterGrid::NumberOfClusters);
+
+			U32 expectedOffset = 0;
+			U32 numberOfOccupiedClusters = 0;
+			U32 maxLightsInCluster = 0;
+			for (const SLightCluster& cluster : clusters)
+			{
+				const U32 count = STATIC_U32(cluster.NumberOfPointLights) + cluster.NumberOfSpotLights;
+				HV_CHECK(cluster.Offset == expectedOffset);
+				HV_CHECK(count <= CLightClusterGrid::MaxLightsPerCluster);
+				expectedOffset += count;
+				numberOfOccupiedClusters += count > 0 ? 1 : 0;
+				maxLightsInCluster = UMath::Max(maxLightsInCluster, count);
+
+				for (U32 i = 0; i < cluster.NumberOfPointLights; ++i)
+					HV_CHECK(grid.GetLightIndices()[cluster.Offset + i] < grid.GetPointLights().size());
+				for (U32 i = 0; i < cluster.NumberOfSpotLights; ++i)
+					HV_CHECK(grid.GetLightIndices()[cluster.Offset + cluster.NumberOfPointLights + i] < grid.GetSpotLights().size());
+			}
+
+			const SLightClusterStats& stats = grid.GetStats();
+			HV_CHECK(grid.GetLightIndices().size() == expectedOffset);
+			HV_CHECK(stats.NumberOfLightAssignments == expectedOffset);
+			HV_CHECK(stats.NumberOfOccupiedClusters == numberOfOccupiedClusters);
+			HV_CHECK(stats.MaxLightsInCluster == maxLightsInCluster);
+		}
+	}
+
+	HV_TEST(LightClusters_PointLightOnlyReachesNearbySlices)
+	{
+		const SLightClusterFrustum frustum;
+		CLightClusterGrid grid;
+		grid.Build(SMatrix::Identity, frustum, { MakePointLight(SVector(0.3f, 0.2f, 10.0f), 1.0f) }, {});
+
+		HV_CHECK(ClusterHasPointLight(grid, GetClusterAtViewPosition(grid, frustum, SVector(0.3f, 0.2f, 10.0f)), 0));
+
+		const U16 firstSlice = grid.GetSliceFromViewDepth(9.0f);
+		const U16 lastSlice = grid.GetSliceFromViewDepth(11.0f);
+		for (U16 z = 0; z < CLightClusterGrid::ClusterCountZ; ++z)
+		{
+			if (z >= firstSlice && z <= lastSlice)
+				continue;
+
+			for (U16 y = 0; y < CLightClusterGrid::ClusterCountY; ++y)
+			{
+				for (U16 x = 0; x < CLightClusterGrid::ClusterCountX; ++x)
+					HV_CHECK(grid.GetClusters()[grid.GetClusterIndex(x, y, z)].NumberOfPointLights == 0);
+			}
+		}
+
+		// The light covers a few clusters around its center, nowhere near the whole slice
+		HV_CHECK(grid.GetStats().NumberOfLightAssignments > 0);
+		HV_CHECK(grid.GetStats().NumberOfLightAssignments < CLightClusterGrid::ClustersPerSlice);
+		CheckClusterListsAreConsistent(grid);
+	}
+
+	HV_TEST(LightClusters_LightsOutsideDepthRangeAreSkipped)
+	{
+		const SLightClusterFrustum frustum;
+		CLightClusterGrid grid;
+		grid.Build(SMatrix::Identity, frustum,
+			{ MakePointLight(SVector(0.0f, 0.0f, -10.0f), 2.0f), MakePointLight(SVector(0.0f, 0.0f, frustum.FarClip + 10.0f), 2.0f) },
+			{ MakeSpotLight(SVector(0.0f, 0.0f, -10.0f), SVector(0.0f, 0.0f, -1.0f), 5.0f, 30.0f) });
+
+		HV_CHECK(grid.GetStats().NumberOfPointLights == 2);
+		HV_CHECK(grid.GetStats().NumberOfSpotLights == 1);
+		HV_CHECK(grid.GetStats().NumberOfLightAssignments == 0);
+		HV_CHECK(grid.GetStats().NumberOfOccupiedClusters == 0);
+		CheckClusterListsAreConsistent(grid);
+	}
+
+	HV_TEST(LightClusters_SpotLightSkipsClustersBehindCone)
+	{
+		const SLightClusterFrustum frustum;
+		CLightClusterGrid grid;
+		grid.Build(SMatrix::Identity, frustum, {}, { MakeSpotLight(SVector(0.0f, 0.0f, 10.0f), SVector(0.0f, 0.0f, 1.0f), 20.0f, 10.0f) });
+
+		HV_CHECK(ClusterHasSpotLight(grid, GetClusterAtViewPosition(grid, frustum, SVector(0.1f, 0.1f, 25.0f)), 0));
+
+		// Inside the range sphere, but behind the light and outside its cone
+		HV_CHECK(!ClusterHasSpotLight(grid, GetClusterAtViewPosition(grid, frustum, SVector(0.1f, 0.1f, 4.0f)), 0));
+		HV_CHECK(!ClusterHasSpotLight(grid, GetClusterAtViewPosition(grid, frustum, SVector(0.1f, 0.1f, 6.0f)), 0));
+		CheckClusterListsAreConsistent(grid);
+	}
+
+	HV_TEST(LightClusters_CameraTransformMovesLightsIntoViewSpace)
+	{
+		const SLightClusterFrustum frustum;
+		CLightClusterGrid referenceGrid;
+		referenceGrid.Build(SMatrix::Identity, frustum, { MakePointLight(SVector(1.0f, -0.5f, 12.0f), 2.0f) }, {});
+
+		SMatrix cameraTransform = SMatrix::Identity;
+		cameraTransform.SetTranslation(SVector(50.0f, 20.0f, -100.0f));
+		CLightClusterGrid movedGrid;
+		movedGrid.Build(cameraTransform, frustum, { MakePointLight(SVector(51.0f, 19.5f, -88.0f), 2.0f) }, {});
+
+		HV_CHECK(referenceGrid.GetLightIndices() == movedGrid.GetLightIndices());
+		for (U32 clusterIndex = 0; clusterIndex < CLightClusterGrid::NumberOfClusters; ++clusterIndex)
+			HV_CHECK(referenceGrid.GetClusters()[clusterIndex].NumberOfPointLights == movedGrid.GetClusters()[clusterIndex].NumberOfPointLights);
+	}
+
+	HV_TEST(LightClusters_FullClustersDropAssignments)
+	{
+		const SLightClusterFrustum frustum;
+		const SClusteredPointLight light = MakePointLight(SVector(0.0f, 0.0f, 20.0f), 0.5f);
+
+		CLightClusterGrid singleLightGrid;
+		singleLightGrid.Build(SMatrix::Identity, frustum, { light }, {});
+		const U32 assignmentsPerLight = singleLightGrid.GetStats().NumberOfLightAssignments;
+		HV_CHECK(assignmentsPerLight > 0);
+
+		constexpr U32 numberOfLights = CLightClusterGrid::MaxLightsPerCluster + 36;
+		CLightClusterGrid grid;
+		grid.Build(SMatrix::Identity, frustum, std::vector<SClusteredPointLight>(numberOfLights, light), {});
+
+		const SLightClusterStats& stats = grid.GetStats();
+		HV_CHECK(stats.MaxLightsInCluster == CLightClusterGrid::MaxLightsPerCluster);
+		HV_CHECK(stats.NumberOfLightAssignments == assignmentsPerLight * CLightClusterGrid::MaxLightsPerCluster);
+		HV_CHECK(stats.NumberOfDroppedAssignments == assignmentsPerLight * (numberOfLights - CLightClusterGrid::MaxLightsPerCluster));
+		CheckClusterListsAreConsistent(grid);
+	}
+
+	HV_TEST(LightClusters_ClearEmptiesGrid)
+	{
+		CLightClusterGrid grid;
+		grid.Build(SMatrix::Identity, SLightClusterFrustum(), { MakePointLight(SVector(0.0f, 0.0f, 10.0f), 3.0f) }, {});
+		grid.Clear();
+
+		HV_CHECK(grid.GetClusters().empty());
+		HV_CHECK(grid.GetLightIndices().empty());
+		HV_CHECK(grid.GetStats().NumberOfLightAssignments == 0);
+	}
+
+	HV_BENCHMARK(LightClusters_Build)
+	{
+		constexpr U32 numberOfPointLights = 2048;
+		constexpr U32 numberOfSpotLights = 512;
+		constexpr U32 numberOfBuilds = 200;
+
+		std::mt19937 random(1337);
+		std::uniform_real_distribution<F32> lateral(-40.0f, 40.0f);
+		std::uniform_real_distribution<F32> depth(1.0f, 120.0f);
+		std::uniform_real_distribution<F32> range(1.0f, 8.0f);
+		std::uniform_real_distribution<F32> angle(10.0f, 60.0f);
+
+		std::vector<SClusteredPointLight> pointLights;
+		for (U32 i = 0; i < numberOfPointLights; ++i)
+			pointLights.push_back(MakePointLight(SVector(lateral(random), lateral(random), depth(random)), range(random)));
+
+		std::vector<SClusteredSpotLight> spotLights;
+		for (U32 i = 0; i < numberOfSpotLights; ++i)
+			spotLights.push_back(MakeSpotLight(SVector(lateral(random), lateral(random), depth(random)), SVector(lateral(random), -40.0f, lateral(random)).GetNormalized(), range(random) * 2.0f, angle(random)));
+
+		CLightClusterGrid grid;
+		const SLightClusterFrustum frustum;
+		grid.Build(SMatrix::Identity, frustum, pointLights, spotLights);
+
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		for (U32 i = 0; i < numberOfBuilds; ++i)
+			grid.Build(SMatrix::Identity, frustum, pointLights, spotLights);
+		const F32 milliseconds = std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		const SLightClusterStats& stats = grid.GetStats();
+		HV_LOG_INFO("Light clusters: %u point and %u spot lights, %u assignments in %u clusters, %u dropped. %.3f ms per build.",
+			stats.NumberOfPointLights, stats.NumberOfSpotLights, stats.NumberOfLightAssignments, stats.NumberOfOccupiedClusters, stats.NumberOfDroppedAssignments, milliseconds / numberOfBuilds);
+		CheckClusterListsAreConsistent(grid);
+	}
+}
@@ -0,0 +1,162 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <Compression.h>
+
+#include <chrono>
+#include <cstring>
+#include <random>
+
+namespace Havtorn
+{
+	namespace
+	{
+		// Repeating records with a few changing fields, roughly what vertex and key blobs look like
+		std::vector<char> MakeStructuredData(const U64 size)
+		{
+			std::vector<char> data(size);
+			for (U64 i = 0; i < size; i++)
+				data[i] = STATIC_I8((i % 56 < 40) ? (i % 7) : ((i / 56) * 13 + i % 56));
+			return data;
+		}
+
+		std::vector<char> MakeRandomData(const U64 size)
+		{
+			std::mt19937 random(1337);
+			std::uniform_int_distribution<I32> byte(-128, 127);
+			std::vector<char> data(size);
+			for (char& value : data)
+				value = STATIC_I8(byte(random));
+			return data;
+		}
+
+		bool DecompressPayload(const std::vector<char>& payload, std::vector<char>& outData)
+		{
+			outData.assign(UCompression::GetPayloadSize(payload.data()), 0);
+			std::vector<SCompressedChunk> chunks;
+			U64 payloadSize = 0;
+			if (!UCompression::GetPayloadChunks(payload.data(), payload.size(), outData.data(), chunks, payloadSize) || payloadSize != payload.size())
+				return false;
+
+			return UCompression::DecompressChunks(chunks);
+		}
+	}
+
+	HV_TEST(Compression_PayloadsRoundTrip)
+	{
+		// Empty, smaller than a chunk, exactly a chunk and several chunks with a partial one at the end
+		for (const U64 size : { STATIC_U64(0), STATIC_U64(1000), STATIC_U64(UCompression::PayloadChunkSize), STATIC_U64(UCompression::PayloadChunkSize) * 3 + 777 })
+		{
+			const std::vector<char> source = MakeStructuredData(size);
+			std::vector<char> payload;
+			UCompression::CompressPayload(source.data(), source.size(), payload);
+			HV_CHECK(UCompression::GetPayloadSize(payload.data()) == size);
+
+			std::vector<char> decompressed;
+			HV_CHECK(DecompressPayload(payload, decompressed));
+			HV_CHECK(decompressed == source);
+			if (size >= UCompression::PayloadChunkSize)
+				HV_CHECK(payload.size() < size / 2);
+		}
+	}
+
+	HV_TEST(Compression_IncompressibleChunksAreStored)
+	{
+		const std::vector<char> source = MakeRandomData(STATIC_U64(UCompression::PayloadChunkSize) * 2);
+		std::vector<char> payload;
+		UCompression::CompressPayload(source.data(), source.size(), payload);
+
+		std::vector<char> decompressed(source.size());
+		std::vector<SCompressedChunk> chunks;
+		U64 payloadSize = 0;
+		HV_CHECK(UCompression::GetPayloadChunks(payload.data(), payload.size(), decompressed.data(), chunks, payloadSize));
+		HV_CHECK(payloadSize == payload.size());
+		HV_CHECK(chunks.size() == 2);
+		for (const SCompressedChunk& chunk : chunks)
+			HV_CHECK(chunk.IsStored);
+
+		HV_CHECK(UCompression::DecompressChunks(chunks));
+		HV_CHECK(decompressed == source);
+	}
+
+	HV_TEST(Compression_CorruptBlocksFail)
+	{
+		const std::vector<char> source = MakeStructuredData(4096);
+		std::vector<char> block(UCompression::GetCompressBound(STATIC_U32(source.size())));
+		const U32 compressedSize = UCompression::CompressBlock(source.data(), STATIC_U32(source.size()), block.data(), STATIC_U32(block.size()));
+		HV_CHECK(compressedSize > 0);
+
+		std::vector<char> decompressed(source.size());
+		HV_CHECK(UCompression::DecompressBlock(block.data(), compressedSize, decompressed.data(), STATIC_U32(decompressed.size())));
+		HV_CHECK(decompressed == source);
+
+		// Cut short, and expected to decompress to more than it holds
+		HV_CHECK(!UCompression::DecompressBlock(block.data(), compressedSize / 2, decompressed.data(), STATIC_U32(decompressed.size())));
+		decompressed.resize(source.size() + 1);
+		HV_CHECK(!UCompression::DecompressBlock(block.data(), compressedSize, decompressed.data(), STATIC_U32(decompressed.size())));
+	}
+
+	HV_TEST(Compression_TruncatedPayloadsFail)
+	{
+		const std::vector<char> source = MakeStructuredData(STATIC_U64(UCompression::PayloadChunkSize) * 2 + 100);
+		std::vector<char> payload;
+		UCompression::CompressPayload(source.data(), source.size(), payload);
+
+		std::vector<char> decompressed(source.size());
+		std::vector<SCompressedChunk> chunks;
+		U64 payloadSize = 0;
+
+		// Cut inside the header, inside the chunk table and inside the last chunk
+		for (const U64 availableSize : { STATIC_U64(4), UCompression::PayloadHeaderSize + 4, STATIC_U64(payload.size() - 1) })
+		{
+			HV_CHECK(!UCompression::IsPayloadValid(payload.data(), availableSize, payloadSize));
+			HV_CHECK(!UCompression::GetPayloadChunks(payload.data(), availableSize, decompressed.data(), chunks, payloadSize));
+			HV_CHECK(chunks.empty());
+		}
+
+		// A chunk size pointing past the end of the payload
+		std::vector<char> corruptPayload = payload;
+		const U32 corruptChunkSize = STATIC_U32(payload.size());
+		memcpy(&corruptPayload[UCompression::PayloadHeaderSize], &corruptChunkSize, sizeof(U32));
+		HV_CHECK(!UCompression::GetPayloadChunks(corruptPayload.data(), corruptPayload.size(), decompressed.data(), chunks, payloadSize));
+		HV_CHECK(chunks.empty());
+
+		// A size that doesn't match the number of chunks
+		corruptPayload = payload;
+		const U64 corruptSize = STATIC_U64(UCompression::PayloadChunkSize) * 100;
+		memcpy(&corruptPayload[0], &corruptSize, sizeof(U64));
+		HV_CHECK(!UCompression::IsPayloadValid(corruptPayload.data(), corruptPayload.size(), payloadSize));
+
+		// Data after the payload is left alone
+		payload.resize(payload.size() + 16);
+		HV_CHECK(UCompression::GetPayloadChunks(payload.data(), payload.size(), decompressed.data(), chunks, payloadSize));
+		HV_CHECK(payloadSize == payload.size() - 16);
+		HV_CHECK(UCompression::DecompressChunks(chunks));
+		HV_CHECK(decompressed == source);
+	}
+
+	HV_BENCHMARK(Compression_DecompressPayload)
+	{
+		constexpr U32 numberOfRuns = 20;
+		const std::vector<char> source = MakeStructuredData(16 * 1024 * 1024);
+		std::vector<char> payload;
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+		UCompression::CompressPayload(source.data(), source.size(), payload);
+		const F32 compressMilliseconds = std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		std::vector<char> decompressed;
+		startTime = std::chrono::high_resolution_clock::now();
+		bool isDecompressed = true;
+		for (U32 run = 0; run < numberOfRuns; run++)
+			isDecompressed = DecompressPayload(payload, decompressed) && isDecompressed;
+		const F32 decompressMilliseconds = std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count() / numberOfRuns;
+
+		const F32 megabytes = STATIC_F32(source.size()) / (1024.0f * 1024.0f);
+		HV_LOG_INFO("Compression: %.1f MB to %.1f%%, compressed in %.2f ms, decompressed in %.2f ms (%.0f MB/s) on one thread.",
+			megabytes, 100.0f * STATIC_F32(payload.size()) / STATIC_F32(source.size()), compressMilliseconds, decompressMilliseconds, megabytes / (decompressMilliseconds / 1000.0f));
+		HV_CHECK(isDecompressed);
+		HV_CHECK(decompressed == source);
+	}
+}
@@ -0,0 +1,85 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <Graphics/Debug/DebugDrawUtility.h>
+
+#include <chrono>
+
+namespace Havtorn
+{
+	HV_TEST(DebugDraw_SyncHandsOverShapes)
+	{
+		// Without a render manager nothing is drawn, but shapes are still handed over at sync
+		GDebugDraw debugDraw;
+		if (!debugDraw.Init(nullptr))
+		{
+			HV_LOG_WARN("Debug shapes are compiled out in this configuration, skipping.");
+			return;
+		}
+
+		GDebugDraw::AddLine(SVector(0.0f), SVector::Up);
+		GDebugDraw::AddLine(SVector(0.0f), SVector(1.0f, 0.0f, 0.0f), SColor::Red, 0.1f, true);
+		GDebugDraw::AddCube(SVector(0.0f), SVector(0.0f), SVector(1.0f));
+		debugDraw.SyncCrossThreadResources(0.05f);
+
+		SDebugDrawStats stats = GDebugDraw::GetStats();
+		HV_CHECK(stats.NumberOfFrameShapes == 2);
+		HV_CHECK(stats.NumberOfTimedShapes == 1);
+		HV_CHECK(stats.NumberOfBatches == 2);
+
+		// Frame shapes are drawn once, timed shapes until their lifetime has run out
+		debugDraw.SyncCrossThreadResources(0.05f);
+		stats = GDebugDraw::GetStats();
+		HV_CHECK(stats.NumberOfFrameShapes == 0);
+		HV_CHECK(stats.NumberOfTimedShapes == 1);
+		HV_CHECK(stats.NumberOfBatches == 1);
+
+		debugDraw.SyncCrossThreadResources(0.05f);
+		stats = GDebugDraw::GetStats();
+		HV_CHECK(stats.NumberOfTimedShapes == 0);
+		HV_CHECK(stats.NumberOfBatches == 0);
+	}
+
+	HV_BENCHMARK(DebugDraw_StressTest)
+	{
+		GDebugDraw debugDraw;
+		if (!debugDraw.Init(nullptr))
+		{
+			HV_LOG_WARN("Debug shapes are compiled out in this configuration, skipping.");
+			return;
+		}
+
+		constexpr U32 numberOfFrames = 20;
+		constexpr U32 numberOfLines = 100000;
+		F32 addMilliseconds = 0.0f;
+		F32 syncMilliseconds = 0.0f;
+		for (U32 frame = 0; frame < numberOfFrames; frame++)
+		{
+			// Lines spiral outwards from the origin. Every other line is timed, every other pair ignores depth,
+			// which spreads them over all four line batches.
+			const auto startTime = std::chrono::high_resolution_clock::now();
+			for (U32 i = 0; i < numberOfLines; i++)
+			{
+				const F32 angle = STATIC_F32(i) * 0.01f;
+				const F32 radius = 1.0f + STATIC_F32(i) * 0.001f;
+				const SVector start = SVector(UMath::Cos(angle) * radius, STATIC_F32(i % 100) * 0.05f, UMath::Sin(angle) * radius);
+				const bool isTimed = (i % 2) == 1;
+				GDebugDraw::AddLine(start, start + SVector::Up * 0.5f, isTimed ? SColor::Orange : SColor::Teal, isTimed ? 0.1f : -1.0f, isTimed, GDebugDraw::ThicknessMinimum, (i % 4) < 2);
+			}
+			const auto addedTime = std::chrono::high_resolution_clock::now();
+			debugDraw.SyncCrossThreadResources(1.0f / 60.0f);
+			const auto syncedTime = std::chrono::high_resolution_clock::now();
+
+			addMilliseconds += std::chrono::duration<F32, std::milli>(addedTime - startTime).count();
+			syncMilliseconds += std::chrono::duration<F32, std::milli>(syncedTime - addedTime).count();
+		}
+
+		const SDebugDrawStats stats = GDebugDraw::GetStats();
+		HV_LOG_INFO("Debug draw: %u lines added in %.3f ms, synced in %.3f ms. %u frame shapes, %u timed shapes in %u batches.",
+			numberOfLines, addMilliseconds / numberOfFrames, syncMilliseconds / numberOfFrames, stats.NumberOfFrameShapes, stats.NumberOfTimedShapes, stats.NumberOfBatches);
+		HV_CHECK(stats.NumberOfFrameShapes == numberOfLines / 2);
+		HV_CHECK(stats.NumberOfTimedShapes > numberOfLines / 2);
+		HV_CHECK(stats.NumberOfBatches == 4);
+	}
+}
@@ -0,0 +1,27 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <CommandLine.h>
+
+#ifdef HV_PLATFORM_WINDOWS
+#include <Windows.h>
+#endif
+
+using namespace Havtorn;
+
+// Headless test runner. Returns the number of failed tests, so 0 means every test passed.
+// -Filter=Name runs only the tests whose name contains Name.
+// -Benchmark also runs the benchmarks, which log their timings and fail only if their results are wrong.
+int main()
+{
+#ifdef HV_PLATFORM_WINDOWS
+	UCommandLine::Parse(GetCommandLineA());
+#endif
+
+	const std::string filterOption = UCommandLine::GetOptionParameter("Filter");
+	const std::string filter = UCommandLine::IsOptionParameterValid(filterOption) ? filterOption : "";
+	const bool runBenchmarks = UCommandLine::HasFreeParameter("-Benchmark");
+
+	return STATIC_I32(UTestRegistry::Run(filter, runBenchmarks));
+}
@@ -0,0 +1,157 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <MeshOptimizer.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <random>
+
+namespace Havtorn
+{
+	namespace
+	{
+		// A wavy grid of quads with its triangles in random order, the worst case for the vertex cache
+		void MakeShuffledGrid(const U32 resolution, std::vector<SStaticMeshVertex>& outVertices, std::vector<U32>& outIndices)
+		{
+			outVertices.clear();
+			outIndices.clear();
+			for (U32 z = 0; z <= resolution; z++)
+			{
+				for (U32 x = 0; x <= resolution; x++)
+				{
+					const F32 u = STATIC_F32(x) / resolution;
+					const F32 v = STATIC_F32(z) / resolution;
+					outVertices.push_back({ u * 10.0f - 5.0f, UMath::Sin(u * 6.0f) * 0.5f, v * 10.0f - 5.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, u, v });
+				}
+			}
+
+			std::vector<std::array<U32, 3>> triangles;
+			for (U32 z = 0; z < resolution; z++)
+			{
+				for (U32 x = 0; x < resolution; x++)
+				{
+					const U32 corner = z * (resolution + 1) + x;
+					triangles.push_back({ corner, corner + resolution + 1, corner + 1 });
+					triangles.push_back({ corner + 1, corner + resolution + 1, corner + resolution + 2 });
+				}
+			}
+
+			std::mt19937 random(1337);
+			std::shuffle(triangles.begin(), triangles.end(), random);
+			for (const std::array<U32, 3>& triangle : triangles)
+				outIndices.insert(outIndices.end(), triangle.begin(), triangle.end());
+		}
+
+		// Triangles by the positions of their corners, rotated to start at the smallest so the winding is kept
+		std::vector<std::array<F32, 9>> GetSortedTriangles(const std::vector<SStaticMeshVertex>& vertices, const std::vector<U32>& indices)
+		{
+			std::vector<std::array<F32, 9>> triangles;
+			for (U64 i = 0; i + 2 < indices.size(); i += 3)
+			{
+				std::array<std::array<F32, 3>, 3> corners;
+				for (U64 corner = 0; corner < 3; corner++)
+				{
+					const SStaticMeshVertex& vertex = vertices[indices[i + corner]];
+					corners[corner] = { vertex.x, vertex.y, vertex.z };
+				}
+				std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+
+				std::array<F32, 9>& triangle = triangles.emplace_back();
+				for (U64 corner = 0; corner < 3; corner++)
+					std::copy(corners[corner].begin(), corners[corner].end(), triangle.begin() + corner * 3);
+			}
+
+			std::ranges::sort(triangles);
+			return triangles;
+		}
+	}
+
+	HV_TEST(MeshOptimizer_KeepsTrianglesAndLowersACMR)
+	{
+		std::vector<SStaticMeshVertex> vertices;
+		std::vector<U32> indices;
+		MakeShuffledGrid(64, vertices, indices);
+		const std::vector<std::array<F32, 9>> triangles = GetSortedTriangles(vertices, indices);
+		const F32 shuffledACMR = UMeshOptimizer::GetACMR(indices, STATIC_U32(vertices.size()));
+
+		UMeshOptimizer::Optimize(vertices, indices);
+		const F32 optimizedACMR = UMeshOptimizer::GetACMR(indices, STATIC_U32(vertices.size()));
+
+		HV_CHECK(vertices.size() == STATIC_U64(65) * 65);
+		HV_CHECK(GetSortedTriangles(vertices, indices) == triangles);
+		HV_CHECK(optimizedACMR < shuffledACMR);
+		// A regular grid can't do much better than 0.5, the shuffled one is close to no reuse at all
+		HV_CHECK(optimizedACMR < 1.0f);
+
+		// Vertices are in the order the indices first use them
+		U32 nextVertex = 0;
+		for (const U32 index : indices)
+		{
+			HV_CHECK(index <= nextVertex);
+			if (index == nextVertex)
+				nextVertex++;
+		}
+	}
+
+	HV_TEST(MeshOptimizer_DropsUnusedVertices)
+	{
+		std::vector<SStaticMeshVertex> vertices;
+		std::vector<U32> indices;
+		MakeShuffledGrid(8, vertices, indices);
+		const U64 numberOfUsedVertices = vertices.size();
+		vertices.push_back(vertices.front());
+		vertices.push_back(vertices.back());
+
+		UMeshOptimizer::Optimize(vertices, indices);
+		HV_CHECK(vertices.size() == numberOfUsedVertices);
+		for (const U32 index : indices)
+			HV_CHECK(index < vertices.size());
+	}
+
+	HV_TEST(MeshOptimizer_BoundsCoverEveryVertex)
+	{
+		std::vector<SStaticMeshVertex> vertices;
+		std::vector<U32> indices;
+		MakeShuffledGrid(16, vertices, indices);
+		std::vector<SStaticMeshVertex> otherVertices = vertices;
+		for (SStaticMeshVertex& vertex : otherVertices)
+			vertex.y += 3.0f;
+
+		const SMeshBounds bounds = UMeshOptimizer::GetBounds({ vertices, otherVertices });
+		HV_CHECK(bounds.IsValid());
+		HV_CHECK(bounds.Min.X == -5.0f && bounds.Max.X == 5.0f);
+		HV_CHECK(bounds.Min.Z == -5.0f && bounds.Max.Z == 5.0f);
+
+		F32 maxDistance = 0.0f;
+		for (const std::vector<SStaticMeshVertex>* meshVertices : { &vertices, &otherVertices })
+		{
+			for (const SStaticMeshVertex& vertex : *meshVertices)
+			{
+				HV_CHECK(vertex.y >= bounds.Min.Y && vertex.y <= bounds.Max.Y);
+				maxDistance = UMath::Max(maxDistance, SVector(vertex.x, vertex.y, vertex.z).Distance(bounds.Center));
+			}
+		}
+
+		// The sphere reaches the farthest vertex, not the box corners
+		HV_CHECK_NEAR(bounds.Radius, maxDistance, 0.0001f);
+	}
+
+	HV_BENCHMARK(MeshOptimizer_Optimize)
+	{
+		std::vector<SStaticMeshVertex> vertices;
+		std::vector<U32> indices;
+		MakeShuffledGrid(256, vertices, indices);
+		const F32 shuffledACMR = UMeshOptimizer::GetACMR(indices, STATIC_U32(vertices.size()));
+
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		UMeshOptimizer::Optimize(vertices, indices);
+		const F32 milliseconds = std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		const F32 optimizedACMR = UMeshOptimizer::GetACMR(indices, STATIC_U32(vertices.size()));
+		HV_LOG_INFO("Mesh optimizer: %u triangles in %.3f ms, ACMR %.3f -> %.3f.", STATIC_U32(indices.size() / 3), milliseconds, shuffledACMR, optimizedACMR);
+		HV_CHECK(optimizedACMR < shuffledACMR);
+	}
+}
@@ -0,0 +1,187 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <MeshSimplifier.h>
+
+namespace Havtorn
+{
+	namespace
+	{
+		// A grid of quads over X and Z. Every quad column past a split starts a new UV island with vertices of its own, so the
+		// columns at the splits are seams. The island is kept in the whole part of U.
+		SStaticMesh MakeGrid(const U32 resolution, const F32 waveHeight, const std::vector<U32>& islandSplits = {})
+		{
+			auto getIsland = [&](const U32 quadColumn)
+				{
+					U32 island = 0;
+					while (island < islandSplits.size() && quadColumn >= islandSplits[island])
+						island++;
+					return island;
+				};
+
+			SStaticMesh mesh;
+			mesh.Name = "Grid";
+			const U32 numberOfIslands = STATIC_U32(islandSplits.size()) + 1;
+			std::vector<U32> firstVertices(numberOfIslands);
+			for (U32 island = 0; island < numberOfIslands; island++)
+			{
+				firstVertices[island] = STATIC_U32(mesh.Vertices.size());
+				for (U32 z = 0; z <= resolution; z++)
+				{
+					for (U32 x = 0; x <= resolution; x++)
+					{
+						const F32 u = STATIC_F32(x) / resolution;
+						const F32 v = STATIC_F32(z) / resolution;
+						mesh.Vertices.push_back({ u, waveHeight * UMath::Sin(u * 6.0f) * UMath::Cos(v * 5.0f), v, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, STATIC_F32(island) * 10.0f + u, v });
+					}
+				}
+			}
+
+			for (U32 z = 0; z < resolution; z++)
+			{
+				for (U32 x = 0; x < resolution; x++)
+				{
+					const U32 corner = firstVertices[getIsland(x)] + z * (resolution + 1) + x;
+					mesh.Indices.insert(mesh.Indices.end(), { corner, corner + resolution + 1, corner + 1, corner + 1, corner + resolution + 1, corner + resolution + 2 });
+				}
+			}
+
+			// Leave out the vertices no island uses
+			SStaticMesh compactMesh;
+			compactMesh.Name = mesh.Name;
+			std::vector<U32> remap(mesh.Vertices.size(), UINT32_MAX);
+			for (const U32 index : mesh.Indices)
+			{
+				if (remap[index] == UINT32_MAX)
+				{
+					remap[index] = STATIC_U32(compactMesh.Vertices.size());
+					compactMesh.Vertices.push_back(mesh.Vertices[index]);
+				}
+				compactMesh.Indices.push_back(remap[index]);
+			}
+			return compactMesh;
+		}
+
+		U32 GetIsland(const SStaticMeshVertex& vertex)
+		{
+			return STATIC_U32(vertex.u / 10.0f);
+		}
+
+		bool AreIndicesValid(const SStaticMesh& mesh)
+		{
+			if (mesh.Indices.size() % 3 != 0)
+				return false;
+
+			for (const U32 index : mesh.Indices)
+			{
+				if (index >= mesh.Vertices.size())
+					return false;
+			}
+			return true;
+		}
+	}
+
+	HV_TEST(MeshSimplifier_ReachesTriangleTarget)
+	{
+		const SStaticMesh mesh = MakeGrid(32, 0.0f);
+		const U32 numberOfTriangles = STATIC_U32(mesh.Indices.size() / 3);
+
+		// A flat grid costs nothing to collapse, so only the target stops it
+		SStaticMesh simplifiedMesh;
+		const F32 error = UMeshSimplifier::Simplify(mesh, 0.25f, 1.0f, simplifiedMesh);
+		const U32 targetTriangles = numberOfTriangles / 4;
+		const U32 numberOfSimplifiedTriangles = STATIC_U32(simplifiedMesh.Indices.size() / 3);
+		HV_CHECK(AreIndicesValid(simplifiedMesh));
+		HV_CHECK(numberOfSimplifiedTriangles <= targetTriangles);
+		HV_CHECK(numberOfSimplifiedTriangles + 2 >= targetTriangles);
+		HV_CHECK(simplifiedMesh.Vertices.size() < mesh.Vertices.size());
+		HV_CHECK(error < 0.0001f);
+
+		// Every vertex is one of the input vertices
+		for (const SStaticMeshVertex& vertex : simplifiedMesh.Vertices)
+		{
+			bool isInputVertex = false;
+			for (const SStaticMeshVertex& inputVertex : mesh.Vertices)
+				isInputVertex = isInputVertex || (inputVertex.x == vertex.x && inputVertex.y == vertex.y && inputVertex.z == vertex.z && inputVertex.u == vertex.u && inputVertex.v == vertex.v);
+			HV_CHECK(isInputVertex);
+		}
+
+		SStaticMesh unchangedMesh;
+		UMeshSimplifier::Simplify(mesh, 1.0f, 1.0f, unchangedMesh);
+		HV_CHECK(unchangedMesh.Indices.size() == mesh.Indices.size());
+
+		// On a curved surface, the error bound stops it before the target
+		const SStaticMesh wavyMesh = MakeGrid(32, 0.2f);
+		constexpr F32 maxError = 0.0001f;
+		SStaticMesh boundedMesh;
+		const F32 boundedError = UMeshSimplifier::Simplify(wavyMesh, 0.25f, maxError, boundedMesh);
+		HV_CHECK(AreIndicesValid(boundedMesh));
+		HV_CHECK(boundedMesh.Indices.size() / 3 > targetTriangles);
+		HV_CHECK(boundedError <= maxError);
+	}
+
+	HV_TEST(MeshSimplifier_KeepsUVSeams)
+	{
+		// Three islands, the middle one a single quad column wide, so the two seams around it are one edge apart
+		constexpr U32 resolution = 24;
+		const SStaticMesh mesh = MakeGrid(resolution, 0.0f, { 12, 13 });
+
+		SStaticMesh simplifiedMesh;
+		UMeshSimplifier::Simplify(mesh, 0.1f, 1.0f, simplifiedMesh);
+		HV_CHECK(AreIndicesValid(simplifiedMesh));
+		HV_CHECK(simplifiedMesh.Indices.size() < mesh.Indices.size() / 2);
+
+		// No triangle spans two islands, and every vertex on a seam stays on it
+		for (U64 i = 0; i + 2 < simplifiedMesh.Indices.size(); i += 3)
+		{
+			const U32 island = GetIsland(simplifiedMesh.Vertices[simplifiedMesh.Indices[i]]);
+			HV_CHECK(GetIsland(simplifiedMesh.Vertices[simplifiedMesh.Indices[i + 1]]) == island);
+			HV_CHECK(GetIsland(simplifiedMesh.Vertices[simplifiedMesh.Indices[i + 2]]) == island);
+		}
+
+		for (const SStaticMeshVertex& vertex : simplifiedMesh.Vertices)
+		{
+			const F32 column = vertex.x * resolution;
+			const U32 island = GetIsland(vertex);
+			if (island == 1)
+				HV_CHECK(UMath::Abs(column - 12.0f) < 0.001f || UMath::Abs(column - 13.0f) < 0.001f);
+			else if (island == 0)
+				HV_CHECK(column < 12.001f);
+			else
+				HV_CHECK(column > 12.999f);
+		}
+
+		// The middle island keeps a triangle in every row, it can only shrink along the seams
+		U32 numberOfMiddleTriangles = 0;
+		for (U64 i = 0; i + 2 < simplifiedMesh.Indices.size(); i += 3)
+			numberOfMiddleTriangles += GetIsland(simplifiedMesh.Vertices[simplifiedMesh.Indices[i]]) == 1 ? 1 : 0;
+		HV_CHECK(numberOfMiddleTriangles >= 2);
+	}
+
+	HV_TEST(MeshSimplifier_HandlesDegenerateInput)
+	{
+		SStaticMesh emptyMesh;
+		SStaticMesh simplifiedMesh;
+		HV_CHECK(UMeshSimplifier::Simplify(emptyMesh, 0.5f, 1.0f, simplifiedMesh) == 0.0f);
+		HV_CHECK(simplifiedMesh.Vertices.empty() && simplifiedMesh.Indices.empty());
+
+		// A single triangle only has open borders, nothing can collapse
+		SStaticMesh triangle = MakeGrid(1, 0.0f);
+		triangle.Indices.resize(3);
+		UMeshSimplifier::Simplify(triangle, 0.1f, 1.0f, simplifiedMesh);
+		HV_CHECK(simplifiedMesh.Indices.size() == 3);
+
+		// Zero area triangles, a repeated index and vertices stacked on one position next to a regular grid
+		SStaticMesh mesh = MakeGrid(8, 0.1f);
+		const U32 firstExtraVertex = STATIC_U32(mesh.Vertices.size());
+		for (U32 i = 0; i < 3; i++)
+			mesh.Vertices.push_back(mesh.Vertices[0]);
+		mesh.Indices.insert(mesh.Indices.end(), { firstExtraVertex, firstExtraVertex + 1, firstExtraVertex + 2, 0, 0, 1, 5, 6, 7 });
+
+		UMeshSimplifier::Simplify(mesh, 0.3f, 1.0f, simplifiedMesh);
+		HV_CHECK(AreIndicesValid(simplifiedMesh));
+		HV_CHECK(!simplifiedMesh.Indices.empty());
+		HV_CHECK(simplifiedMesh.Indices.size() < mesh.Indices.size());
+	}
+}
@@ -0,0 +1,245 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <Graphics/GeometryPrimitives.h>
+#include <Graphics/OcclusionCulling.h>
+
+#include <chrono>
+
+namespace Havtorn
+{
+	namespace
+	{
+		constexpr F32 NearClip = 0.1f;
+		constexpr F32 FarClip = 1000.0f;
+
+		SMatrix GetViewProjection()
+		{
+			return SMatrix::PerspectiveFovLH(UMath::DegToRad(70.0f), STATIC_F32(COcclusionCuller::BufferWidth) / COcclusionCuller::BufferHeight, NearClip, FarClip);
+		}
+
+		SMatrix GetTranslation(const SVector& translation)
+		{
+			SMatrix transform = SMatrix::Identity;
+			transform.SetTranslation(translation);
+			return transform;
+		}
+
+		// The built in unit cube, scaled up to be used as an occluder
+		std::vector<SVector> GetCubePositions(const F32 size)
+		{
+			std::vector<SVector> positions;
+			for (const SStaticMeshVertex& vertex : GeometryPrimitives::Cube)
+				positions.emplace_back(SVector(vertex.x, vertex.y, vertex.z) * size);
+			return positions;
+		}
+
+		F32 GetNDCDepth(const F32 viewDepth)
+		{
+			return (FarClip / (FarClip - NearClip)) * (1.0f - NearClip / viewDepth);
+		}
+
+		EOcclusionResult TestUnitBox(const COcclusionCuller& culler, const SVector& center)
+		{
+			return culler.TestBounds(SVector(-0.5f), SVector(0.5f), GetTranslation(center));
+		}
+	}
+
+	HV_TEST(OcclusionCulling_RasterizerWritesClosestDepth)
+	{
+		COcclusionCuller culler;
+		culler.BeginFrame(GetViewProjection());
+		culler.AddOccluder(GetCubePositions(10.0f), GeometryPrimitives::CubeIndices, GetTranslation(SVector(0.0f, 0.0f, 20.0f)));
+		culler.RasterizeOccluders(nullptr);
+
+		const std::vector<F32>& depthBuffer = culler.GetDepthBuffer();
+		HV_CHECK(depthBuffer.size() == STATIC_U64(COcclusionCuller::BufferWidth) * COcclusionCuller::BufferHeight);
+
+		// The center pixel sees the front face of the cube, not the back face behind it
+		const F32 centerDepth = depthBuffer[STATIC_U64(COcclusionCuller::BufferHeight / 2) * COcclusionCuller::BufferWidth + COcclusionCuller::BufferWidth / 2];
+		HV_CHECK_NEAR(centerDepth, GetNDCDepth(15.0f), 0.0005f);
+
+		// Corners of the buffer are outside the cube's silhouette and keep the cleared far depth
+		HV_CHECK(depthBuffer.front() == 1.0f);
+		HV_CHECK(depthBuffer.back() == 1.0f);
+
+		const SOcclusionCullingStats& stats = culler.GetStats();
+		HV_CHECK(stats.NumberOfOccluders == 1);
+		HV_CHECK(stats.NumberOfOccluderTriangles > 0);
+		HV_CHECK(stats.NumberOfOccluderTriangles <= GeometryPrimitives::CubeIndices.size() / 3);
+	}
+
+	HV_TEST(OcclusionCulling_SharedEdgesLeaveNoCracks)
+	{
+		const SMatrix viewProjection = GetViewProjection();
+		const F32 tanHalfFOVY = UMath::Tan(UMath::DegToRad(70.0f) * 0.5f);
+		const F32 tanHalfFOVX = tanHalfFOVY * STATIC_F32(COcclusionCuller::BufferWidth) / COcclusionCuller::BufferHeight;
+
+		// Sub pixel offsets move the diagonals of the cube faces across pixel centers
+		for (U32 offsetIndex = 0; offsetIndex < 16; offsetIndex++)
+		{
+			const SVector center = SVector(STATIC_F32(offsetIndex) * 0.013f, STATIC_F32(offsetIndex) * -0.007f, 20.0f);
+			COcclusionCuller culler;
+			culler.BeginFrame(viewProjection);
+			culler.AddOccluder(GetCubePositions(10.0f), GeometryPrimitives::CubeIndices, GetTranslation(center));
+			culler.RasterizeOccluders(nullptr);
+
+			// Every pixel center inside the front face has to see the front face, never the back face behind a crack
+			const F32 frontDepth = GetNDCDepth(15.0f);
+			const F32 minX = ((center.X - 5.0f) / (15.0f * tanHalfFOVX) * 0.5f + 0.5f) * COcclusionCuller::BufferWidth;
+			const F32 maxX = ((center.X + 5.0f) / (15.0f * tanHalfFOVX) * 0.5f + 0.5f) * COcclusionCuller::BufferWidth;
+			const F32 minY = (0.5f - (center.Y + 5.0f) / (15.0f * tanHalfFOVY) * 0.5f) * COcclusionCuller::BufferHeight;
+			const F32 maxY = (0.5f - (center.Y - 5.0f) / (15.0f * tanHalfFOVY) * 0.5f) * COcclusionCuller::BufferHeight;
+
+			U32 numberOfCracks = 0;
+			for (I32 y = STATIC_I32(std::ceil(minY)) + 1; y < STATIC_I32(maxY) - 1; y++)
+			{
+				for (I32 x = STATIC_I32(std::ceil(minX)) + 1; x < STATIC_I32(maxX) - 1; x++)
+				{
+					if (std::abs(culler.GetDepthBuffer()[STATIC_U64(y) * COcclusionCuller::BufferWidth + x] - frontDepth) > 0.0005f)
+						numberOfCracks++;
+				}
+			}
+			HV_CHECK(numberOfCracks == 0);
+		}
+	}
+
+	HV_TEST(OcclusionCulling_BoundsBehindOccluderAreOccluded)
+	{
+		COcclusionCuller culler;
+		culler.BeginFrame(GetViewProjection());
+		culler.AddOccluder(GetCubePositions(10.0f), GeometryPrimitives::CubeIndices, GetTranslation(SVector(0.0f, 0.0f, 20.0f)));
+		culler.RasterizeOccluders(nullptr);
+
+		HV_CHECK(TestUnitBox(culler, SVector(0.0f, 0.0f, 40.0f)) == EOcclusionResult::Occluded);
+		HV_CHECK(TestUnitBox(culler, SVector(2.0f, -2.0f, 60.0f)) == EOcclusionResult::Occluded);
+		HV_CHECK(TestUnitBox(culler, SVector(0.0f, 0.0f, 8.0f)) == EOcclusionResult::Visible);
+
+		// Inside the occluder, in front of its back faces but behind its front face
+		HV_CHECK(TestUnitBox(culler, SVector(0.0f, 0.0f, 20.0f)) == EOcclusionResult::Occluded);
+
+		HV_CHECK(TestUnitBox(culler, SVector(0.0f, 0.0f, -5.0f)) == EOcclusionResult::OutsideFrustum);
+		HV_CHECK(TestUnitBox(culler, SVector(500.0f, 0.0f, 40.0f)) == EOcclusionResult::OutsideFrustum);
+		HV_CHECK(TestUnitBox(culler, SVector(0.0f, 0.0f, FarClip + 10.0f)) == EOcclusionResult::OutsideFrustum);
+
+		// Crossing the near plane can't be projected, so it has to count as visible
+		HV_CHECK(TestUnitBox(culler, SVector(0.0f, 0.0f, 0.0f)) == EOcclusionResult::Visible);
+	}
+
+	HV_TEST(OcclusionCulling_TilesPartlyCoveredByOccluderAreCheckedPerPixel)
+	{
+		COcclusionCuller culler;
+		culler.BeginFrame(GetViewProjection());
+		culler.AddOccluder(GetCubePositions(10.0f), GeometryPrimitives::CubeIndices, GetTranslation(SVector(0.0f, 0.0f, 20.0f)));
+		culler.RasterizeOccluders(nullptr);
+
+		// The box straddles the cube's silhouette at x = 5 / 15 of the view depth, so some of its tiles are only partly covered.
+		// Their max depth is the cleared far depth, which must not let the box count as occluded.
+		HV_CHECK(TestUnitBox(culler, SVector(15.0f, 0.0f, 45.0f)) == EOcclusionResult::Visible);
+		HV_CHECK(TestUnitBox(culler, SVector(0.0f, 15.0f, 45.0f)) == EOcclusionResult::Visible);
+
+		// Well inside the silhouette every touched tile is fully covered
+		HV_CHECK(TestUnitBox(culler, SVector(9.0f, 0.0f, 45.0f)) == EOcclusionResult::Occluded);
+
+		// In front of the occluder's front face at about the same screen position
+		HV_CHECK(TestUnitBox(culler, SVector(2.8f, 0.0f, 14.0f)) == EOcclusionResult::Visible);
+	}
+
+	HV_TEST(OcclusionCulling_BoundsAtBufferEdgesStayInRange)
+	{
+		COcclusionCuller culler;
+		culler.BeginFrame(GetViewProjection());
+
+		// A wall filling the whole view, so bounds reaching past the buffer edges are tested against the outermost tiles
+		culler.AddOccluder(GetCubePositions(400.0f), GeometryPrimitives::CubeIndices, GetTranslation(SVector(0.0f, 0.0f, 230.0f)));
+		culler.RasterizeOccluders(nullptr);
+
+		const SVector boundsMin = SVector(-20.0f, -20.0f, -1.0f);
+		const SVector boundsMax = SVector(20.0f, 20.0f, 1.0f);
+		for (const SVector& center : { SVector(-360.0f, 0.0f, 250.0f), SVector(360.0f, 0.0f, 250.0f), SVector(0.0f, -180.0f, 250.0f), SVector(0.0f, 180.0f, 250.0f), SVector(360.0f, 180.0f, 250.0f) })
+			HV_CHECK(culler.TestBounds(boundsMin, boundsMax, GetTranslation(center)) == EOcclusionResult::Occluded);
+
+		COcclusionCuller emptyCuller;
+		emptyCuller.BeginFrame(GetViewProjection());
+		emptyCuller.RasterizeOccluders(nullptr);
+		HV_CHECK(!emptyCuller.HasOccluders());
+		HV_CHECK(emptyCuller.TestBounds(boundsMin, boundsMax, GetTranslation(SVector(0.0f, 0.0f, 250.0f))) == EOcclusionResult::Visible);
+	}
+
+	HV_TEST(OcclusionCulling_BatchedQueriesMatchSingleQueries)
+	{
+		COcclusionCuller culler;
+		culler.BeginFrame(GetViewProjection());
+		for (I32 i = 0; i < 16; i++)
+			culler.AddOccluder(GetCubePositions(4.0f), GeometryPrimitives::CubeIndices, GetTranslation(SVector(STATIC_F32(i % 4) * 8.0f - 12.0f, STATIC_F32(i / 4) * 6.0f - 9.0f, 30.0f + i)));
+		culler.RasterizeOccluders(nullptr);
+
+		std::vector<SOcclusionQuery> queries(1000);
+		for (U64 i = 0; i < queries.size(); i++)
+		{
+			queries[i].Transform = GetTranslation(SVector(STATIC_F32(i % 40) * 2.0f - 40.0f, STATIC_F32((i / 40) % 25) * 2.0f - 25.0f, 10.0f + STATIC_F32(i % 7) * 15.0f));
+			queries[i].BoundsMin = SVector(-0.5f);
+			queries[i].BoundsMax = SVector(0.5f);
+		}
+
+		std::vector<EOcclusionResult> results;
+		culler.TestBounds(queries, results, nullptr);
+		HV_CHECK(results.size() == queries.size());
+
+		U32 numberOfVisible = 0, numberOfFrustumCulled = 0, numberOfOccluded = 0;
+		for (U64 i = 0; i < queries.size(); i++)
+		{
+			const EOcclusionResult result = culler.TestBounds(queries[i].BoundsMin, queries[i].BoundsMax, queries[i].Transform);
+			HV_CHECK(results[i] == result);
+			numberOfVisible += result == EOcclusionResult::Visible ? 1 : 0;
+			numberOfFrustumCulled += result == EOcclusionResult::OutsideFrustum ? 1 : 0;
+			numberOfOccluded += result == EOcclusionResult::Occluded ? 1 : 0;
+		}
+
+		const SOcclusionCullingStats& stats = culler.GetStats();
+		HV_CHECK(stats.NumberOfVisibleInstances == numberOfVisible);
+		HV_CHECK(stats.NumberOfFrustumCulledInstances == numberOfFrustumCulled);
+		HV_CHECK(stats.NumberOfOccludedInstances == numberOfOccluded);
+		HV_CHECK(numberOfOccluded > 0);
+		HV_CHECK(numberOfVisible > 0);
+	}
+
+	HV_BENCHMARK(OcclusionCulling_RasterizeAndTest)
+	{
+		constexpr U32 numberOfFrames = 50;
+		std::vector<SOcclusionQuery> queries(20000);
+		for (U64 i = 0; i < queries.size(); i++)
+		{
+			queries[i].Transform = GetTranslation(SVector(STATIC_F32(i % 200) * 0.5f - 50.0f, STATIC_F32((i / 200) % 100) * 0.5f - 25.0f, 20.0f + STATIC_F32(i % 37) * 5.0f));
+			queries[i].BoundsMin = SVector(-0.5f);
+			queries[i].BoundsMax = SVector(0.5f);
+		}
+
+		const std::vector<SVector> cubePositions = GetCubePositions(3.0f);
+		COcclusionCuller culler;
+		std::vector<EOcclusionResult> results;
+		F32 rasterizeMilliseconds = 0.0f;
+		F32 testMilliseconds = 0.0f;
+		for (U32 frame = 0; frame < numberOfFrames; frame++)
+		{
+			const auto startTime = std::chrono::high_resolution_clock::now();
+			culler.BeginFrame(GetViewProjection());
+			for (I32 i = 0; i < 100; i++)
+				culler.AddOccluder(cubePositions, GeometryPrimitives::CubeIndices, GetTranslation(SVector(STATIC_F32(i % 10 - 5) * 4.0f, STATIC_F32(i / 10 - 5) * 4.0f, 30.0f + i)));
+			culler.RasterizeOccluders(nullptr);
+			const auto rasterizedTime = std::chrono::high_resolution_clock::now();
+			culler.TestBounds(queries, results, nullptr);
+			const auto testedTime = std::chrono::high_resolution_clock::now();
+
+			rasterizeMilliseconds += std::chrono::duration<F32, std::milli>(rasterizedTime - startTime).count();
+			testMilliseconds += std::chrono::duration<F32, std::milli>(testedTime - rasterizedTime).count();
+		}
+
+		const SOcclusionCullingStats& stats = culler.GetStats();
+		HV_LOG_INFO("Occlusion culling: %u occluder triangles rasterized in %.3f ms, %u queries tested in %.3f ms. %u visible, %u outside the frustum, %u occluded.",
+			stats.NumberOfOccluderTriangles, rasterizeMilliseconds / numberOfFrames, STATIC_U32(queries.size()), testMilliseconds / numberOfFrames,
+			stats.NumberOfVisibleInstances, stats.NumberOfFrustumCulledInstances, stats.NumberOfOccludedInstances);
+		HV_CHECK(stats.NumberOfOccludedInstances > 0);
+	}
+}
@@ -0,0 +1,62 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <chrono>
+
+namespace Havtorn
+{
+	U32 UTestRegistry::CurrentFailures = 0;
+
+	bool UTestRegistry::Register(const char* name, std::function<void()> function, const bool isBenchmark)
+	{
+		GetTestCases().push_back({ name, function, isBenchmark });
+		return true;
+	}
+
+	void UTestRegistry::ReportFailure(const char* file, const I32 line, const char* expression)
+	{
+		HV_LOG_ERROR("%s(%i): Check failed: %s", file, line, expression);
+		CurrentFailures++;
+	}
+
+	U32 UTestRegistry::Run(const std::string& filter, const bool runBenchmarks)
+	{
+		U32 numberOfRun = 0;
+		U32 numberOfFailed = 0;
+		for (const STestCase& testCase : GetTestCases())
+		{
+			if (testCase.IsBenchmark && !runBenchmarks)
+				continue;
+
+			if (!filter.empty() && testCase.Name.find(filter) == std::string::npos)
+				continue;
+
+			CurrentFailures = 0;
+			const auto startTime = std::chrono::high_resolution_clock::now();
+			testCase.Function();
+			const F32 milliseconds = std::chrono::duration<F32, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+			numberOfRun++;
+			if (CurrentFailures > 0)
+			{
+				numberOfFailed++;
+				HV_LOG_ERROR("[ FAILED ] %s (%u checks failed, %.2f ms)", testCase.Name.c_str(), CurrentFailures, milliseconds);
+			}
+			else
+			{
+				HV_LOG_INFO("[ PASSED ] %s (%.2f ms)", testCase.Name.c_str(), milliseconds);
+			}
+		}
+
+		HV_LOG_INFO("%u of %u tests passed", numberOfRun - numberOfFailed, numberOfRun);
+		return numberOfFailed;
+	}
+
+	std::vector<STestCase>& UTestRegistry::GetTestCases()
+	{
+		// Function local so registration from other translation units' static initializers sees a constructed vector
+		static std::vector<STestCase> testCases;
+		return testCases;
+	}
+}
@@ -0,0 +1,72 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#pragma once
+
+#include <EngineTypes.h>
+#include <Log.h>
+
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Havtorn
+{
+	struct STestCase
+	{
+		std::string Name;
+		std::function<void()> Function;
+		bool IsBenchmark = false;
+	};
+
+	// Collects every HV_TEST and HV_BENCHMARK in the executable. Tests build their own fixtures,
+	// so the runner needs no assets, window or graphics device.
+	class UTestRegistry
+	{
+	public:
+		static bool Register(const char* name, std::function<void()> function, const bool isBenchmark);
+		static void ReportFailure(const char* file, const I32 line, const char* expression);
+
+		// Runs every test whose name contains filter, and the benchmarks as well if runBenchmarks is set. Returns the number of failed tests.
+		static U32 Run(const std::string& filter, const bool runBenchmarks);
+
+	private:
+		static std::vector<STestCase>& GetTestCases();
+		static U32 CurrentFailures;
+	};
+
+	// A fresh directory under the system's temporary directory, removed again when the test is done with it
+	class CTestDirectory
+	{
+	public:
+		explicit CTestDirectory(const std::string& name)
+			: Path((std::filesystem::temp_directory_path() / "HavtornTests" / name).generic_string())
+		{
+			std::filesystem::remove_all(Path);
+			std::filesystem::create_directories(Path);
+		}
+
+		~CTestDirectory()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(Path, error);
+		}
+
+		const std::string Path;
+	};
+}
+
+#define HV_TEST_CASE(name, isBenchmark) \
+	static void name(); \
+	static const bool name##Registered = ::Havtorn::UTestRegistry::Register(#name, &name, isBenchmark); \
+	static void name()
+
+#define HV_TEST(name) HV_TEST_CASE(name, false)
+#define HV_BENCHMARK(name) HV_TEST_CASE(name, true)
+
+#define HV_CHECK(expression) \
+	do { if (!(expression)) ::Havtorn::UTestRegistry::ReportFailure(__FILE__, __LINE__, #expression); } while (false)
+
+#define HV_CHECK_NEAR(a, b, tolerance) \
+	do { if (!(std::abs((a) - (b)) <= (tolerance))) ::Havtorn::UTestRegistry::ReportFailure(__FILE__, __LINE__, #a " ~= " #b); } while (false)
@@ -0,0 +1,179 @@
+// Copyright 2025 Team Havtorn. All Rights Reserved.
+
+#include "TestFramework.h"
+
+#include <Assets/FileHeaderDeclarations.h>
+#include <MeshOptimizer.h>
+#include <VertexQuantization.h>
+
+#include <cstring>
+
+namespace Havtorn
+{
+	namespace
+	{
+		SStaticMesh MakeStaticMesh(const U32 resolution, const F32 offset)
+		{
+			SStaticMesh mesh;
+			mesh.Name = "Grid";
+			for (U32 z = 0; z <= resolution; z++)
+			{
+				for (U32 x = 0; x <= resolution; x++)
+				{
+					const F32 u = STATIC_F32(x) / resolution;
+					const F32 v = STATIC_F32(z) / resolution;
+					const SVector normal = SVector(-UMath::Cos(u * 6.0f) * 0.5f, 1.0f, 0.2f * v).GetNormalized();
+					const SVector tangent = SVector(1.0f, 0.0f, 0.0f).Cross(normal).Cross(normal).GetNormalized();
+					const SVector bitangent = normal.Cross(tangent);
+					mesh.Vertices.push_back({ u * 10.0f - 5.0f + offset, UMath::Sin(u * 6.0f) * 0.5f, v * 10.0f - 5.0f, normal.X, normal.Y, normal.Z, tangent.X, tangent.Y, tangent.Z, bitangent.X, bitangent.Y, bitangent.Z, u * 2.0f, v });
+				}
+			}
+
+			for (U32 z = 0; z < resolution; z++)
+			{
+				for (U32 x = 0; x < resolution; x++)
+				{
+					const U32 corner = z * (resolution + 1) + x;
+					mesh.Indices.insert(mesh.Indices.end(), { corner, corner + resolution + 1, corner + 1, corner + 1, corner + resolution + 1, corner + resolution + 2 });
+				}
+			}
+			return mesh;
+		}
+
+		SStaticModelFileHeader MakeStaticModel()
+		{
+			SStaticModelFileHeader header;
+			header.Name = "QuantizationTestModel";
+			header.Meshes.push_back(MakeStaticMesh(32, 0.0f));
+			header.Meshes.push_back(MakeStaticMesh(16, 12.0f));
+			header.NumberOfMeshes = STATIC_U32(header.Meshes.size());
+			header.NumberOfMaterials = 1;
+
+			std::vector<std::span<const SStaticMeshVertex>> meshVertices;
+			for (const SStaticMesh& mesh : header.Meshes)
+				meshVertices.emplace_back(mesh.Vertices);
+			header.Bounds = UMeshOptimizer::GetBounds(meshVertices);
+			return header;
+		}
+
+		SSkeletalModelFileHeader MakeSkeletalModel()
+		{
+			SSkeletalModelFileHeader header;
+			header.Name = "QuantizationTestSkeletalModel";
+			const SStaticMesh staticMesh = MakeStaticMesh(24, 0.0f);
+
+			SSkeletalMesh& mesh = header.Meshes.emplace_back();
+			mesh.Name = staticMesh.Name;
+			mesh.Indices = staticMesh.Indices;
+			for (U64 i = 0; i < staticMesh.Vertices.size(); i++)
+			{
+				const SStaticMeshVertex& vertex = staticMesh.Vertices[i];
+				const F32 weight = STATIC_F32(i % 7) / 7.0f;
+				mesh.Vertices.push_back({ vertex.x, vertex.y, vertex.z, vertex.nx, vertex.ny, vertex.nz, vertex.tx, vertex.ty, vertex.tz, vertex.bx, vertex.by, vertex.bz, vertex.u, vertex.v,
+					STATIC_F32(i % 200), STATIC_F32((i + 1) % 200), 0.0f, 0.0f, weight, 1.0f - weight, 0.0f, 0.0f });
+			}
+			header.NumberOfMeshes = 1;
+			header.NumberOfMaterials = 1;
+			return header;
+		}
+
+		template<typename THeader>
+		std::vector<char> Serialize(const THeader& header)
+		{
+			std::vector<char> data(header.GetSize());
+			header.Serialize(data.data());
+			return data;
+		}
+
+		template<typename TVertex>
+		bool AreSameBytes(std::span<const TVertex> a, const std::vector<TVertex>& b)
+		{
+			return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size_bytes()) == 0;
+		}
+	}
+
+	HV_TEST(VertexQuantization_StaticMeshWithinErrorBounds)
+	{
+		SStaticModelFileHeader header = MakeStaticModel();
+		HV_CHECK(header.QuantizeVertices());
+		HV_CHECK(header.CompactVertices.size() == header.Meshes.size());
+
+		SVertexQuantizationError error;
+		for (const SStaticMesh& mesh : header.Meshes)
+		{
+			std::vector<SCompactStaticMeshVertex> compactVertices;
+			error.Add(UVertexQuantization::Encode(mesh.Vertices, header.Quantization, compactVertices));
+		}
+
+		HV_CHECK(UVertexQuantization::IsWithinErrorBounds(error, header.Quantization));
+		HV_CHECK(error.Direction <= UVertexQuantization::MaxDirectionError);
+		HV_CHECK(error.UV <= UVertexQuantization::MaxUVError);
+	}
+
+	HV_TEST(VertexQuantization_StaticMeshFileRoundTrips)
+	{
+		SStaticModelFileHeader header = MakeStaticModel();
+		HV_CHECK(header.QuantizeVertices());
+
+		std::vector<std::vector<SStaticMeshVertex>> decodedVertices(header.CompactVertices.size());
+		for (U64 i = 0; i < header.CompactVertices.size(); i++)
+			UVertexQuantization::Decode(header.CompactVertices[i], header.Quantization, decodedVertices[i]);
+
+		// Once as is and once with compressed payloads, both decode to the same vertices
+		for (const bool shouldCompress : { false, true })
+		{
+			if (shouldCompress)
+				header.CompressPayloads();
+
+			const std::vector<char> data = Serialize(header);
+			SStaticModelFileHeader readHeader;
+			readHeader.Deserialize(data.data(), data.size());
+
+			HV_CHECK(readHeader.NumberOfMeshes == header.NumberOfMeshes);
+			HV_CHECK(readHeader.Bounds.Min.X == header.Bounds.Min.X && readHeader.Bounds.Radius == header.Bounds.Radius);
+			for (U32 i = 0; i < STATIC_U32(decodedVertices.size()); i++)
+			{
+				HV_CHECK(AreSameBytes(readHeader.GetVertices(STATIC_U8(i / header.NumberOfMeshes), i % header.NumberOfMeshes), decodedVertices[i]));
+				HV_CHECK(AreSameBytes(readHeader.GetIndices(STATIC_U8(i / header.NumberOfMeshes), i % header.NumberOfMeshes), header.Meshes[i].Indices));
+			}
+		}
+	}
+
+	HV_TEST(VertexQuantization_SkeletalMeshFileRoundTrips)
+	{
+		SSkeletalModelFileHeader header = MakeSkeletalModel();
+		HV_CHECK(header.QuantizeVertices());
+
+		std::vector<SSkeletalMeshVertex> decodedVertices;
+		UVertexQuantization::Decode(header.CompactVertices[0], header.Quantization, decodedVertices);
+
+		std::vector<SCompactSkeletalMeshVertex> compactVertices;
+		const SVertexQuantizationError error = UVertexQuantization::Encode(header.Meshes[0].Vertices, header.Quantization, compactVertices);
+		HV_CHECK(UVertexQuantization::IsWithinErrorBounds(error, header.Quantization));
+		HV_CHECK(!error.HasUnsupportedBoneIndices);
+		HV_CHECK(error.BoneWeight <= UVertexQuantization::MaxBoneWeightError);
+
+		// Bone indices survive exactly
+		for (U64 i = 0; i < decodedVertices.size(); i++)
+			HV_CHECK(decodedVertices[i].bix == header.Meshes[0].Vertices[i].bix && decodedVertices[i].biy == header.Meshes[0].Vertices[i].biy);
+
+		for (const bool shouldCompress : { false, true })
+		{
+			if (shouldCompress)
+				header.CompressPayloads();
+
+			const std::vector<char> data = Serialize(header);
+			SSkeletalModelFileHeader readHeader;
+			readHeader.Deserialize(data.data(), data.size());
+			HV_CHECK(AreSameBytes(readHeader.GetVertices(0), decodedVertices));
+		}
+	}
+
+	HV_TEST(VertexQuantization_RejectsBoneIndicesOutsideAByte)
+	{
+		SSkeletalModelFileHeader header = MakeSkeletalModel();
+		header.Meshes[0].Vertices[3].bix = 300.0f;
+		HV_CHECK(!header.QuantizeVertices());
+		HV_CHECK(header.CompactVertices.empty());
+	}
+}